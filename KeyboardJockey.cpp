@@ -1,2655 +1,3847 @@
-// KeyboardJockey.cpp - A keyboard-driven mouse navigation utility
-// Minimizes to tray, shows grid overlay on Ctrl+Alt+M, type letters to move mouse
-
-#define WIN32_LEAN_AND_MEAN
-#define OEMRESOURCE  // Required for OCR_* cursor constants
-
-#include <windows.h>
-#include <shellapi.h>
-#include <ShellScalingApi.h>
-#pragma comment(lib, "Shcore.lib")
-#include <vector>
-#include <string>
-#include <map>
-#include <cstdlib>
-#include <cmath>
-#include <algorithm>
-#include <thread>
-
-// Resource IDs
-#define IDI_KEYBOARDJOCKEY 101
-#define IDM_EXIT 1001
-#define IDM_SHOW 1002
-#define IDM_PALETTE 1003
-
-// Constants
-#define WM_TRAYICON (WM_USER + 1)
-#define HOTKEY_ID_SHOW_GRID 1
-#define TARGET_CELL_SIZE_DIP 86  // Target cell size in device-independent pixels (at 96 DPI)
-#define TIMER_ID_RESET 1
-#define TIMER_ID_TAB_TEXT 2
-#define RESET_TIMEOUT_MS 3000
-#define TAB_TEXT_TIMEOUT_MS 4000
-#define GRID_ALPHA 160           // Default grid overlay opacity (0-255)
-#define MOUSE_MOVE_ALPHA 0       // Overlay fully invisible during arrow-key mouse movement
-#define SHIFT_PEEK_ALPHA 51      // 80% transparent peek when Shift held in typing mode
-#define ACTIVATION_DELAY_MS 50   // Brief sleep before activating a window
-#define DEFAULT_DPI 96           // Standard Windows DPI baseline
-#define MAIN_FONT_HEIGHT_PCT 80  // Main label font height as % of sub-cell height
-#define MAIN_FONT_WIDTH_DIV 5    // Main label font width = cellW / this
-#define MIN_MAIN_FONT_SIZE (-8)  // Floor for main label font
-#define SUB_FONT_HEIGHT_PCT 60   // Sub-label font height as % of sub-cell height
-#define MIN_SUB_FONT_SIZE (-6)   // Floor for sub-label font
-#define DT_CENTERED (DT_CENTER | DT_VCENTER | DT_SINGLELINE)
-
-static const wchar_t* GRID_FONT_NAME = L"Segoe UI Variable Display";
-static const wchar_t* SUB_LABELS = L"abcdefgh";
-static const DWORD CURSOR_IDS[] = { OCR_NORMAL, OCR_IBEAM, OCR_HAND, OCR_CROSS,
-                                    OCR_SIZEALL, OCR_SIZENWSE, OCR_SIZENESW, OCR_SIZEWE, OCR_SIZENS };
-
-// Centralized color palette – all colors generated from a single base hue
-struct Palette {
-    // Base grid
-    COLORREF background;              // Overall background fill
-    COLORREF cellBgEven;              // Checkerboard cell fill (even)
-    COLORREF cellBgOdd;               // Checkerboard cell fill (odd)
-    COLORREF gridLine;                // Major cell border lines
-    COLORREF subGridLine;             // 3×3 sub-grid lines inside each cell
-    COLORREF mainLabelText;           // Main 3-letter label text
-    COLORREF subLabelText;            // Sub-label text (a–h)
-
-    // Typing – fully matched cell
-    COLORREF matchCellBg;             // Background of the matched cell
-    COLORREF matchGridLine;           // Sub-grid lines on the matched cell
-    COLORREF matchLabelText;          // Main label on the matched cell
-    COLORREF matchSubLabelText;       // Sub-labels on the matched cell
-    COLORREF matchSubHighlightBg;     // Highlighted sub-cell background
-    COLORREF matchSubHighlightText;   // Highlighted sub-cell text
-
-    // Typing – partial match
-    COLORREF partialMatchBg;          // Partially matched cell background
-    COLORREF partialMatchText;        // Text on partially matched cell
-
-    // Typing – non-match (dimmed)
-    COLORREF dimBg;                   // Dimmed non-matching cell background
-    COLORREF dimText;                 // Dimmed non-matching cell text
-
-    // Window highlight (TAB mode) reuses: mainLabelText, gridLine,
-    //   matchCellBg, cellBgEven, matchLabelText
-    // Minimized panel reuses: background, gridLine, mainLabelText,
-    //   subLabelText, matchSubHighlightBg, matchSubHighlightText
-};
-
-// --- HSL → RGB conversion for generative palette ---
-static COLORREF hsl(float h, float s, float l) {
-    h = fmodf(h, 360.0f);
-    if (h < 0.0f) h += 360.0f;
-    float c = (1.0f - fabsf(2.0f * l - 1.0f)) * s;
-    float x = c * (1.0f - fabsf(fmodf(h / 60.0f, 2.0f) - 1.0f));
-    float m = l - c / 2.0f;
-    float r, g, b;
-    if      (h < 60.0f)  { r = c; g = x; b = 0; }
-    else if (h < 120.0f) { r = x; g = c; b = 0; }
-    else if (h < 180.0f) { r = 0; g = c; b = x; }
-    else if (h < 240.0f) { r = 0; g = x; b = c; }
-    else if (h < 300.0f) { r = x; g = 0; b = c; }
-    else                  { r = c; g = 0; b = x; }
-    return RGB(
-        max(0, min(255, (int)((r + m) * 255.0f + 0.5f))),
-        max(0, min(255, (int)((g + m) * 255.0f + 0.5f))),
-        max(0, min(255, (int)((b + m) * 255.0f + 0.5f))));
-}
-
-// Color wheel:  0°=Red  30°=Orange  60°=Yellow  120°=Green
-//               180°=Cyan  210°=Azure  240°=Blue  270°=Purple  300°=Magenta
-//
-// ► Change BASE_HUE to shift the entire UI to your favorite color.
-#define BASE_HUE_DEFAULT 30.0f  // 30 = woodsy amber (default)
-                                  // Try: 270 = purple, 210 = ocean blue, 0 = crimson,
-                                  //      160 = teal, 340 = rose, 60 = golden
-
-static float g_baseHue = BASE_HUE_DEFAULT;  // Current hue – changed at runtime by palette picker
-
-static Palette GeneratePalette(float H) {
-    float A = H + 90.0f;  // accent hue – 90° offset for natural contrast
-
-    Palette p;
-    //                               Hue          Sat    Light
-    // -- base grid ------------------------------------------------
-    p.background            = hsl(H,         0.40f, 0.04f);  // very dark base
-    p.cellBgEven            = hsl(H,         0.40f, 0.12f);  // dark base tint
-    p.cellBgOdd             = hsl(A,         0.35f, 0.12f);  // dark accent (checker)
-    p.gridLine              = hsl(H,         0.25f, 0.32f);  // medium base
-    p.subGridLine           = hsl(H + 45,    0.20f, 0.25f);  // muted mid-tone
-    p.mainLabelText         = hsl(H + 10,    0.65f, 0.65f);  // bright warm label
-    p.subLabelText          = hsl(A - 20,    0.30f, 0.58f);  // medium accent
-
-    // -- typing: full match ---------------------------------------
-    p.matchCellBg           = hsl(A,         0.45f, 0.20f);  // rich accent bg
-    p.matchGridLine         = hsl(A,         0.45f, 0.33f);  // bright accent lines
-    p.matchLabelText        = hsl(H,         0.20f, 0.90f);  // near-white base tint
-    p.matchSubLabelText     = hsl(A,         0.35f, 0.72f);  // light accent
-    p.matchSubHighlightBg   = hsl(A,         0.55f, 0.33f);  // vivid accent
-    p.matchSubHighlightText = hsl(H,         0.10f, 0.95f);  // near-white
-
-    // -- typing: partial match ------------------------------------
-    p.partialMatchBg        = hsl(A,         0.35f, 0.12f);  // subtle accent
-    p.partialMatchText      = hsl(A,         0.45f, 0.75f);  // bright accent
-
-    // -- typing: non-match (dimmed) -------------------------------
-    p.dimBg                 = hsl(H,         0.30f, 0.04f);  // fade to background
-    p.dimText               = hsl(H,         0.20f, 0.25f);  // muted base
-
-    return p;
-}
-
-static Palette g_palette = GeneratePalette(BASE_HUE_DEFAULT);
-
-// Global variables
-HINSTANCE g_hInstance;
-HWND g_hMainWnd = NULL;
-HWND g_hOverlayWnd = NULL;
-NOTIFYICONDATA g_nid = {};
-bool g_bGridVisible = false;
-bool g_bMouseMoveMode = false;  // True when using arrow keys
-bool g_bCursorHidden = false;   // True when cursor is hidden via Space
-HHOOK g_hMouseHook = NULL;      // Low-level mouse hook
-HHOOK g_hKeyboardHook = NULL;   // Low-level keyboard hook for hiding cursor on typing
-bool g_bCursorAnimating = false; // True during cursor shrink animation
-HCURSOR g_hSavedArrow = NULL;    // Saved copy of default arrow cursor for animation
-bool g_bScrollMode = false;       // True when in PgUp/PgDn scroll-through mode
-HHOOK g_hScrollMouseHook = NULL;  // Mouse hook for detecting movement in scroll mode
-bool g_bTabTextMode = false;      // True when in TAB "select by text" mode (all windows shown)
-std::wstring g_typedChars;
-std::map<std::wstring, POINT> g_gridMap;
-
-// Cached base grid bitmap (rendered once at startup)
-HBITMAP g_hGridBitmap = NULL;
-int g_gridBitmapW = 0;
-int g_gridBitmapH = 0;
-
-// Virtual screen bounds (all monitors combined)
-struct VirtualScreenBounds {
-    int left, top, width, height;
-};
-
-inline VirtualScreenBounds GetVirtualScreenBounds() {
-    return {
-        GetSystemMetrics(SM_XVIRTUALSCREEN),
-        GetSystemMetrics(SM_YVIRTUALSCREEN),
-        GetSystemMetrics(SM_CXVIRTUALSCREEN),
-        GetSystemMetrics(SM_CYVIRTUALSCREEN)
-    };
-}
-
-// Per-monitor info
-struct MonitorInfo {
-    HMONITOR hMonitor;
-    RECT rcMonitor;
-    UINT dpiX, dpiY;
-    wchar_t prefix;  // First letter of labels on this monitor ('a', 'b', ...)
-};
-std::vector<MonitorInfo> g_monitors;
-
-// Grid cell structure
-struct GridCell {
-    RECT rect;
-    std::wstring label;  // 3-letter label: monitor prefix + 2-char cell code
-    POINT center;
-    POINT subPoints[9];  // 3x3 sub-grid points (0-8, center is 4)
-    int gridRow, gridCol; // Position in the monitor grid (for checkerboard)
-};
-
-std::vector<GridCell> g_cells;
-
-// Window highlight (TAB cycling) state
-struct AppWindow {
-    HWND hwnd;
-    RECT rect;
-    std::wstring title;
-    int visibleArea;  // Pixels of visible (unoccluded) area
-};
-std::vector<AppWindow> g_appWindows;
-std::vector<AppWindow> g_allAppWindows;  // All enumerated windows (including 0 visible area)
-std::vector<AppWindow> g_minimizedWindows;  // Minimized windows
-std::vector<AppWindow> g_allMinimizedWindows;  // All minimized (before search filter)
-int g_highlightIndex = -1;  // -1 = no highlight active
-std::wstring g_tabSearchStr;  // Substring search in TAB mode
-
-HWND g_hPaletteWnd = NULL;  // Palette picker window
-
-// Forward declarations
-LRESULT CALLBACK MainWndProc(HWND, UINT, WPARAM, LPARAM);
-LRESULT CALLBACK OverlayWndProc(HWND, UINT, WPARAM, LPARAM);
-LRESULT CALLBACK PaletteWndProc(HWND, UINT, WPARAM, LPARAM);
-void CreateTrayIcon(HWND hWnd);
-void RemoveTrayIcon();
-void ShowContextMenu(HWND hWnd);
-void ShowPaletteWindow();
-void ApplyHue(float hue);
-void CreateOverlayWindow();
-void ShowGrid();
-void HideGrid();
-void BuildGridCells();
-void RenderBaseGridBitmap();
-void PaintGrid(HDC hdc);
-void ProcessTypedChar(wchar_t ch);
-void MoveMouse(POINT pt);
-void SendClick(bool rightClick);
-std::wstring GenerateLabel(wchar_t monitorPrefix, int index);
-void FilterAppWindowsBySearch();
-void HideCursor();
-void RestoreCursor();
-void MoveMouseByArrowKey(int dx, int dy, int moveAmount);
-void CreateGridFonts(int sh, int cellW, HFONT* outMain, HFONT* outSub);
-LRESULT CALLBACK LowLevelMouseProc(int nCode, WPARAM wParam, LPARAM lParam);
-LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam);
-void InstallGlobalKeyboardHook();
-void UninstallGlobalKeyboardHook();
-void EnumerateAppWindows();
-void CycleHighlight(bool forward);
-void ExitScrollMode();
-LRESULT CALLBACK ScrollMouseProc(int nCode, WPARAM wParam, LPARAM lParam);
-
-// Force restore cursors - called on exit/crash
-void ForceRestoreCursors() {
-    g_bCursorAnimating = false;
-    SystemParametersInfo(SPI_SETCURSORS, 0, NULL, 0);
-}
-
-// Unhandled exception filter - restore cursor on crash
-LONG WINAPI CrashHandler(EXCEPTION_POINTERS* pExceptionInfo) {
-    ForceRestoreCursors();
-    return EXCEPTION_CONTINUE_SEARCH;
-}
-
-// Low-level mouse hook for scroll mode - detect any mouse movement
-LRESULT CALLBACK ScrollMouseProc(int nCode, WPARAM wParam, LPARAM lParam) {
-    if (nCode >= 0 && g_bScrollMode && wParam == WM_MOUSEMOVE) {
-        ExitScrollMode();
-    }
-    return CallNextHookEx(g_hScrollMouseHook, nCode, wParam, lParam);
-}
-
-void ExitScrollMode() {
-    if (!g_bScrollMode) return;
-    g_bScrollMode = false;
-    // Remove input-transparent flag so overlay receives input again
-    LONG_PTR exStyle = GetWindowLongPtr(g_hOverlayWnd, GWL_EXSTYLE);
-    SetWindowLongPtr(g_hOverlayWnd, GWL_EXSTYLE, exStyle & ~WS_EX_TRANSPARENT);
-    if (g_hScrollMouseHook) {
-        UnhookWindowsHookEx(g_hScrollMouseHook);
-        g_hScrollMouseHook = NULL;
-    }
-    HideGrid();
-}
-
-// Low-level mouse hook callback
-LRESULT CALLBACK LowLevelMouseProc(int nCode, WPARAM wParam, LPARAM lParam) {
-    if (nCode >= 0 && g_bCursorHidden) {
-        // Mouse moved - restore cursor
-        if (wParam == WM_MOUSEMOVE) {
-            RestoreCursor();
-        }
-    }
-    return CallNextHookEx(g_hMouseHook, nCode, wParam, lParam);
-}
-
-// Hide the cursor system-wide
-void HideCursor() {
-    if (g_bCursorHidden) return;
-    
-    // Cancel any ongoing animation and wait for it to see the flag
-    if (g_bCursorAnimating) {
-        g_bCursorAnimating = false;
-        Sleep(100);  // Give animation thread time to exit
-    }
-    
-    // Create a blank cursor
-    BYTE andMask[128];
-    BYTE xorMask[128];
-    memset(andMask, 0xFF, sizeof(andMask));  // AND mask all 1s = transparent
-    memset(xorMask, 0x00, sizeof(xorMask));  // XOR mask all 0s = no change
-    HCURSOR hBlankCursor = CreateCursor(g_hInstance, 0, 0, 32, 32, andMask, xorMask);
-    
-    // Copy and set for all standard cursor types
-    for (DWORD id : CURSOR_IDS) {
-        HCURSOR hCopy = CopyCursor(hBlankCursor);
-        SetSystemCursor(hCopy, id);
-    }
-    
-    DestroyCursor(hBlankCursor);
-    
-    // Install low-level mouse hook to detect movement
-    g_hMouseHook = SetWindowsHookEx(WH_MOUSE_LL, LowLevelMouseProc, g_hInstance, 0);
-    
-    g_bCursorHidden = true;
-}
-
-// Set all system cursors to a scaled version of the saved arrow cursor
-// Scale the saved cursor to a new size using DrawIconEx for proper transparency
-HCURSOR CreateScaledCursor(HCURSOR hOriginal, int targetSize) {
-    if (!hOriginal) return NULL;
-    
-    // Get original cursor info for hotspot
-    ICONINFO iiOrig;
-    if (!GetIconInfo(hOriginal, &iiOrig)) return NULL;
-    
-    BITMAP bm;
-    GetObject(iiOrig.hbmMask, sizeof(bm), &bm);
-    int origW = bm.bmWidth;
-    int origH = iiOrig.hbmColor ? bm.bmHeight : bm.bmHeight / 2;
-    
-    // Calculate scaled hotspot
-    int hotX = (int)((float)iiOrig.xHotspot / origW * targetSize);
-    int hotY = (int)((float)iiOrig.yHotspot / origH * targetSize);
-    
-    // Clean up ICONINFO bitmaps
-    DeleteObject(iiOrig.hbmColor);
-    DeleteObject(iiOrig.hbmMask);
-    
-    HDC hdcScreen = GetDC(NULL);
-    
-    // Create a 32-bit ARGB bitmap for the color (supports per-pixel alpha)
-    BITMAPINFO bmi = {};
-    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth = targetSize;
-    bmi.bmiHeader.biHeight = -targetSize;  // Top-down
-    bmi.bmiHeader.biPlanes = 1;
-    bmi.bmiHeader.biBitCount = 32;
-    bmi.bmiHeader.biCompression = BI_RGB;
-    
-    void* pBits = NULL;
-    HBITMAP hbmColor = CreateDIBSection(hdcScreen, &bmi, DIB_RGB_COLORS, &pBits, NULL, 0);
-    
-    // Create mask bitmap
-    HBITMAP hbmMask = CreateBitmap(targetSize, targetSize, 1, 1, NULL);
-    
-    HDC hdcColor = CreateCompatibleDC(hdcScreen);
-    HDC hdcMask = CreateCompatibleDC(hdcScreen);
-    
-    // Draw color: clear to transparent black, then draw icon
-    SelectObject(hdcColor, hbmColor);
-    memset(pBits, 0, targetSize * targetSize * 4);  // Fully transparent
-    DrawIconEx(hdcColor, 0, 0, hOriginal, targetSize, targetSize, 0, NULL, DI_NORMAL);
-    
-    // Draw mask: white = transparent, black = opaque
-    SelectObject(hdcMask, hbmMask);
-    RECT rcMask = { 0, 0, targetSize, targetSize };
-    FillRect(hdcMask, &rcMask, (HBRUSH)GetStockObject(WHITE_BRUSH));
-    DrawIconEx(hdcMask, 0, 0, hOriginal, targetSize, targetSize, 0, NULL, DI_MASK);
-    
-    DeleteDC(hdcColor);
-    DeleteDC(hdcMask);
-    ReleaseDC(NULL, hdcScreen);
-    
-    // Create the scaled cursor
-    ICONINFO iiNew;
-    iiNew.fIcon = FALSE;
-    iiNew.xHotspot = hotX;
-    iiNew.yHotspot = hotY;
-    iiNew.hbmMask = hbmMask;
-    iiNew.hbmColor = hbmColor;
-    
-    HCURSOR hResult = CreateIconIndirect(&iiNew);
-    DeleteObject(hbmColor);
-    DeleteObject(hbmMask);
-    
-    return hResult;
-}
-
-void SetScaledCursors(int size) {
-    if (!g_hSavedArrow) return;
-    
-    HCURSOR hScaled = CreateScaledCursor(g_hSavedArrow, size);
-    if (!hScaled) return;
-    
-    for (DWORD id : CURSOR_IDS) {
-        HCURSOR hCopy = CopyCursor(hScaled);
-        SetSystemCursor(hCopy, id);
-    }
-    DestroyCursor(hScaled);
-}
-
-// Animate cursor from large to normal size over ~1 second
-void AnimateCursorRestore() {
-    g_bCursorAnimating = true;
-    
-    const int startSize = 128;   // Start big
-    const int endSize = 32;      // Normal cursor size
-    const int steps = 15;
-    const int delayMs = 500 / steps;  // ~33ms per step
-    
-    // Set the first frame immediately (large cursor)
-    SetScaledCursors(startSize);
-    
-    for (int i = 1; i <= steps; i++) {
-        if (!g_bCursorAnimating) break;  // Cancelled
-        
-        Sleep(delayMs);
-        
-        if (!g_bCursorAnimating) break;  // Check again after sleep
-        
-        // Ease-out: fast shrink at start, slow at end
-        float t = (float)i / (float)steps;
-        float eased = 1.0f - (1.0f - t) * (1.0f - t);  // quadratic ease-out
-        int size = startSize - (int)((startSize - endSize) * eased);
-        if (size < endSize) size = endSize;
-        
-        SetScaledCursors(size);
-    }
-    
-    // Final step: restore to true system defaults (only if not cancelled)
-    if (g_bCursorAnimating) {
-        SystemParametersInfo(SPI_SETCURSORS, 0, NULL, 0);
-    }
-    g_bCursorAnimating = false;
-}
-
-// Restore the cursor to system defaults
-void RestoreCursor() {
-    if (!g_bCursorHidden) return;
-    
-    // Unhook mouse first
-    if (g_hMouseHook) {
-        UnhookWindowsHookEx(g_hMouseHook);
-        g_hMouseHook = NULL;
-    }
-    
-    g_bCursorHidden = false;
-    
-    // Start animated cursor restore in a background thread
-    std::thread(AnimateCursorRestore).detach();
-}
-
-// Check if a key is a typing key (not a modifier, function key, etc.)
-bool IsTypingKey(DWORD vkCode) {
-    // Ignore modifiers
-    if (vkCode == VK_SHIFT || vkCode == VK_CONTROL || vkCode == VK_MENU ||
-        vkCode == VK_LSHIFT || vkCode == VK_RSHIFT ||
-        vkCode == VK_LCONTROL || vkCode == VK_RCONTROL ||
-        vkCode == VK_LMENU || vkCode == VK_RMENU ||
-        vkCode == VK_LWIN || vkCode == VK_RWIN) {
-        return false;
-    }
-    
-    // Ignore function keys
-    if (vkCode >= VK_F1 && vkCode <= VK_F24) {
-        return false;
-    }
-    
-    // Ignore navigation keys that typically involve mouse use
-    if (vkCode == VK_PRINT || vkCode == VK_SNAPSHOT ||
-        vkCode == VK_PAUSE || vkCode == VK_CAPITAL ||
-        vkCode == VK_NUMLOCK || vkCode == VK_SCROLL) {
-        return false;
-    }
-    
-    // Consider everything else as typing
-    return true;
-}
-
-// Low-level keyboard hook callback - hide cursor on typing
-LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam) {
-    if (nCode >= 0 && !g_bGridVisible && !g_bMouseMoveMode) {
-        // Only on key down events, and not when our grid is active
-        if (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN) {
-            KBDLLHOOKSTRUCT* pKb = (KBDLLHOOKSTRUCT*)lParam;
-            if (IsTypingKey(pKb->vkCode)) {
-                // Hide cursor when typing
-                if (!g_bCursorHidden) {
-                    HideCursor();
-                }
-            }
-        }
-    }
-    return CallNextHookEx(g_hKeyboardHook, nCode, wParam, lParam);
-}
-
-// Install global keyboard hook for cursor hiding while typing
-void InstallGlobalKeyboardHook() {
-    if (g_hKeyboardHook) return;  // Already installed
-    g_hKeyboardHook = SetWindowsHookEx(WH_KEYBOARD_LL, LowLevelKeyboardProc, g_hInstance, 0);
-}
-
-// Uninstall global keyboard hook
-void UninstallGlobalKeyboardHook() {
-    if (g_hKeyboardHook) {
-        UnhookWindowsHookEx(g_hKeyboardHook);
-        g_hKeyboardHook = NULL;
-    }
-}
-
-// Monitor enumeration callback for DPI-aware per-monitor grids
-BOOL CALLBACK GridMonitorEnumProc(HMONITOR hMon, HDC hdcMon, LPRECT lprcMonitor, LPARAM lParam) {
-    MonitorInfo mi;
-    mi.hMonitor = hMon;
-    mi.rcMonitor = *lprcMonitor;
-    HRESULT hr = GetDpiForMonitor(hMon, MDT_EFFECTIVE_DPI, &mi.dpiX, &mi.dpiY);
-    if (FAILED(hr)) { mi.dpiX = DEFAULT_DPI; mi.dpiY = DEFAULT_DPI; }
-    auto* vec = reinterpret_cast<std::vector<MonitorInfo>*>(lParam);
-    mi.prefix = L'a' + (wchar_t)vec->size();
-    vec->push_back(mi);
-    return TRUE;
-}
-
-// Generate 3-letter label: monitor prefix + 2-char cell code
-std::wstring GenerateLabel(wchar_t monitorPrefix, int index) {
-    std::wstring label;
-    label += monitorPrefix;
-    int first = index / 26;
-    int second = index % 26;
-    if (first < 26) {
-        label += static_cast<wchar_t>(L'a' + first);
-        label += static_cast<wchar_t>(L'a' + second);
-    }
-    return label;
-}
-
-// Build grid cells per monitor with DPI-aware sizing
-void BuildGridCells() {
-    g_cells.clear();
-    g_gridMap.clear();
-    g_monitors.clear();
-    
-    // Enumerate all monitors with DPI info
-    EnumDisplayMonitors(NULL, NULL, GridMonitorEnumProc, reinterpret_cast<LPARAM>(&g_monitors));
-    
-    // Build grid independently for each monitor
-    for (const auto& mon : g_monitors) {
-        int monWidth = mon.rcMonitor.right - mon.rcMonitor.left;
-        int monHeight = mon.rcMonitor.bottom - mon.rcMonitor.top;
-        
-        // Scale target cell size by this monitor's DPI
-        int targetCellPx = TARGET_CELL_SIZE_DIP * (int)mon.dpiX / DEFAULT_DPI;
-        
-        int gridCols = max(1, monWidth / targetCellPx);
-        int gridRows = max(1, monHeight / targetCellPx);
-        // Cap to 676 cells per monitor (2-char codes aa-zz)
-        while (gridCols * gridRows > 676) {
-            if (gridCols > gridRows) gridCols--; else gridRows--;
-        }
-        
-        int cellWidth = monWidth / gridCols;
-        int cellHeight = monHeight / gridRows;
-        int subWidth = cellWidth / 3;
-        int subHeight = cellHeight / 3;
-        
-        int index = 0;
-        for (int row = 0; row < gridRows; row++) {
-            for (int col = 0; col < gridCols; col++) {
-                GridCell cell;
-                cell.rect.left = mon.rcMonitor.left + col * cellWidth;
-                cell.rect.top = mon.rcMonitor.top + row * cellHeight;
-                cell.rect.right = cell.rect.left + cellWidth;
-                cell.rect.bottom = cell.rect.top + cellHeight;
-                cell.center.x = cell.rect.left + cellWidth / 2;
-                cell.center.y = cell.rect.top + cellHeight / 2;
-                cell.label = GenerateLabel(mon.prefix, index);
-                cell.gridRow = row;
-                cell.gridCol = col;
-                
-                // Calculate 3x3 sub-grid points
-                for (int sy = 0; sy < 3; sy++) {
-                    for (int sx = 0; sx < 3; sx++) {
-                        int subIdx = sy * 3 + sx;
-                        cell.subPoints[subIdx].x = cell.rect.left + sx * subWidth + subWidth / 2;
-                        cell.subPoints[subIdx].y = cell.rect.top + sy * subHeight + subHeight / 2;
-                    }
-                }
-                
-                g_cells.push_back(cell);
-                g_gridMap[cell.label] = cell.center;
-                index++;
-            }
-        }
-    }
-}
-
-// Render the static base grid (lines, labels, sub-labels) to a cached bitmap
-void RenderBaseGridBitmap() {
-    if (g_hGridBitmap) { DeleteObject(g_hGridBitmap); g_hGridBitmap = NULL; }
-    
-    auto vs = GetVirtualScreenBounds();
-    int virtualWidth = vs.width;
-    int virtualHeight = vs.height;
-    int virtualLeft = vs.left;
-    int virtualTop = vs.top;
-    g_gridBitmapW = virtualWidth;
-    g_gridBitmapH = virtualHeight;
-    
-    HDC hdcScreen = GetDC(NULL);
-    HDC hdcMem = CreateCompatibleDC(hdcScreen);
-    g_hGridBitmap = CreateCompatibleBitmap(hdcScreen, virtualWidth, virtualHeight);
-    SelectObject(hdcMem, g_hGridBitmap);
-    
-    // Background fill
-    HBRUSH hBrushBg = CreateSolidBrush(g_palette.background);
-    RECT rcFull = { 0, 0, virtualWidth, virtualHeight };
-    FillRect(hdcMem, &rcFull, hBrushBg);
-    DeleteObject(hBrushBg);
-    
-    // Checkerboard cell backgrounds
-    HBRUSH hBrushEven = CreateSolidBrush(g_palette.cellBgEven);
-    HBRUSH hBrushOdd  = CreateSolidBrush(g_palette.cellBgOdd);
-    for (const auto& cell : g_cells) {
-        RECT adj;
-        adj.left   = cell.rect.left   - virtualLeft;
-        adj.top    = cell.rect.top    - virtualTop;
-        adj.right  = cell.rect.right  - virtualLeft;
-        adj.bottom = cell.rect.bottom - virtualTop;
-        bool isEven = ((cell.gridRow + cell.gridCol) % 2 == 0);
-        FillRect(hdcMem, &adj, isEven ? hBrushEven : hBrushOdd);
-    }
-    DeleteObject(hBrushEven);
-    DeleteObject(hBrushOdd);
-    
-    // Grid lines
-    int gridPenWidth = max(1, virtualHeight / 800);
-    HPEN hPen = CreatePen(PS_SOLID, gridPenWidth, g_palette.gridLine);
-    HPEN hSubPen = CreatePen(PS_SOLID, max(1, gridPenWidth / 2), g_palette.subGridLine);
-    HPEN hOldPen = (HPEN)SelectObject(hdcMem, hPen);
-    
-    for (const auto& cell : g_cells) {
-        int sw = (cell.rect.right - cell.rect.left) / 3;
-        int sh = (cell.rect.bottom - cell.rect.top) / 3;
-        
-        RECT adj;
-        adj.left = cell.rect.left - virtualLeft;
-        adj.top = cell.rect.top - virtualTop;
-        adj.right = cell.rect.right - virtualLeft;
-        adj.bottom = cell.rect.bottom - virtualTop;
-        
-        SelectObject(hdcMem, hPen);
-        MoveToEx(hdcMem, adj.left, adj.top, NULL);
-        LineTo(hdcMem, adj.right, adj.top);
-        LineTo(hdcMem, adj.right, adj.bottom);
-        LineTo(hdcMem, adj.left, adj.bottom);
-        LineTo(hdcMem, adj.left, adj.top);
-        
-        SelectObject(hdcMem, hSubPen);
-        MoveToEx(hdcMem, adj.left + sw, adj.top, NULL);
-        LineTo(hdcMem, adj.left + sw, adj.bottom);
-        MoveToEx(hdcMem, adj.left + sw * 2, adj.top, NULL);
-        LineTo(hdcMem, adj.left + sw * 2, adj.bottom);
-        MoveToEx(hdcMem, adj.left, adj.top + sh, NULL);
-        LineTo(hdcMem, adj.right, adj.top + sh);
-        MoveToEx(hdcMem, adj.left, adj.top + sh * 2, NULL);
-        LineTo(hdcMem, adj.right, adj.top + sh * 2);
-    }
-    
-    SelectObject(hdcMem, hOldPen);
-    DeleteObject(hPen);
-    DeleteObject(hSubPen);
-    
-    // Draw labels
-    SetBkMode(hdcMem, TRANSPARENT);
-    SetTextColor(hdcMem, g_palette.mainLabelText);
-    
-    int lastSubH = 0;
-    HFONT hFont = NULL, hSubFont = NULL;
-    HFONT hOldFont = NULL;
-    
-    for (const auto& cell : g_cells) {
-        int sw = (cell.rect.right - cell.rect.left) / 3;
-        int sh = (cell.rect.bottom - cell.rect.top) / 3;
-        
-        if (sh != lastSubH) {
-            if (hOldFont) { SelectObject(hdcMem, hOldFont); hOldFont = NULL; }
-            if (hFont) DeleteObject(hFont);
-            if (hSubFont) DeleteObject(hSubFont);
-            
-            int cellW = sw * 3;
-            CreateGridFonts(sh, cellW, &hFont, &hSubFont);
-            
-            hOldFont = (HFONT)SelectObject(hdcMem, hFont);
-            lastSubH = sh;
-        }
-        
-        RECT adj;
-        adj.left = cell.rect.left - virtualLeft;
-        adj.top = cell.rect.top - virtualTop;
-        adj.right = cell.rect.right - virtualLeft;
-        adj.bottom = cell.rect.bottom - virtualTop;
-        
-        // Center label
-        SelectObject(hdcMem, hFont);
-        SetTextColor(hdcMem, g_palette.mainLabelText);
-        DrawText(hdcMem, cell.label.c_str(), -1, &adj, DT_CENTERED);
-        
-        // Sub-labels
-        SelectObject(hdcMem, hSubFont);
-        SetTextColor(hdcMem, g_palette.subLabelText);
-        int subLabelIdx = 0;
-        for (int sy = 0; sy < 3; sy++) {
-            for (int sx = 0; sx < 3; sx++) {
-                if (sx == 1 && sy == 1) continue;
-                RECT subRect;
-                subRect.left = adj.left + sx * sw;
-                subRect.top = adj.top + sy * sh;
-                subRect.right = subRect.left + sw;
-                subRect.bottom = subRect.top + sh;
-                wchar_t subLabel[2] = { SUB_LABELS[subLabelIdx], 0 };
-                DrawText(hdcMem, subLabel, 1, &subRect, DT_CENTERED);
-                subLabelIdx++;
-            }
-        }
-    }
-    
-    if (hOldFont) SelectObject(hdcMem, hOldFont);
-    if (hFont) DeleteObject(hFont);
-    if (hSubFont) DeleteObject(hSubFont);
-    
-    DeleteDC(hdcMem);
-    ReleaseDC(NULL, hdcScreen);
-}
-
-// Paint the grid overlay
-void PaintGrid(HDC hdc) {
-    // Get virtual screen bounds
-    auto vs = GetVirtualScreenBounds();
-    int virtualLeft = vs.left;
-    int virtualTop = vs.top;
-    int virtualWidth = vs.width;
-    int virtualHeight = vs.height;
-    
-    // Semi-transparent background
-    HBRUSH hBrushBg = CreateSolidBrush(g_palette.background);
-    RECT rcFull = { 0, 0, virtualWidth, virtualHeight };
-    FillRect(hdc, &rcFull, hBrushBg);
-    DeleteObject(hBrushBg);
-    
-    // In scroll mode, paint only black (LWA_COLORKEY makes it fully transparent)
-    if (g_bScrollMode) return;
-    
-    // If in window highlight or text select mode, skip drawing the grid entirely
-    bool highlightMode = (g_highlightIndex >= 0 || g_bTabTextMode || !g_tabSearchStr.empty());
-    
-  if (!highlightMode) {
-    // Blit cached base grid
-    if (g_hGridBitmap) {
-        HDC hdcGrid = CreateCompatibleDC(hdc);
-        SelectObject(hdcGrid, g_hGridBitmap);
-        BitBlt(hdc, 0, 0, g_gridBitmapW, g_gridBitmapH, hdcGrid, 0, 0, SRCCOPY);
-        DeleteDC(hdcGrid);
-    }
-    
-    // Overlay dynamic highlights for typed chars
-    if (!g_typedChars.empty()) {
-        SetBkMode(hdc, TRANSPARENT);
-        
-        int lastSubH = 0;
-        HFONT hFont = NULL, hSubFont = NULL;
-        HFONT hOldFont = NULL;
-        
-        for (const auto& cell : g_cells) {
-            int sw = (cell.rect.right - cell.rect.left) / 3;
-            int sh = (cell.rect.bottom - cell.rect.top) / 3;
-            
-            if (sh != lastSubH) {
-                if (hOldFont) { SelectObject(hdc, hOldFont); hOldFont = NULL; }
-                if (hFont) DeleteObject(hFont);
-                if (hSubFont) DeleteObject(hSubFont);
-                int cellW = sw * 3;
-                CreateGridFonts(sh, cellW, &hFont, &hSubFont);
-                hOldFont = (HFONT)SelectObject(hdc, hFont);
-                lastSubH = sh;
-            }
-            
-            RECT adjusted;
-            adjusted.left = cell.rect.left - virtualLeft;
-            adjusted.top = cell.rect.top - virtualTop;
-            adjusted.right = cell.rect.right - virtualLeft;
-            adjusted.bottom = cell.rect.bottom - virtualTop;
-            
-            bool isMatch = false;
-            bool isPartialMatch = false;
-            if (g_typedChars.length() >= 3) {
-                if (cell.label == g_typedChars.substr(0, 3)) isMatch = true;
-            } else {
-                if (cell.label.substr(0, g_typedChars.length()) == g_typedChars) isPartialMatch = true;
-            }
-            
-            if (!isMatch && !isPartialMatch) {
-                // Dim non-matching cells
-                HBRUSH hDim = CreateSolidBrush(g_palette.dimBg);
-                FillRect(hdc, &adjusted, hDim);
-                DeleteObject(hDim);
-                SelectObject(hdc, hFont);
-                SetTextColor(hdc, g_palette.dimText);
-                DrawText(hdc, cell.label.c_str(), -1, &adjusted, DT_CENTERED);
-                continue;
-            }
-            
-            if (isMatch) {
-                HBRUSH hHighlight = CreateSolidBrush(g_palette.matchCellBg);
-                FillRect(hdc, &adjusted, hHighlight);
-                DeleteObject(hHighlight);
-                
-                HPEN hSubPenLight = CreatePen(PS_SOLID, 1, g_palette.matchGridLine);
-                HPEN hOldPen = (HPEN)SelectObject(hdc, hSubPenLight);
-                MoveToEx(hdc, adjusted.left + sw, adjusted.top, NULL);
-                LineTo(hdc, adjusted.left + sw, adjusted.bottom);
-                MoveToEx(hdc, adjusted.left + sw * 2, adjusted.top, NULL);
-                LineTo(hdc, adjusted.left + sw * 2, adjusted.bottom);
-                MoveToEx(hdc, adjusted.left, adjusted.top + sh, NULL);
-                LineTo(hdc, adjusted.right, adjusted.top + sh);
-                MoveToEx(hdc, adjusted.left, adjusted.top + sh * 2, NULL);
-                LineTo(hdc, adjusted.right, adjusted.top + sh * 2);
-                SelectObject(hdc, hOldPen);
-                DeleteObject(hSubPenLight);
-                
-                SelectObject(hdc, hFont);
-                SetTextColor(hdc, g_palette.matchLabelText);
-                DrawText(hdc, cell.label.c_str(), -1, &adjusted, DT_CENTERED);
-                
-                // Draw sub-labels on matched cell
-                SelectObject(hdc, hSubFont);
-                int subLabelIdx = 0;
-                for (int sy = 0; sy < 3; sy++) {
-                    for (int sx = 0; sx < 3; sx++) {
-                        if (sx == 1 && sy == 1) continue;
-                        RECT subRect;
-                        subRect.left = adjusted.left + sx * sw;
-                        subRect.top = adjusted.top + sy * sh;
-                        subRect.right = subRect.left + sw;
-                        subRect.bottom = subRect.top + sh;
-                        
-                        if (g_typedChars.length() == 4) {
-                            wchar_t subChar = g_typedChars[3];
-                            if (subChar >= L'a' && subChar <= L'h' && (subChar - L'a') == subLabelIdx) {
-                                HBRUSH hSubHi = CreateSolidBrush(g_palette.matchSubHighlightBg);
-                                FillRect(hdc, &subRect, hSubHi);
-                                DeleteObject(hSubHi);
-                                SetTextColor(hdc, g_palette.matchSubHighlightText);
-                            } else {
-                                SetTextColor(hdc, g_palette.matchSubLabelText);
-                            }
-                        } else {
-                            SetTextColor(hdc, g_palette.matchSubLabelText);
-                        }
-                        wchar_t sl[2] = { SUB_LABELS[subLabelIdx], 0 };
-                        DrawText(hdc, sl, 1, &subRect, DT_CENTERED);
-                        subLabelIdx++;
-                    }
-                }
-            } else {
-                // Partial match - subtle green tint so user can still see underneath
-                HBRUSH hPartial = CreateSolidBrush(g_palette.partialMatchBg);
-                FillRect(hdc, &adjusted, hPartial);
-                DeleteObject(hPartial);
-                SelectObject(hdc, hFont);
-                SetTextColor(hdc, g_palette.partialMatchText);
-                DrawText(hdc, cell.label.c_str(), -1, &adjusted, DT_CENTERED);
-            }
-        }
-        
-        if (hOldFont) SelectObject(hdc, hOldFont);
-        if (hFont) DeleteObject(hFont);
-        if (hSubFont) DeleteObject(hSubFont);
-    }
-  } // end if (!highlightMode)
-    if (g_highlightIndex >= 0 && !g_appWindows.empty()) {
-        // When search is active or in text mode, highlight ALL matching windows
-        // When just cycling (no search), highlight only the current one
-        bool showAll = !g_tabSearchStr.empty() || g_bTabTextMode;
-        int startIdx = showAll ? 0 : g_highlightIndex;
-        int endIdx = showAll ? (int)g_appWindows.size() : g_highlightIndex + 1;
-        
-        HFONT hLabelFont = CreateFont(-(max(12, virtualHeight / 80)), 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE,
-            DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
-            CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
-        
-        for (int idx = startIdx; idx < endIdx && idx < (int)g_appWindows.size(); idx++) {
-            const AppWindow& aw = g_appWindows[idx];
-            
-            // Convert screen coords to overlay window coords
-            RECT hr;
-            hr.left = aw.rect.left - virtualLeft;
-            hr.top = aw.rect.top - virtualTop;
-            hr.right = aw.rect.right - virtualLeft;
-            hr.bottom = aw.rect.bottom - virtualTop;
-            
-        // Draw thick red border (scaled to screen)
-            int thickness = max(2, virtualHeight / 400);
-            bool isCurrent = (idx == g_highlightIndex);
-            HBRUSH hBorderBrush = CreateSolidBrush(isCurrent ? g_palette.mainLabelText : g_palette.gridLine);
-            
-            // Top edge
-            RECT edge = { hr.left, hr.top, hr.right, hr.top + thickness };
-            FillRect(hdc, &edge, hBorderBrush);
-            // Bottom edge
-            edge = { hr.left, hr.bottom - thickness, hr.right, hr.bottom };
-            FillRect(hdc, &edge, hBorderBrush);
-            // Left edge
-            edge = { hr.left, hr.top, hr.left + thickness, hr.bottom };
-            FillRect(hdc, &edge, hBorderBrush);
-            // Right edge
-            edge = { hr.right - thickness, hr.top, hr.right, hr.bottom };
-            FillRect(hdc, &edge, hBorderBrush);
-            
-            DeleteObject(hBorderBrush);
-            
-            // Draw window title + index label
-            HFONT hPrevFont = (HFONT)SelectObject(hdc, hLabelFont);
-            
-            wchar_t labelBuf[300];
-            swprintf_s(labelBuf, L" [%d/%d] %s ", idx + 1, (int)g_appWindows.size(), aw.title.c_str());
-            
-            SIZE textSize;
-            GetTextExtentPoint32(hdc, labelBuf, (int)wcslen(labelBuf), &textSize);
-            
-            int labelX = hr.left;
-            int labelY = hr.top - textSize.cy - 6;
-            if (labelY < 0) labelY = hr.top + thickness;
-            
-            RECT labelBg = { labelX, labelY, labelX + textSize.cx + 8, labelY + textSize.cy + 8 };
-            HBRUSH hLabelBg = CreateSolidBrush(isCurrent ? g_palette.matchCellBg : g_palette.cellBgEven);
-            FillRect(hdc, &labelBg, hLabelBg);
-            DeleteObject(hLabelBg);
-            
-            SetTextColor(hdc, g_palette.matchLabelText);
-            SetBkMode(hdc, TRANSPARENT);
-            RECT labelRect = { labelX + 4, labelY + 2, labelBg.right, labelBg.bottom };
-            DrawText(hdc, labelBuf, -1, &labelRect, DT_LEFT | DT_SINGLELINE | DT_NOPREFIX);
-            
-            SelectObject(hdc, hPrevFont);
-        }
-        
-        DeleteObject(hLabelFont);
-    }
-    
-    // Draw minimized windows panel (bottom-right of primary monitor) - only in text search mode
-    if ((g_bTabTextMode || !g_tabSearchStr.empty()) && !g_minimizedWindows.empty()) {
-        // Get primary monitor work area
-        MONITORINFO mi = { sizeof(mi) };
-        GetMonitorInfo(MonitorFromPoint({ 0, 0 }, MONITOR_DEFAULTTOPRIMARY), &mi);
-        RECT workArea = mi.rcWork;
-        
-        int panelPad = max(8, virtualHeight / 200);
-        int lineH = max(18, virtualHeight / 60);
-        int titleH = lineH + panelPad;
-        int maxItems = min((int)g_minimizedWindows.size(), 20);  // cap to 20 rows
-        int panelH = titleH + maxItems * lineH + panelPad * 2;
-        int panelW = max(250, virtualWidth / 5);
-        
-        // Position: bottom-right of primary monitor work area
-        int panelX = (workArea.right - virtualLeft) - panelW - panelPad;
-        int panelY = (workArea.bottom - virtualTop) - panelH - panelPad;
-        
-        RECT panelRect = { panelX, panelY, panelX + panelW, panelY + panelH };
-        
-        // Panel background
-        HBRUSH hPanelBg = CreateSolidBrush(g_palette.cellBgEven);
-        FillRect(hdc, &panelRect, hPanelBg);
-        DeleteObject(hPanelBg);
-        
-        // Panel border
-        int borderT = max(1, virtualHeight / 500);
-        HBRUSH hPanelBorder = CreateSolidBrush(g_palette.gridLine);
-        RECT be;
-        be = { panelRect.left, panelRect.top, panelRect.right, panelRect.top + borderT };
-        FillRect(hdc, &be, hPanelBorder);
-        be = { panelRect.left, panelRect.bottom - borderT, panelRect.right, panelRect.bottom };
-        FillRect(hdc, &be, hPanelBorder);
-        be = { panelRect.left, panelRect.top, panelRect.left + borderT, panelRect.bottom };
-        FillRect(hdc, &be, hPanelBorder);
-        be = { panelRect.right - borderT, panelRect.top, panelRect.right, panelRect.bottom };
-        FillRect(hdc, &be, hPanelBorder);
-        DeleteObject(hPanelBorder);
-        
-        // Title font (bold)
-        HFONT hTitleFont = CreateFont(-(lineH * 80 / 100), 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE,
-            DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
-            CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
-        // Item font (normal)
-        HFONT hItemFont = CreateFont(-(lineH * 70 / 100), 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
-            DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
-            CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
-        
-        SetBkMode(hdc, TRANSPARENT);
-        
-        // Draw title
-        HFONT hPrevFont = (HFONT)SelectObject(hdc, hTitleFont);
-        SetTextColor(hdc, g_palette.mainLabelText);
-        RECT titleRect = { panelX + panelPad, panelY + panelPad, panelX + panelW - panelPad, panelY + titleH };
-        DrawText(hdc, L"Minimized applications", -1, &titleRect, DT_LEFT | DT_SINGLELINE | DT_END_ELLIPSIS);
-        
-        // Draw items
-        SelectObject(hdc, hItemFont);
-        int totalNormal = (int)g_appWindows.size();
-        for (int i = 0; i < maxItems; i++) {
-            int itemY = panelY + titleH + i * lineH;
-            RECT itemRect = { panelX + panelPad, itemY, panelX + panelW - panelPad, itemY + lineH };
-            
-            // Check if this minimized item is the current highlight
-            bool isCurrent = (g_highlightIndex >= totalNormal && (g_highlightIndex - totalNormal) == i);
-            
-            if (isCurrent) {
-                RECT hlRect = { panelX + borderT, itemY, panelX + panelW - borderT, itemY + lineH };
-                HBRUSH hItemHl = CreateSolidBrush(g_palette.matchSubHighlightBg);
-                FillRect(hdc, &hlRect, hItemHl);
-                DeleteObject(hItemHl);
-                SetTextColor(hdc, g_palette.matchSubHighlightText);
-            } else {
-                SetTextColor(hdc, g_palette.subLabelText);
-            }
-            
-            wchar_t itemBuf[300];
-            swprintf_s(itemBuf, L" %s", g_minimizedWindows[i].title.c_str());
-            DrawText(hdc, itemBuf, -1, &itemRect, DT_LEFT | DT_SINGLELINE | DT_END_ELLIPSIS | DT_NOPREFIX);
-        }
-        
-        SelectObject(hdc, hPrevFont);
-        DeleteObject(hTitleFont);
-        DeleteObject(hItemFont);
-    }
-}
-
-// Enumerate visible application windows in Z-order (front to back)
-BOOL CALLBACK EnumWindowsProc(HWND hwnd, LPARAM lParam) {
-    // Skip our own windows
-    if (hwnd == g_hOverlayWnd || hwnd == g_hMainWnd) return TRUE;
-    
-    // Must be visible
-    if (!IsWindowVisible(hwnd)) return TRUE;
-    
-    // Must have a non-empty title
-    wchar_t title[256] = {};
-    GetWindowText(hwnd, title, 256);
-    if (wcslen(title) == 0) return TRUE;
-    
-    // Skip tool windows and other non-app windows
-    LONG exStyle = GetWindowLong(hwnd, GWL_EXSTYLE);
-    if (exStyle & WS_EX_TOOLWINDOW) return TRUE;
-    
-    // Collect minimized windows separately
-    if (IsIconic(hwnd)) {
-        AppWindow aw;
-        aw.hwnd = hwnd;
-        GetWindowRect(hwnd, &aw.rect);
-        aw.title = title;
-        aw.visibleArea = 0;
-        g_minimizedWindows.push_back(aw);
-        return TRUE;
-    }
-    
-    // Must have some area
-    RECT rc;
-    GetWindowRect(hwnd, &rc);
-    if (rc.right - rc.left <= 0 || rc.bottom - rc.top <= 0) return TRUE;
-    
-    // Skip windows that are completely off-screen (e.g. cloaked UWP)
-    BOOL cloaked = FALSE;
-    // DwmGetWindowAttribute not linked; use owner check instead
-    HWND owner = GetWindow(hwnd, GW_OWNER);
-    if (owner != NULL) {
-        // Skip owned windows (popups/dialogs) - we want top-level app windows
-        // But some apps use owned windows, so only skip if also WS_EX_TOOLWINDOW
-    }
-    
-    AppWindow aw;
-    aw.hwnd = hwnd;
-    aw.rect = rc;
-    aw.title = title;
-    
-    auto* vec = reinterpret_cast<std::vector<AppWindow>*>(lParam);
-    vec->push_back(aw);
-    return TRUE;
-}
-
-void EnumerateAppWindows() {
-    g_appWindows.clear();
-    g_minimizedWindows.clear();
-    EnumWindows(EnumWindowsProc, reinterpret_cast<LPARAM>(&g_appWindows));
-    // EnumWindows returns in Z-order (front to back)
-    
-    // Calculate visible area for each window by subtracting regions of windows above it
-    for (int i = 0; i < (int)g_appWindows.size(); i++) {
-        const RECT& r = g_appWindows[i].rect;
-        HRGN hRgn = CreateRectRgn(r.left, r.top, r.right, r.bottom);
-        
-        // Subtract all windows that are above this one (indices 0..i-1 are higher Z-order)
-        for (int j = 0; j < i; j++) {
-            const RECT& above = g_appWindows[j].rect;
-            HRGN hAbove = CreateRectRgn(above.left, above.top, above.right, above.bottom);
-            CombineRgn(hRgn, hRgn, hAbove, RGN_DIFF);
-            DeleteObject(hAbove);
-        }
-        
-        // Get the bounding box area of the remaining visible region
-        // Use GetRegionData for exact pixel area
-        DWORD size = GetRegionData(hRgn, 0, NULL);
-        int visArea = 0;
-        if (size > 0) {
-            RGNDATA* pData = (RGNDATA*)malloc(size);
-            if (pData && GetRegionData(hRgn, size, pData)) {
-                RECT* pRects = (RECT*)pData->Buffer;
-                for (DWORD k = 0; k < pData->rdh.nCount; k++) {
-                    visArea += (pRects[k].right - pRects[k].left) * (pRects[k].bottom - pRects[k].top);
-                }
-            }
-            free(pData);
-        }
-        g_appWindows[i].visibleArea = visArea;
-        DeleteObject(hRgn);
-    }
-    
-    // Sort by visible area descending (most visible windows first)
-    std::sort(g_appWindows.begin(), g_appWindows.end(),
-        [](const AppWindow& a, const AppWindow& b) {
-            return a.visibleArea > b.visibleArea;
-        });
-    
-    // Store all windows (including 0 visible area) for search
-    g_allAppWindows = g_appWindows;
-    
-    // Store all minimized windows for search
-    g_allMinimizedWindows = g_minimizedWindows;
-    
-    // Remove windows with 0 visible area from the cycling list
-    g_appWindows.erase(
-        std::remove_if(g_appWindows.begin(), g_appWindows.end(),
-            [](const AppWindow& w) { return w.visibleArea <= 0; }),
-        g_appWindows.end());
-}
-
-void FilterAppWindowsBySearch() {
-    if (g_tabSearchStr.empty()) {
-        // No search active - restore original visible-area-filtered list
-        // Re-run enumeration to get fresh state
-        return;
-    }
-    
-    // Case-insensitive substring search across ALL windows (including occluded)
-    std::wstring searchLower = g_tabSearchStr;
-    for (auto& c : searchLower) c = towlower(c);
-    
-    g_appWindows.clear();
-    for (const auto& aw : g_allAppWindows) {
-        std::wstring titleLower = aw.title;
-        for (auto& c : titleLower) c = towlower(c);
-        if (titleLower.find(searchLower) != std::wstring::npos) {
-            g_appWindows.push_back(aw);
-        }
-    }
-    
-    // Also filter minimized windows
-    g_minimizedWindows.clear();
-    for (const auto& aw : g_allMinimizedWindows) {
-        std::wstring titleLower = aw.title;
-        for (auto& c : titleLower) c = towlower(c);
-        if (titleLower.find(searchLower) != std::wstring::npos) {
-            g_minimizedWindows.push_back(aw);
-        }
-    }
-    
-    // If we have matches, highlight the first one
-    if (!g_appWindows.empty()) {
-        g_highlightIndex = 0;
-    } else if (!g_minimizedWindows.empty()) {
-        g_highlightIndex = 0;  // will point into minimized range (0 normal + i)
-    } else {
-        g_highlightIndex = -1;
-    }
-}
-
-void CycleHighlight(bool forward) {
-    if (g_appWindows.empty() && g_minimizedWindows.empty()) {
-        EnumerateAppWindows();
-    }
-    int total = (int)g_appWindows.size() + (int)g_minimizedWindows.size();
-    if (total == 0) return;
-    
-    if (forward) {
-        g_highlightIndex++;
-        if (g_highlightIndex >= total) {
-            g_highlightIndex = 0;
-        }
-    } else {
-        g_highlightIndex--;
-        if (g_highlightIndex < 0) {
-            g_highlightIndex = total - 1;
-        }
-    }
-    
-    // Make black background transparent via color key so red highlights stay vivid
-    SetLayeredWindowAttributes(g_hOverlayWnd, g_palette.background, 0, LWA_COLORKEY);
-    
-    // Reset the tab-to-text timer on each TAB press
-    g_bTabTextMode = false;
-    KillTimer(g_hOverlayWnd, TIMER_ID_TAB_TEXT);
-    SetTimer(g_hOverlayWnd, TIMER_ID_TAB_TEXT, TAB_TEXT_TIMEOUT_MS, NULL);
-    
-    InvalidateRect(g_hOverlayWnd, NULL, TRUE);
-}
-
-// Create overlay window
-void CreateOverlayWindow() {
-    if (g_hOverlayWnd) return;
-    
-    // Get virtual screen bounds (all monitors)
-    auto vs = GetVirtualScreenBounds();
-    int virtualLeft = vs.left;
-    int virtualTop = vs.top;
-    int virtualWidth = vs.width;
-    int virtualHeight = vs.height;
-    
-    g_hOverlayWnd = CreateWindowEx(
-        WS_EX_TOPMOST | WS_EX_TOOLWINDOW | WS_EX_LAYERED,
-        L"KeyboardJockeyOverlay",
-        L"Grid Overlay",
-        WS_POPUP,
-        virtualLeft, virtualTop, virtualWidth, virtualHeight,
-        NULL, NULL, g_hInstance, NULL
-    );
-    
-    // Set transparency
-    SetLayeredWindowAttributes(g_hOverlayWnd, 0, GRID_ALPHA, LWA_ALPHA);
-}
-
-// Show the grid overlay
-void ShowGrid() {
-    if (g_bGridVisible) return;
-    
-    // Restore cursor in case it was hidden by typing (e.g., pressing hotkey)
-    // Do it instantly without animation since we're showing the grid
-    if (g_bCursorHidden) {
-        g_bCursorAnimating = false;
-        if (g_hMouseHook) {
-            UnhookWindowsHookEx(g_hMouseHook);
-            g_hMouseHook = NULL;
-        }
-        SystemParametersInfo(SPI_SETCURSORS, 0, NULL, 0);
-        g_bCursorHidden = false;
-    }
-    
-    g_typedChars.clear();
-    g_bMouseMoveMode = false;  // Reset mouse move mode
-    CreateOverlayWindow();
-    
-    // Reset transparency to default (in case it was reduced in a previous session)
-    SetLayeredWindowAttributes(g_hOverlayWnd, 0, GRID_ALPHA, LWA_ALPHA);
-    
-    ShowWindow(g_hOverlayWnd, SW_SHOW);
-    SetForegroundWindow(g_hOverlayWnd);
-    SetFocus(g_hOverlayWnd);
-    
-    g_bGridVisible = true;
-    InvalidateRect(g_hOverlayWnd, NULL, TRUE);
-}
-
-// Hide the grid overlay
-void HideGrid() {
-    if (!g_bGridVisible) return;
-    
-    ShowWindow(g_hOverlayWnd, SW_HIDE);
-    g_bGridVisible = false;
-    g_bMouseMoveMode = false;
-    g_typedChars.clear();
-    g_appWindows.clear();
-    g_allAppWindows.clear();
-    g_minimizedWindows.clear();
-    g_allMinimizedWindows.clear();
-    g_highlightIndex = -1;
-    g_tabSearchStr.clear();
-    g_bTabTextMode = false;
-    KillTimer(g_hOverlayWnd, TIMER_ID_TAB_TEXT);
-    // Clean up scroll mode if active
-    if (g_bScrollMode) {
-        g_bScrollMode = false;
-        if (g_hScrollMouseHook) {
-            UnhookWindowsHookEx(g_hScrollMouseHook);
-            g_hScrollMouseHook = NULL;
-        }
-    }
-}
-
-// Move mouse to a point
-void MoveMouse(POINT pt) {
-    SetCursorPos(pt.x, pt.y);
-}
-
-// Send a mouse click
-void SendClick(bool rightClick) {
-    INPUT input[2] = {};
-    
-    input[0].type = INPUT_MOUSE;
-    input[0].mi.dwFlags = rightClick ? MOUSEEVENTF_RIGHTDOWN : MOUSEEVENTF_LEFTDOWN;
-    
-    input[1].type = INPUT_MOUSE;
-    input[1].mi.dwFlags = rightClick ? MOUSEEVENTF_RIGHTUP : MOUSEEVENTF_LEFTUP;
-    
-    SendInput(2, input, sizeof(INPUT));
-}
-
-void SendDoubleClick() {
-    INPUT input[4] = {};
-    for (int i = 0; i < 4; i++) input[i].type = INPUT_MOUSE;
-    input[0].mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
-    input[1].mi.dwFlags = MOUSEEVENTF_LEFTUP;
-    input[2].mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
-    input[3].mi.dwFlags = MOUSEEVENTF_LEFTUP;
-    SendInput(4, input, sizeof(INPUT));
-}
-
-// Get sub-grid point index from character a-h
-// Layout: a b c
-//         d X e
-//         f g h
-// Returns the subPoints index (0-8, skipping 4 which is center)
-int GetSubPointIndex(wchar_t ch) {
-    // a=0, b=1, c=2, d=3, e=5, f=6, g=7, h=8 (4 is center, skipped)
-    if (ch >= L'a' && ch <= L'd') {
-        return ch - L'a';  // 0-3
-    } else if (ch >= L'e' && ch <= L'h') {
-        return ch - L'a' + 1;  // 5-8 (skip index 4)
-    }
-    return 4;  // center as fallback
-}
-
-// Create main and sub-label fonts for a given sub-cell height and cell width
-void CreateGridFonts(int sh, int cellW, HFONT* outMain, HFONT* outSub) {
-    int fromHeight = sh * MAIN_FONT_HEIGHT_PCT / 100;
-    int fromWidth = cellW / MAIN_FONT_WIDTH_DIV;
-    int mainFontSize = -min(fromHeight, fromWidth);
-    if (mainFontSize > MIN_MAIN_FONT_SIZE) mainFontSize = MIN_MAIN_FONT_SIZE;
-    *outMain = CreateFont(mainFontSize, 0, 0, 0, FW_MEDIUM, FALSE, FALSE, FALSE,
-        DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
-        CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
-    int subFontSize = -(sh * SUB_FONT_HEIGHT_PCT / 100);
-    if (subFontSize > MIN_SUB_FONT_SIZE) subFontSize = MIN_SUB_FONT_SIZE;
-    *outSub = CreateFont(subFontSize, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
-        DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
-        CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
-}
-
-// Move cursor by arrow key offset and enter mouse-move mode
-void MoveMouseByArrowKey(int dx, int dy, int moveAmount) {
-    POINT pt;
-    GetCursorPos(&pt);
-    pt.x += dx;
-    pt.y += dy;
-    SetCursorPos(pt.x, pt.y);
-    if (!g_bMouseMoveMode) {
-        g_bMouseMoveMode = true;
-        SetLayeredWindowAttributes(g_hOverlayWnd, 0, MOUSE_MOVE_ALPHA, LWA_ALPHA);
-        SetCursor(LoadCursor(NULL, IDC_ARROW));
-    }
-}
-
-// Process typed character
-void ProcessTypedChar(wchar_t ch) {
-    if (!g_bGridVisible) return;
-    
-    // Convert to lowercase
-    ch = towlower(ch);
-    
-    if (ch >= L'a' && ch <= L'z') {
-        g_typedChars += ch;
-        
-        // Exit window highlight mode if active
-        if (g_highlightIndex >= 0) {
-            g_highlightIndex = -1;
-            g_appWindows.clear();
-            SetLayeredWindowAttributes(g_hOverlayWnd, 0, GRID_ALPHA, LWA_ALPHA);
-            InvalidateRect(g_hOverlayWnd, NULL, TRUE);
-        }
-        
-        // Restore default opacity when typing
-        if (g_bMouseMoveMode) {
-            g_bMouseMoveMode = false;
-            SetLayeredWindowAttributes(g_hOverlayWnd, 0, GRID_ALPHA, LWA_ALPHA);
-        }
-        
-        // Reset the timeout timer
-        if (g_hOverlayWnd) {
-            KillTimer(g_hOverlayWnd, TIMER_ID_RESET);
-            SetTimer(g_hOverlayWnd, TIMER_ID_RESET, RESET_TIMEOUT_MS, NULL);
-        }
-        
-        // Check if we have 4 characters (sub-grid selection)
-        if (g_typedChars.length() == 4) {
-            std::wstring threeChar = g_typedChars.substr(0, 3);
-            wchar_t subChar = g_typedChars[3];
-            
-            // Find the cell
-            for (const auto& cell : g_cells) {
-                if (cell.label == threeChar) {
-                    if (subChar >= L'a' && subChar <= L'h') {
-                        int subIdx = GetSubPointIndex(subChar);
-                        MoveMouse(cell.subPoints[subIdx]);
-                    } else {
-                        // Invalid sub-char, move to center
-                        MoveMouse(cell.center);
-                    }
-                    break;
-                }
-            }
-            // Clear for next selection
-            g_typedChars.clear();
-        }
-        // If exactly 3 chars, move to cell center immediately
-        else if (g_typedChars.length() == 3) {
-            auto it = g_gridMap.find(g_typedChars);
-            if (it != g_gridMap.end()) {
-                MoveMouse(it->second);
-            }
-        }
-        
-        InvalidateRect(g_hOverlayWnd, NULL, TRUE);
-    }
-}
-
-// Create tray icon
-void CreateTrayIcon(HWND hWnd) {
-    g_nid.cbSize = sizeof(NOTIFYICONDATA);
-    g_nid.hWnd = hWnd;
-    g_nid.uID = 1;
-    g_nid.uFlags = NIF_ICON | NIF_MESSAGE | NIF_TIP;
-    g_nid.uCallbackMessage = WM_TRAYICON;
-    g_nid.hIcon = LoadIcon(g_hInstance, MAKEINTRESOURCE(IDI_KEYBOARDJOCKEY));
-    wcscpy_s(g_nid.szTip, L"Keyboard Jockey - Ctrl+Alt+M to show grid");
-    
-    Shell_NotifyIcon(NIM_ADD, &g_nid);
-}
-
-// Remove tray icon
-void RemoveTrayIcon() {
-    Shell_NotifyIcon(NIM_DELETE, &g_nid);
-}
-
-// ========================================================================
-// Palette picker window
-// ========================================================================
-
-// DPI-scaled layout for the palette window — all values computed at runtime
-struct PalLayout {
-    int winW, winH;
-    int hueBarX, hueBarY, hueBarW, hueBarH;
-    int markerH;
-    int previewX, previewY, previewW, previewH;
-    int btnW, btnH, btnY, btnOkX, btnCancelX;
-    int fontLabel, fontSmall;   // font sizes (negative = point)
-    float dpiScale;
-};
-
-static PalLayout g_palLayout = {};
-
-static PalLayout ComputePalLayout() {
-    // Get DPI of primary monitor
-    UINT dpiX = DEFAULT_DPI, dpiY = DEFAULT_DPI;
-    HMONITOR hMon = MonitorFromPoint({ 0, 0 }, MONITOR_DEFAULTTOPRIMARY);
-    GetDpiForMonitor(hMon, MDT_EFFECTIVE_DPI, &dpiX, &dpiY);
-    float s = (float)dpiX / 96.0f;
-
-    PalLayout L;
-    L.dpiScale  = s;
-    L.winW      = (int)(620 * s);
-    L.winH      = (int)(560 * s);
-    int pad     = (int)(20 * s);
-
-    L.hueBarX   = pad;
-    L.hueBarY   = pad;
-    L.hueBarW   = L.winW - pad * 2;
-    L.hueBarH   = (int)(36 * s);
-    L.markerH   = (int)(10 * s);
-
-    L.btnH      = (int)(32 * s);
-    L.btnW      = (int)(90 * s);
-    L.btnY      = L.winH - pad - L.btnH;  // bottom area
-    L.btnOkX    = L.winW - pad - L.btnW * 2 - (int)(10 * s);
-    L.btnCancelX = L.winW - pad - L.btnW;
-
-    L.previewX  = pad;
-    L.previewY  = L.hueBarY + L.hueBarH + L.markerH + (int)(16 * s);
-    L.previewW  = L.winW - pad * 2;
-    L.previewH  = L.btnY - L.previewY - (int)(8 * s);
-
-    L.fontLabel = -(int)(14 * s);
-    L.fontSmall = -(int)(11 * s);
-
-    return L;
-}
-
-#define IDC_PAL_OK      2001
-#define IDC_PAL_CANCEL  2002
-
-static bool g_bDraggingHue = false;
-static float g_hueBeforeEdit = 0.0f;   // saved on dialog open for Cancel
-static HWND g_hBtnOk = NULL;
-static HWND g_hBtnCancel = NULL;
-static HBITMAP g_hHueBarBitmap = NULL;  // cached rainbow strip (static, never changes)
-
-// Map x pixel inside the hue bar to hue 0..360
-static float HueBarPixelToHue(int x) {
-    const PalLayout& L = g_palLayout;
-    float t = (float)(x - L.hueBarX) / (float)L.hueBarW;
-    if (t < 0.0f) t = 0.0f;
-    if (t > 1.0f) t = 1.0f;
-    return t * 360.0f;
-}
-
-static int HueToHueBarPixel(float hue) {
-    const PalLayout& L = g_palLayout;
-    return L.hueBarX + (int)(hue / 360.0f * L.hueBarW);
-}
-
-// Apply a new hue: regenerate palette, optionally rebuild grid bitmap, repaint
-void ApplyHue(float hue) {
-    g_baseHue = hue;
-    if (g_baseHue < 0.0f)   g_baseHue = 0.0f;
-    if (g_baseHue > 359.9f) g_baseHue = 359.9f;
-    g_palette = GeneratePalette(g_baseHue);
-    // Defer the expensive grid bitmap rebuild unless we're not dragging
-    if (!g_bDraggingHue) {
-        RenderBaseGridBitmap();
-        if (g_bGridVisible) {
-            InvalidateRect(g_hOverlayWnd, NULL, TRUE);
-        }
-    }
-}
-
-// Build the static hue rainbow bitmap (called once when palette window opens)
-static void BuildHueBarBitmap() {
-    if (g_hHueBarBitmap) { DeleteObject(g_hHueBarBitmap); g_hHueBarBitmap = NULL; }
-    const PalLayout& L = g_palLayout;
-    HDC hdcScreen = GetDC(NULL);
-    HDC hdcMem = CreateCompatibleDC(hdcScreen);
-    g_hHueBarBitmap = CreateCompatibleBitmap(hdcScreen, L.hueBarW, L.hueBarH);
-    SelectObject(hdcMem, g_hHueBarBitmap);
-    for (int x = 0; x < L.hueBarW; x++) {
-        float h = (float)x / (float)L.hueBarW * 360.0f;
-        COLORREF c = hsl(h, 0.85f, 0.50f);
-        // SetPixelV for single-pixel columns is faster than brush create/fill/delete
-        for (int y = 0; y < L.hueBarH; y++)
-            SetPixelV(hdcMem, x, y, c);
-    }
-    DeleteDC(hdcMem);
-    ReleaseDC(NULL, hdcScreen);
-}
-
-// Draw the horizontal hue rainbow bar (blits cached bitmap + draws marker)
-static void PaintHueBar(HDC hdc) {
-    const PalLayout& L = g_palLayout;
-    // Blit cached rainbow
-    if (g_hHueBarBitmap) {
-        HDC hdcBmp = CreateCompatibleDC(hdc);
-        SelectObject(hdcBmp, g_hHueBarBitmap);
-        BitBlt(hdc, L.hueBarX, L.hueBarY, L.hueBarW, L.hueBarH, hdcBmp, 0, 0, SRCCOPY);
-        DeleteDC(hdcBmp);
-    }
-    // Border
-    HPEN hPen = CreatePen(PS_SOLID, 1, RGB(80, 80, 80));
-    HPEN hOld = (HPEN)SelectObject(hdc, hPen);
-    HBRUSH hNull = (HBRUSH)GetStockObject(NULL_BRUSH);
-    HBRUSH hOldBr = (HBRUSH)SelectObject(hdc, hNull);
-    Rectangle(hdc, L.hueBarX - 1, L.hueBarY - 1,
-              L.hueBarX + L.hueBarW + 1, L.hueBarY + L.hueBarH + 1);
-    SelectObject(hdc, hOldBr);
-    SelectObject(hdc, hOld);
-    DeleteObject(hPen);
-
-    // Marker triangle below bar at current hue
-    int triH = L.markerH;
-    int mx = HueToHueBarPixel(g_baseHue);
-    int triTop = L.hueBarY + L.hueBarH + 2;
-    POINT tri[3] = {
-        { mx, triTop },
-        { mx - triH * 3 / 4, triTop + triH },
-        { mx + triH * 3 / 4, triTop + triH }
-    };
-    HBRUSH hMarker = CreateSolidBrush(RGB(255, 255, 255));
-    HPEN hMarkerPen = CreatePen(PS_SOLID, 1, RGB(40, 40, 40));
-    SelectObject(hdc, hMarker);
-    SelectObject(hdc, hMarkerPen);
-    Polygon(hdc, tri, 3);
-    SelectObject(hdc, hOld);
-    DeleteObject(hMarker);
-    DeleteObject(hMarkerPen);
-}
-
-// Draw a miniature preview of the grid + window highlight using the current palette
-static void PaintPreview(HDC hdc) {
-    const PalLayout& L = g_palLayout;
-    int px = L.previewX, py = L.previewY;
-    int pw = L.previewW, ph = L.previewH;
-    float s = L.dpiScale;
-    const Palette& P = g_palette;
-
-    // Background for the whole preview area
-    HBRUSH hBg = CreateSolidBrush(RGB(20, 20, 20));
-    RECT rcBg = { px, py, px + pw, py + ph };
-    FillRect(hdc, &rcBg, hBg);
-    DeleteObject(hBg);
-
-    // ---- Grid preview (left half) ----
-    int pad = (int)(8 * s);
-    int headerH = (int)(22 * s);
-    int gridX = px + pad, gridY = py + headerH + pad;
-    int gridW = pw / 2 - pad * 2, gridH = ph / 2 - headerH - pad;
-    int cols = 4, rows = 3;
-    int cellW = gridW / cols, cellH = gridH / rows;
-
-    // Background fill
-    HBRUSH hGridBg = CreateSolidBrush(P.background);
-    RECT rcGrid = { gridX, gridY, gridX + cols * cellW, gridY + rows * cellH };
-    FillRect(hdc, &rcGrid, hGridBg);
-    DeleteObject(hGridBg);
-
-    // DPI-scaled fonts (cached – only recreated when layout changes)
-    static HFONT hSmallFont = NULL;
-    static HFONT hTinyFont = NULL;
-    static int sCachedLabelSz = 0, sCachedSmallSz = 0;
-    if (!hSmallFont || sCachedLabelSz != L.fontLabel) {
-        if (hSmallFont) DeleteObject(hSmallFont);
-        hSmallFont = CreateFont(L.fontLabel, 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE,
-            DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
-            CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
-        sCachedLabelSz = L.fontLabel;
-    }
-    if (!hTinyFont || sCachedSmallSz != L.fontSmall) {
-        if (hTinyFont) DeleteObject(hTinyFont);
-        hTinyFont = CreateFont(L.fontSmall, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
-            DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
-            CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
-        sCachedSmallSz = L.fontSmall;
-    }
-    HFONT hOldFont = (HFONT)SelectObject(hdc, hSmallFont);
-    SetBkMode(hdc, TRANSPARENT);
-    SetTextColor(hdc, RGB(200, 200, 200));
-    RECT rcLabel = { gridX, py + pad / 2, gridX + gridW, py + headerH };
-    DrawText(hdc, L"Grid View", -1, &rcLabel, DT_LEFT | DT_SINGLELINE);
-
-    // Checkerboard cells + grid lines
-    HBRUSH hEven = CreateSolidBrush(P.cellBgEven);
-    HBRUSH hOdd  = CreateSolidBrush(P.cellBgOdd);
-    const wchar_t* demoLabels[] = {
-        L"aaa", L"aab", L"aac", L"aad",
-        L"aae", L"aaf", L"aag", L"aah",
-        L"aai", L"aaj", L"aak", L"aal"
-    };
-
-    for (int r = 0; r < rows; r++) {
-        for (int c = 0; c < cols; c++) {
-            RECT rc = { gridX + c * cellW, gridY + r * cellH,
-                        gridX + (c + 1) * cellW, gridY + (r + 1) * cellH };
-            FillRect(hdc, &rc, ((r + c) % 2 == 0) ? hEven : hOdd);
-
-            // Grid line border
-            HPEN hPen = CreatePen(PS_SOLID, 1, P.gridLine);
-            HPEN hOldPen = (HPEN)SelectObject(hdc, hPen);
-            HBRUSH hNullBr = (HBRUSH)GetStockObject(NULL_BRUSH);
-            HBRUSH hOldBr2 = (HBRUSH)SelectObject(hdc, hNullBr);
-            Rectangle(hdc, rc.left, rc.top, rc.right, rc.bottom);
-            SelectObject(hdc, hOldBr2);
-            SelectObject(hdc, hOldPen);
-            DeleteObject(hPen);
-
-            // Sub-grid lines
-            int sw = cellW / 3, sh = cellH / 3;
-            HPEN hSub = CreatePen(PS_SOLID, 1, P.subGridLine);
-            SelectObject(hdc, hSub);
-            MoveToEx(hdc, rc.left + sw, rc.top, NULL); LineTo(hdc, rc.left + sw, rc.bottom);
-            MoveToEx(hdc, rc.left + sw * 2, rc.top, NULL); LineTo(hdc, rc.left + sw * 2, rc.bottom);
-            MoveToEx(hdc, rc.left, rc.top + sh, NULL); LineTo(hdc, rc.right, rc.top + sh);
-            MoveToEx(hdc, rc.left, rc.top + sh * 2, NULL); LineTo(hdc, rc.right, rc.top + sh * 2);
-            SelectObject(hdc, (HPEN)GetStockObject(BLACK_PEN));
-            DeleteObject(hSub);
-
-            // Cell label
-            SelectObject(hdc, hTinyFont);
-            int idx = r * cols + c;
-            SetTextColor(hdc, P.mainLabelText);
-            DrawText(hdc, demoLabels[idx], -1, &rc, DT_CENTERED);
-
-            // Sub-labels
-            const wchar_t* subs = L"abcdefgh";
-            int si = 0;
-            for (int sy = 0; sy < 3; sy++) {
-                for (int sx = 0; sx < 3; sx++) {
-                    if (sx == 1 && sy == 1) continue;
-                    RECT sr = { rc.left + sx * sw, rc.top + sy * sh,
-                                rc.left + (sx + 1) * sw, rc.top + (sy + 1) * sh };
-                    SetTextColor(hdc, P.subLabelText);
-                    wchar_t sl[2] = { subs[si], 0 };
-                    DrawText(hdc, sl, 1, &sr, DT_CENTERED);
-                    si++;
-                }
-            }
-        }
-    }
-    DeleteObject(hEven);
-    DeleteObject(hOdd);
-
-    // ---- Typing preview (right half) - show match/partial/dim ----
-    int typX = px + pw / 2 + pad, typY = py + headerH + pad;
-    int typW = pw / 2 - pad * 2, typH = ph / 2 - headerH - pad;
-    int tCols = 3, tRows = 3;
-    int tCellW = typW / tCols, tCellH = typH / tRows;
-
-    // Label
-    SelectObject(hdc, hSmallFont);
-    SetTextColor(hdc, RGB(200, 200, 200));
-    RECT rcTypLabel = { typX, py + pad / 2, typX + typW, py + headerH };
-    DrawText(hdc, L"Typing Match", -1, &rcTypLabel, DT_LEFT | DT_SINGLELINE);
-
-    // Simulate: cell [1,1] = full match, [0,x] = partial, rest = dim
-    for (int r = 0; r < tRows; r++) {
-        for (int c = 0; c < tCols; c++) {
-            RECT rc = { typX + c * tCellW, typY + r * tCellH,
-                        typX + (c + 1) * tCellW, typY + (r + 1) * tCellH };
-            bool isMatch = (r == 1 && c == 1);
-            bool isPartial = (r == 0);
-
-            COLORREF bg, fg;
-            if (isMatch) {
-                bg = P.matchCellBg; fg = P.matchLabelText;
-            } else if (isPartial) {
-                bg = P.partialMatchBg; fg = P.partialMatchText;
-            } else {
-                bg = P.dimBg; fg = P.dimText;
-            }
-
-            HBRUSH hCellBg = CreateSolidBrush(bg);
-            FillRect(hdc, &rc, hCellBg);
-            DeleteObject(hCellBg);
-
-            // Grid lines
-            HPEN hPen = CreatePen(PS_SOLID, 1, isMatch ? P.matchGridLine : P.gridLine);
-            HPEN hOldPen = (HPEN)SelectObject(hdc, hPen);
-            HBRUSH hNullBr = (HBRUSH)GetStockObject(NULL_BRUSH);
-            SelectObject(hdc, hNullBr);
-            Rectangle(hdc, rc.left, rc.top, rc.right, rc.bottom);
-            SelectObject(hdc, hOldPen);
-            DeleteObject(hPen);
-
-            // Label
-            SelectObject(hdc, hTinyFont);
-            SetTextColor(hdc, fg);
-            const wchar_t* cellLabel = isMatch ? L"aaf" : (isPartial ? L"aab" : L"abz");
-            DrawText(hdc, cellLabel, -1, &rc, DT_CENTERED);
-
-            // On the matched cell, draw sub-labels + one highlighted
-            if (isMatch) {
-                int sw2 = tCellW / 3, sh2 = tCellH / 3;
-                HPEN hSub = CreatePen(PS_SOLID, 1, P.matchGridLine);
-                SelectObject(hdc, hSub);
-                MoveToEx(hdc, rc.left + sw2, rc.top, NULL); LineTo(hdc, rc.left + sw2, rc.bottom);
-                MoveToEx(hdc, rc.left + sw2 * 2, rc.top, NULL); LineTo(hdc, rc.left + sw2 * 2, rc.bottom);
-                MoveToEx(hdc, rc.left, rc.top + sh2, NULL); LineTo(hdc, rc.right, rc.top + sh2);
-                MoveToEx(hdc, rc.left, rc.top + sh2 * 2, NULL); LineTo(hdc, rc.right, rc.top + sh2 * 2);
-                SelectObject(hdc, (HPEN)GetStockObject(BLACK_PEN));
-                DeleteObject(hSub);
-
-                int si = 0;
-                for (int sy = 0; sy < 3; sy++) {
-                    for (int sx = 0; sx < 3; sx++) {
-                        if (sx == 1 && sy == 1) continue;
-                        RECT sr = { rc.left + sx * sw2, rc.top + sy * sh2,
-                                    rc.left + (sx + 1) * sw2, rc.top + (sy + 1) * sh2 };
-                        if (si == 3) {
-                            HBRUSH hHl = CreateSolidBrush(P.matchSubHighlightBg);
-                            FillRect(hdc, &sr, hHl);
-                            DeleteObject(hHl);
-                            SetTextColor(hdc, P.matchSubHighlightText);
-                        } else {
-                            SetTextColor(hdc, P.matchSubLabelText);
-                        }
-                        wchar_t sl[2] = { L"abcdefgh"[si], 0 };
-                        DrawText(hdc, sl, 1, &sr, DT_CENTERED);
-                        si++;
-                    }
-                }
-            }
-        }
-    }
-
-    // ---- Window highlight preview (bottom half) ----
-    int winY = py + ph / 2 + headerH + pad;
-    int winH = ph / 2 - headerH - pad * 2;
-    int winW = pw - pad * 2;
-    int winX = px + pad;
-
-    SelectObject(hdc, hSmallFont);
-    SetTextColor(hdc, RGB(200, 200, 200));
-    RECT rcWinLabel = { winX, py + ph / 2 + pad / 2, winX + winW, py + ph / 2 + headerH };
-    DrawText(hdc, L"Window Highlight (TAB mode)", -1, &rcWinLabel, DT_LEFT | DT_SINGLELINE);
-
-    // Dark background
-    HBRUSH hWinBg = CreateSolidBrush(P.background);
-    RECT rcWin = { winX, winY, winX + winW, winY + winH };
-    FillRect(hdc, &rcWin, hWinBg);
-    DeleteObject(hWinBg);
-
-    // Fake windows
-    struct FakeWin { RECT r; const wchar_t* title; bool current; };
-    int fw1 = winW * 55 / 100, fh1 = winH * 70 / 100;
-    int fw2 = winW * 45 / 100, fh2 = winH * 60 / 100;
-    FakeWin fakes[] = {
-        { { winX + (int)(10*s), winY + (int)(24*s), winX + (int)(10*s) + fw1, winY + (int)(24*s) + fh1 }, L"[1/2] Visual Studio Code", true },
-        { { winX + winW - fw2 - (int)(10*s), winY + (int)(12*s), winX + winW - (int)(10*s), winY + (int)(12*s) + fh2 }, L"[2/2] Firefox", false }
-    };
-
-    int thick = max(2, (int)(3 * s));
-    for (const auto& fw : fakes) {
-        COLORREF borderCol = fw.current ? P.mainLabelText : P.gridLine;
-        HBRUSH hBorder = CreateSolidBrush(borderCol);
-
-        RECT e;
-        e = { fw.r.left, fw.r.top, fw.r.right, fw.r.top + thick };
-        FillRect(hdc, &e, hBorder);
-        e = { fw.r.left, fw.r.bottom - thick, fw.r.right, fw.r.bottom };
-        FillRect(hdc, &e, hBorder);
-        e = { fw.r.left, fw.r.top, fw.r.left + thick, fw.r.bottom };
-        FillRect(hdc, &e, hBorder);
-        e = { fw.r.right - thick, fw.r.top, fw.r.right, fw.r.bottom };
-        FillRect(hdc, &e, hBorder);
-        DeleteObject(hBorder);
-
-        // Label above the window
-        SIZE ts;
-        GetTextExtentPoint32(hdc, fw.title, (int)wcslen(fw.title), &ts);
-        RECT lblBg = { fw.r.left, fw.r.top - ts.cy - (int)(6*s),
-                       fw.r.left + ts.cx + (int)(8*s), fw.r.top - 2 };
-        HBRUSH hLbl = CreateSolidBrush(fw.current ? P.matchCellBg : P.cellBgEven);
-        FillRect(hdc, &lblBg, hLbl);
-        DeleteObject(hLbl);
-
-        SelectObject(hdc, hTinyFont);
-        SetTextColor(hdc, P.matchLabelText);
-        RECT lblRc = { lblBg.left + (int)(4*s), lblBg.top + (int)(2*s), lblBg.right, lblBg.bottom };
-        DrawText(hdc, fw.title, -1, &lblRc, DT_LEFT | DT_SINGLELINE | DT_NOPREFIX);
-    }
-
-    // Minimized panel preview
-    int mpW = winW / 3, mpH = winH - (int)(10*s);
-    int mpX = winX + winW - mpW - (int)(4*s), mpY = winY + (int)(4*s);
-    RECT rcPanel = { mpX, mpY, mpX + mpW, mpY + mpH };
-    HBRUSH hPanelBg = CreateSolidBrush(P.background);
-    FillRect(hdc, &rcPanel, hPanelBg);
-    DeleteObject(hPanelBg);
-
-    // Panel border
-    HBRUSH hPanelBorder = CreateSolidBrush(P.gridLine);
-    RECT be;
-    be = { rcPanel.left, rcPanel.top, rcPanel.right, rcPanel.top + 1 };
-    FillRect(hdc, &be, hPanelBorder);
-    be = { rcPanel.left, rcPanel.bottom - 1, rcPanel.right, rcPanel.bottom };
-    FillRect(hdc, &be, hPanelBorder);
-    be = { rcPanel.left, rcPanel.top, rcPanel.left + 1, rcPanel.bottom };
-    FillRect(hdc, &be, hPanelBorder);
-    be = { rcPanel.right - 1, rcPanel.top, rcPanel.right, rcPanel.bottom };
-    FillRect(hdc, &be, hPanelBorder);
-    DeleteObject(hPanelBorder);
-
-    // Panel title
-    SetTextColor(hdc, P.mainLabelText);
-    SelectObject(hdc, hTinyFont);
-    int itemH = (int)(18 * s);
-    RECT rcPanelTitle = { mpX + (int)(4*s), mpY + (int)(3*s), mpX + mpW - (int)(4*s), mpY + itemH };
-    DrawText(hdc, L"Minimized", -1, &rcPanelTitle, DT_LEFT | DT_SINGLELINE);
-
-    // Panel items
-    const wchar_t* items[] = { L"Notepad", L"Calculator", L"Slack" };
-    int itemTop = mpY + itemH + (int)(2*s);
-    for (int i = 0; i < 3; i++) {
-        int iy = itemTop + i * itemH;
-        RECT ir = { mpX + (int)(4*s), iy, mpX + mpW - (int)(4*s), iy + itemH };
-        if (i == 0) {
-            RECT hlr = { mpX + 1, iy, mpX + mpW - 1, iy + itemH };
-            HBRUSH hHl = CreateSolidBrush(P.matchSubHighlightBg);
-            FillRect(hdc, &hlr, hHl);
-            DeleteObject(hHl);
-            SetTextColor(hdc, P.matchSubHighlightText);
-        } else {
-            SetTextColor(hdc, P.subLabelText);
-        }
-        DrawText(hdc, items[i], -1, &ir, DT_LEFT | DT_SINGLELINE | DT_NOPREFIX);
-    }
-
-    // Hue value label at bottom of preview
-    SelectObject(hdc, hSmallFont);
-    SetTextColor(hdc, RGB(200, 200, 200));
-    wchar_t hueBuf[64];
-    swprintf_s(hueBuf, L"Hue: %.0f\u00b0", g_baseHue);
-    RECT rcHue = { px, py + ph - (int)(22*s), px + pw, py + ph };
-    DrawText(hdc, hueBuf, -1, &rcHue, DT_CENTER | DT_SINGLELINE);
-
-    // Cleanup (fonts are cached statics, don't delete here)
-    SelectObject(hdc, hOldFont);
-}
-
-// --- Registry persistence for user settings ---
-static const wchar_t* REG_KEY = L"Software\\KeyboardJockey";
-
-static void SaveHueToRegistry(float hue) {
-    HKEY hKey;
-    if (RegCreateKeyEx(HKEY_CURRENT_USER, REG_KEY, 0, NULL,
-            REG_OPTION_NON_VOLATILE, KEY_WRITE, NULL, &hKey, NULL) == ERROR_SUCCESS) {
-        DWORD val = (DWORD)(hue * 100.0f);  // store as fixed-point (2 decimals)
-        RegSetValueEx(hKey, L"BaseHue", 0, REG_DWORD, (BYTE*)&val, sizeof(val));
-        RegCloseKey(hKey);
-    }
-}
-
-static float LoadHueFromRegistry() {
-    HKEY hKey;
-    if (RegOpenKeyEx(HKEY_CURRENT_USER, REG_KEY, 0, KEY_READ, &hKey) == ERROR_SUCCESS) {
-        DWORD val = 0, sz = sizeof(val), type = 0;
-        if (RegQueryValueEx(hKey, L"BaseHue", NULL, &type, (BYTE*)&val, &sz) == ERROR_SUCCESS
-            && type == REG_DWORD) {
-            RegCloseKey(hKey);
-            float h = (float)val / 100.0f;
-            if (h >= 0.0f && h < 360.0f) return h;
-        } else {
-            RegCloseKey(hKey);
-        }
-    }
-    return BASE_HUE_DEFAULT;  // no saved value
-}
-
-// Palette window procedure
-LRESULT CALLBACK PaletteWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
-    switch (message) {
-    case WM_CREATE: {
-        const PalLayout& L = g_palLayout;
-        // Create OK and Cancel buttons
-        HFONT hBtnFont = CreateFont(L.fontLabel, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
-            DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
-            CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
-        g_hBtnOk = CreateWindowEx(0, L"BUTTON", L"OK",
-            WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
-            L.btnOkX, L.btnY, L.btnW, L.btnH,
-            hWnd, (HMENU)IDC_PAL_OK, g_hInstance, NULL);
-        g_hBtnCancel = CreateWindowEx(0, L"BUTTON", L"Cancel",
-            WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
-            L.btnCancelX, L.btnY, L.btnW, L.btnH,
-            hWnd, (HMENU)IDC_PAL_CANCEL, g_hInstance, NULL);
-        SendMessage(g_hBtnOk, WM_SETFONT, (WPARAM)hBtnFont, TRUE);
-        SendMessage(g_hBtnCancel, WM_SETFONT, (WPARAM)hBtnFont, TRUE);
-        // hBtnFont intentionally not deleted — owned by the buttons for their lifetime
-        return 0;
-    }
-
-    case WM_PAINT: {
-        PAINTSTRUCT ps;
-        HDC hdc = BeginPaint(hWnd, &ps);
-
-        // Double-buffer
-        RECT rc;
-        GetClientRect(hWnd, &rc);
-        int w = rc.right, h = rc.bottom;
-        HDC hdcMem = CreateCompatibleDC(hdc);
-        HBITMAP hbm = CreateCompatibleBitmap(hdc, w, h);
-        HBITMAP hOldBm = (HBITMAP)SelectObject(hdcMem, hbm);
-
-        // Fill with dark gray
-        HBRUSH hBg = CreateSolidBrush(RGB(30, 30, 30));
-        FillRect(hdcMem, &rc, hBg);
-        DeleteObject(hBg);
-
-        PaintHueBar(hdcMem);
-        PaintPreview(hdcMem);
-
-        BitBlt(hdc, 0, 0, w, h, hdcMem, 0, 0, SRCCOPY);
-        SelectObject(hdcMem, hOldBm);
-        DeleteObject(hbm);
-        DeleteDC(hdcMem);
-
-        EndPaint(hWnd, &ps);
-        return 0;
-    }
-
-    case WM_LBUTTONDOWN: {
-        const PalLayout& L = g_palLayout;
-        int mx = LOWORD(lParam), my = HIWORD(lParam);
-        if (mx >= L.hueBarX && mx <= L.hueBarX + L.hueBarW &&
-            my >= L.hueBarY - (int)(4*L.dpiScale) &&
-            my <= L.hueBarY + L.hueBarH + L.markerH + (int)(8*L.dpiScale)) {
-            g_bDraggingHue = true;
-            SetCapture(hWnd);
-            float newHue = HueBarPixelToHue(mx);
-            ApplyHue(newHue);
-            InvalidateRect(hWnd, NULL, FALSE);
-        }
-        return 0;
-    }
-
-    case WM_MOUSEMOVE: {
-        if (g_bDraggingHue) {
-            int mx = (short)LOWORD(lParam);
-            float newHue = HueBarPixelToHue(mx);
-            ApplyHue(newHue);
-            InvalidateRect(hWnd, NULL, FALSE);
-        }
-        return 0;
-    }
-
-    case WM_LBUTTONUP:
-        if (g_bDraggingHue) {
-            g_bDraggingHue = false;
-            ReleaseCapture();
-            // Now do the deferred expensive rebuild
-            RenderBaseGridBitmap();
-            if (g_bGridVisible) {
-                InvalidateRect(g_hOverlayWnd, NULL, TRUE);
-            }
-        }
-        return 0;
-
-    case WM_COMMAND:
-        switch (LOWORD(wParam)) {
-        case IDC_PAL_OK:
-            // Accept — save to registry and close
-            SaveHueToRegistry(g_baseHue);
-            DestroyWindow(hWnd);
-            break;
-        case IDC_PAL_CANCEL:
-            // Revert to the hue we had when the dialog opened
-            ApplyHue(g_hueBeforeEdit);
-            DestroyWindow(hWnd);
-            break;
-        }
-        return 0;
-
-    case WM_CLOSE:
-        // Closing via X button = Cancel
-        ApplyHue(g_hueBeforeEdit);
-        DestroyWindow(hWnd);
-        return 0;
-
-    case WM_DESTROY:
-        g_hBtnOk = NULL;
-        g_hBtnCancel = NULL;
-        g_hPaletteWnd = NULL;
-        if (g_hHueBarBitmap) { DeleteObject(g_hHueBarBitmap); g_hHueBarBitmap = NULL; }
-        return 0;
-
-    default:
-        return DefWindowProc(hWnd, message, wParam, lParam);
-    }
-    return 0;
-}
-
-void ShowPaletteWindow() {
-    // If already open, bring to front
-    if (g_hPaletteWnd && IsWindow(g_hPaletteWnd)) {
-        SetForegroundWindow(g_hPaletteWnd);
-        return;
-    }
-
-    // Save current hue for Cancel
-    g_hueBeforeEdit = g_baseHue;
-
-    // Compute DPI-aware layout
-    g_palLayout = ComputePalLayout();
-    const PalLayout& L = g_palLayout;
-
-    // Build cached hue bar bitmap
-    BuildHueBarBitmap();
-
-    // Compute outer window size from desired client area
-    DWORD style = WS_OVERLAPPED | WS_CAPTION | WS_SYSMENU | WS_CLIPCHILDREN;
-    RECT rcDesired = { 0, 0, L.winW, L.winH };
-    AdjustWindowRectEx(&rcDesired, style, FALSE, WS_EX_APPWINDOW);
-    int outerW = rcDesired.right - rcDesired.left;
-    int outerH = rcDesired.bottom - rcDesired.top;
-
-    // Center on primary monitor
-    int sx = GetSystemMetrics(SM_CXSCREEN);
-    int sy = GetSystemMetrics(SM_CYSCREEN);
-    int wx = (sx - outerW) / 2;
-    int wy = (sy - outerH) / 2;
-
-    g_hPaletteWnd = CreateWindowEx(
-        WS_EX_APPWINDOW,
-        L"KeyboardJockeyPalette",
-        L"Keyboard Jockey \u2013 Palette",
-        style,
-        wx, wy, outerW, outerH,
-        NULL, NULL, g_hInstance, NULL
-    );
-
-    ShowWindow(g_hPaletteWnd, SW_SHOW);
-    UpdateWindow(g_hPaletteWnd);
-}
-
-// Show context menu
-void ShowContextMenu(HWND hWnd) {
-    POINT pt;
-    GetCursorPos(&pt);
-    
-    HMENU hMenu = CreatePopupMenu();
-    AppendMenu(hMenu, MF_STRING, IDM_SHOW, L"Show Grid (Ctrl+Alt+M)");
-    AppendMenu(hMenu, MF_STRING, IDM_PALETTE, L"Palette...");
-    AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
-    AppendMenu(hMenu, MF_STRING, IDM_EXIT, L"Exit");
-    
-    SetForegroundWindow(hWnd);
-    TrackPopupMenu(hMenu, TPM_RIGHTBUTTON, pt.x, pt.y, 0, hWnd, NULL);
-    DestroyMenu(hMenu);
-}
-
-// Overlay window procedure
-LRESULT CALLBACK OverlayWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
-    switch (message) {
-    case WM_ERASEBKGND:
-        return 1;  // Skip erase — we paint the full surface ourselves
-    
-    case WM_SETCURSOR:
-        // Show normal arrow cursor during mouse-move and scroll modes instead of cross
-        if (g_bMouseMoveMode || g_bScrollMode) {
-            SetCursor(LoadCursor(NULL, IDC_ARROW));
-            return TRUE;
-        }
-        return DefWindowProc(hWnd, message, wParam, lParam);
-    
-    case WM_PAINT: {
-        PAINTSTRUCT ps;
-        HDC hdc = BeginPaint(hWnd, &ps);
-        
-        // Double-buffer: paint to off-screen bitmap, then blit
-        RECT rc;
-        GetClientRect(hWnd, &rc);
-        int w = rc.right - rc.left;
-        int h = rc.bottom - rc.top;
-        HDC hdcMem = CreateCompatibleDC(hdc);
-        HBITMAP hbmMem = CreateCompatibleBitmap(hdc, w, h);
-        HBITMAP hbmOld = (HBITMAP)SelectObject(hdcMem, hbmMem);
-        
-        PaintGrid(hdcMem);
-        
-        BitBlt(hdc, 0, 0, w, h, hdcMem, 0, 0, SRCCOPY);
-        
-        SelectObject(hdcMem, hbmOld);
-        DeleteObject(hbmMem);
-        DeleteDC(hdcMem);
-        
-        EndPaint(hWnd, &ps);
-        return 0;
-    }
-    
-    case WM_KEYDOWN:
-    case WM_SYSKEYDOWN: {
-        // In scroll mode, only PgUp/PgDn/Escape are allowed; anything else exits
-        if (g_bScrollMode && wParam != VK_PRIOR && wParam != VK_NEXT && wParam != VK_ESCAPE) {
-            ExitScrollMode();
-            return 0;
-        }
-        
-        // In TAB/text mode, only allow relevant keys; block grid navigation
-        bool inTabMode = (g_highlightIndex >= 0 || g_bTabTextMode || !g_tabSearchStr.empty());
-        if (inTabMode) {
-            switch (wParam) {
-            case VK_ESCAPE:
-                HideGrid();
-                return 0;
-            case VK_RETURN: {
-                // Activate highlighted window (or single search match)
-                int totalNormal = (int)g_appWindows.size();
-                HWND targetWnd = NULL;
-                if (g_highlightIndex >= 0 && g_highlightIndex < totalNormal) {
-                    targetWnd = g_appWindows[g_highlightIndex].hwnd;
-                } else if (g_highlightIndex >= totalNormal && (g_highlightIndex - totalNormal) < (int)g_minimizedWindows.size()) {
-                    targetWnd = g_minimizedWindows[g_highlightIndex - totalNormal].hwnd;
-                }
-                if (targetWnd) {
-                    HideGrid();
-                    Sleep(ACTIVATION_DELAY_MS);
-                    SetForegroundWindow(targetWnd);
-                    if (IsIconic(targetWnd)) {
-                        ShowWindow(targetWnd, SW_RESTORE);
-                    }
-                }
-                }
-                return 0;
-            case VK_TAB: {
-                // If in text search mode, TAB exits back to normal cycling
-                if (g_bTabTextMode || !g_tabSearchStr.empty()) {
-                    g_bTabTextMode = false;
-                    g_tabSearchStr.clear();
-                    // Restore to visible-only windows for normal cycling
-                    g_appWindows.clear();
-                    for (const auto& aw : g_allAppWindows) {
-                        if (aw.visibleArea > 0) g_appWindows.push_back(aw);
-                    }
-                    g_minimizedWindows.clear();  // hide minimized panel
-                    if (!g_appWindows.empty()) g_highlightIndex = 0;
-                    else g_highlightIndex = -1;
-                    SetLayeredWindowAttributes(g_hOverlayWnd, g_palette.background, 0, LWA_COLORKEY);
-                    KillTimer(hWnd, TIMER_ID_TAB_TEXT);
-                    SetTimer(hWnd, TIMER_ID_TAB_TEXT, TAB_TEXT_TIMEOUT_MS, NULL);
-                    InvalidateRect(hWnd, NULL, TRUE);
-                } else {
-                    bool shiftTab = (GetKeyState(VK_SHIFT) & 0x8000) != 0;
-                    CycleHighlight(!shiftTab);
-                }
-                return 0;
-            }
-            case VK_BACK:
-                if (!g_tabSearchStr.empty()) {
-                    g_tabSearchStr.pop_back();
-                    if (g_tabSearchStr.empty()) {
-                        g_appWindows.clear();
-                        if (g_bTabTextMode) {
-                            g_appWindows = g_allAppWindows;
-                        } else {
-                            for (const auto& aw : g_allAppWindows) {
-                                if (aw.visibleArea > 0) g_appWindows.push_back(aw);
-                            }
-                        }
-                        g_minimizedWindows = g_allMinimizedWindows;
-                        if (!g_appWindows.empty()) g_highlightIndex = 0;
-                        else if (!g_minimizedWindows.empty()) g_highlightIndex = 0;
-                        else g_highlightIndex = -1;
-                    } else {
-                        FilterAppWindowsBySearch();
-                    }
-                    InvalidateRect(hWnd, NULL, TRUE);
-                }
-                return 0;
-            default:
-                // Block all other keys (arrows, space, etc.) in TAB mode
-                return 0;
-            }
-        }
-        
-        // Check modifiers for movement amount
-        bool shiftHeld = (GetKeyState(VK_SHIFT) & 0x8000) != 0;
-        bool ctrlHeld = (GetKeyState(VK_CONTROL) & 0x8000) != 0;
-        int moveAmount = shiftHeld ? 1 : (ctrlHeld ? 50 : 10);
-        
-        switch (wParam) {
-        case VK_ESCAPE:
-            HideGrid();
-            break;
-        case VK_LEFT:
-            MoveMouseByArrowKey(-moveAmount, 0, moveAmount);
-            break;
-        case VK_RIGHT:
-            MoveMouseByArrowKey(moveAmount, 0, moveAmount);
-            break;
-        case VK_UP:
-            MoveMouseByArrowKey(0, -moveAmount, moveAmount);
-            break;
-        case VK_DOWN:
-            MoveMouseByArrowKey(0, moveAmount, moveAmount);
-            break;
-        case VK_SHIFT:
-            // Make UI subtle when Shift is pressed (skip in highlight mode)
-            if (g_highlightIndex < 0) {
-                BYTE peekAlpha = g_bMouseMoveMode ? MOUSE_MOVE_ALPHA : SHIFT_PEEK_ALPHA;
-                SetLayeredWindowAttributes(g_hOverlayWnd, 0, peekAlpha, LWA_ALPHA);
-            }
-            break;
-        case VK_SPACE: {
-            // Hide the cursor and close the grid
-            HideGrid();
-            HideCursor();
-            break;
-        }
-        case VK_RETURN: {
-            // If in window highlight mode, activate the highlighted window
-            HWND targetWnd2 = NULL;
-            int totalNormal2 = (int)g_appWindows.size();
-            if (g_highlightIndex >= 0 && g_highlightIndex < totalNormal2) {
-                targetWnd2 = g_appWindows[g_highlightIndex].hwnd;
-            } else if (g_highlightIndex >= totalNormal2 && (g_highlightIndex - totalNormal2) < (int)g_minimizedWindows.size()) {
-                targetWnd2 = g_minimizedWindows[g_highlightIndex - totalNormal2].hwnd;
-            }
-            if (targetWnd2) {
-                HideGrid();
-                Sleep(ACTIVATION_DELAY_MS);
-                // Activate the window
-                SetForegroundWindow(targetWnd2);
-                // If minimized, restore it
-                if (IsIconic(targetWnd2)) {
-                    ShowWindow(targetWnd2, SW_RESTORE);
-                }
-                break;
-            }
-            // If we have 3 chars typed, move to center before clicking
-            if (g_typedChars.length() >= 3) {
-                std::wstring threeChar = g_typedChars.substr(0, 3);
-                auto it = g_gridMap.find(threeChar);
-                if (it != g_gridMap.end()) {
-                    MoveMouse(it->second);
-                }
-            }
-            // Capture modifiers before hiding overlay/focus changes
-            bool altHeld = (GetKeyState(VK_MENU) & 0x8000) != 0;
-            bool ctrlHeldForClick = (GetKeyState(VK_CONTROL) & 0x8000) != 0;
-            HideGrid();
-            // Small delay to let grid disappear
-            Sleep(ACTIVATION_DELAY_MS);
-            // Check modifiers: Alt=right-click, Ctrl=double-click
-            if (altHeld) {
-                SendClick(true);    // Right click
-            } else if (ctrlHeldForClick) {
-                SendDoubleClick();  // Double click
-            } else {
-                SendClick(false);   // Left click
-            }
-            break;
-        }
-        case VK_TAB: {
-            bool shiftTab = (GetKeyState(VK_SHIFT) & 0x8000) != 0;
-            CycleHighlight(!shiftTab);
-            break;
-        }
-        case VK_BACK:
-            // In TAB search mode, delete from search string
-            if (g_highlightIndex >= 0 && !g_tabSearchStr.empty()) {
-                g_tabSearchStr.pop_back();
-                if (g_tabSearchStr.empty()) {
-                    // Restore to cycling mode with all visible windows
-                    g_appWindows.clear();
-                    for (const auto& aw : g_allAppWindows) {
-                        if (aw.visibleArea > 0) g_appWindows.push_back(aw);
-                    }
-                    g_minimizedWindows = g_allMinimizedWindows;
-                    if (!g_appWindows.empty()) g_highlightIndex = 0;
-                    else if (!g_minimizedWindows.empty()) g_highlightIndex = 0;
-                    else g_highlightIndex = -1;
-                } else {
-                    FilterAppWindowsBySearch();
-                }
-                InvalidateRect(hWnd, NULL, TRUE);
-            } else if (!g_typedChars.empty()) {
-                g_typedChars.pop_back();
-                InvalidateRect(hWnd, NULL, TRUE);
-            }
-            break;
-        case VK_PRIOR:   // PgUp
-        case VK_NEXT: {  // PgDn
-            // Enter scroll mode: make overlay invisible, send wheel to window under cursor
-            if (!g_bScrollMode) {
-                g_bScrollMode = true;
-                // Make overlay visually transparent via color key
-                SetLayeredWindowAttributes(g_hOverlayWnd, g_palette.background, 0, LWA_COLORKEY);
-                InvalidateRect(g_hOverlayWnd, NULL, TRUE);
-                UpdateWindow(g_hOverlayWnd);
-                SetCursor(LoadCursor(NULL, IDC_ARROW));
-                // Make overlay transparent to ALL input (mouse clicks, wheel, etc.)
-                LONG_PTR exStyle = GetWindowLongPtr(g_hOverlayWnd, GWL_EXSTYLE);
-                SetWindowLongPtr(g_hOverlayWnd, GWL_EXSTYLE, exStyle | WS_EX_TRANSPARENT);
-                // Install mouse hook to detect movement
-                g_hScrollMouseHook = SetWindowsHookEx(WH_MOUSE_LL, ScrollMouseProc, g_hInstance, 0);
-            }
-            // Simulate mouse wheel scroll (passes through to window under cursor)
-            {
-                INPUT input = {};
-                input.type = INPUT_MOUSE;
-                input.mi.dwFlags = MOUSEEVENTF_WHEEL;
-                input.mi.mouseData = (wParam == VK_PRIOR) ? (DWORD)(3 * WHEEL_DELTA) : (DWORD)(-3 * WHEEL_DELTA);
-                SendInput(1, &input, sizeof(INPUT));
-            }
-            break;
-        }
-        }
-        return 0;
-    }
-    
-    case WM_CHAR: {
-        wchar_t ch = (wchar_t)wParam;
-        // Any typing in scroll mode exits it
-        if (g_bScrollMode) {
-            ExitScrollMode();
-            return 0;
-        }
-        if (ch == L'*' && !g_bTabTextMode) {
-            // Enter "Select Window By Name" mode from grid or TAB mode
-            EnumerateAppWindows();
-            g_bTabTextMode = true;
-            g_tabSearchStr.clear();
-            KillTimer(hWnd, TIMER_ID_TAB_TEXT);
-            g_appWindows = g_allAppWindows;
-            g_minimizedWindows = g_allMinimizedWindows;
-            if (!g_appWindows.empty()) g_highlightIndex = 0;
-            else if (!g_minimizedWindows.empty()) g_highlightIndex = 0;
-            // Combine color-key + alpha: background pixels = invisible, panel = semi-transparent
-            SetLayeredWindowAttributes(g_hOverlayWnd, g_palette.background, GRID_ALPHA, LWA_COLORKEY | LWA_ALPHA);
-            InvalidateRect(hWnd, NULL, TRUE);
-            return 0;
-        }
-        if (ch >= L'a' && ch <= L'z') {
-            // In TAB highlight/text mode, typing filters windows by substring
-            if (g_highlightIndex >= 0 || g_bTabTextMode || !g_tabSearchStr.empty()) {
-                g_tabSearchStr += ch;
-                FilterAppWindowsBySearch();
-                // Reset the tab text timeout timer (don't use TIMER_ID_RESET for search)
-                KillTimer(hWnd, TIMER_ID_TAB_TEXT);
-                SetTimer(hWnd, TIMER_ID_TAB_TEXT, TAB_TEXT_TIMEOUT_MS, NULL);
-                InvalidateRect(hWnd, NULL, TRUE);
-            } else {
-                ProcessTypedChar(ch);
-            }
-        }
-        return 0;
-    }
-    
-    case WM_KEYUP: {
-        // Restore UI when Shift is released (skip in highlight mode)
-        if (wParam == VK_SHIFT && g_highlightIndex < 0) {
-            // Restore to mouse move mode transparency or full opacity
-            if (g_bMouseMoveMode) {
-                SetLayeredWindowAttributes(g_hOverlayWnd, 0, MOUSE_MOVE_ALPHA, LWA_ALPHA);
-            } else {
-                SetLayeredWindowAttributes(g_hOverlayWnd, 0, GRID_ALPHA, LWA_ALPHA);
-            }
-        }
-        return 0;
-    }
-    
-    case WM_KILLFOCUS:
-        // Hide grid when losing focus
-        HideGrid();
-        return 0;
-    
-    case WM_TIMER:
-        if (wParam == TIMER_ID_RESET) {
-            KillTimer(hWnd, TIMER_ID_RESET);
-            // In TAB search mode, clear search but stay in highlight mode
-            if ((g_highlightIndex >= 0 || g_bTabTextMode) && !g_tabSearchStr.empty()) {
-                g_tabSearchStr.clear();
-                // Restore all windows (if in text mode) or visible-area ones
-                g_appWindows.clear();
-                if (g_bTabTextMode) {
-                    g_appWindows = g_allAppWindows;
-                } else {
-                    for (const auto& aw : g_allAppWindows) {
-                        if (aw.visibleArea > 0) g_appWindows.push_back(aw);
-                    }
-                }
-                g_minimizedWindows = g_allMinimizedWindows;
-                if (!g_appWindows.empty()) g_highlightIndex = 0;
-                else if (!g_minimizedWindows.empty()) g_highlightIndex = 0;
-                else g_highlightIndex = -1;
-                InvalidateRect(hWnd, NULL, TRUE);
-            } else if (!g_typedChars.empty()) {
-                g_typedChars.clear();
-                InvalidateRect(hWnd, NULL, TRUE);
-            }
-        }
-        else if (wParam == TIMER_ID_TAB_TEXT) {
-            KillTimer(hWnd, TIMER_ID_TAB_TEXT);
-            // Enter "select by text" mode - show ALL windows highlighted
-            if (g_highlightIndex >= 0 && !g_bTabTextMode) {
-                g_bTabTextMode = true;
-                g_tabSearchStr.clear();
-                // Switch to all windows (including fully occluded)
-                g_appWindows = g_allAppWindows;
-                g_minimizedWindows = g_allMinimizedWindows;
-                if (!g_appWindows.empty()) g_highlightIndex = 0;
-                else if (!g_minimizedWindows.empty()) g_highlightIndex = 0;
-                // Combine color-key + alpha: background pixels = invisible, panel = semi-transparent
-                SetLayeredWindowAttributes(g_hOverlayWnd, g_palette.background, GRID_ALPHA, LWA_COLORKEY | LWA_ALPHA);
-                InvalidateRect(hWnd, NULL, TRUE);
-            }
-        }
-        return 0;
-    
-    default:
-        return DefWindowProc(hWnd, message, wParam, lParam);
-    }
-}
-
-// Main window procedure
-LRESULT CALLBACK MainWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
-    switch (message) {
-    case WM_CREATE:
-        CreateTrayIcon(hWnd);
-        // Register global hotkey: Ctrl+Alt+M
-        if (!RegisterHotKey(hWnd, HOTKEY_ID_SHOW_GRID, MOD_CONTROL | MOD_ALT, 'M')) {
-            MessageBox(hWnd, L"Failed to register hotkey Ctrl+Alt+M", L"Error", MB_ICONERROR);
-        }
-        // Pre-build grid cells and cache base grid bitmap
-        BuildGridCells();
-        RenderBaseGridBitmap();
-        // Install global keyboard hook for cursor hiding while typing
-        InstallGlobalKeyboardHook();
-        return 0;
-    
-    case WM_HOTKEY:
-        if (wParam == HOTKEY_ID_SHOW_GRID) {
-            if (g_bGridVisible) {
-                HideGrid();
-            } else {
-                ShowGrid();
-            }
-        }
-        return 0;
-    
-    case WM_TRAYICON:
-        switch (LOWORD(lParam)) {
-        case WM_RBUTTONUP:
-            ShowContextMenu(hWnd);
-            break;
-        case WM_LBUTTONDBLCLK:
-            ShowGrid();
-            break;
-        }
-        return 0;
-    
-    case WM_COMMAND:
-        switch (LOWORD(wParam)) {
-        case IDM_EXIT:
-            DestroyWindow(hWnd);
-            break;
-        case IDM_SHOW:
-            ShowGrid();
-            break;
-        case IDM_PALETTE:
-            ShowPaletteWindow();
-            break;
-        }
-        return 0;
-    
-    case WM_DESTROY:
-        UnregisterHotKey(hWnd, HOTKEY_ID_SHOW_GRID);
-        RemoveTrayIcon();
-        if (g_hGridBitmap) { DeleteObject(g_hGridBitmap); g_hGridBitmap = NULL; }
-        UninstallGlobalKeyboardHook();  // Remove keyboard hook
-        RestoreCursor();  // Make sure cursor is restored on exit
-        if (g_hOverlayWnd) {
-            DestroyWindow(g_hOverlayWnd);
-        }
-        PostQuitMessage(0);
-        return 0;
-    
-    default:
-        return DefWindowProc(hWnd, message, wParam, lParam);
-    }
-}
-
-// Entry point
-int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow) {
-    // Enable per-monitor DPI awareness for correct coordinates on mixed-DPI setups
-    SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
-    
-    g_hInstance = hInstance;
-
-    // Load saved hue from registry and apply it
-    g_baseHue = LoadHueFromRegistry();
-    g_palette = GeneratePalette(g_baseHue);
-    
-    // Save a copy of the default arrow cursor before we ever modify system cursors
-    HCURSOR hArrow = LoadCursor(NULL, IDC_ARROW);
-    if (hArrow) {
-        g_hSavedArrow = CopyCursor(hArrow);
-    }
-    
-    // Register cleanup handlers for crash/force-kill scenarios
-    atexit(ForceRestoreCursors);
-    SetUnhandledExceptionFilter(CrashHandler);
-    
-    // Register main window class
-    WNDCLASSEX wcMain = {};
-    wcMain.cbSize = sizeof(WNDCLASSEX);
-    wcMain.lpfnWndProc = MainWndProc;
-    wcMain.hInstance = hInstance;
-    wcMain.hIcon = LoadIcon(hInstance, MAKEINTRESOURCE(IDI_KEYBOARDJOCKEY));
-    wcMain.hCursor = LoadCursor(NULL, IDC_ARROW);
-    wcMain.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
-    wcMain.lpszClassName = L"KeyboardJockeyMain";
-    wcMain.hIconSm = LoadIcon(hInstance, MAKEINTRESOURCE(IDI_KEYBOARDJOCKEY));
-    
-    if (!RegisterClassEx(&wcMain)) {
-        MessageBox(NULL, L"Failed to register main window class", L"Error", MB_ICONERROR);
-        return 1;
-    }
-    
-    // Register overlay window class
-    WNDCLASSEX wcOverlay = {};
-    wcOverlay.cbSize = sizeof(WNDCLASSEX);
-    wcOverlay.lpfnWndProc = OverlayWndProc;
-    wcOverlay.hInstance = hInstance;
-    wcOverlay.hCursor = LoadCursor(NULL, IDC_CROSS);
-    wcOverlay.hbrBackground = NULL;
-    wcOverlay.lpszClassName = L"KeyboardJockeyOverlay";
-    
-    if (!RegisterClassEx(&wcOverlay)) {
-        MessageBox(NULL, L"Failed to register overlay window class", L"Error", MB_ICONERROR);
-        return 1;
-    }
-    
-    // Register palette picker window class
-    WNDCLASSEX wcPalette = {};
-    wcPalette.cbSize = sizeof(WNDCLASSEX);
-    wcPalette.lpfnWndProc = PaletteWndProc;
-    wcPalette.hInstance = hInstance;
-    wcPalette.hCursor = LoadCursor(NULL, IDC_ARROW);
-    wcPalette.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
-    wcPalette.lpszClassName = L"KeyboardJockeyPalette";
-    wcPalette.hIcon = LoadIcon(hInstance, MAKEINTRESOURCE(IDI_KEYBOARDJOCKEY));
-    wcPalette.hIconSm = LoadIcon(hInstance, MAKEINTRESOURCE(IDI_KEYBOARDJOCKEY));
-    RegisterClassEx(&wcPalette);
-    
-    // Create main window (hidden)
-    g_hMainWnd = CreateWindowEx(
-        0,
-        L"KeyboardJockeyMain",
-        L"Keyboard Jockey",
-        WS_OVERLAPPEDWINDOW,
-        CW_USEDEFAULT, CW_USEDEFAULT, 400, 300,
-        NULL, NULL, hInstance, NULL
-    );
-    
-    if (!g_hMainWnd) {
-        MessageBox(NULL, L"Failed to create main window", L"Error", MB_ICONERROR);
-        return 1;
-    }
-    
-    // Don't show the main window - it minimizes to tray immediately
-    // ShowWindow(g_hMainWnd, SW_HIDE);
-    
-    // Message loop
-    MSG msg;
-    while (GetMessage(&msg, NULL, 0, 0)) {
-        TranslateMessage(&msg);
-        DispatchMessage(&msg);
-    }
-    
-    return (int)msg.wParam;
-}
+// KeyboardJockey.cpp - A keyboard-driven mouse navigation utility
+// Minimizes to tray, shows grid overlay on Ctrl+Alt+M, type letters to move mouse
+
+#define WIN32_LEAN_AND_MEAN
+#define OEMRESOURCE  // Required for OCR_* cursor constants
+
+#include <windows.h>
+#include <shellapi.h>
+#include <ShellScalingApi.h>
+#pragma comment(lib, "Shcore.lib")
+#include <commdlg.h>
+#pragma comment(lib, "Comdlg32.lib")
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include <climits>
+#include <algorithm>
+#include <thread>
+#include <intrin.h>
+#include <immintrin.h>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <cassert>
+
+#include "core/BufferPool.h"
+#include "core/CellAtlas.h"
+#include "core/CellDiff.h"
+#include "core/ClickHistory.h"
+#include "core/CursorAnimation.h"
+#include "core/FoldedSearch.h"
+#include "core/FuzzyMatch.h"
+#include "core/GridCells.h"
+#include "core/GridLayout.h"
+#include "core/GridRaster.h"
+#include "core/LabelCodes.h"
+#include "core/LatencyHistogram.h"
+#include "core/MonitorTopology.h"
+#include "core/Palette.h"
+#include "core/Simd.h"
+#include "core/SpscRing.h"
+#include "core/StartupStages.h"
+#include "core/TitleIndex.h"
+#include "core/VisibleArea.h"
+#include "core/WindowInventory.h"
+#include "core/ZoomMath.h"
+
+// Resource IDs
+#define IDI_KEYBOARDJOCKEY 101
+#define IDM_EXIT 1001
+#define IDM_SHOW 1002
+#define IDM_PALETTE 1003
+#define IDM_EXPORT_LATENCY 1004
+
+// Constants
+#define WM_TRAYICON (WM_USER + 1)
+#define WM_HOOKEVENT (WM_USER + 2)            // Main window: input hook events queued
+#define WM_GRIDREADY (WM_USER + 3)            // Main window: base grid bitmap rendered
+#define WM_FOREGROUNDAPP (WM_USER + 4)        // Main window: another app came to the foreground
+#define HOOK_MSG_CURSOR_MOUSE (WM_APP + 1)    // Hook thread: wParam = install/remove cursor-restore mouse hook
+#define HOOK_MSG_SCROLL_MOUSE (WM_APP + 2)    // Hook thread: wParam = install/remove scroll-mode mouse hook
+#define HOTKEY_ID_SHOW_GRID 1
+#define TIMER_ID_RESET 1
+#define TIMER_ID_TAB_TEXT 2
+#define TIMER_ID_BUILD_GRID 3
+#define TIMER_ID_RECOLOR 4
+#define TIMER_ID_SAVE_CLICKS 5
+#define RESET_TIMEOUT_MS 3000
+#define TAB_TEXT_TIMEOUT_MS 4000
+#define INVENTORY_DEBOUNCE_MS 100  // Quiet period after a window event before re-snapshotting
+#define GRID_BUILD_DELAY_MS 2000   // Build the grid this long after startup unless needed sooner
+#define HUE_RECOLOR_MS 16          // Hue drags recolor the grid at most once per frame
+#define CLICK_SAVE_DELAY_MS 5000   // Quiet period after a click before the history is written
+#define GRID_ALPHA 160           // Default grid overlay opacity (0-255)
+#define MOUSE_MOVE_ALPHA 0       // Overlay fully invisible during arrow-key mouse movement
+#define SHIFT_PEEK_ALPHA 51      // 80% transparent peek when Shift held in typing mode
+#define ACTIVATION_DELAY_MS 50   // Brief sleep before activating a window
+#define MAIN_FONT_HEIGHT_PCT 80  // Main label font height as % of sub-cell height
+#define MAIN_FONT_WIDTH_DIV 5    // Main label font width = cellW / this
+#define MIN_MAIN_FONT_SIZE (-8)  // Floor for main label font
+#define SUB_FONT_HEIGHT_PCT 60   // Sub-label font height as % of sub-cell height
+#define MIN_SUB_FONT_SIZE (-6)   // Floor for sub-label font
+#define DT_CENTERED (DT_CENTER | DT_VCENTER | DT_SINGLELINE)
+#define HUE_LUT_STEPS 3600       // Hue bar colors precomputed per 0.1 degree
+#define ZOOM_MIN_CELL_DIP 24     // Zoom grid parts smaller than this are drawn magnified
+
+static const wchar_t* GRID_FONT_NAME = L"Segoe UI Variable Display";
+static const wchar_t ZOOM_LABELS[] = L"abcdefghijklmnopqrstuvwxyz";  // Zoom grid parts, row-major
+static_assert(ZOOM_FANOUT * ZOOM_FANOUT <= 26, "every zoom part needs its own letter");
+static const DWORD CURSOR_IDS[] = { OCR_NORMAL, OCR_IBEAM, OCR_HAND, OCR_CROSS,
+                                    OCR_SIZEALL, OCR_SIZENWSE, OCR_SIZENESW, OCR_SIZEWE, OCR_SIZENS };
+
+static float g_baseHue = BASE_HUE_DEFAULT;  // Current hue – changed at runtime by palette picker
+
+// Grid data: the render worker reads it while the grid renders (see GridOwnedByCaller)
+static Palette g_palette = PALETTE_PRESETS[0].palette;
+
+// Global variables
+HINSTANCE g_hInstance;
+HWND g_hMainWnd = NULL;
+HWND g_hOverlayWnd = NULL;
+NOTIFYICONDATA g_nid = {};
+bool g_bGridVisible = false;
+bool g_bMouseMoveMode = false;  // True when using arrow keys
+bool g_bCursorHidden = false;   // True when cursor is hidden via Space
+HHOOK g_hMouseHook = NULL;      // Low-level mouse hook (hook thread only)
+HHOOK g_hKeyboardHook = NULL;   // Low-level keyboard hook for hiding cursor on typing (hook thread only)
+HCURSOR g_hSavedArrow = NULL;    // Saved copy of default arrow cursor for animation (cursor worker once started)
+bool g_bScrollMode = false;       // True when in PgUp/PgDn scroll-through mode
+HHOOK g_hScrollMouseHook = NULL;  // Mouse hook for detecting movement in scroll mode (hook thread only)
+bool g_bTabTextMode = false;      // True when in TAB "select by text" mode (all windows shown)
+std::wstring g_typedChars;
+
+// Cursor worker: the one thread that changes system cursors. The UI thread
+// (including the low-level hooks) only queues commands and never waits.
+enum CursorCommand { CURSOR_CMD_HIDE, CURSOR_CMD_RESTORE, CURSOR_CMD_RESTORE_NOW, CURSOR_CMD_QUIT };
+enum CursorState { CURSOR_STATE_SYSTEM, CURSOR_STATE_HIDDEN, CURSOR_STATE_ANIMATING };
+CoalescingSpscRing<CursorCommand, 16> g_cursorCommands;
+HANDLE g_hCursorWake = NULL;        // Auto-reset event: commands queued
+std::thread g_cursorThread;
+std::atomic<int> g_cursorState(CURSOR_STATE_SYSTEM);  // Published by the worker
+
+// Pre-rendered restore-animation frames; frame[i] is the cursor for step i.
+// Ease-out can make late steps repeat sizes, and those share one handle.
+struct CursorFrameCache {
+    UINT dpi;                                // System DPI when rendered; 0 = not built
+    int baseSize;                            // Cursor size setting when rendered
+    int size[CURSOR_ANIM_STEPS + 1];
+    HCURSOR frame[CURSOR_ANIM_STEPS + 1];
+};
+CursorFrameCache g_cursorFrames = {};
+std::atomic<bool> g_cursorSettingsChanged(false);  // WM_SETTINGCHANGE seen; the worker re-reads the arrow
+
+// Virtual screen bounds (all monitors combined)
+struct VirtualScreenBounds {
+    int left, top, width, height;
+};
+
+inline VirtualScreenBounds GetVirtualScreenBounds() {
+    return {
+        GetSystemMetrics(SM_XVIRTUALSCREEN),
+        GetSystemMetrics(SM_YVIRTUALSCREEN),
+        GetSystemMetrics(SM_CXVIRTUALSCREEN),
+        GetSystemMetrics(SM_CYVIRTUALSCREEN)
+    };
+}
+
+// Off-screen paint surfaces kept alive across WM_PAINTs (see PooledBuffer)
+struct GdiSurface {
+    HDC hdc;
+    HBITMAP hbm, hbmOld;
+};
+typedef PooledBuffer<GdiSurface> BackBuffer;
+
+BackBuffer g_overlayBackBuffer = {};
+BackBuffer g_paletteBackBuffer = {};
+BufferPoolStats g_backBufferStats = {};  // All back buffers together
+
+static void DestroyGdiSurface(GdiSurface& surface) {
+    SelectObject(surface.hdc, surface.hbmOld);
+    DeleteObject(surface.hbm);
+    DeleteDC(surface.hdc);
+}
+
+void ReleaseBackBuffer(BackBuffer& bb) {
+    ReleasePooledBuffer(bb, g_backBufferStats, DestroyGdiSurface);
+}
+
+// Memory DC of exactly w x h compatible with hdcRef, reusing the last one if it fits
+HDC AcquireBackBuffer(BackBuffer& bb, HDC hdcRef, int w, int h) {
+    auto create = [hdcRef](int width, int height) {
+        GdiSurface surface;
+        surface.hdc = CreateCompatibleDC(hdcRef);
+        surface.hbm = CreateCompatibleBitmap(hdcRef, width, height);
+        surface.hbmOld = (HBITMAP)SelectObject(surface.hdc, surface.hbm);
+        return surface;
+    };
+    return AcquirePooledBuffer(bb, g_backBufferStats, w, h, create, DestroyGdiSurface).hdc;
+}
+
+// Per-monitor info
+struct MonitorInfo {
+    HMONITOR hMonitor;
+    wchar_t device[CCHDEVICENAME];  // Display device name; identifies the monitor across topology changes
+    RECT rcMonitor;
+    UINT dpiX, dpiY;
+    wchar_t prefix;  // First letter of labels on this monitor ('a', 'b', ...); kept while it stays attached
+    int gridCols, gridRows;  // Cell layout on this monitor
+    int firstCell;   // Index of this monitor's first cell in g_cells
+    int cellCount;   // Number of cells on this monitor (at most MAX_CELLS_PER_MONITOR)
+    LabelPlan codes; // Cell code lengths for cellCount cells
+};
+std::vector<MonitorInfo> g_monitors;  // Grid data (see GridOwnedByCaller)
+
+typedef GridCellArrays<RECT, POINT> GridCells;
+GridCells g_cells = {};  // Grid data (see GridOwnedByCaller)
+
+// Window highlight (TAB cycling) state
+struct AppWindow {
+    HWND hwnd;
+    RECT rect;
+    std::wstring title;
+    int visibleArea;  // Pixels of visible (unoccluded) area
+    int zOrder;       // Position in the front-to-back enumeration (0 = most recently active)
+};
+// One enumeration of the top-level windows: visible ones sorted by visible
+// area (most visible first), minimized ones in Z-order
+struct WindowSnapshot {
+    std::vector<AppWindow> windows;
+    std::vector<AppWindow> minimized;
+    unsigned eventSeq;  // Window-event count when enumeration began
+};
+std::vector<AppWindow> g_allAppWindows;  // All enumerated windows (including 0 visible area)
+std::vector<AppWindow> g_allMinimizedWindows;  // All minimized (before search filter)
+std::vector<int> g_appWindows;  // Indices into g_allAppWindows being cycled/shown
+std::vector<int> g_minimizedWindows;  // Indices into g_allMinimizedWindows shown in the panel
+int g_highlightIndex = -1;  // -1 = no highlight active
+std::wstring g_tabSearchStr;  // Substring search in TAB mode
+
+// Case-folded titles of g_allAppWindows then g_allMinimizedWindows
+typedef FoldedTitleIndex<wchar_t> TitleIndex;
+TitleIndex g_titleIndex = {};
+// g_searchResults[n - 1] holds the index entries matching the first n
+// characters of g_searchQuery
+std::vector<SearchLevel> g_searchResults;
+std::wstring g_searchQuery;
+// Matched character positions of the shown results (the last level's
+// positions); g_titleMatchAt[entry] is where an entry's run starts, or -1
+std::vector<int> g_matchChars;
+std::vector<int> g_titleMatchAt;
+
+HWND g_hPaletteWnd = NULL;  // Palette picker window
+
+// Forward declarations
+LRESULT CALLBACK MainWndProc(HWND, UINT, WPARAM, LPARAM);
+LRESULT CALLBACK OverlayWndProc(HWND, UINT, WPARAM, LPARAM);
+LRESULT CALLBACK PaletteWndProc(HWND, UINT, WPARAM, LPARAM);
+void CreateTrayIcon(HWND hWnd);
+void RemoveTrayIcon();
+void ShowContextMenu(HWND hWnd);
+void ShowPaletteWindow();
+void ApplyHue(float hue);
+void FlushHueRecolor();
+void CreateOverlayWindow();
+void ShowGrid();
+void HideGrid();
+bool BuildGridCells(const wchar_t* app);
+void RenderBaseGridTiles();
+void RecolorBaseGridTiles();
+void RemapGridTiles(const std::vector<int>& kept);
+void ReleaseGridTiles();
+bool GridOwnedByCaller();
+void BeginGridBuild();
+void EnsureGridReady();
+GridMemoryUsage MeasureBaseGridMemory();
+void OnDisplayChange();
+void ReleaseCellAtlases();
+void ReleaseGridGlyphs();
+void PaintGrid(HDC hdc, const RECT& rcPaint);
+void UpdateCellStates();
+void ProcessTypedChar(wchar_t ch);
+void MoveMouse(POINT pt);
+void SendClick(bool rightClick);
+void RecordGridClick(POINT pt);
+int FindCellByLabel(const wchar_t* label, int n);
+void FilterAppWindowsBySearch();
+void ResetWindowLists(bool includeOccluded, bool includeMinimized);
+void BuildTitleIndex();
+void HideCursor();
+void RestoreCursor();
+void PostCursorCommand(CursorCommand cmd);
+void StartCursorWorker();
+void StopCursorWorker();
+void EnsureCursorFrames();
+void MoveMouseByArrowKey(int dx, int dy, int moveAmount);
+void CreateGridFonts(int sh, int cellW, HFONT* outMain, HFONT* outSub);
+LRESULT CALLBACK LowLevelMouseProc(int nCode, WPARAM wParam, LPARAM lParam);
+LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam);
+void StartInputHooks();
+void StopInputHooks();
+void RequestMouseHook(UINT which, bool install);
+void ProcessHookEvents();
+void EnumerateAppWindows();
+void StartWindowInventory();
+void StopWindowInventory();
+void CycleHighlight(bool forward);
+void ExitScrollMode();
+LRESULT CALLBACK ScrollMouseProc(int nCode, WPARAM wParam, LPARAM lParam);
+
+// ============================================================================
+// Latency telemetry
+// ============================================================================
+// Time spent in the input hooks and in the main UI paths, kept in
+// fixed-memory histograms so recording costs a few atomic adds and the
+// process never grows. Summaries go to the debugger on exit and can be
+// exported from the tray menu. Values are QPC ticks.
+
+LONGLONG g_qpcFrequency = 0;  // Set once in wWinMain
+
+LONGLONG QpcNow() {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+// Records the lifetime of the scope into a histogram
+struct LatencyScope {
+    LatencyHistogram& hist;
+    LONGLONG start;
+    explicit LatencyScope(LatencyHistogram& h) : hist(h), start(QpcNow()) {}
+    ~LatencyScope() { hist.Record(QpcNow() - start); }
+};
+
+// Input hook callbacks (time inside the callback) and the delay from hook
+// to UI-thread handling
+LatencyHistogram g_keyboardHookLatency;
+LatencyHistogram g_mouseHookLatency;
+LatencyHistogram g_scrollHookLatency;
+LatencyHistogram g_hookDispatchDelay;
+std::atomic<unsigned> g_hookEventsDropped(0);  // Hook events lost to a full queue
+// UI thread
+LatencyHistogram g_paintLatency;       // Overlay WM_PAINT
+LatencyHistogram g_enumerateLatency;   // EnumerateAppWindows
+LatencyHistogram g_filterLatency;      // FilterAppWindowsBySearch
+LatencyHistogram g_gridRenderLatency;  // RenderBaseGridTiles
+LatencyHistogram g_gridRecolorLatency; // RecolorBaseGridTiles
+
+// Startup trace, in QPC ticks after wWinMain started
+LONGLONG g_startupQpc = 0;
+StartupTrace g_startupTrace;
+
+// Record a milestone the first time it is reached; callable from any thread
+void MarkStartup(StartupMark mark) {
+    g_startupTrace.Mark(mark, QpcNow() - g_startupQpc);
+}
+
+struct TelemetryMetric {
+    const char* name;
+    const LatencyHistogram* hist;
+};
+static const TelemetryMetric TELEMETRY_METRICS[] = {
+    { "keyboard_hook", &g_keyboardHookLatency },
+    { "mouse_hook", &g_mouseHookLatency },
+    { "scroll_hook", &g_scrollHookLatency },
+    { "hook_dispatch", &g_hookDispatchDelay },
+    { "overlay_paint", &g_paintLatency },
+    { "enumerate_windows", &g_enumerateLatency },
+    { "filter_windows", &g_filterLatency },
+    { "render_grid", &g_gridRenderLatency },
+    { "recolor_grid", &g_gridRecolorLatency },
+};
+
+// Write p50/p99/max of each histogram to the debugger output
+void ReportLatency() {
+    if (!g_qpcFrequency) return;
+    double usPerTick = 1e6 / (double)g_qpcFrequency;
+    for (const TelemetryMetric& m : TELEMETRY_METRICS) {
+        if (m.hist->Count() == 0) continue;
+        char line[200];
+        sprintf_s(line, "KeyboardJockey: %s n=%llu p50=%.1fus p99=%.1fus max=%.1fus\n",
+            m.name, m.hist->Count(),
+            m.hist->Percentile(50.0) * usPerTick,
+            m.hist->Percentile(99.0) * usPerTick,
+            (double)m.hist->Max() * usPerTick);
+        OutputDebugStringA(line);
+    }
+    if (g_hookEventsDropped.load()) {
+        char line[100];
+        sprintf_s(line, "KeyboardJockey: %u hook events dropped\n", g_hookEventsDropped.load());
+        OutputDebugStringA(line);
+    }
+    for (int i = 0; i < STARTUP_MARK_COUNT; i++) {
+        long long ticks = g_startupTrace.At((StartupMark)i);
+        if (!ticks) continue;
+        char line[100];
+        sprintf_s(line, "KeyboardJockey: startup %s at %.1fms\n", STARTUP_MARK_NAMES[i], ticks * usPerTick / 1000.0);
+        OutputDebugStringA(line);
+    }
+    if (!g_monitors.empty()) {
+        GridMemoryUsage usage = MeasureBaseGridMemory();
+        char line[160];
+        sprintf_s(line, "KeyboardJockey: grid tiles %.1fMB + tone maps %.1fMB (bounding box %.1fMB)\n",
+            usage.tileBytes / 1048576.0, usage.toneMapBytes / 1048576.0, usage.boundingBoxBytes / 1048576.0);
+        OutputDebugStringA(line);
+    }
+    if (g_backBufferStats.allocations) {
+        char line[160];
+        sprintf_s(line, "KeyboardJockey: back buffers %.1fMB (peak %.1fMB), %u allocated, %u reused\n",
+            g_backBufferStats.bytes / 1048576.0, g_backBufferStats.peakBytes / 1048576.0,
+            g_backBufferStats.allocations, g_backBufferStats.reuses);
+        OutputDebugStringA(line);
+    }
+}
+
+// Write every histogram to a file: CSV with one summary row per metric, or
+// JSON with the summary plus each non-empty bucket. Times in microseconds.
+bool WriteTelemetryFile(const wchar_t* path, bool json) {
+    double usPerTick = 1e6 / (double)g_qpcFrequency;
+    std::string out;
+    char buf[256];
+    out += json ? "{\n  \"unit\": \"us\",\n  \"metrics\": [" : "metric,count,p50_us,p90_us,p99_us,p999_us,max_us\n";
+    bool firstMetric = true;
+    for (const TelemetryMetric& m : TELEMETRY_METRICS) {
+        const LatencyHistogram& h = *m.hist;
+        double p50 = h.Percentile(50.0) * usPerTick, p90 = h.Percentile(90.0) * usPerTick;
+        double p99 = h.Percentile(99.0) * usPerTick, p999 = h.Percentile(99.9) * usPerTick;
+        double maxUs = (double)h.Max() * usPerTick;
+        if (!json) {
+            sprintf_s(buf, "%s,%llu,%.3f,%.3f,%.3f,%.3f,%.3f\n", m.name, h.Count(), p50, p90, p99, p999, maxUs);
+            out += buf;
+            continue;
+        }
+        sprintf_s(buf, "%s\n    { \"name\": \"%s\", \"count\": %llu, \"p50\": %.3f, \"p90\": %.3f, "
+                       "\"p99\": %.3f, \"p999\": %.3f, \"max\": %.3f,\n      \"buckets\": [",
+                  firstMetric ? "" : ",", m.name, h.Count(), p50, p90, p99, p999, maxUs);
+        out += buf;
+        firstMetric = false;
+        // [low, high) bounds of each bucket with its count
+        bool firstBucket = true;
+        for (int b = 0; b < LatencyHistogram::BUCKET_COUNT; b++) {
+            unsigned count = h.counts[b].load(std::memory_order_relaxed);
+            if (!count) continue;
+            double low = (double)LatencyHistogram::BucketLow(b) * usPerTick;
+            double high = (b + 1 < LatencyHistogram::BUCKET_COUNT)
+                ? (double)LatencyHistogram::BucketLow(b + 1) * usPerTick : low;
+            sprintf_s(buf, "%s[%.3f, %.3f, %u]", firstBucket ? "" : ", ", low, high, count);
+            out += buf;
+            firstBucket = false;
+        }
+        out += "] }";
+    }
+    // Startup milestones: a JSON object in milliseconds (null if not
+    // reached), or single-sample CSV rows in microseconds
+    if (json) out += "\n  ],\n  \"startup_ms\": {";
+    for (int i = 0; i < STARTUP_MARK_COUNT; i++) {
+        long long ticks = g_startupTrace.At((StartupMark)i);
+        double us = ticks * usPerTick;
+        if (json) {
+            if (ticks) sprintf_s(buf, "%s \"%s\": %.3f", i ? "," : "", STARTUP_MARK_NAMES[i], us / 1000.0);
+            else sprintf_s(buf, "%s \"%s\": null", i ? "," : "", STARTUP_MARK_NAMES[i]);
+        } else {
+            if (!ticks) continue;
+            sprintf_s(buf, "startup_%s,1,%.3f,%.3f,%.3f,%.3f,%.3f\n", STARTUP_MARK_NAMES[i], us, us, us, us, us);
+        }
+        out += buf;
+    }
+    if (json) {
+        GridMemoryUsage usage = MeasureBaseGridMemory();
+        sprintf_s(buf, " },\n  \"grid_memory\": { \"tile_bytes\": %llu, \"tone_map_bytes\": %llu, "
+                       "\"bounding_box_bytes\": %llu },\n",
+                  usage.tileBytes, usage.toneMapBytes, usage.boundingBoxBytes);
+        out += buf;
+        sprintf_s(buf, "  \"back_buffers\": { \"bytes\": %llu, \"peak_bytes\": %llu, \"allocations\": %u, \"reuses\": %u }\n}\n",
+                  (unsigned long long)g_backBufferStats.bytes, (unsigned long long)g_backBufferStats.peakBytes,
+                  g_backBufferStats.allocations, g_backBufferStats.reuses);
+        out += buf;
+    }
+    
+    HANDLE hFile = CreateFile(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) return false;
+    DWORD written = 0;
+    BOOL ok = WriteFile(hFile, out.data(), (DWORD)out.size(), &written, NULL);
+    CloseHandle(hFile);
+    return ok && written == (DWORD)out.size();
+}
+
+// Tray menu: ask where to save, then export as JSON or CSV by extension
+void ExportTelemetry(HWND hWnd) {
+    wchar_t path[MAX_PATH] = L"KeyboardJockey-latency.json";
+    OPENFILENAME ofn = {};
+    ofn.lStructSize = sizeof(ofn);
+    ofn.hwndOwner = hWnd;
+    ofn.lpstrFilter = L"JSON (*.json)\0*.json\0CSV (*.csv)\0*.csv\0";
+    ofn.lpstrFile = path;
+    ofn.nMaxFile = MAX_PATH;
+    ofn.lpstrDefExt = L"json";
+    ofn.Flags = OFN_OVERWRITEPROMPT | OFN_PATHMUSTEXIST;
+    if (!GetSaveFileName(&ofn)) return;
+    
+    size_t len = wcslen(path);
+    bool csv = len >= 4 && _wcsicmp(path + len - 4, L".csv") == 0;
+    if (!WriteTelemetryFile(path, !csv)) {
+        MessageBox(hWnd, L"Failed to write the latency file", L"Error", MB_ICONERROR);
+    }
+}
+
+// Force restore cursors - called on exit/crash
+void ForceRestoreCursors() {
+    if (g_cursorState.load() == CURSOR_STATE_SYSTEM) return;  // Never changed, or already restored
+    SystemParametersInfo(SPI_SETCURSORS, 0, NULL, 0);
+}
+
+// Unhandled exception filter - restore cursor on crash
+LONG WINAPI CrashHandler(EXCEPTION_POINTERS* pExceptionInfo) {
+    ForceRestoreCursors();
+    return EXCEPTION_CONTINUE_SEARCH;
+}
+
+void ExitScrollMode() {
+    if (!g_bScrollMode) return;
+    g_bScrollMode = false;
+    // Remove input-transparent flag so overlay receives input again
+    LONG_PTR exStyle = GetWindowLongPtr(g_hOverlayWnd, GWL_EXSTYLE);
+    SetWindowLongPtr(g_hOverlayWnd, GWL_EXSTYLE, exStyle & ~WS_EX_TRANSPARENT);
+    RequestMouseHook(HOOK_MSG_SCROLL_MOUSE, false);
+    HideGrid();
+}
+
+// Queue a command for the cursor worker. Only the UI thread posts, which
+// keeps the ring single-producer.
+void PostCursorCommand(CursorCommand cmd) {
+    if (!g_hCursorWake) return;  // Worker not running
+    // Each command sets the whole cursor state, so if the worker is starved
+    // and the ring fills, the newest command replaces the unrun ones past
+    // it instead of the UI thread waiting
+    g_cursorCommands.Post(cmd);
+    SetEvent(g_hCursorWake);
+}
+
+// Hide the cursor system-wide
+void HideCursor() {
+    if (g_bCursorHidden) return;
+    
+    // Blank cursors are set on the worker; this also cancels any restore animation
+    PostCursorCommand(CURSOR_CMD_HIDE);
+    
+    // Have the hook thread watch for mouse movement
+    RequestMouseHook(HOOK_MSG_CURSOR_MOUSE, true);
+    
+    g_bCursorHidden = true;
+}
+
+// Set all system cursors to a blank cursor (cursor worker only)
+void SetBlankCursors() {
+    // Create a blank cursor
+    BYTE andMask[128];
+    BYTE xorMask[128];
+    memset(andMask, 0xFF, sizeof(andMask));  // AND mask all 1s = transparent
+    memset(xorMask, 0x00, sizeof(xorMask));  // XOR mask all 0s = no change
+    HCURSOR hBlankCursor = CreateCursor(g_hInstance, 0, 0, 32, 32, andMask, xorMask);
+    
+    // Copy and set for all standard cursor types
+    for (DWORD id : CURSOR_IDS) {
+        HCURSOR hCopy = CopyCursor(hBlankCursor);
+        SetSystemCursor(hCopy, id);
+    }
+    
+    DestroyCursor(hBlankCursor);
+}
+
+// Read a bitmap as top-down 32-bit pixels
+static bool ReadBitmapPixels(HDC hdc, HBITMAP hbm, int width, int height, std::vector<uint32_t>& pixels) {
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = width;
+    bmi.bmiHeader.biHeight = -height;  // Top-down
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    pixels.resize((size_t)width * height);
+    return GetDIBits(hdc, hbm, 0, height, pixels.data(), &bmi, DIB_RGB_COLORS) == height;
+}
+
+// Scale a color cursor to a new size (see ScaleCursorImage). Monochrome
+// cursors have no color bitmap to scale and are drawn by DrawIconEx instead.
+HCURSOR CreateScaledCursor(HCURSOR hOriginal, int targetSize) {
+    if (!hOriginal) return NULL;
+    
+    ICONINFO iiOrig;
+    if (!GetIconInfo(hOriginal, &iiOrig)) return NULL;
+    
+    BITMAP bm;
+    GetObject(iiOrig.hbmMask, sizeof(bm), &bm);
+    int origW = bm.bmWidth;
+    int origH = iiOrig.hbmColor ? bm.bmHeight : bm.bmHeight / 2;
+    
+    HDC hdcScreen = GetDC(NULL);
+    std::vector<uint32_t> scaled((size_t)targetSize * targetSize);
+    std::vector<uint32_t> color, mask;
+    bool read = iiOrig.hbmColor && ReadBitmapPixels(hdcScreen, iiOrig.hbmColor, origW, origH, color) &&
+                ReadBitmapPixels(hdcScreen, iiOrig.hbmMask, origW, origH, mask);
+    if (read) {
+        ApplyCursorMaskAlpha(color.data(), mask.data(), origW * origH);
+        ScaleCursorImage(color.data(), origW, origH, scaled.data(), targetSize, targetSize);
+    }
+    
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = targetSize;
+    bmi.bmiHeader.biHeight = -targetSize;  // Top-down
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    void* pBits = NULL;
+    HBITMAP hbmColor = CreateDIBSection(hdcScreen, &bmi, DIB_RGB_COLORS, &pBits, NULL, 0);
+    HBITMAP hbmMask;
+    if (read) {
+        memcpy(pBits, scaled.data(), scaled.size() * sizeof(uint32_t));
+        std::vector<uint8_t> maskBits = BuildCursorMask(scaled.data(), targetSize, targetSize);
+        hbmMask = CreateBitmap(targetSize, targetSize, 1, 1, maskBits.data());
+    } else {
+        // Draw color: clear to transparent black, then draw icon
+        hbmMask = CreateBitmap(targetSize, targetSize, 1, 1, NULL);
+        HDC hdcColor = CreateCompatibleDC(hdcScreen);
+        HDC hdcMask = CreateCompatibleDC(hdcScreen);
+        SelectObject(hdcColor, hbmColor);
+        memset(pBits, 0, (size_t)targetSize * targetSize * 4);
+        DrawIconEx(hdcColor, 0, 0, hOriginal, targetSize, targetSize, 0, NULL, DI_NORMAL);
+        // Draw mask: white = transparent, black = opaque
+        SelectObject(hdcMask, hbmMask);
+        RECT rcMask = { 0, 0, targetSize, targetSize };
+        FillRect(hdcMask, &rcMask, (HBRUSH)GetStockObject(WHITE_BRUSH));
+        DrawIconEx(hdcMask, 0, 0, hOriginal, targetSize, targetSize, 0, NULL, DI_MASK);
+        DeleteDC(hdcColor);
+        DeleteDC(hdcMask);
+    }
+    ReleaseDC(NULL, hdcScreen);
+    
+    ICONINFO iiNew;
+    iiNew.fIcon = FALSE;
+    iiNew.xHotspot = ScaleCursorHotspot(iiOrig.xHotspot, origW, targetSize);
+    iiNew.yHotspot = ScaleCursorHotspot(iiOrig.yHotspot, origH, targetSize);
+    iiNew.hbmMask = hbmMask;
+    iiNew.hbmColor = hbmColor;
+    
+    HCURSOR hResult = CreateIconIndirect(&iiNew);
+    DeleteObject(hbmColor);
+    DeleteObject(hbmMask);
+    if (iiOrig.hbmColor) DeleteObject(iiOrig.hbmColor);
+    DeleteObject(iiOrig.hbmMask);
+    
+    return hResult;
+}
+
+void ReleaseCursorFrames() {
+    CursorFrameCache& c = g_cursorFrames;
+    for (int i = 0; i <= CURSOR_ANIM_STEPS; i++) {
+        if (c.frame[i] && (i == 0 || c.frame[i] != c.frame[i - 1])) DestroyCursor(c.frame[i]);
+        c.frame[i] = NULL;
+    }
+    c.dpi = 0;
+}
+
+// The cursor size setting (px at 96 DPI), which Windows keeps as
+// CursorBaseSize; the default size if it was never changed
+int QueryCursorBaseSize() {
+    HKEY hKey;
+    if (RegOpenKeyEx(HKEY_CURRENT_USER, L"Control Panel\\Cursors", 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
+        return CURSOR_ANIM_END_SIZE;
+    }
+    DWORD val = 0, sz = sizeof(val), type = 0;
+    bool read = RegQueryValueEx(hKey, L"CursorBaseSize", NULL, &type, (BYTE*)&val, &sz) == ERROR_SUCCESS &&
+                type == REG_DWORD;
+    RegCloseKey(hKey);
+    return read && val >= CURSOR_ANIM_END_SIZE && val <= CURSOR_BASE_SIZE_MAX ? (int)val : CURSOR_ANIM_END_SIZE;
+}
+
+// Render every animation frame once so the animation only swaps handles.
+// Cursor worker only, which also makes it the frames' only user. The frames
+// are rebuilt when the system DPI or the cursor size setting changes.
+void EnsureCursorFrames() {
+    CursorFrameCache& c = g_cursorFrames;
+    UINT dpi = GetDpiForSystem();
+    int baseSize = QueryCursorBaseSize();
+    if ((c.dpi == dpi && c.baseSize == baseSize) || !g_hSavedArrow) return;
+    ReleaseCursorFrames();
+    for (int i = 0; i <= CURSOR_ANIM_STEPS; i++) {
+        c.size[i] = CursorAnimationSize(i, (int)dpi, baseSize);
+        c.frame[i] = (i > 0 && c.size[i] == c.size[i - 1])
+            ? c.frame[i - 1] : CreateScaledCursor(g_hSavedArrow, c.size[i]);
+    }
+    c.dpi = dpi;
+    c.baseSize = baseSize;
+}
+
+// After a settings change, copy the arrow again (the scheme may have
+// changed it) and drop the frames rendered from the old one. Only while
+// the system cursors are in place: hidden or animating, the arrow is ours.
+// Cursor worker only.
+void RefreshCursorSource() {
+    if (g_cursorState.load() != CURSOR_STATE_SYSTEM || !g_cursorSettingsChanged.exchange(false)) return;
+    HCURSOR hArrow = LoadCursor(NULL, IDC_ARROW);
+    if (hArrow) {
+        if (g_hSavedArrow) DestroyCursor(g_hSavedArrow);
+        g_hSavedArrow = CopyCursor(hArrow);
+    }
+    ReleaseCursorFrames();
+}
+
+// Set all system cursors to one animation frame (cursor worker only)
+void SetCursorFrame(int step) {
+    HCURSOR hFrame = g_cursorFrames.frame[step];
+    if (!hFrame) return;
+    
+    // SetSystemCursor takes ownership, so each slot gets its own copy
+    for (DWORD id : CURSOR_IDS) {
+        HCURSOR hCopy = CopyCursor(hFrame);
+        SetSystemCursor(hCopy, id);
+    }
+}
+
+// Cursor worker loop. Commands take effect as soon as they are queued:
+// a restore starts (or restarts) the large-to-normal animation, a hide
+// cancels it mid-frame, and the animation advances on its own deadlines
+// while the queue is quiet.
+void CursorWorkerThread() {
+    const ULONGLONG frameMs = CURSOR_ANIM_MS / CURSOR_ANIM_STEPS;  // ~33ms per step
+    bool animating = false;
+    int step = 0;
+    ULONGLONG nextFrame = 0;
+    
+    for (;;) {
+        DWORD wait = INFINITE;
+        if (animating) {
+            ULONGLONG now = GetTickCount64();
+            wait = nextFrame > now ? (DWORD)(nextFrame - now) : 0;
+        }
+        WaitForSingleObject(g_hCursorWake, wait);
+        
+        CursorCommand cmd;
+        while (g_cursorCommands.Take(cmd)) {
+            switch (cmd) {
+            case CURSOR_CMD_HIDE:
+                animating = false;
+                SetBlankCursors();
+                g_cursorState = CURSOR_STATE_HIDDEN;
+                // Have the restore animation ready before it can be needed
+                EnsureCursorFrames();
+                break;
+            case CURSOR_CMD_RESTORE:
+                // Set the first frame immediately (large cursor)
+                EnsureCursorFrames();
+                animating = true;
+                step = 0;
+                SetCursorFrame(0);
+                nextFrame = GetTickCount64() + frameMs;
+                g_cursorState = CURSOR_STATE_ANIMATING;
+                break;
+            case CURSOR_CMD_RESTORE_NOW:
+                animating = false;
+                if (g_cursorState.load() != CURSOR_STATE_SYSTEM) {
+                    SystemParametersInfo(SPI_SETCURSORS, 0, NULL, 0);
+                    g_cursorState = CURSOR_STATE_SYSTEM;
+                }
+                break;
+            case CURSOR_CMD_QUIT:
+                if (g_cursorState.load() != CURSOR_STATE_SYSTEM) {
+                    SystemParametersInfo(SPI_SETCURSORS, 0, NULL, 0);
+                    g_cursorState = CURSOR_STATE_SYSTEM;
+                }
+                ReleaseCursorFrames();
+                return;
+            }
+        }
+        
+        if (animating && GetTickCount64() >= nextFrame) {
+            step++;
+            if (step > CURSOR_ANIM_STEPS) {
+                // Final step: restore to true system defaults
+                animating = false;
+                SystemParametersInfo(SPI_SETCURSORS, 0, NULL, 0);
+                g_cursorState = CURSOR_STATE_SYSTEM;
+            } else {
+                // Repeated sizes need no swap
+                if (g_cursorFrames.frame[step] != g_cursorFrames.frame[step - 1]) SetCursorFrame(step);
+                nextFrame += frameMs;
+            }
+        }
+        RefreshCursorSource();
+    }
+}
+
+void StartCursorWorker() {
+    if (g_cursorThread.joinable()) return;
+    g_hCursorWake = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (!g_hCursorWake) return;
+    g_cursorThread = std::thread(CursorWorkerThread);
+}
+
+// Restores system cursors if needed and waits for the worker to exit
+void StopCursorWorker() {
+    if (!g_cursorThread.joinable()) return;
+    PostCursorCommand(CURSOR_CMD_QUIT);
+    g_cursorThread.join();
+    CloseHandle(g_hCursorWake);
+    g_hCursorWake = NULL;
+}
+
+// Restore the cursor to system defaults
+void RestoreCursor() {
+    if (!g_bCursorHidden) return;
+    
+    // Unhook mouse first
+    RequestMouseHook(HOOK_MSG_CURSOR_MOUSE, false);
+    
+    g_bCursorHidden = false;
+    
+    // Animate back to normal on the cursor worker
+    PostCursorCommand(CURSOR_CMD_RESTORE);
+}
+
+// Check if a key is a typing key (not a modifier, function key, etc.)
+bool IsTypingKey(DWORD vkCode) {
+    // Ignore modifiers
+    if (vkCode == VK_SHIFT || vkCode == VK_CONTROL || vkCode == VK_MENU ||
+        vkCode == VK_LSHIFT || vkCode == VK_RSHIFT ||
+        vkCode == VK_LCONTROL || vkCode == VK_RCONTROL ||
+        vkCode == VK_LMENU || vkCode == VK_RMENU ||
+        vkCode == VK_LWIN || vkCode == VK_RWIN) {
+        return false;
+    }
+    
+    // Ignore function keys
+    if (vkCode >= VK_F1 && vkCode <= VK_F24) {
+        return false;
+    }
+    
+    // Ignore navigation keys that typically involve mouse use
+    if (vkCode == VK_PRINT || vkCode == VK_SNAPSHOT ||
+        vkCode == VK_PAUSE || vkCode == VK_CAPITAL ||
+        vkCode == VK_NUMLOCK || vkCode == VK_SCROLL) {
+        return false;
+    }
+    
+    // Consider everything else as typing
+    return true;
+}
+
+// ============================================================================
+// Click history - shortest codes for the most clicked cells
+// ============================================================================
+// Each monitor layout keeps decayed click counts per cell and sub-cell, for
+// every click and per foreground app (see core/ClickHistory.h), and the
+// cell codes are handed out in order of them, so the cells clicked most in
+// the app in front take the shortest codes. Codes are reassigned when a
+// monitor is laid out again and when another app comes to the foreground
+// while the grid is hidden, so labels never move while they are in use.
+// A completed code lands on the sub-cell that cell's clicks mostly go to.
+
+static_assert(CCHDEVICENAME < CLICK_NAME_LEN, "Click history names hold device names");
+
+ClickModel g_clickModel;
+bool g_clickHistoryDirty = false;           // Changed since loaded or saved
+wchar_t g_foregroundApp[CLICK_NAME_LEN];    // App the codes are ranked for and clicks counted against
+
+// Image name of the foreground window's process, lowercase ("chrome.exe");
+// empty if it is ours or cannot be read
+static void GetForegroundAppName(wchar_t (&app)[CLICK_NAME_LEN]) {
+    app[0] = 0;
+    DWORD pid = 0;
+    HWND hwnd = GetForegroundWindow();
+    if (!hwnd || !GetWindowThreadProcessId(hwnd, &pid) || pid == GetCurrentProcessId()) return;
+    HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!hProcess) return;
+    wchar_t path[MAX_PATH];
+    DWORD len = MAX_PATH;
+    if (QueryFullProcessImageName(hProcess, 0, path, &len)) {
+        const wchar_t* name = wcsrchr(path, L'\\');
+        CopyClickName(app, name ? name + 1 : path);
+        for (wchar_t* c = app; *c; c++) *c = towlower(*c);
+    }
+    CloseHandle(hProcess);
+}
+
+// Monitor that cell index i (into g_cells) belongs to
+static const MonitorInfo* MonitorOfCell(int i) {
+    for (const MonitorInfo& mon : g_monitors) {
+        if (i >= mon.firstCell && i < mon.firstCell + mon.cellCount) return &mon;
+    }
+    return NULL;
+}
+
+// Where a completed code puts the mouse: the cell center, or the sub-point
+// of the sub-cell its clicks mostly land in (see PredictSubCell)
+static POINT CodeLandingPoint(int cellIdx) {
+    const MonitorInfo* mon = MonitorOfCell(cellIdx);
+    int sub = mon ? PredictSubCell(g_clickModel, *mon, g_foregroundApp, cellIdx - mon->firstCell) : CLICK_SUB_CENTER;
+    return sub == CLICK_SUB_CENTER ? g_cells.center[cellIdx] : g_cells.subPoints[cellIdx][sub];
+}
+
+// Count a click at pt on the grid cell and sub-cell under it, if any
+void RecordGridClick(POINT pt) {
+    assert(GridOwnedByCaller());
+    for (const MonitorInfo& mon : g_monitors) {
+        if (!PtInRect(&mon.rcMonitor, pt)) continue;
+        int cellWidth = (mon.rcMonitor.right - mon.rcMonitor.left) / mon.gridCols;
+        int cellHeight = (mon.rcMonitor.bottom - mon.rcMonitor.top) / mon.gridRows;
+        // The last column and row also cover the remainder of the division
+        int col = min((int)(pt.x - mon.rcMonitor.left) / cellWidth, mon.gridCols - 1);
+        int row = min((int)(pt.y - mon.rcMonitor.top) / cellHeight, mon.gridRows - 1);
+        int cell = row * mon.gridCols + col;
+        const RECT& rc = g_cells.rect[mon.firstCell + cell];
+        int sub = CLICK_SUB_CENTER;
+        for (int k = 0; k < 9; k++) {
+            RECT subRect = SubCellRect(rc, k);
+            if (PtInRect(&subRect, pt)) sub = k;
+        }
+        
+        RecordClick(g_clickModel, mon, g_foregroundApp, cell, sub);
+        g_clickHistoryDirty = true;
+        SetTimer(g_hMainWnd, TIMER_ID_SAVE_CLICKS, CLICK_SAVE_DELAY_MS, NULL);  // Restarts on every click
+        return;
+    }
+}
+
+// %LOCALAPPDATA%\KeyboardJockey\clicks.bin, creating the directory
+static bool GetClickHistoryPath(std::wstring& path) {
+    wchar_t base[MAX_PATH];
+    DWORD len = GetEnvironmentVariable(L"LOCALAPPDATA", base, MAX_PATH);
+    if (len == 0 || len >= MAX_PATH) return false;
+    path = base;
+    path += L"\\KeyboardJockey";
+    CreateDirectory(path.c_str(), NULL);  // Fails harmlessly if it exists
+    path += L"\\clicks.bin";
+    return true;
+}
+
+// Write the history if it changed. It goes to a temporary file that then
+// replaces the old one, so a crash or power loss mid-write leaves the
+// previous history intact. Called CLICK_SAVE_DELAY_MS after the last click,
+// at session end (a tray app never sees WM_DESTROY at logoff) and on exit.
+void SaveClickHistory() {
+    KillTimer(g_hMainWnd, TIMER_ID_SAVE_CLICKS);
+    if (!g_clickHistoryDirty) return;
+    std::wstring path;
+    if (!GetClickHistoryPath(path)) return;
+    
+    std::string out;
+    WriteClickModel(g_clickModel, out);
+    
+    std::wstring tmpPath = path + L".tmp";
+    HANDLE hFile = CreateFile(tmpPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) return;
+    DWORD written = 0;
+    bool ok = WriteFile(hFile, out.data(), (DWORD)out.size(), &written, NULL) &&
+              written == (DWORD)out.size() && FlushFileBuffers(hFile);
+    CloseHandle(hFile);
+    if (ok && MoveFileEx(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        g_clickHistoryDirty = false;
+    } else {
+        DeleteFile(tmpPath.c_str());
+    }
+}
+
+// Load the saved history (see ReadClickModel); a missing or malformed file
+// leaves it empty
+void LoadClickHistory() {
+    std::wstring path;
+    if (!GetClickHistoryPath(path)) return;
+    HANDLE hFile = CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) return;
+    std::string in;
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(hFile, &size) && size.QuadPart <= 16 * 1024 * 1024) {
+        in.resize((size_t)size.QuadPart);
+        DWORD read = 0;
+        if (!ReadFile(hFile, &in[0], (DWORD)in.size(), &read, NULL) || read != in.size()) in.clear();
+    }
+    CloseHandle(hFile);
+    
+    ReadClickModel(in, g_clickModel);
+}
+
+// ============================================================================
+// Input hooks - low-level hooks on their own thread
+// ============================================================================
+// Every keystroke and mouse move on the machine waits for our low-level hook
+// callbacks, and Windows drops hooks that are slow. So the hooks live on a
+// dedicated high-priority thread whose callbacks do nothing but filter, push
+// a timestamped event into a ring and post a wake-up to the main window;
+// the UI thread does the actual work (hiding the cursor, leaving scroll
+// mode). The mouse hooks are only installed while needed, on request from
+// the UI thread via thread messages.
+
+enum HookEventType : BYTE { HOOK_EVT_TYPING_KEY, HOOK_EVT_CURSOR_MOVE, HOOK_EVT_SCROLL_MOVE };
+struct HookEvent {
+    HookEventType type;
+    LONGLONG qpc;  // QueryPerformanceCounter when the hook saw it
+};
+SpscRing<HookEvent, 256> g_hookEvents;  // Hook thread -> UI thread
+std::thread g_hookThread;
+DWORD g_hookThreadId = 0;
+
+// Hook-thread only: one move event per install is enough to act on
+bool g_cursorMoveReported = false;
+bool g_scrollMoveReported = false;
+
+// Queue an event for the UI thread. Never blocks: if the UI thread is so
+// far behind that the ring is full, the event is counted and dropped.
+static void PushHookEvent(HookEventType type, LONGLONG qpc) {
+    HookEvent ev = { type, qpc };
+    if (g_hookEvents.Push(ev)) {
+        PostMessage(g_hMainWnd, WM_HOOKEVENT, 0, 0);
+    } else {
+        g_hookEventsDropped++;
+    }
+}
+
+// Low-level keyboard hook callback - report typing so the cursor can hide
+LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam) {
+    LONGLONG start = QpcNow();
+    if (nCode >= 0 && (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN)) {
+        KBDLLHOOKSTRUCT* pKb = (KBDLLHOOKSTRUCT*)lParam;
+        if (IsTypingKey(pKb->vkCode)) {
+            PushHookEvent(HOOK_EVT_TYPING_KEY, start);
+        }
+    }
+    LRESULT result = CallNextHookEx(g_hKeyboardHook, nCode, wParam, lParam);
+    g_keyboardHookLatency.Record(QpcNow() - start);
+    return result;
+}
+
+// Low-level mouse hook callback - installed while the cursor is hidden
+LRESULT CALLBACK LowLevelMouseProc(int nCode, WPARAM wParam, LPARAM lParam) {
+    LONGLONG start = QpcNow();
+    if (nCode >= 0 && wParam == WM_MOUSEMOVE && !g_cursorMoveReported) {
+        // Mouse moved - restore cursor
+        g_cursorMoveReported = true;
+        PushHookEvent(HOOK_EVT_CURSOR_MOVE, start);
+    }
+    LRESULT result = CallNextHookEx(g_hMouseHook, nCode, wParam, lParam);
+    g_mouseHookLatency.Record(QpcNow() - start);
+    return result;
+}
+
+// Low-level mouse hook for scroll mode - detect any mouse movement
+LRESULT CALLBACK ScrollMouseProc(int nCode, WPARAM wParam, LPARAM lParam) {
+    LONGLONG start = QpcNow();
+    if (nCode >= 0 && wParam == WM_MOUSEMOVE && !g_scrollMoveReported) {
+        g_scrollMoveReported = true;
+        PushHookEvent(HOOK_EVT_SCROLL_MOVE, start);
+    }
+    LRESULT result = CallNextHookEx(g_hScrollMouseHook, nCode, wParam, lParam);
+    g_scrollHookLatency.Record(QpcNow() - start);
+    return result;
+}
+
+// Install or remove a hook on the hook thread
+static void SetHookInstalled(HHOOK& hook, bool install, HOOKPROC proc, int type) {
+    if (install && !hook) {
+        hook = SetWindowsHookEx(type, proc, g_hInstance, 0);
+    } else if (!install && hook) {
+        UnhookWindowsHookEx(hook);
+        hook = NULL;
+    }
+}
+
+void InputHookThread() {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+    MSG msg;
+    PeekMessage(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);  // Create the message queue
+    
+    // Keyboard hook for cursor hiding while typing
+    g_hKeyboardHook = SetWindowsHookEx(WH_KEYBOARD_LL, LowLevelKeyboardProc, g_hInstance, 0);
+    
+    // Hook callbacks are delivered from inside GetMessage
+    while (GetMessage(&msg, NULL, 0, 0) > 0) {
+        switch (msg.message) {
+        case HOOK_MSG_CURSOR_MOUSE:
+            g_cursorMoveReported = false;
+            SetHookInstalled(g_hMouseHook, msg.wParam != 0, LowLevelMouseProc, WH_MOUSE_LL);
+            break;
+        case HOOK_MSG_SCROLL_MOUSE:
+            g_scrollMoveReported = false;
+            SetHookInstalled(g_hScrollMouseHook, msg.wParam != 0, ScrollMouseProc, WH_MOUSE_LL);
+            break;
+        }
+    }
+    
+    SetHookInstalled(g_hScrollMouseHook, false, NULL, 0);
+    SetHookInstalled(g_hMouseHook, false, NULL, 0);
+    SetHookInstalled(g_hKeyboardHook, false, NULL, 0);
+}
+
+// Ask the hook thread to install (true) or remove (false) a mouse hook:
+// HOOK_MSG_CURSOR_MOUSE or HOOK_MSG_SCROLL_MOUSE
+void RequestMouseHook(UINT which, bool install) {
+    if (g_hookThreadId) PostThreadMessage(g_hookThreadId, which, install ? 1 : 0, 0);
+}
+
+void StartInputHooks() {
+    if (g_hookThread.joinable()) return;
+    g_hookThread = std::thread(InputHookThread);
+    g_hookThreadId = GetThreadId(g_hookThread.native_handle());
+}
+
+void StopInputHooks() {
+    if (!g_hookThread.joinable()) return;
+    // The thread may not have created its queue yet; retry until it has
+    while (!PostThreadMessage(g_hookThreadId, WM_QUIT, 0, 0)) Sleep(1);
+    g_hookThread.join();
+    g_hookThreadId = 0;
+}
+
+// Handle queued hook events on the UI thread
+void ProcessHookEvents() {
+    HookEvent ev;
+    while (g_hookEvents.Pop(ev)) {
+        g_hookDispatchDelay.Record(QpcNow() - ev.qpc);
+        switch (ev.type) {
+        case HOOK_EVT_TYPING_KEY:
+            // Hide cursor when typing, but not when our grid is active
+            if (!g_bGridVisible && !g_bMouseMoveMode && !g_bCursorHidden) {
+                HideCursor();
+            }
+            break;
+        case HOOK_EVT_CURSOR_MOVE:
+            RestoreCursor();
+            break;
+        case HOOK_EVT_SCROLL_MOVE:
+            ExitScrollMode();
+            break;
+        }
+    }
+}
+
+// Monitor enumeration callback for DPI-aware per-monitor grids
+BOOL CALLBACK GridMonitorEnumProc(HMONITOR hMon, HDC hdcMon, LPRECT lprcMonitor, LPARAM lParam) {
+    MonitorInfo mi = {};
+    mi.hMonitor = hMon;
+    mi.rcMonitor = *lprcMonitor;
+    MONITORINFOEX mix = {};
+    mix.cbSize = sizeof(mix);
+    if (GetMonitorInfo(hMon, &mix)) wcscpy_s(mi.device, mix.szDevice);
+    HRESULT hr = GetDpiForMonitor(hMon, MDT_EFFECTIVE_DPI, &mi.dpiX, &mi.dpiY);
+    if (FAILED(hr)) { mi.dpiX = DEFAULT_DPI; mi.dpiY = DEFAULT_DPI; }
+    auto* vec = reinterpret_cast<std::vector<MonitorInfo>*>(lParam);
+    vec->push_back(mi);
+    return TRUE;
+}
+
+// Label mon's cells with the codes of their ranks in g_cells.byCode: the
+// most clicked cells take the shortest codes
+static void LabelCellsByRank(const MonitorInfo& mon) {
+    const int* byCode = g_cells.byCode + mon.firstCell;
+    for (int rank = 0; rank < mon.cellCount; rank++) {
+        g_cells.label[mon.firstCell + byCode[rank]] = MakeLabel(mon.prefix, mon.codes, rank);
+    }
+}
+
+// Build grid cells per monitor with DPI-aware sizing. After a display
+// change, monitors whose position, size and DPI are unchanged keep their
+// cells and tiles as they were (see DiffMonitorLayouts); only the others
+// are laid out again, their codes ranked for app. Returns false if no
+// monitor changed, leaving the grid as it was.
+bool BuildGridCells(const wchar_t* app) {
+    assert(GridOwnedByCaller());
+    // Enumerate all monitors with DPI info
+    std::vector<MonitorInfo> monitors;
+    EnumDisplayMonitors(NULL, NULL, GridMonitorEnumProc, reinterpret_cast<LPARAM>(&monitors));
+    std::vector<int> match = AssignMonitorPrefixes(monitors, g_monitors);
+    std::vector<int> kept;
+    bool anyChanged = DiffMonitorLayouts(monitors, g_monitors, match, kept) || g_cells.count == 0;
+    if (!anyChanged) return false;
+    
+    std::vector<MonitorInfo> oldMonitors;
+    oldMonitors.swap(g_monitors);
+    g_monitors.swap(monitors);
+    GridCells oldCells = std::move(g_cells);  // Arrays stay valid in the moved arena
+    ReleaseCellAtlases();
+    ReleaseGridGlyphs();
+    
+    // First pass: lay out each monitor's grid so the arena can be sized once
+    int totalCells = 0;
+    for (auto& mon : g_monitors) {
+        int monWidth = mon.rcMonitor.right - mon.rcMonitor.left;
+        int monHeight = mon.rcMonitor.bottom - mon.rcMonitor.top;
+        
+        // Cells scale with this monitor's DPI
+        GridSize size = PlanGridSize(monWidth, monHeight, (int)mon.dpiX);
+        mon.gridCols = size.cols;
+        mon.gridRows = size.rows;
+        mon.firstCell = totalCells;
+        mon.cellCount = size.cols * size.rows;
+        mon.codes = PlanLabelCodes(mon.cellCount);
+        totalCells += mon.cellCount;
+    }
+    
+    AllocateGridCells(g_cells, totalCells);
+    
+    // Tiles of unchanged monitors are still valid; the rest are redrawn
+    RemapGridTiles(kept);
+    
+    // Second pass: fill in geometry and labels
+    for (size_t m = 0; m < g_monitors.size(); m++) {
+        const MonitorInfo& mon = g_monitors[m];
+        if (kept[m] >= 0) {
+            CopyGridCells(g_cells, oldCells, oldMonitors[kept[m]].firstCell, mon.firstCell, mon.cellCount);
+            continue;
+        }
+        GridSize size = { mon.gridCols, mon.gridRows };
+        int index = 0;
+        for (int row = 0; row < mon.gridRows; row++) {
+            for (int col = 0; col < mon.gridCols; col++) {
+                int i = mon.firstCell + index;
+                RECT& rc = g_cells.rect[i];
+                rc = GridCellRect(mon.rcMonitor, size, col, row);
+                g_cells.center[i].x = rc.left + (rc.right - rc.left) / 2;
+                g_cells.center[i].y = rc.top + (rc.bottom - rc.top) / 2;
+                g_cells.gridRow[i] = (short)row;
+                g_cells.gridCol[i] = (short)col;
+                
+                // 3x3 sub-grid points: the centre of each sub-cell, the
+                // same pixel zooming into it targets
+                for (int subIdx = 0; subIdx < 9; subIdx++) {
+                    g_cells.subPoints[i][subIdx] = ZoomTarget<POINT>(SubCellRect(rc, subIdx));
+                }
+                
+                index++;
+            }
+        }
+        
+        RankCellsByClicks(g_clickModel, mon, app, g_cells.byCode + mon.firstCell);
+        LabelCellsByRank(mon);
+    }
+    return true;
+}
+
+// Resolve the n-letter label to its index in g_cells, or -1 if it is not a
+// complete label (see FindCellByLabel in core/LabelCodes.h)
+int FindCellByLabel(const wchar_t* label, int n) {
+    return FindCellByLabel(g_monitors.data(), (int)g_monitors.size(), g_cells.byCode, label, n);
+}
+
+// Recompute every cell's CellState from g_typedChars and invalidate only the
+// cells whose state changed (see UpdateTypedCellStates)
+void UpdateCellStates() {
+    assert(GridOwnedByCaller());
+    auto vs = GetVirtualScreenBounds();
+    UpdateTypedCellStates(g_cells, g_typedChars, [&](RECT run) {
+        OffsetRect(&run, -vs.left, -vs.top);
+        InvalidateRect(g_hOverlayWnd, &run, FALSE);
+    });
+}
+
+// ========================================================================
+// Zoom sub-grid - recursive refinement below the 3x3 sub-cells
+// ========================================================================
+// Picking a sub-cell (a-h, or x for the centre one) makes it the zoom
+// region. Each further letter splits the region into up to ZOOM_FANOUT x
+// ZOOM_FANOUT parts and zooms into one of them, moving the mouse to its
+// centre; Backspace zooms back out. Cells tile their monitor, the nine
+// sub-cells are the 3x3 parts of their cell, and parts always tile their
+// region with at least one pixel each, so every pixel of every monitor is
+// reachable, in about log25(area) letters below the sub-cell.
+
+std::vector<RECT> g_zoomRegions;  // Screen rects, outermost first; empty = not zoomed
+
+// Where the zoom grid of region is drawn, in screen coordinates: over the
+// region itself when its parts are big enough to label, otherwise magnified
+// to ZOOM_MIN_CELL_DIP parts just below it (above, near the monitor bottom)
+static RECT ZoomPanelRect(const RECT& region) {
+    int cols, rows;
+    ZoomGridSize(region, &cols, &rows);
+    POINT mid = ZoomTarget<POINT>(region);
+    RECT bounds = region;
+    UINT dpi = DEFAULT_DPI;
+    for (const MonitorInfo& mon : g_monitors) {
+        if (PtInRect(&mon.rcMonitor, mid)) { bounds = mon.rcMonitor; dpi = mon.dpiX; break; }
+    }
+    int minPart = ZOOM_MIN_CELL_DIP * (int)dpi / DEFAULT_DPI;
+    if ((region.right - region.left) / cols >= minPart && (region.bottom - region.top) / rows >= minPart) {
+        return region;
+    }
+    int w = cols * minPart, h = rows * minPart, gap = minPart / 4;
+    RECT panel;
+    panel.left = max(bounds.left, min(mid.x - w / 2, bounds.right - w));
+    panel.top = region.bottom + gap;
+    if (panel.top + h > bounds.bottom) panel.top = max(bounds.top, region.top - gap - h);
+    panel.right = panel.left + w;
+    panel.bottom = panel.top + h;
+    return panel;
+}
+
+// Invalidate the current zoom region, its outline and its grid
+static void InvalidateZoom() {
+    if (g_zoomRegions.empty()) return;
+    const RECT& region = g_zoomRegions.back();
+    RECT panel = ZoomPanelRect(region);
+    RECT area;
+    UnionRect(&area, &region, &panel);
+    InflateRect(&area, 2, 2);
+    auto vs = GetVirtualScreenBounds();
+    OffsetRect(&area, -vs.left, -vs.top);
+    InvalidateRect(g_hOverlayWnd, &area, FALSE);
+}
+
+// Start zooming into region, the sub-cell just picked
+void BeginZoom(const RECT& region) {
+    InvalidateZoom();
+    g_zoomRegions.assign(1, region);
+    InvalidateZoom();
+}
+
+// Zoom into the part of the current region labelled ch; false if no part has it
+bool ZoomInto(wchar_t ch) {
+    RECT region = g_zoomRegions.back();
+    int cols, rows;
+    ZoomGridSize(region, &cols, &rows);
+    int k = ch - L'a';
+    if (cols * rows <= 1 || k < 0 || k >= cols * rows) return false;
+    assert(ZoomPartsTile(region, cols, rows));
+    InvalidateZoom();
+    RECT part = ZoomSubRegion(region, cols, rows, k);
+    g_zoomRegions.push_back(part);
+    MoveMouse(ZoomTarget<POINT>(part));
+    InvalidateZoom();
+    return true;
+}
+
+// Zoom back out one level. Leaving the sub-cell also drops its letter and
+// returns the mouse to the cell centre.
+void ZoomOut() {
+    InvalidateZoom();
+    g_zoomRegions.pop_back();
+    if (!g_zoomRegions.empty()) {
+        MoveMouse(ZoomTarget<POINT>(g_zoomRegions.back()));
+        InvalidateZoom();
+        return;
+    }
+    if (!g_typedChars.empty()) g_typedChars.pop_back();
+    int cellIdx = FindCellByLabel(g_typedChars.c_str(), (int)g_typedChars.length());
+    if (cellIdx >= 0) MoveMouse(g_cells.center[cellIdx]);
+    UpdateCellStates();
+}
+
+void EndZoom() {
+    InvalidateZoom();
+    g_zoomRegions.clear();
+}
+
+// ========================================================================
+// Grid rasterizer - GDI backend
+// ========================================================================
+// The rasterizer itself is in core/GridRaster.h; this is its GDI backend.
+// GDI rasterizes the letters a-z once per font size, and tiles are DIB
+// sections that PaintGrid blits like any other bitmap.
+
+std::vector<GridGlyphs> g_gridGlyphs;  // Grid data (see GridOwnedByCaller)
+
+// Layout changed: fonts for the old cell sizes are no longer needed
+void ReleaseGridGlyphs() {
+    assert(GridOwnedByCaller());
+    g_gridGlyphs.clear();
+}
+
+static void RasterizeGlyphFace(HDC hdc, HFONT hFont, GlyphFace& face) {
+    HFONT hOldFont = (HFONT)SelectObject(hdc, hFont);
+    TEXTMETRIC tm;
+    GetTextMetrics(hdc, &tm);
+    face.height = tm.tmHeight;
+    face.margin = tm.tmHeight / 4 + 1;
+    face.maskW = 0;
+    for (int c = 0; c < 26; c++) {
+        wchar_t ch = (wchar_t)(L'a' + c);
+        SIZE sz;
+        GetTextExtentPoint32(hdc, &ch, 1, &sz);
+        face.advance[c] = sz.cx;
+        face.x[c] = face.maskW;
+        face.maskW += sz.cx + 2 * face.margin;
+    }
+    
+    size_t pixelCount = (size_t)face.maskW * face.height;
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = face.maskW;
+    bmi.bmiHeader.biHeight = -face.height;  // Top-down
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    void* bits = NULL;
+    HBITMAP hbm = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+    if (hbm) {
+        HBITMAP hbmOld = (HBITMAP)SelectObject(hdc, hbm);  // Starts out zeroed
+        SetBkMode(hdc, TRANSPARENT);
+        SetTextColor(hdc, RGB(255, 255, 255));
+        for (int c = 0; c < 26; c++) {
+            wchar_t ch = (wchar_t)(L'a' + c);
+            TextOut(hdc, face.x[c] + face.margin, 0, &ch, 1);
+        }
+        GdiFlush();
+        face.coverage.assign((UINT32*)bits, (UINT32*)bits + pixelCount);
+        SelectObject(hdc, hbmOld);
+        DeleteObject(hbm);
+    } else {
+        face.coverage.assign(pixelCount, 0);
+    }
+    SelectObject(hdc, hOldFont);
+}
+
+// Glyphs for a cell size, rasterized on first use after a layout change.
+// The reference is only good until the next call.
+static const GridGlyphs& GetGridGlyphs(int sh, int cellW) {
+    assert(GridOwnedByCaller());
+    for (const auto& g : g_gridGlyphs) {
+        if (g.sh == sh && g.cellW == cellW) return g;
+    }
+    GridGlyphs g;
+    g.sh = sh;
+    g.cellW = cellW;
+    HFONT hFont, hSubFont;
+    CreateGridFonts(sh, cellW, &hFont, &hSubFont);
+    HDC hdcScreen = GetDC(NULL);
+    HDC hdc = CreateCompatibleDC(hdcScreen);
+    ReleaseDC(NULL, hdcScreen);
+    RasterizeGlyphFace(hdc, hFont, g.main);
+    RasterizeGlyphFace(hdc, hSubFont, g.sub);
+    DeleteDC(hdc);
+    DeleteObject(hFont);
+    DeleteObject(hSubFont);
+    g_gridGlyphs.push_back(std::move(g));
+    return g_gridGlyphs.back();
+}
+
+// Glyphs from GetGridGlyphs; tiles are DIB sections
+struct GdiGridBackend : GridRasterBackend {
+    const GridGlyphs& Glyphs(int sh, int cellW) override { return GetGridGlyphs(sh, cellW); }
+    uint32_t* CreateTile(int width, int height, void** handle) override {
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmi.bmiHeader.biWidth = width;
+        bmi.bmiHeader.biHeight = -height;  // Top-down
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+        void* bits = NULL;
+        HBITMAP hbm = CreateDIBSection(NULL, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+        *handle = hbm;
+        return hbm ? (uint32_t*)bits : NULL;
+    }
+    void ReleaseTile(void* handle) override { DeleteObject((HBITMAP)handle); }
+};
+static GdiGridBackend g_gdiGridBackend;
+
+// The cached base grid: one tile per monitor, parallel to g_monitors.
+// PaintGrid composites the tiles; a hue change recolors them in place.
+typedef BaseGridTile<RECT> GridTile;
+std::vector<GridTile> g_gridTiles;  // Grid data (see GridOwnedByCaller)
+
+// Drop every tile bitmap (display change, exit)
+void ReleaseGridTiles() {
+    assert(GridOwnedByCaller());
+    ReleaseGridTiles(g_gdiGridBackend, g_gridTiles);
+}
+
+// Line the tiles up with a new g_monitors (see RemapGridTiles in core/GridRaster.h)
+void RemapGridTiles(const std::vector<int>& kept) {
+    assert(GridOwnedByCaller());
+    RemapGridTiles(g_gdiGridBackend, g_gridTiles, kept);
+}
+
+// Render the static base grid of every monitor whose tile is missing
+void RenderBaseGridTiles() {
+    assert(GridOwnedByCaller());
+    LatencyScope timing(g_gridRenderLatency);
+    g_gridTiles.resize(g_monitors.size());
+    for (size_t m = 0; m < g_monitors.size(); m++) {
+        const MonitorInfo& mon = g_monitors[m];
+        RenderGridTile(g_gdiGridBackend, g_gridTiles[m], mon.rcMonitor, g_cells,
+                       mon.firstCell, mon.cellCount, g_palette);
+    }
+}
+
+// Repaint the cached base grid in the current palette from the tiles' tone
+// maps. Every pixel is rewritten, so hue drags call this at most once per
+// HUE_RECOLOR_MS through FlushHueRecolor.
+void RecolorBaseGridTiles() {
+    assert(GridOwnedByCaller());
+    if (g_gridTiles.empty()) return;
+    LatencyScope timing(g_gridRecolorLatency);
+    GdiFlush();  // Finish any pending blit from the tiles before rewriting them
+    bool redraw = false;
+    for (GridTile& tile : g_gridTiles) {
+        if (!RecolorGridTile(g_gdiGridBackend, tile, g_palette)) redraw = true;
+    }
+    if (redraw) RenderBaseGridTiles();  // Tiles released as too detailed to index
+}
+
+// ========================================================================
+// Cell sprite atlas - pre-rendered highlight appearances
+// ========================================================================
+
+// The atlas of a cell size (see core/CellAtlas.h), painted by the grid
+// rasterizer with the base grid's glyphs into a DIB section that stays
+// selected into a memory DC for PaintGrid to blit from
+struct CellSpriteAtlas {
+    CellAtlasLayout layout;
+    HDC hdc;                 // Memory DC with the atlas bitmap selected
+    HBITMAP hbm, hbmOld;
+};
+
+std::vector<CellSpriteAtlas> g_cellAtlases;
+
+void ReleaseCellAtlases() {
+    for (auto& a : g_cellAtlases) {
+        if (a.hbmOld) SelectObject(a.hdc, a.hbmOld);
+        if (a.hbm) DeleteObject(a.hbm);
+        DeleteDC(a.hdc);
+    }
+    g_cellAtlases.clear();
+}
+
+static const CellSpriteAtlas& BuildCellAtlas(int cellW, int cellH) {
+    const GridGlyphs& glyphs = GetGridGlyphs(cellH / 3, cellW / 3 * 3);
+    CellSpriteAtlas a = {};
+    a.layout = PlanCellAtlas(cellW, cellH, glyphs.main);
+    
+    void* handle = NULL;
+    uint32_t* bits = g_gdiGridBackend.CreateTile(a.layout.width, a.layout.height, &handle);
+    a.hbm = (HBITMAP)handle;
+    HDC hdcScreen = GetDC(NULL);
+    a.hdc = CreateCompatibleDC(hdcScreen);
+    ReleaseDC(NULL, hdcScreen);
+    if (bits) {
+        PixelSurface s = { bits, a.layout.width, a.layout.height, a.layout.width };
+        PaintCellAtlas(s, a.layout, glyphs, g_palette);
+        a.hbmOld = (HBITMAP)SelectObject(a.hdc, a.hbm);
+    }
+    
+    g_cellAtlases.push_back(a);
+    return g_cellAtlases.back();
+}
+
+// Atlas for a cell size, built on first use after a palette or layout change
+static const CellSpriteAtlas& GetCellAtlas(int cellW, int cellH) {
+    for (const auto& a : g_cellAtlases) {
+        if (a.layout.cellW == cellW && a.layout.cellH == cellH) return a;
+    }
+    return BuildCellAtlas(cellW, cellH);
+}
+
+// Blit an n-letter label centred in cell (like DT_CENTERED), clipped to clip
+static void BlitLabel(HDC hdc, const CellSpriteAtlas& a, int style,
+                      const wchar_t* label, int n, const RECT& cell, const RECT& clip) {
+    ForEachLabelBlit(a.layout, style, label, n, cell, clip,
+                     [&](int x, int y, int w, int h, int srcX, int srcY) {
+        BitBlt(hdc, x, y, w, h, a.hdc, srcX, srcY, SRCCOPY);
+    });
+}
+
+// Draw the zoom grid of the current region: its parts with their letters,
+// inside an outline of the region
+static void PaintZoomGrid(HDC hdc, int originX, int originY) {
+    const RECT& region = g_zoomRegions.back();
+    int cols, rows;
+    ZoomGridSize(region, &cols, &rows);
+    
+    RECT outline = region;
+    OffsetRect(&outline, -originX, -originY);
+    InflateRect(&outline, 1, 1);
+    HBRUSH hOutline = CreateSolidBrush(g_palette.matchSubHighlightBg);
+    FrameRect(hdc, &outline, hOutline);
+    DeleteObject(hOutline);
+    if (cols * rows <= 1) return;  // Down to one pixel: nothing left to pick
+    
+    RECT panel = ZoomPanelRect(region);
+    OffsetRect(&panel, -originX, -originY);
+    HBRUSH hBg = CreateSolidBrush(g_palette.matchCellBg);
+    FillRect(hdc, &panel, hBg);
+    DeleteObject(hBg);
+    
+    int partH = (panel.bottom - panel.top) / rows;
+    HFONT hFont = CreateFont(-max(6, partH * SUB_FONT_HEIGHT_PCT / 100), 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
+        DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
+        CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
+    HFONT hOldFont = (HFONT)SelectObject(hdc, hFont);
+    HPEN hPen = CreatePen(PS_SOLID, 1, g_palette.matchGridLine);
+    HPEN hOldPen = (HPEN)SelectObject(hdc, hPen);
+    SetBkMode(hdc, TRANSPARENT);
+    SetTextColor(hdc, g_palette.matchSubLabelText);
+    for (int k = 0; k < cols * rows; k++) {
+        RECT part = ZoomSubRegion(panel, cols, rows, k);
+        // Lines between parts: each part draws its right and bottom edges
+        if (part.right < panel.right) {
+            MoveToEx(hdc, part.right, part.top, NULL);
+            LineTo(hdc, part.right, part.bottom);
+        }
+        if (part.bottom < panel.bottom) {
+            MoveToEx(hdc, part.left, part.bottom, NULL);
+            LineTo(hdc, part.right, part.bottom);
+        }
+        DrawText(hdc, &ZOOM_LABELS[k], 1, &part, DT_CENTERED);
+    }
+    SelectObject(hdc, hOldPen);
+    DeleteObject(hPen);
+    SelectObject(hdc, hOldFont);
+    DeleteObject(hFont);
+}
+
+// Underline text[start, start + len) of a single line drawn top-left aligned
+// in rc with the font currently selected; clipped to rc (e.g. past an ellipsis)
+static void UnderlineSpan(HDC hdc, const wchar_t* text, int start, int len, const RECT& rc, COLORREF color) {
+    int textLen = (int)wcslen(text);
+    if (start >= textLen) return;
+    len = min(len, textLen - start);
+    SIZE before, through;
+    GetTextExtentPoint32(hdc, text, start, &before);
+    GetTextExtentPoint32(hdc, text, start + len, &through);
+    TEXTMETRIC tm;
+    GetTextMetrics(hdc, &tm);
+    int thickness = max(1, tm.tmHeight / 14);
+    RECT line = { rc.left + before.cx, rc.top + tm.tmAscent + 1,
+                  rc.left + through.cx, rc.top + tm.tmAscent + 1 + thickness };
+    if (!IntersectRect(&line, &line, &rc)) return;
+    HBRUSH hBrush = CreateSolidBrush(color);
+    FillRect(hdc, &line, hBrush);
+    DeleteObject(hBrush);
+}
+
+// Underline the characters of title index entry `entry` that the current
+// search matched; the title starts at text[titleStart]
+static void UnderlineMatches(HDC hdc, const wchar_t* text, int titleStart, int entry,
+                             const RECT& rc, COLORREF color) {
+    int at = g_titleMatchAt[entry];
+    if (at < 0) return;
+    const int* pos = &g_matchChars[at];
+    int n = (int)g_tabSearchStr.size();
+    for (int k = 0; k < n; ) {
+        int run = 1;
+        while (k + run < n && pos[k + run] == pos[k] + run) run++;
+        UnderlineSpan(hdc, text, titleStart + pos[k], run, rc, color);
+        k += run;
+    }
+}
+
+// Paint the grid overlay
+// rcPaint is the invalidated area in overlay coordinates; only it is refreshed
+void PaintGrid(HDC hdc, const RECT& rcPaint) {
+    assert(GridOwnedByCaller());
+    // Get virtual screen bounds
+    auto vs = GetVirtualScreenBounds();
+    int virtualLeft = vs.left;
+    int virtualTop = vs.top;
+    int virtualWidth = vs.width;
+    int virtualHeight = vs.height;
+    
+    // Semi-transparent background
+    HBRUSH hBrushBg = CreateSolidBrush(g_palette.background);
+    FillRect(hdc, &rcPaint, hBrushBg);
+    DeleteObject(hBrushBg);
+    
+    // In scroll mode, paint only black (LWA_COLORKEY makes it fully transparent)
+    if (g_bScrollMode) return;
+    
+    // If in window highlight or text select mode, skip drawing the grid entirely
+    bool highlightMode = (g_highlightIndex >= 0 || g_bTabTextMode || !g_tabSearchStr.empty());
+    
+    if (!highlightMode) {
+        // Blit the cached base grid tiles that overlap the invalidated area
+        if (!g_gridTiles.empty()) {
+            HDC hdcGrid = CreateCompatibleDC(hdc);
+            HGDIOBJ hOldBitmap = NULL;
+            for (const GridTile& tile : g_gridTiles) {
+                if (!tile.handle) continue;
+                RECT dest = tile.rc;
+                OffsetRect(&dest, -virtualLeft, -virtualTop);
+                RECT clip;
+                if (!IntersectRect(&clip, &dest, &rcPaint)) continue;
+                HGDIOBJ hPrev = SelectObject(hdcGrid, (HBITMAP)tile.handle);
+                if (!hOldBitmap) hOldBitmap = hPrev;
+                BitBlt(hdc, clip.left, clip.top, clip.right - clip.left, clip.bottom - clip.top,
+                       hdcGrid, clip.left - dest.left, clip.top - dest.top, SRCCOPY);
+            }
+            if (hOldBitmap) SelectObject(hdcGrid, hOldBitmap);
+            DeleteDC(hdcGrid);
+        }
+        
+        // Overlay dynamic highlights for typed chars (states kept by UpdateCellStates).
+        // Every highlighted appearance is pre-rendered, so this is blits only.
+        if (!g_typedChars.empty()) {
+            const CellSpriteAtlas* atlas = NULL;
+            
+            for (int i = 0; i < g_cells.count; i++) {
+                BYTE state = g_cells.state[i];
+                if (state == CELL_BASE) continue;
+                
+                const RECT& rc = g_cells.rect[i];
+                RECT adjusted;
+                adjusted.left = rc.left - virtualLeft;
+                adjusted.top = rc.top - virtualTop;
+                adjusted.right = rc.right - virtualLeft;
+                adjusted.bottom = rc.bottom - virtualTop;
+                
+                // Only cells inside the invalidated area need redrawing
+                RECT clip;
+                if (!IntersectRect(&clip, &adjusted, &rcPaint)) continue;
+                
+                int cellW = rc.right - rc.left;
+                int cellH = rc.bottom - rc.top;
+                if (!atlas || atlas->layout.cellW != cellW || atlas->layout.cellH != cellH) {
+                    atlas = &GetCellAtlas(cellW, cellH);
+                }
+                
+                BitBlt(hdc, adjusted.left, adjusted.top, cellW, cellH,
+                       atlas->hdc, (state - CELL_DIM) * cellW, 0, SRCCOPY);
+                
+                // Full matches keep the label inside the centre sub-cell (see LabelClip)
+                wchar_t label[MAX_LABEL_LETTERS + 1];
+                int labelLen = FormatLabel(g_cells.label[i], label);
+                BlitLabel(hdc, *atlas, LabelStyleOf(state), label, labelLen, adjusted, LabelClip(adjusted, state));
+            }
+        }
+        
+        if (!g_zoomRegions.empty()) PaintZoomGrid(hdc, virtualLeft, virtualTop);
+    } // end if (!highlightMode)
+    if (g_highlightIndex >= 0 && !g_appWindows.empty()) {
+        // When search is active or in text mode, highlight ALL matching windows
+        // When just cycling (no search), highlight only the current one
+        bool showAll = !g_tabSearchStr.empty() || g_bTabTextMode;
+        int startIdx = showAll ? 0 : g_highlightIndex;
+        int endIdx = showAll ? (int)g_appWindows.size() : g_highlightIndex + 1;
+        
+        HFONT hLabelFont = CreateFont(-(max(12, virtualHeight / 80)), 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE,
+            DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
+            CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
+        
+        for (int idx = startIdx; idx < endIdx && idx < (int)g_appWindows.size(); idx++) {
+            const AppWindow& aw = g_allAppWindows[g_appWindows[idx]];
+            
+            // Convert screen coords to overlay window coords
+            RECT hr;
+            hr.left = aw.rect.left - virtualLeft;
+            hr.top = aw.rect.top - virtualTop;
+            hr.right = aw.rect.right - virtualLeft;
+            hr.bottom = aw.rect.bottom - virtualTop;
+            
+            // Draw thick red border (scaled to screen)
+            int thickness = max(2, virtualHeight / 400);
+            bool isCurrent = (idx == g_highlightIndex);
+            HBRUSH hBorderBrush = CreateSolidBrush(isCurrent ? g_palette.mainLabelText : g_palette.gridLine);
+            
+            // Top edge
+            RECT edge = { hr.left, hr.top, hr.right, hr.top + thickness };
+            FillRect(hdc, &edge, hBorderBrush);
+            // Bottom edge
+            edge = { hr.left, hr.bottom - thickness, hr.right, hr.bottom };
+            FillRect(hdc, &edge, hBorderBrush);
+            // Left edge
+            edge = { hr.left, hr.top, hr.left + thickness, hr.bottom };
+            FillRect(hdc, &edge, hBorderBrush);
+            // Right edge
+            edge = { hr.right - thickness, hr.top, hr.right, hr.bottom };
+            FillRect(hdc, &edge, hBorderBrush);
+            
+            DeleteObject(hBorderBrush);
+            
+            // Draw window title + index label
+            HFONT hPrevFont = (HFONT)SelectObject(hdc, hLabelFont);
+            
+            wchar_t countBuf[32];
+            swprintf_s(countBuf, L" [%d/%d] ", idx + 1, (int)g_appWindows.size());
+            wchar_t labelBuf[300];
+            swprintf_s(labelBuf, L"%s%s ", countBuf, aw.title.c_str());
+            
+            SIZE textSize;
+            GetTextExtentPoint32(hdc, labelBuf, (int)wcslen(labelBuf), &textSize);
+            
+            int labelX = hr.left;
+            int labelY = hr.top - textSize.cy - 6;
+            if (labelY < 0) labelY = hr.top + thickness;
+            
+            RECT labelBg = { labelX, labelY, labelX + textSize.cx + 8, labelY + textSize.cy + 8 };
+            HBRUSH hLabelBg = CreateSolidBrush(isCurrent ? g_palette.matchCellBg : g_palette.cellBgEven);
+            FillRect(hdc, &labelBg, hLabelBg);
+            DeleteObject(hLabelBg);
+            
+            SetTextColor(hdc, g_palette.matchLabelText);
+            SetBkMode(hdc, TRANSPARENT);
+            RECT labelRect = { labelX + 4, labelY + 2, labelBg.right, labelBg.bottom };
+            DrawText(hdc, labelBuf, -1, &labelRect, DT_LEFT | DT_SINGLELINE | DT_NOPREFIX);
+            if (!g_tabSearchStr.empty()) {
+                UnderlineMatches(hdc, labelBuf, (int)wcslen(countBuf), g_appWindows[idx],
+                                 labelRect, g_palette.matchLabelText);
+            }
+            
+            SelectObject(hdc, hPrevFont);
+        }
+        
+        DeleteObject(hLabelFont);
+    }
+    
+    // Draw minimized windows panel (bottom-right of primary monitor) - only in text search mode
+    if ((g_bTabTextMode || !g_tabSearchStr.empty()) && !g_minimizedWindows.empty()) {
+        // Get primary monitor work area
+        MONITORINFO mi = { sizeof(mi) };
+        GetMonitorInfo(MonitorFromPoint({ 0, 0 }, MONITOR_DEFAULTTOPRIMARY), &mi);
+        RECT workArea = mi.rcWork;
+        
+        int panelPad = max(8, virtualHeight / 200);
+        int lineH = max(18, virtualHeight / 60);
+        int titleH = lineH + panelPad;
+        int maxItems = min((int)g_minimizedWindows.size(), 20);  // cap to 20 rows
+        int panelH = titleH + maxItems * lineH + panelPad * 2;
+        int panelW = max(250, virtualWidth / 5);
+        
+        // Position: bottom-right of primary monitor work area
+        int panelX = (workArea.right - virtualLeft) - panelW - panelPad;
+        int panelY = (workArea.bottom - virtualTop) - panelH - panelPad;
+        
+        RECT panelRect = { panelX, panelY, panelX + panelW, panelY + panelH };
+        
+        // Panel background
+        HBRUSH hPanelBg = CreateSolidBrush(g_palette.cellBgEven);
+        FillRect(hdc, &panelRect, hPanelBg);
+        DeleteObject(hPanelBg);
+        
+        // Panel border
+        int borderT = max(1, virtualHeight / 500);
+        HBRUSH hPanelBorder = CreateSolidBrush(g_palette.gridLine);
+        RECT be;
+        be = { panelRect.left, panelRect.top, panelRect.right, panelRect.top + borderT };
+        FillRect(hdc, &be, hPanelBorder);
+        be = { panelRect.left, panelRect.bottom - borderT, panelRect.right, panelRect.bottom };
+        FillRect(hdc, &be, hPanelBorder);
+        be = { panelRect.left, panelRect.top, panelRect.left + borderT, panelRect.bottom };
+        FillRect(hdc, &be, hPanelBorder);
+        be = { panelRect.right - borderT, panelRect.top, panelRect.right, panelRect.bottom };
+        FillRect(hdc, &be, hPanelBorder);
+        DeleteObject(hPanelBorder);
+        
+        // Title font (bold)
+        HFONT hTitleFont = CreateFont(-(lineH * 80 / 100), 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE,
+            DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
+            CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
+        // Item font (normal)
+        HFONT hItemFont = CreateFont(-(lineH * 70 / 100), 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
+            DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
+            CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
+        
+        SetBkMode(hdc, TRANSPARENT);
+        
+        // Draw title
+        HFONT hPrevFont = (HFONT)SelectObject(hdc, hTitleFont);
+        SetTextColor(hdc, g_palette.mainLabelText);
+        RECT titleRect = { panelX + panelPad, panelY + panelPad, panelX + panelW - panelPad, panelY + titleH };
+        DrawText(hdc, L"Minimized applications", -1, &titleRect, DT_LEFT | DT_SINGLELINE | DT_END_ELLIPSIS);
+        
+        // Draw items
+        SelectObject(hdc, hItemFont);
+        int totalNormal = (int)g_appWindows.size();
+        for (int i = 0; i < maxItems; i++) {
+            int itemY = panelY + titleH + i * lineH;
+            RECT itemRect = { panelX + panelPad, itemY, panelX + panelW - panelPad, itemY + lineH };
+            
+            // Check if this minimized item is the current highlight
+            bool isCurrent = (g_highlightIndex >= totalNormal && (g_highlightIndex - totalNormal) == i);
+            
+            if (isCurrent) {
+                RECT hlRect = { panelX + borderT, itemY, panelX + panelW - borderT, itemY + lineH };
+                HBRUSH hItemHl = CreateSolidBrush(g_palette.matchSubHighlightBg);
+                FillRect(hdc, &hlRect, hItemHl);
+                DeleteObject(hItemHl);
+                SetTextColor(hdc, g_palette.matchSubHighlightText);
+            } else {
+                SetTextColor(hdc, g_palette.subLabelText);
+            }
+            
+            wchar_t itemBuf[300];
+            swprintf_s(itemBuf, L" %s", g_allMinimizedWindows[g_minimizedWindows[i]].title.c_str());
+            DrawText(hdc, itemBuf, -1, &itemRect, DT_LEFT | DT_SINGLELINE | DT_END_ELLIPSIS | DT_NOPREFIX);
+            if (!g_tabSearchStr.empty()) {
+                UnderlineMatches(hdc, itemBuf, 1, g_titleIndex.normalCount + g_minimizedWindows[i],
+                                 itemRect, isCurrent ? g_palette.matchSubHighlightText : g_palette.subLabelText);
+            }
+        }
+        
+        SelectObject(hdc, hPrevFont);
+        DeleteObject(hTitleFont);
+        DeleteObject(hItemFont);
+    }
+}
+
+// Enumerate visible application windows in Z-order (front to back)
+BOOL CALLBACK EnumWindowsProc(HWND hwnd, LPARAM lParam) {
+    // Skip our own windows
+    if (hwnd == g_hOverlayWnd || hwnd == g_hMainWnd) return TRUE;
+    
+    // Must be visible
+    if (!IsWindowVisible(hwnd)) return TRUE;
+    
+    // Must have a non-empty title
+    wchar_t title[256] = {};
+    GetWindowText(hwnd, title, 256);
+    if (wcslen(title) == 0) return TRUE;
+    
+    // Skip tool windows and other non-app windows
+    LONG exStyle = GetWindowLong(hwnd, GWL_EXSTYLE);
+    if (exStyle & WS_EX_TOOLWINDOW) return TRUE;
+    
+    auto* snap = reinterpret_cast<WindowSnapshot*>(lParam);
+    
+    // Collect minimized windows separately
+    if (IsIconic(hwnd)) {
+        AppWindow aw;
+        aw.hwnd = hwnd;
+        GetWindowRect(hwnd, &aw.rect);
+        aw.title = title;
+        aw.visibleArea = 0;
+        aw.zOrder = (int)(snap->windows.size() + snap->minimized.size());
+        snap->minimized.push_back(aw);
+        return TRUE;
+    }
+    
+    // Must have some area
+    RECT rc;
+    GetWindowRect(hwnd, &rc);
+    if (rc.right - rc.left <= 0 || rc.bottom - rc.top <= 0) return TRUE;
+    
+    // Skip windows that are completely off-screen (e.g. cloaked UWP)
+    BOOL cloaked = FALSE;
+    // DwmGetWindowAttribute not linked; use owner check instead
+    HWND owner = GetWindow(hwnd, GW_OWNER);
+    if (owner != NULL) {
+        // Skip owned windows (popups/dialogs) - we want top-level app windows
+        // But some apps use owned windows, so only skip if also WS_EX_TOOLWINDOW
+    }
+    
+    AppWindow aw;
+    aw.hwnd = hwnd;
+    aw.rect = rc;
+    aw.title = title;
+    aw.visibleArea = 0;
+    aw.zOrder = (int)(snap->windows.size() + snap->minimized.size());
+    snap->windows.push_back(aw);
+    return TRUE;
+}
+
+// Enumerate top-level windows into a snapshot. Touches no globals besides
+// reading our own window handles, so it runs on either thread.
+void CollectWindowSnapshot(WindowSnapshot& snap) {
+    snap.windows.clear();
+    snap.minimized.clear();
+    EnumWindows(EnumWindowsProc, reinterpret_cast<LPARAM>(&snap));
+    // EnumWindows returns in Z-order (front to back)
+    
+    // Calculate visible area for each window (indices 0..i-1 are higher Z-order)
+    int count = (int)snap.windows.size();
+    std::vector<RECT> rects(count);
+    std::vector<long long> areas(count);
+    for (int i = 0; i < count; i++) rects[i] = snap.windows[i].rect;
+    ComputeVisibleAreas(rects.data(), count, areas.data());
+    for (int i = 0; i < count; i++) snap.windows[i].visibleArea = (int)areas[i];
+    
+    // Sort by visible area descending (most visible windows first)
+    std::stable_sort(snap.windows.begin(), snap.windows.end(),
+        [](const AppWindow& a, const AppWindow& b) {
+            return a.visibleArea > b.visibleArea;
+        });
+}
+
+// ============================================================================
+// Window inventory - snapshot kept fresh off the UI thread
+// ============================================================================
+// A background thread listens for shell window events (create, destroy,
+// show/hide, move, rename, foreground, minimize) and re-enumerates once they
+// go quiet, so Tab can use a ready snapshot instead of walking every window
+// on the UI thread. Every relevant event bumps g_inventoryEventSeq; a
+// snapshot is only trusted if no event arrived since its enumeration began.
+
+static_assert(INV_SYSTEM_FOREGROUND == EVENT_SYSTEM_FOREGROUND && INV_SYSTEM_MOVESIZEEND == EVENT_SYSTEM_MOVESIZEEND &&
+              INV_SYSTEM_MINIMIZESTART == EVENT_SYSTEM_MINIMIZESTART &&
+              INV_SYSTEM_MINIMIZEEND == EVENT_SYSTEM_MINIMIZEEND && INV_OBJECT_CREATE == EVENT_OBJECT_CREATE &&
+              INV_OBJECT_DESTROY == EVENT_OBJECT_DESTROY && INV_OBJECT_SHOW == EVENT_OBJECT_SHOW &&
+              INV_OBJECT_HIDE == EVENT_OBJECT_HIDE && INV_OBJECT_LOCATIONCHANGE == EVENT_OBJECT_LOCATIONCHANGE &&
+              INV_OBJECT_NAMECHANGE == EVENT_OBJECT_NAMECHANGE, "WinEvent IDs differ from WinUser.h");
+static_assert(sizeof(INVENTORY_EVENT_RANGES) / sizeof(INVENTORY_EVENT_RANGES[0]) == INVENTORY_EVENT_RANGE_COUNT,
+              "One hook per event range");
+
+std::mutex g_inventoryLock;
+std::shared_ptr<const WindowSnapshot> g_inventorySnapshot;  // Guarded by g_inventoryLock
+std::atomic<unsigned> g_inventoryEventSeq(0);
+std::thread g_inventoryThread;
+DWORD g_inventoryThreadId = 0;
+UINT_PTR g_inventoryTimer = 0;               // Inventory thread only
+std::vector<HWND> g_inventoryKnownWindows;   // Inventory thread only: windows in the last snapshot, sorted
+
+void RebuildWindowInventory() {
+    auto snap = std::make_shared<WindowSnapshot>();
+    snap->eventSeq = g_inventoryEventSeq.load();
+    CollectWindowSnapshot(*snap);
+    
+    g_inventoryKnownWindows.clear();
+    for (const auto& w : snap->windows) g_inventoryKnownWindows.push_back(w.hwnd);
+    for (const auto& w : snap->minimized) g_inventoryKnownWindows.push_back(w.hwnd);
+    std::sort(g_inventoryKnownWindows.begin(), g_inventoryKnownWindows.end());
+    
+    std::lock_guard<std::mutex> lock(g_inventoryLock);
+    g_inventorySnapshot = snap;
+}
+
+void CALLBACK InventoryWinEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd,
+                                    LONG idObject, LONG idChild, DWORD thread, DWORD time) {
+    if (!hwnd || idObject != OBJID_WINDOW || idChild != CHILDID_SELF) return;
+    if (event == EVENT_SYSTEM_FOREGROUND) PostMessage(g_hMainWnd, WM_FOREGROUNDAPP, 0, 0);  // Codes follow the app
+    bool known = false, topLevel = false;
+    if (event == EVENT_OBJECT_DESTROY || event == EVENT_OBJECT_LOCATIONCHANGE) {
+        known = std::binary_search(g_inventoryKnownWindows.begin(), g_inventoryKnownWindows.end(), hwnd);
+        // Moves arrive for every window on the desktop; only snapshot
+        // windows, all top-level, are worth asking about
+        if (event == EVENT_OBJECT_LOCATIONCHANGE) topLevel = known && GetAncestor(hwnd, GA_ROOT) == hwnd;
+    } else {
+        topLevel = GetAncestor(hwnd, GA_ROOT) == hwnd;
+    }
+    if (!InventoryEventStales(event, known, topLevel)) return;
+    g_inventoryEventSeq++;
+    // Restart the debounce so bursts (app launches, title churn) cost one rebuild
+    if (g_inventoryTimer) KillTimer(NULL, g_inventoryTimer);
+    g_inventoryTimer = SetTimer(NULL, 0, INVENTORY_DEBOUNCE_MS, NULL);
+}
+
+void WindowInventoryThread() {
+    MSG msg;
+    PeekMessage(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);  // Create the message queue
+    
+    const DWORD flags = WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS;
+    HWINEVENTHOOK hooks[INVENTORY_EVENT_RANGE_COUNT];
+    for (int i = 0; i < INVENTORY_EVENT_RANGE_COUNT; i++) {
+        hooks[i] = SetWinEventHook(INVENTORY_EVENT_RANGES[i].first, INVENTORY_EVENT_RANGES[i].last,
+            NULL, InventoryWinEventProc, 0, 0, flags);
+    }
+    
+    RebuildWindowInventory();
+    
+    // WinEvent callbacks are delivered from inside GetMessage
+    while (GetMessage(&msg, NULL, 0, 0) > 0) {
+        if (msg.message == WM_TIMER && msg.hwnd == NULL && msg.wParam == g_inventoryTimer) {
+            KillTimer(NULL, g_inventoryTimer);
+            g_inventoryTimer = 0;
+            RebuildWindowInventory();
+        }
+    }
+    
+    if (g_inventoryTimer) { KillTimer(NULL, g_inventoryTimer); g_inventoryTimer = 0; }
+    for (HWINEVENTHOOK hook : hooks) {
+        if (hook) UnhookWinEvent(hook);
+    }
+}
+
+void StartWindowInventory() {
+    if (g_inventoryThread.joinable()) return;
+    g_inventoryThread = std::thread(WindowInventoryThread);
+    g_inventoryThreadId = GetThreadId(g_inventoryThread.native_handle());
+}
+
+void StopWindowInventory() {
+    if (!g_inventoryThread.joinable()) return;
+    // The thread may not have created its queue yet; retry until it has
+    while (!PostThreadMessage(g_inventoryThreadId, WM_QUIT, 0, 0)) Sleep(1);
+    g_inventoryThread.join();
+    g_inventoryThreadId = 0;
+    std::lock_guard<std::mutex> lock(g_inventoryLock);
+    g_inventorySnapshot.reset();
+}
+
+// Latest snapshot if nothing has changed since it was taken, else null
+std::shared_ptr<const WindowSnapshot> TakeWindowSnapshot() {
+    std::shared_ptr<const WindowSnapshot> snap;
+    {
+        std::lock_guard<std::mutex> lock(g_inventoryLock);
+        snap = g_inventorySnapshot;
+    }
+    if (snap && snap->eventSeq != g_inventoryEventSeq.load()) snap.reset();
+    return snap;
+}
+
+// ============================================================================
+// Window title search
+// ============================================================================
+
+// Fold every title once per enumeration so each search keystroke is a
+// plain scan with no allocation or case conversion
+void BuildTitleIndex() {
+    TitleIndex& ix = g_titleIndex;
+    int count = (int)(g_allAppWindows.size() + g_allMinimizedWindows.size());
+    ix.folded.clear();
+    ix.offset.clear();
+    ix.length.clear();
+    ix.normalCount = (int)g_allAppWindows.size();
+    for (int i = 0; i < count; i++) {
+        const std::wstring& title = (i < ix.normalCount)
+            ? g_allAppWindows[i].title : g_allMinimizedWindows[i - ix.normalCount].title;
+        AppendFoldedTitle(ix, title.c_str(), (int)title.size(), towlower);
+    }
+    g_searchResults.clear();
+    g_searchQuery.clear();
+    g_matchChars.clear();
+    g_titleMatchAt.assign(count, -1);
+}
+
+void EnumerateAppWindows() {
+    LatencyScope timing(g_enumerateLatency);
+    // Use the background snapshot when it is current; enumerate inline otherwise
+    std::shared_ptr<const WindowSnapshot> snap = TakeWindowSnapshot();
+    if (!snap) {
+        auto fresh = std::make_shared<WindowSnapshot>();
+        CollectWindowSnapshot(*fresh);
+        snap = fresh;
+    }
+    
+    // Store all windows (including 0 visible area) and all minimized ones for search
+    g_allAppWindows = snap->windows;
+    g_allMinimizedWindows = snap->minimized;
+    BuildTitleIndex();
+    
+    // Windows with 0 visible area are left out of the cycling list
+    ResetWindowLists(false, true);
+}
+
+// Point the shown lists back at the full enumeration: every window or only
+// those with visible area, and every minimized window or none
+void ResetWindowLists(bool includeOccluded, bool includeMinimized) {
+    g_appWindows.clear();
+    for (int i = 0; i < (int)g_allAppWindows.size(); i++) {
+        if (includeOccluded || g_allAppWindows[i].visibleArea > 0) g_appWindows.push_back(i);
+    }
+    g_minimizedWindows.clear();
+    if (includeMinimized) {
+        for (int i = 0; i < (int)g_allMinimizedWindows.size(); i++) g_minimizedWindows.push_back(i);
+    }
+}
+
+// Among equal scores, the more recently active window first, then the more
+// visible one
+static bool SearchTieBefore(int a, int b) {
+    int normal = g_titleIndex.normalCount;
+    const AppWindow& wa = a < normal ? g_allAppWindows[a] : g_allMinimizedWindows[a - normal];
+    const AppWindow& wb = b < normal ? g_allAppWindows[b] : g_allMinimizedWindows[b - normal];
+    if (wa.zOrder != wb.zOrder) return wa.zOrder < wb.zOrder;
+    return wa.visibleArea > wb.visibleArea;
+}
+
+void FilterAppWindowsBySearch() {
+    LatencyScope timing(g_filterLatency);
+    if (g_tabSearchStr.empty()) {
+        // No search active - restore original visible-area-filtered list
+        // Re-run enumeration to get fresh state
+        return;
+    }
+    
+    // Case-insensitive fuzzy search across ALL windows (including occluded)
+    std::wstring searchLower = g_tabSearchStr;
+    for (auto& c : searchLower) c = towlower(c);
+    
+    UpdateSearchLevels(g_searchResults, g_searchQuery, searchLower, g_titleIndex, FuzzyMatchTitle<wchar_t>);
+    
+    const TitleIndex& ix = g_titleIndex;
+    int entryCount = (int)ix.offset.size();
+    
+    // Rank, then split back into normal and minimized lists; the level's
+    // matched positions are kept for underlining
+    const SearchLevel& level = g_searchResults.back();
+    std::vector<SearchHit> ranked = level.hits;
+    RankSearchHits(ranked, SearchTieBefore);
+    g_appWindows.clear();
+    g_minimizedWindows.clear();
+    g_matchChars = level.positions;
+    g_titleMatchAt.assign(entryCount, -1);
+    for (const SearchHit& hit : ranked) {
+        g_titleMatchAt[hit.entry] = hit.matchAt;
+        if (hit.entry < ix.normalCount) g_appWindows.push_back(hit.entry);
+        else g_minimizedWindows.push_back(hit.entry - ix.normalCount);
+    }
+    
+    // If we have matches, highlight the first one
+    if (!g_appWindows.empty()) {
+        g_highlightIndex = 0;
+    } else if (!g_minimizedWindows.empty()) {
+        g_highlightIndex = 0;  // will point into minimized range (0 normal + i)
+    } else {
+        g_highlightIndex = -1;
+    }
+}
+
+void CycleHighlight(bool forward) {
+    if (g_appWindows.empty() && g_minimizedWindows.empty()) {
+        EnumerateAppWindows();
+    }
+    int total = (int)g_appWindows.size() + (int)g_minimizedWindows.size();
+    if (total == 0) return;
+    
+    if (forward) {
+        g_highlightIndex++;
+        if (g_highlightIndex >= total) {
+            g_highlightIndex = 0;
+        }
+    } else {
+        g_highlightIndex--;
+        if (g_highlightIndex < 0) {
+            g_highlightIndex = total - 1;
+        }
+    }
+    
+    // Make black background transparent via color key so red highlights stay vivid
+    SetLayeredWindowAttributes(g_hOverlayWnd, g_palette.background, 0, LWA_COLORKEY);
+    
+    // Reset the tab-to-text timer on each TAB press
+    g_bTabTextMode = false;
+    KillTimer(g_hOverlayWnd, TIMER_ID_TAB_TEXT);
+    SetTimer(g_hOverlayWnd, TIMER_ID_TAB_TEXT, TAB_TEXT_TIMEOUT_MS, NULL);
+    
+    InvalidateRect(g_hOverlayWnd, NULL, TRUE);
+}
+
+// Create overlay window
+void CreateOverlayWindow() {
+    if (g_hOverlayWnd) return;
+    
+    // Get virtual screen bounds (all monitors)
+    auto vs = GetVirtualScreenBounds();
+    int virtualLeft = vs.left;
+    int virtualTop = vs.top;
+    int virtualWidth = vs.width;
+    int virtualHeight = vs.height;
+    
+    g_hOverlayWnd = CreateWindowEx(
+        WS_EX_TOPMOST | WS_EX_TOOLWINDOW | WS_EX_LAYERED,
+        L"KeyboardJockeyOverlay",
+        L"Grid Overlay",
+        WS_POPUP,
+        virtualLeft, virtualTop, virtualWidth, virtualHeight,
+        NULL, NULL, g_hInstance, NULL
+    );
+    
+    // Set transparency
+    SetLayeredWindowAttributes(g_hOverlayWnd, 0, GRID_ALPHA, LWA_ALPHA);
+}
+
+// ============================================================================
+// Staged grid construction
+// ============================================================================
+// Nothing needs the grid until it is first shown, so WM_CREATE only brings
+// up the tray icon, hotkey and hooks. GRID_BUILD_DELAY_MS later a worker
+// builds the cell geometry and then renders the base grid bitmap, leaving
+// the message loop free. Anything that needs the grid sooner calls
+// EnsureGridReady, which waits for the worker (see core/StartupStages.h).
+
+// The grid data (g_monitors, g_cells, g_gridTiles, g_gridGlyphs, g_palette)
+// belongs to the worker from BeginGridBuild until EnsureGridReady joins it,
+// to the UI thread the rest of the time. Nothing locks it, so every
+// function that reads or writes it asserts GridOwnedByCaller instead.
+StagedBuild g_gridBuild;
+static DWORD g_uiThreadId = 0;  // Set at the top of wWinMain
+
+bool GridOwnedByCaller() {
+    return g_gridBuild.OwnedByCaller(GetCurrentThreadId() == g_uiThreadId);
+}
+
+// Render the missing tiles on the worker, which owns the grid data until
+// EnsureGridReady joins it
+static void RenderGridOnWorker() {
+    HWND hNotify = g_hMainWnd;
+    g_gridBuild.Run([hNotify]() {
+        RenderBaseGridTiles();
+        PostMessage(hNotify, WM_GRIDREADY, 0, 0);
+    });
+}
+
+// Build the cells and render their bitmap in the background. While it
+// runs, the worker owns the grid data; the UI thread must go through
+// EnsureGridReady before touching it. The codes are ranked with the click
+// model, which only the grid's owner writes (RecordGridClick) once the
+// build has begun, and for a copy of the foreground app, which the UI
+// thread may change meanwhile.
+void BeginGridBuild() {
+    KillTimer(g_hMainWnd, TIMER_ID_BUILD_GRID);
+    if (g_gridBuild.State() != STAGE_PENDING) return;
+    HWND hNotify = g_hMainWnd;
+    std::wstring app = g_foregroundApp;
+    g_gridBuild.Begin([hNotify, app]() {
+        BuildGridCells(app.c_str());
+        RenderBaseGridTiles();
+        MarkStartup(STARTUP_GRID_READY);
+        PostMessage(hNotify, WM_GRIDREADY, 0, 0);
+    });
+}
+
+// Cells and base grid bitmap are ready when this returns; blocks only while
+// the worker finishes
+void EnsureGridReady() {
+    if (g_gridBuild.State() == STAGE_READY) return;
+    BeginGridBuild();
+    g_gridBuild.Finish();
+}
+
+// Memory held by the base grid tiles; waits for the worker, which may still
+// be filling in their tone maps
+GridMemoryUsage MeasureBaseGridMemory() {
+    if (g_gridBuild.State() == STAGE_RUNNING) EnsureGridReady();
+    return MeasureGridMemory(g_monitors, &MonitorInfo::rcMonitor, &g_gridTiles);
+}
+
+// Re-rank every monitor's codes for g_foregroundApp. Monitors whose codes
+// change are labelled again and lose their tiles, which the caller redraws.
+// Returns false if every code stayed put.
+static bool RelabelGridCells() {
+    assert(GridOwnedByCaller());
+    std::vector<int> kept(g_monitors.size()), byCode;
+    bool changed = false;
+    for (size_t m = 0; m < g_monitors.size(); m++) {
+        const MonitorInfo& mon = g_monitors[m];
+        int* current = g_cells.byCode + mon.firstCell;
+        byCode.resize(mon.cellCount);
+        RankCellsByClicks(g_clickModel, mon, g_foregroundApp, byCode.data());
+        kept[m] = (int)m;
+        if (std::equal(byCode.begin(), byCode.end(), current)) continue;
+        std::copy(byCode.begin(), byCode.end(), current);
+        LabelCellsByRank(mon);
+        kept[m] = -1;
+        changed = true;
+    }
+    if (changed) RemapGridTiles(kept);
+    return changed;
+}
+
+// Another app came to the foreground. While the grid is hidden and built,
+// its codes are re-ranked for that app and the relabelled tiles redrawn on
+// the worker, ready for the next ShowGrid; otherwise ShowGrid catches up.
+void OnForegroundAppChange() {
+    if (g_bGridVisible) return;
+    wchar_t app[CLICK_NAME_LEN];
+    GetForegroundAppName(app);
+    if (wcscmp(app, g_foregroundApp) == 0) return;
+    wcscpy_s(g_foregroundApp, app);
+    if (g_gridBuild.State() == STAGE_READY && RelabelGridCells()) RenderGridOnWorker();
+}
+
+// Monitors were attached, detached, moved, resized or changed DPI. A grid
+// that has not been built yet will pick the new layout up when it is.
+void OnDisplayChange() {
+    if (g_gridBuild.State() == STAGE_PENDING) return;
+    EnsureGridReady();
+    if (!BuildGridCells(g_foregroundApp)) return;
+    RenderBaseGridTiles();  // Only the changed monitors' tiles
+    if (g_hOverlayWnd) {
+        auto vs = GetVirtualScreenBounds();
+        SetWindowPos(g_hOverlayWnd, HWND_TOPMOST, vs.left, vs.top, vs.width, vs.height, SWP_NOACTIVATE);
+    }
+    if (g_bGridVisible) {
+        UpdateCellStates();
+        InvalidateRect(g_hOverlayWnd, NULL, FALSE);
+    }
+}
+
+// Show the grid overlay
+void ShowGrid() {
+    if (g_bGridVisible) return;
+    GetForegroundAppName(g_foregroundApp);  // Before the overlay takes the foreground
+    EnsureGridReady();
+    if (RelabelGridCells()) RenderBaseGridTiles();  // Ranked for an app whose switch was missed
+    FlushHueRecolor();
+    
+    // Restore cursor in case it was hidden by typing (e.g., pressing hotkey)
+    // Do it instantly without animation since we're showing the grid
+    if (g_bCursorHidden) {
+        RequestMouseHook(HOOK_MSG_CURSOR_MOUSE, false);
+        PostCursorCommand(CURSOR_CMD_RESTORE_NOW);
+        g_bCursorHidden = false;
+    }
+    
+    g_typedChars.clear();
+    g_typedChars.reserve(MAX_LABEL_LETTERS + 1);  // Typing never reallocates
+    g_zoomRegions.clear();
+    g_bMouseMoveMode = false;  // Reset mouse move mode
+    CreateOverlayWindow();
+    UpdateCellStates();
+    
+    // Reset transparency to default (in case it was reduced in a previous session)
+    SetLayeredWindowAttributes(g_hOverlayWnd, 0, GRID_ALPHA, LWA_ALPHA);
+    
+    ShowWindow(g_hOverlayWnd, SW_SHOW);
+    SetForegroundWindow(g_hOverlayWnd);
+    SetFocus(g_hOverlayWnd);
+    
+    g_bGridVisible = true;
+    InvalidateRect(g_hOverlayWnd, NULL, TRUE);
+}
+
+// Hide the grid overlay
+void HideGrid() {
+    if (!g_bGridVisible) return;
+    
+    ShowWindow(g_hOverlayWnd, SW_HIDE);
+    g_bGridVisible = false;
+    g_bMouseMoveMode = false;
+    g_typedChars.clear();
+    g_zoomRegions.clear();
+    g_appWindows.clear();
+    g_allAppWindows.clear();
+    g_minimizedWindows.clear();
+    g_allMinimizedWindows.clear();
+    BuildTitleIndex();
+    g_highlightIndex = -1;
+    g_tabSearchStr.clear();
+    g_bTabTextMode = false;
+    KillTimer(g_hOverlayWnd, TIMER_ID_TAB_TEXT);
+    // Clean up scroll mode if active
+    if (g_bScrollMode) {
+        g_bScrollMode = false;
+        RequestMouseHook(HOOK_MSG_SCROLL_MOUSE, false);
+    }
+}
+
+// Move mouse to a point
+void MoveMouse(POINT pt) {
+    SetCursorPos(pt.x, pt.y);
+}
+
+// Send a mouse click
+void SendClick(bool rightClick) {
+    INPUT input[2] = {};
+    
+    input[0].type = INPUT_MOUSE;
+    input[0].mi.dwFlags = rightClick ? MOUSEEVENTF_RIGHTDOWN : MOUSEEVENTF_LEFTDOWN;
+    
+    input[1].type = INPUT_MOUSE;
+    input[1].mi.dwFlags = rightClick ? MOUSEEVENTF_RIGHTUP : MOUSEEVENTF_LEFTUP;
+    
+    SendInput(2, input, sizeof(INPUT));
+    
+    POINT pt;
+    GetCursorPos(&pt);
+    RecordGridClick(pt);
+}
+
+void SendDoubleClick() {
+    INPUT input[4] = {};
+    for (int i = 0; i < 4; i++) input[i].type = INPUT_MOUSE;
+    input[0].mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
+    input[1].mi.dwFlags = MOUSEEVENTF_LEFTUP;
+    input[2].mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
+    input[3].mi.dwFlags = MOUSEEVENTF_LEFTUP;
+    SendInput(4, input, sizeof(INPUT));
+    
+    POINT pt;
+    GetCursorPos(&pt);
+    RecordGridClick(pt);
+}
+
+// Get sub-grid point index from character a-h, or x for the centre
+// Layout: a b c
+//         d x e
+//         f g h
+// Returns the subPoints index (0-8), or -1 for any other letter
+int GetSubPointIndex(wchar_t ch) {
+    // a=0, b=1, c=2, d=3, x=4, e=5, f=6, g=7, h=8
+    if (ch >= L'a' && ch <= L'd') {
+        return ch - L'a';  // 0-3
+    } else if (ch >= L'e' && ch <= L'h') {
+        return ch - L'a' + 1;  // 5-8
+    } else if (ch == L'x') {
+        return 4;  // Centre, under the cell label
+    }
+    return -1;
+}
+
+// Create main and sub-label fonts for a given sub-cell height and cell width
+void CreateGridFonts(int sh, int cellW, HFONT* outMain, HFONT* outSub) {
+    int fromHeight = sh * MAIN_FONT_HEIGHT_PCT / 100;
+    int fromWidth = cellW / MAIN_FONT_WIDTH_DIV;
+    int mainFontSize = -min(fromHeight, fromWidth);
+    if (mainFontSize > MIN_MAIN_FONT_SIZE) mainFontSize = MIN_MAIN_FONT_SIZE;
+    *outMain = CreateFont(mainFontSize, 0, 0, 0, FW_MEDIUM, FALSE, FALSE, FALSE,
+        DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
+        CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
+    int subFontSize = -(sh * SUB_FONT_HEIGHT_PCT / 100);
+    if (subFontSize > MIN_SUB_FONT_SIZE) subFontSize = MIN_SUB_FONT_SIZE;
+    *outSub = CreateFont(subFontSize, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
+        DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
+        CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
+}
+
+// Move cursor by arrow key offset and enter mouse-move mode
+void MoveMouseByArrowKey(int dx, int dy, int moveAmount) {
+    POINT pt;
+    GetCursorPos(&pt);
+    pt.x += dx;
+    pt.y += dy;
+    SetCursorPos(pt.x, pt.y);
+    if (!g_bMouseMoveMode) {
+        g_bMouseMoveMode = true;
+        SetLayeredWindowAttributes(g_hOverlayWnd, 0, MOUSE_MOVE_ALPHA, LWA_ALPHA);
+        SetCursor(LoadCursor(NULL, IDC_ARROW));
+    }
+}
+
+// Process typed character
+void ProcessTypedChar(wchar_t ch) {
+    if (!g_bGridVisible) return;
+    
+    // Convert to lowercase
+    ch = towlower(ch);
+    
+    if (ch >= L'a' && ch <= L'z') {
+        // Exit window highlight mode if active
+        if (g_highlightIndex >= 0) {
+            g_highlightIndex = -1;
+            g_appWindows.clear();
+            SetLayeredWindowAttributes(g_hOverlayWnd, 0, GRID_ALPHA, LWA_ALPHA);
+            InvalidateRect(g_hOverlayWnd, NULL, TRUE);
+        }
+        
+        // Restore default opacity when typing
+        if (g_bMouseMoveMode) {
+            g_bMouseMoveMode = false;
+            SetLayeredWindowAttributes(g_hOverlayWnd, 0, GRID_ALPHA, LWA_ALPHA);
+        }
+        
+        // Reset the timeout timer
+        if (g_hOverlayWnd) {
+            KillTimer(g_hOverlayWnd, TIMER_ID_RESET);
+            SetTimer(g_hOverlayWnd, TIMER_ID_RESET, RESET_TIMEOUT_MS, NULL);
+        }
+        
+        // While zoomed, letters pick a part of the zoom region
+        if (!g_zoomRegions.empty()) {
+            ZoomInto(ch);
+            return;
+        }
+        g_typedChars += ch;
+        
+        // A letter after a complete label is a sub-grid selection
+        int typedLen = (int)g_typedChars.length();
+        int cellIdx = FindCellByLabel(g_typedChars.c_str(), typedLen - 1);
+        if (cellIdx >= 0) {
+            int subIdx = GetSubPointIndex(g_typedChars[typedLen - 1]);
+            if (subIdx >= 0) {
+                // The sub-cell becomes the zoom region for further letters.
+                // It includes its share of the cell's remainder pixels.
+                MoveMouse(g_cells.subPoints[cellIdx][subIdx]);
+                const RECT& rc = g_cells.rect[cellIdx];
+                assert(ZoomPartsTile(rc, 3, 3));
+                BeginZoom(SubCellRect(rc, subIdx));
+            } else {
+                // Invalid sub-char, move to center and clear for next selection
+                MoveMouse(g_cells.center[cellIdx]);
+                g_typedChars.clear();
+            }
+        }
+        // A complete label moves to the cell immediately
+        else if ((cellIdx = FindCellByLabel(g_typedChars.c_str(), typedLen)) >= 0) {
+            MoveMouse(CodeLandingPoint(cellIdx));
+        }
+        // Longer than any label: start over
+        else if (typedLen > MAX_LABEL_LETTERS) {
+            g_typedChars.clear();
+        }
+        
+        UpdateCellStates();
+    }
+}
+
+// Create tray icon
+void CreateTrayIcon(HWND hWnd) {
+    g_nid.cbSize = sizeof(NOTIFYICONDATA);
+    g_nid.hWnd = hWnd;
+    g_nid.uID = 1;
+    g_nid.uFlags = NIF_ICON | NIF_MESSAGE | NIF_TIP;
+    g_nid.uCallbackMessage = WM_TRAYICON;
+    g_nid.hIcon = LoadIcon(g_hInstance, MAKEINTRESOURCE(IDI_KEYBOARDJOCKEY));
+    wcscpy_s(g_nid.szTip, L"Keyboard Jockey - Ctrl+Alt+M to show grid");
+    
+    Shell_NotifyIcon(NIM_ADD, &g_nid);
+}
+
+// Remove tray icon
+void RemoveTrayIcon() {
+    Shell_NotifyIcon(NIM_DELETE, &g_nid);
+}
+
+// ========================================================================
+// Palette picker window
+// ========================================================================
+
+// DPI-scaled layout for the palette window — all values computed at runtime
+struct PalLayout {
+    int winW, winH;
+    int hueBarX, hueBarY, hueBarW, hueBarH;
+    int markerH;
+    int previewX, previewY, previewW, previewH;
+    int btnW, btnH, btnY, btnOkX, btnCancelX;
+    int fontLabel, fontSmall;   // font sizes (negative = point)
+    float dpiScale;
+};
+
+static PalLayout g_palLayout = {};
+
+static PalLayout ComputePalLayout() {
+    // Get DPI of primary monitor
+    UINT dpiX = DEFAULT_DPI, dpiY = DEFAULT_DPI;
+    HMONITOR hMon = MonitorFromPoint({ 0, 0 }, MONITOR_DEFAULTTOPRIMARY);
+    GetDpiForMonitor(hMon, MDT_EFFECTIVE_DPI, &dpiX, &dpiY);
+    float s = (float)dpiX / 96.0f;
+
+    PalLayout L;
+    L.dpiScale  = s;
+    L.winW      = (int)(620 * s);
+    L.winH      = (int)(560 * s);
+    int pad     = (int)(20 * s);
+
+    L.hueBarX   = pad;
+    L.hueBarY   = pad;
+    L.hueBarW   = L.winW - pad * 2;
+    L.hueBarH   = (int)(36 * s);
+    L.markerH   = (int)(10 * s);
+
+    L.btnH      = (int)(32 * s);
+    L.btnW      = (int)(90 * s);
+    L.btnY      = L.winH - pad - L.btnH;  // bottom area
+    L.btnOkX    = L.winW - pad - L.btnW * 2 - (int)(10 * s);
+    L.btnCancelX = L.winW - pad - L.btnW;
+
+    L.previewX  = pad;
+    L.previewY  = L.hueBarY + L.hueBarH + L.markerH + (int)(16 * s);
+    L.previewW  = L.winW - pad * 2;
+    L.previewH  = L.btnY - L.previewY - (int)(8 * s);
+
+    L.fontLabel = -(int)(14 * s);
+    L.fontSmall = -(int)(11 * s);
+
+    return L;
+}
+
+#define IDC_PAL_OK      2001
+#define IDC_PAL_CANCEL  2002
+
+static bool g_bDraggingHue = false;
+static float g_hueBeforeEdit = 0.0f;   // saved on dialog open for Cancel
+static HWND g_hBtnOk = NULL;
+static HWND g_hBtnCancel = NULL;
+static HBITMAP g_hHueBarBitmap = NULL;  // cached rainbow strip (static, never changes)
+
+// Map x pixel inside the hue bar to hue 0..360
+static float HueBarPixelToHue(int x) {
+    const PalLayout& L = g_palLayout;
+    float t = (float)(x - L.hueBarX) / (float)L.hueBarW;
+    if (t < 0.0f) t = 0.0f;
+    if (t > 1.0f) t = 1.0f;
+    return t * 360.0f;
+}
+
+static int HueToHueBarPixel(float hue) {
+    const PalLayout& L = g_palLayout;
+    return L.hueBarX + (int)(hue / 360.0f * L.hueBarW);
+}
+
+static bool g_hueRecolorPending = false;
+
+// Apply a new hue: regenerate the palette now and schedule the grid recolor.
+// Recoloring rewrites every pixel of every tile and drops the cell
+// atlases, so a hue drag coalesces its mouse moves into one recolor per
+// HUE_RECOLOR_MS tick instead of one per WM_MOUSEMOVE
+void ApplyHue(float hue) {
+    // The palette is read by a grid render in progress; a grid not built
+    // yet simply renders with the new one
+    if (g_gridBuild.State() == STAGE_RUNNING) EnsureGridReady();
+    assert(GridOwnedByCaller());
+    g_baseHue = hue;
+    if (g_baseHue < 0.0f)   g_baseHue = 0.0f;
+    if (g_baseHue > 359.9f) g_baseHue = 359.9f;
+    g_palette = GeneratePalette(g_baseHue);
+    if (!g_hueRecolorPending) {
+        g_hueRecolorPending = true;
+        SetTimer(g_hMainWnd, TIMER_ID_RECOLOR, HUE_RECOLOR_MS, NULL);
+    }
+}
+
+// Recolor the grid bitmap for the current palette and repaint, if a hue
+// change is still waiting for its tick
+void FlushHueRecolor() {
+    if (!g_hueRecolorPending) return;
+    // A hue set before the grid was built can tick while the worker renders it
+    if (g_gridBuild.State() == STAGE_RUNNING) EnsureGridReady();
+    g_hueRecolorPending = false;
+    KillTimer(g_hMainWnd, TIMER_ID_RECOLOR);
+    ReleaseCellAtlases();  // Highlight sprites are baked with the old palette
+    RecolorBaseGridTiles();
+    if (g_bGridVisible) {
+        InvalidateRect(g_hOverlayWnd, NULL, FALSE);
+    }
+}
+
+// Hue bar colors at every tenth of a degree, as DIB pixels
+static const UINT32* HueBarLut() {
+    static UINT32 lut[HUE_LUT_STEPS];
+    static bool built = false;
+    if (!built) {
+        static float hue[HUE_LUT_STEPS], sat[HUE_LUT_STEPS], light[HUE_LUT_STEPS];
+        for (int i = 0; i < HUE_LUT_STEPS; i++) {
+            hue[i] = (float)i * (360.0f / HUE_LUT_STEPS);
+            sat[i] = 0.85f;
+            light[i] = 0.50f;
+        }
+        PaletteColor colors[HUE_LUT_STEPS];
+        HslBatch(hue, sat, light, colors, HUE_LUT_STEPS);
+        for (int i = 0; i < HUE_LUT_STEPS; i++) lut[i] = SurfacePixel(colors[i]);
+        built = true;
+    }
+    return lut;
+}
+
+// Build the static hue rainbow bitmap (called once when palette window opens):
+// one row from the hue LUT, copied down a DIB section
+static void BuildHueBarBitmap() {
+    if (g_hHueBarBitmap) { DeleteObject(g_hHueBarBitmap); g_hHueBarBitmap = NULL; }
+    const PalLayout& L = g_palLayout;
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = L.hueBarW;
+    bmi.bmiHeader.biHeight = -L.hueBarH;  // Top-down
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    void* bits = NULL;
+    g_hHueBarBitmap = CreateDIBSection(NULL, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+    if (!g_hHueBarBitmap) return;
+    
+    const UINT32* lut = HueBarLut();
+    UINT32* row = (UINT32*)bits;
+    for (int x = 0; x < L.hueBarW; x++) row[x] = lut[x * HUE_LUT_STEPS / L.hueBarW];
+    for (int y = 1; y < L.hueBarH; y++) memcpy(row + (size_t)y * L.hueBarW, row, L.hueBarW * sizeof(UINT32));
+}
+
+// Draw the horizontal hue rainbow bar (blits cached bitmap + draws marker)
+static void PaintHueBar(HDC hdc) {
+    const PalLayout& L = g_palLayout;
+    // Blit cached rainbow
+    if (g_hHueBarBitmap) {
+        HDC hdcBmp = CreateCompatibleDC(hdc);
+        SelectObject(hdcBmp, g_hHueBarBitmap);
+        BitBlt(hdc, L.hueBarX, L.hueBarY, L.hueBarW, L.hueBarH, hdcBmp, 0, 0, SRCCOPY);
+        DeleteDC(hdcBmp);
+    }
+    // Border
+    HPEN hPen = CreatePen(PS_SOLID, 1, RGB(80, 80, 80));
+    HPEN hOld = (HPEN)SelectObject(hdc, hPen);
+    HBRUSH hNull = (HBRUSH)GetStockObject(NULL_BRUSH);
+    HBRUSH hOldBr = (HBRUSH)SelectObject(hdc, hNull);
+    Rectangle(hdc, L.hueBarX - 1, L.hueBarY - 1,
+              L.hueBarX + L.hueBarW + 1, L.hueBarY + L.hueBarH + 1);
+    SelectObject(hdc, hOldBr);
+    SelectObject(hdc, hOld);
+    DeleteObject(hPen);
+
+    // Marker triangle below bar at current hue
+    int triH = L.markerH;
+    int mx = HueToHueBarPixel(g_baseHue);
+    int triTop = L.hueBarY + L.hueBarH + 2;
+    POINT tri[3] = {
+        { mx, triTop },
+        { mx - triH * 3 / 4, triTop + triH },
+        { mx + triH * 3 / 4, triTop + triH }
+    };
+    HBRUSH hMarker = CreateSolidBrush(RGB(255, 255, 255));
+    HPEN hMarkerPen = CreatePen(PS_SOLID, 1, RGB(40, 40, 40));
+    SelectObject(hdc, hMarker);
+    SelectObject(hdc, hMarkerPen);
+    Polygon(hdc, tri, 3);
+    SelectObject(hdc, hOld);
+    DeleteObject(hMarker);
+    DeleteObject(hMarkerPen);
+}
+
+// Draw a miniature preview of the grid + window highlight using the current palette
+static void PaintPreview(HDC hdc) {
+    assert(GridOwnedByCaller());
+    const PalLayout& L = g_palLayout;
+    int px = L.previewX, py = L.previewY;
+    int pw = L.previewW, ph = L.previewH;
+    float s = L.dpiScale;
+    const Palette& P = g_palette;
+
+    // Background for the whole preview area
+    HBRUSH hBg = CreateSolidBrush(RGB(20, 20, 20));
+    RECT rcBg = { px, py, px + pw, py + ph };
+    FillRect(hdc, &rcBg, hBg);
+    DeleteObject(hBg);
+
+    // ---- Grid preview (left half) ----
+    int pad = (int)(8 * s);
+    int headerH = (int)(22 * s);
+    int gridX = px + pad, gridY = py + headerH + pad;
+    int gridW = pw / 2 - pad * 2, gridH = ph / 2 - headerH - pad;
+    int cols = 4, rows = 3;
+    int cellW = gridW / cols, cellH = gridH / rows;
+
+    // Background fill
+    HBRUSH hGridBg = CreateSolidBrush(P.background);
+    RECT rcGrid = { gridX, gridY, gridX + cols * cellW, gridY + rows * cellH };
+    FillRect(hdc, &rcGrid, hGridBg);
+    DeleteObject(hGridBg);
+
+    // DPI-scaled fonts (cached – only recreated when layout changes)
+    static HFONT hSmallFont = NULL;
+    static HFONT hTinyFont = NULL;
+    static int sCachedLabelSz = 0, sCachedSmallSz = 0;
+    if (!hSmallFont || sCachedLabelSz != L.fontLabel) {
+        if (hSmallFont) DeleteObject(hSmallFont);
+        hSmallFont = CreateFont(L.fontLabel, 0, 0, 0, FW_BOLD, FALSE, FALSE, FALSE,
+            DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
+            CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
+        sCachedLabelSz = L.fontLabel;
+    }
+    if (!hTinyFont || sCachedSmallSz != L.fontSmall) {
+        if (hTinyFont) DeleteObject(hTinyFont);
+        hTinyFont = CreateFont(L.fontSmall, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
+            DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
+            CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
+        sCachedSmallSz = L.fontSmall;
+    }
+    HFONT hOldFont = (HFONT)SelectObject(hdc, hSmallFont);
+    SetBkMode(hdc, TRANSPARENT);
+    SetTextColor(hdc, RGB(200, 200, 200));
+    RECT rcLabel = { gridX, py + pad / 2, gridX + gridW, py + headerH };
+    DrawText(hdc, L"Grid View", -1, &rcLabel, DT_LEFT | DT_SINGLELINE);
+
+    // Checkerboard cells + grid lines
+    HBRUSH hEven = CreateSolidBrush(P.cellBgEven);
+    HBRUSH hOdd  = CreateSolidBrush(P.cellBgOdd);
+    const wchar_t* demoLabels[] = {
+        L"aaa", L"aab", L"aac", L"aad",
+        L"aae", L"aaf", L"aag", L"aah",
+        L"aai", L"aaj", L"aak", L"aal"
+    };
+
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            RECT rc = { gridX + c * cellW, gridY + r * cellH,
+                        gridX + (c + 1) * cellW, gridY + (r + 1) * cellH };
+            FillRect(hdc, &rc, ((r + c) % 2 == 0) ? hEven : hOdd);
+
+            // Grid line border
+            HPEN hPen = CreatePen(PS_SOLID, 1, P.gridLine);
+            HPEN hOldPen = (HPEN)SelectObject(hdc, hPen);
+            HBRUSH hNullBr = (HBRUSH)GetStockObject(NULL_BRUSH);
+            HBRUSH hOldBr2 = (HBRUSH)SelectObject(hdc, hNullBr);
+            Rectangle(hdc, rc.left, rc.top, rc.right, rc.bottom);
+            SelectObject(hdc, hOldBr2);
+            SelectObject(hdc, hOldPen);
+            DeleteObject(hPen);
+
+            // Sub-grid lines
+            int sw = cellW / 3, sh = cellH / 3;
+            HPEN hSub = CreatePen(PS_SOLID, 1, P.subGridLine);
+            SelectObject(hdc, hSub);
+            MoveToEx(hdc, rc.left + sw, rc.top, NULL); LineTo(hdc, rc.left + sw, rc.bottom);
+            MoveToEx(hdc, rc.left + sw * 2, rc.top, NULL); LineTo(hdc, rc.left + sw * 2, rc.bottom);
+            MoveToEx(hdc, rc.left, rc.top + sh, NULL); LineTo(hdc, rc.right, rc.top + sh);
+            MoveToEx(hdc, rc.left, rc.top + sh * 2, NULL); LineTo(hdc, rc.right, rc.top + sh * 2);
+            SelectObject(hdc, (HPEN)GetStockObject(BLACK_PEN));
+            DeleteObject(hSub);
+
+            // Cell label
+            SelectObject(hdc, hTinyFont);
+            int idx = r * cols + c;
+            SetTextColor(hdc, P.mainLabelText);
+            DrawText(hdc, demoLabels[idx], -1, &rc, DT_CENTERED);
+
+            // Sub-labels
+            const wchar_t* subs = L"abcdefgh";
+            int si = 0;
+            for (int sy = 0; sy < 3; sy++) {
+                for (int sx = 0; sx < 3; sx++) {
+                    if (sx == 1 && sy == 1) continue;
+                    RECT sr = { rc.left + sx * sw, rc.top + sy * sh,
+                                rc.left + (sx + 1) * sw, rc.top + (sy + 1) * sh };
+                    SetTextColor(hdc, P.subLabelText);
+                    wchar_t sl[2] = { subs[si], 0 };
+                    DrawText(hdc, sl, 1, &sr, DT_CENTERED);
+                    si++;
+                }
+            }
+        }
+    }
+    DeleteObject(hEven);
+    DeleteObject(hOdd);
+
+    // ---- Typing preview (right half) - show match/partial/dim ----
+    int typX = px + pw / 2 + pad, typY = py + headerH + pad;
+    int typW = pw / 2 - pad * 2, typH = ph / 2 - headerH - pad;
+    int tCols = 3, tRows = 3;
+    int tCellW = typW / tCols, tCellH = typH / tRows;
+
+    // Label
+    SelectObject(hdc, hSmallFont);
+    SetTextColor(hdc, RGB(200, 200, 200));
+    RECT rcTypLabel = { typX, py + pad / 2, typX + typW, py + headerH };
+    DrawText(hdc, L"Typing Match", -1, &rcTypLabel, DT_LEFT | DT_SINGLELINE);
+
+    // Simulate: cell [1,1] = full match, [0,x] = partial, rest = dim
+    for (int r = 0; r < tRows; r++) {
+        for (int c = 0; c < tCols; c++) {
+            RECT rc = { typX + c * tCellW, typY + r * tCellH,
+                        typX + (c + 1) * tCellW, typY + (r + 1) * tCellH };
+            bool isMatch = (r == 1 && c == 1);
+            bool isPartial = (r == 0);
+
+            COLORREF bg, fg;
+            if (isMatch) {
+                bg = P.matchCellBg; fg = P.matchLabelText;
+            } else if (isPartial) {
+                bg = P.partialMatchBg; fg = P.partialMatchText;
+            } else {
+                bg = P.dimBg; fg = P.dimText;
+            }
+
+            HBRUSH hCellBg = CreateSolidBrush(bg);
+            FillRect(hdc, &rc, hCellBg);
+            DeleteObject(hCellBg);
+
+            // Grid lines
+            HPEN hPen = CreatePen(PS_SOLID, 1, isMatch ? P.matchGridLine : P.gridLine);
+            HPEN hOldPen = (HPEN)SelectObject(hdc, hPen);
+            HBRUSH hNullBr = (HBRUSH)GetStockObject(NULL_BRUSH);
+            SelectObject(hdc, hNullBr);
+            Rectangle(hdc, rc.left, rc.top, rc.right, rc.bottom);
+            SelectObject(hdc, hOldPen);
+            DeleteObject(hPen);
+
+            // Label
+            SelectObject(hdc, hTinyFont);
+            SetTextColor(hdc, fg);
+            const wchar_t* cellLabel = isMatch ? L"aaf" : (isPartial ? L"aab" : L"abz");
+            DrawText(hdc, cellLabel, -1, &rc, DT_CENTERED);
+
+            // On the matched cell, draw sub-labels + one highlighted
+            if (isMatch) {
+                int sw2 = tCellW / 3, sh2 = tCellH / 3;
+                HPEN hSub = CreatePen(PS_SOLID, 1, P.matchGridLine);
+                SelectObject(hdc, hSub);
+                MoveToEx(hdc, rc.left + sw2, rc.top, NULL); LineTo(hdc, rc.left + sw2, rc.bottom);
+                MoveToEx(hdc, rc.left + sw2 * 2, rc.top, NULL); LineTo(hdc, rc.left + sw2 * 2, rc.bottom);
+                MoveToEx(hdc, rc.left, rc.top + sh2, NULL); LineTo(hdc, rc.right, rc.top + sh2);
+                MoveToEx(hdc, rc.left, rc.top + sh2 * 2, NULL); LineTo(hdc, rc.right, rc.top + sh2 * 2);
+                SelectObject(hdc, (HPEN)GetStockObject(BLACK_PEN));
+                DeleteObject(hSub);
+
+                int si = 0;
+                for (int sy = 0; sy < 3; sy++) {
+                    for (int sx = 0; sx < 3; sx++) {
+                        if (sx == 1 && sy == 1) continue;
+                        RECT sr = { rc.left + sx * sw2, rc.top + sy * sh2,
+                                    rc.left + (sx + 1) * sw2, rc.top + (sy + 1) * sh2 };
+                        if (si == 3) {
+                            HBRUSH hHl = CreateSolidBrush(P.matchSubHighlightBg);
+                            FillRect(hdc, &sr, hHl);
+                            DeleteObject(hHl);
+                            SetTextColor(hdc, P.matchSubHighlightText);
+                        } else {
+                            SetTextColor(hdc, P.matchSubLabelText);
+                        }
+                        wchar_t sl[2] = { L"abcdefgh"[si], 0 };
+                        DrawText(hdc, sl, 1, &sr, DT_CENTERED);
+                        si++;
+                    }
+                }
+            }
+        }
+    }
+
+    // ---- Window highlight preview (bottom half) ----
+    int winY = py + ph / 2 + headerH + pad;
+    int winH = ph / 2 - headerH - pad * 2;
+    int winW = pw - pad * 2;
+    int winX = px + pad;
+
+    SelectObject(hdc, hSmallFont);
+    SetTextColor(hdc, RGB(200, 200, 200));
+    RECT rcWinLabel = { winX, py + ph / 2 + pad / 2, winX + winW, py + ph / 2 + headerH };
+    DrawText(hdc, L"Window Highlight (TAB mode)", -1, &rcWinLabel, DT_LEFT | DT_SINGLELINE);
+
+    // Dark background
+    HBRUSH hWinBg = CreateSolidBrush(P.background);
+    RECT rcWin = { winX, winY, winX + winW, winY + winH };
+    FillRect(hdc, &rcWin, hWinBg);
+    DeleteObject(hWinBg);
+
+    // Fake windows
+    struct FakeWin { RECT r; const wchar_t* title; bool current; };
+    int fw1 = winW * 55 / 100, fh1 = winH * 70 / 100;
+    int fw2 = winW * 45 / 100, fh2 = winH * 60 / 100;
+    FakeWin fakes[] = {
+        { { winX + (int)(10*s), winY + (int)(24*s), winX + (int)(10*s) + fw1, winY + (int)(24*s) + fh1 }, L"[1/2] Visual Studio Code", true },
+        { { winX + winW - fw2 - (int)(10*s), winY + (int)(12*s), winX + winW - (int)(10*s), winY + (int)(12*s) + fh2 }, L"[2/2] Firefox", false }
+    };
+
+    int thick = max(2, (int)(3 * s));
+    for (const auto& fw : fakes) {
+        COLORREF borderCol = fw.current ? P.mainLabelText : P.gridLine;
+        HBRUSH hBorder = CreateSolidBrush(borderCol);
+
+        RECT e;
+        e = { fw.r.left, fw.r.top, fw.r.right, fw.r.top + thick };
+        FillRect(hdc, &e, hBorder);
+        e = { fw.r.left, fw.r.bottom - thick, fw.r.right, fw.r.bottom };
+        FillRect(hdc, &e, hBorder);
+        e = { fw.r.left, fw.r.top, fw.r.left + thick, fw.r.bottom };
+        FillRect(hdc, &e, hBorder);
+        e = { fw.r.right - thick, fw.r.top, fw.r.right, fw.r.bottom };
+        FillRect(hdc, &e, hBorder);
+        DeleteObject(hBorder);
+
+        // Label above the window
+        SIZE ts;
+        GetTextExtentPoint32(hdc, fw.title, (int)wcslen(fw.title), &ts);
+        RECT lblBg = { fw.r.left, fw.r.top - ts.cy - (int)(6*s),
+                       fw.r.left + ts.cx + (int)(8*s), fw.r.top - 2 };
+        HBRUSH hLbl = CreateSolidBrush(fw.current ? P.matchCellBg : P.cellBgEven);
+        FillRect(hdc, &lblBg, hLbl);
+        DeleteObject(hLbl);
+
+        SelectObject(hdc, hTinyFont);
+        SetTextColor(hdc, P.matchLabelText);
+        RECT lblRc = { lblBg.left + (int)(4*s), lblBg.top + (int)(2*s), lblBg.right, lblBg.bottom };
+        DrawText(hdc, fw.title, -1, &lblRc, DT_LEFT | DT_SINGLELINE | DT_NOPREFIX);
+    }
+
+    // Minimized panel preview
+    int mpW = winW / 3, mpH = winH - (int)(10*s);
+    int mpX = winX + winW - mpW - (int)(4*s), mpY = winY + (int)(4*s);
+    RECT rcPanel = { mpX, mpY, mpX + mpW, mpY + mpH };
+    HBRUSH hPanelBg = CreateSolidBrush(P.background);
+    FillRect(hdc, &rcPanel, hPanelBg);
+    DeleteObject(hPanelBg);
+
+    // Panel border
+    HBRUSH hPanelBorder = CreateSolidBrush(P.gridLine);
+    RECT be;
+    be = { rcPanel.left, rcPanel.top, rcPanel.right, rcPanel.top + 1 };
+    FillRect(hdc, &be, hPanelBorder);
+    be = { rcPanel.left, rcPanel.bottom - 1, rcPanel.right, rcPanel.bottom };
+    FillRect(hdc, &be, hPanelBorder);
+    be = { rcPanel.left, rcPanel.top, rcPanel.left + 1, rcPanel.bottom };
+    FillRect(hdc, &be, hPanelBorder);
+    be = { rcPanel.right - 1, rcPanel.top, rcPanel.right, rcPanel.bottom };
+    FillRect(hdc, &be, hPanelBorder);
+    DeleteObject(hPanelBorder);
+
+    // Panel title
+    SetTextColor(hdc, P.mainLabelText);
+    SelectObject(hdc, hTinyFont);
+    int itemH = (int)(18 * s);
+    RECT rcPanelTitle = { mpX + (int)(4*s), mpY + (int)(3*s), mpX + mpW - (int)(4*s), mpY + itemH };
+    DrawText(hdc, L"Minimized", -1, &rcPanelTitle, DT_LEFT | DT_SINGLELINE);
+
+    // Panel items
+    const wchar_t* items[] = { L"Notepad", L"Calculator", L"Slack" };
+    int itemTop = mpY + itemH + (int)(2*s);
+    for (int i = 0; i < 3; i++) {
+        int iy = itemTop + i * itemH;
+        RECT ir = { mpX + (int)(4*s), iy, mpX + mpW - (int)(4*s), iy + itemH };
+        if (i == 0) {
+            RECT hlr = { mpX + 1, iy, mpX + mpW - 1, iy + itemH };
+            HBRUSH hHl = CreateSolidBrush(P.matchSubHighlightBg);
+            FillRect(hdc, &hlr, hHl);
+            DeleteObject(hHl);
+            SetTextColor(hdc, P.matchSubHighlightText);
+        } else {
+            SetTextColor(hdc, P.subLabelText);
+        }
+        DrawText(hdc, items[i], -1, &ir, DT_LEFT | DT_SINGLELINE | DT_NOPREFIX);
+    }
+
+    // Hue value label at bottom of preview
+    SelectObject(hdc, hSmallFont);
+    SetTextColor(hdc, RGB(200, 200, 200));
+    wchar_t hueBuf[64];
+    swprintf_s(hueBuf, L"Hue: %.0f\u00b0", g_baseHue);
+    RECT rcHue = { px, py + ph - (int)(22*s), px + pw, py + ph };
+    DrawText(hdc, hueBuf, -1, &rcHue, DT_CENTER | DT_SINGLELINE);
+
+    // Cleanup (fonts are cached statics, don't delete here)
+    SelectObject(hdc, hOldFont);
+}
+
+// --- Registry persistence for user settings ---
+static const wchar_t* REG_KEY = L"Software\\KeyboardJockey";
+
+static void SaveHueToRegistry(float hue) {
+    HKEY hKey;
+    if (RegCreateKeyEx(HKEY_CURRENT_USER, REG_KEY, 0, NULL,
+            REG_OPTION_NON_VOLATILE, KEY_WRITE, NULL, &hKey, NULL) == ERROR_SUCCESS) {
+        DWORD val = (DWORD)(hue * 100.0f);  // store as fixed-point (2 decimals)
+        RegSetValueEx(hKey, L"BaseHue", 0, REG_DWORD, (BYTE*)&val, sizeof(val));
+        RegCloseKey(hKey);
+    }
+}
+
+static float LoadHueFromRegistry() {
+    HKEY hKey;
+    if (RegOpenKeyEx(HKEY_CURRENT_USER, REG_KEY, 0, KEY_READ, &hKey) == ERROR_SUCCESS) {
+        DWORD val = 0, sz = sizeof(val), type = 0;
+        if (RegQueryValueEx(hKey, L"BaseHue", NULL, &type, (BYTE*)&val, &sz) == ERROR_SUCCESS
+            && type == REG_DWORD) {
+            RegCloseKey(hKey);
+            float h = (float)val / 100.0f;
+            if (h >= 0.0f && h < 360.0f) return h;
+        } else {
+            RegCloseKey(hKey);
+        }
+    }
+    return BASE_HUE_DEFAULT;  // no saved value
+}
+
+// Palette window procedure
+LRESULT CALLBACK PaletteWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
+    switch (message) {
+    case WM_CREATE: {
+        const PalLayout& L = g_palLayout;
+        // Create OK and Cancel buttons
+        HFONT hBtnFont = CreateFont(L.fontLabel, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
+            DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
+            CLEARTYPE_NATURAL_QUALITY, DEFAULT_PITCH | FF_DONTCARE, GRID_FONT_NAME);
+        g_hBtnOk = CreateWindowEx(0, L"BUTTON", L"OK",
+            WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
+            L.btnOkX, L.btnY, L.btnW, L.btnH,
+            hWnd, (HMENU)IDC_PAL_OK, g_hInstance, NULL);
+        g_hBtnCancel = CreateWindowEx(0, L"BUTTON", L"Cancel",
+            WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
+            L.btnCancelX, L.btnY, L.btnW, L.btnH,
+            hWnd, (HMENU)IDC_PAL_CANCEL, g_hInstance, NULL);
+        SendMessage(g_hBtnOk, WM_SETFONT, (WPARAM)hBtnFont, TRUE);
+        SendMessage(g_hBtnCancel, WM_SETFONT, (WPARAM)hBtnFont, TRUE);
+        // hBtnFont intentionally not deleted — owned by the buttons for their lifetime
+        return 0;
+    }
+
+    case WM_PAINT: {
+        // The preview is drawn in g_palette, which a grid render in progress owns
+        if (g_gridBuild.State() == STAGE_RUNNING) EnsureGridReady();
+        PAINTSTRUCT ps;
+        HDC hdc = BeginPaint(hWnd, &ps);
+
+        // Double-buffer
+        RECT rc;
+        GetClientRect(hWnd, &rc);
+        int w = rc.right, h = rc.bottom;
+        HDC hdcMem = AcquireBackBuffer(g_paletteBackBuffer, hdc, w, h);
+
+        // Fill with dark gray
+        HBRUSH hBg = CreateSolidBrush(RGB(30, 30, 30));
+        FillRect(hdcMem, &rc, hBg);
+        DeleteObject(hBg);
+
+        PaintHueBar(hdcMem);
+        PaintPreview(hdcMem);
+
+        BitBlt(hdc, 0, 0, w, h, hdcMem, 0, 0, SRCCOPY);
+
+        EndPaint(hWnd, &ps);
+        return 0;
+    }
+
+    case WM_LBUTTONDOWN: {
+        const PalLayout& L = g_palLayout;
+        int mx = LOWORD(lParam), my = HIWORD(lParam);
+        if (mx >= L.hueBarX && mx <= L.hueBarX + L.hueBarW &&
+            my >= L.hueBarY - (int)(4*L.dpiScale) &&
+            my <= L.hueBarY + L.hueBarH + L.markerH + (int)(8*L.dpiScale)) {
+            g_bDraggingHue = true;
+            SetCapture(hWnd);
+            float newHue = HueBarPixelToHue(mx);
+            ApplyHue(newHue);
+            InvalidateRect(hWnd, NULL, FALSE);
+        }
+        return 0;
+    }
+
+    case WM_MOUSEMOVE: {
+        if (g_bDraggingHue) {
+            int mx = (short)LOWORD(lParam);
+            float newHue = HueBarPixelToHue(mx);
+            ApplyHue(newHue);
+            InvalidateRect(hWnd, NULL, FALSE);
+        }
+        return 0;
+    }
+
+    case WM_LBUTTONUP:
+        if (g_bDraggingHue) {
+            g_bDraggingHue = false;
+            ReleaseCapture();
+            FlushHueRecolor();  // Land on the released hue without waiting a tick
+        }
+        return 0;
+
+    case WM_COMMAND:
+        switch (LOWORD(wParam)) {
+        case IDC_PAL_OK:
+            // Accept — save to registry and close
+            SaveHueToRegistry(g_baseHue);
+            FlushHueRecolor();
+            DestroyWindow(hWnd);
+            break;
+        case IDC_PAL_CANCEL:
+            // Revert to the hue we had when the dialog opened
+            ApplyHue(g_hueBeforeEdit);
+            FlushHueRecolor();
+            DestroyWindow(hWnd);
+            break;
+        }
+        return 0;
+
+    case WM_CLOSE:
+        // Closing via X button = Cancel
+        ApplyHue(g_hueBeforeEdit);
+        FlushHueRecolor();
+        DestroyWindow(hWnd);
+        return 0;
+
+    case WM_DESTROY:
+        g_hBtnOk = NULL;
+        g_hBtnCancel = NULL;
+        g_hPaletteWnd = NULL;
+        if (g_hHueBarBitmap) { DeleteObject(g_hHueBarBitmap); g_hHueBarBitmap = NULL; }
+        ReleaseBackBuffer(g_paletteBackBuffer);
+        return 0;
+
+    default:
+        return DefWindowProc(hWnd, message, wParam, lParam);
+    }
+    return 0;
+}
+
+void ShowPaletteWindow() {
+    // If already open, bring to front
+    if (g_hPaletteWnd && IsWindow(g_hPaletteWnd)) {
+        SetForegroundWindow(g_hPaletteWnd);
+        return;
+    }
+
+    // Save current hue for Cancel
+    g_hueBeforeEdit = g_baseHue;
+
+    // Compute DPI-aware layout
+    g_palLayout = ComputePalLayout();
+    const PalLayout& L = g_palLayout;
+
+    // Build cached hue bar bitmap
+    BuildHueBarBitmap();
+
+    // Compute outer window size from desired client area
+    DWORD style = WS_OVERLAPPED | WS_CAPTION | WS_SYSMENU | WS_CLIPCHILDREN;
+    RECT rcDesired = { 0, 0, L.winW, L.winH };
+    AdjustWindowRectEx(&rcDesired, style, FALSE, WS_EX_APPWINDOW);
+    int outerW = rcDesired.right - rcDesired.left;
+    int outerH = rcDesired.bottom - rcDesired.top;
+
+    // Center on primary monitor
+    int sx = GetSystemMetrics(SM_CXSCREEN);
+    int sy = GetSystemMetrics(SM_CYSCREEN);
+    int wx = (sx - outerW) / 2;
+    int wy = (sy - outerH) / 2;
+
+    g_hPaletteWnd = CreateWindowEx(
+        WS_EX_APPWINDOW,
+        L"KeyboardJockeyPalette",
+        L"Keyboard Jockey \u2013 Palette",
+        style,
+        wx, wy, outerW, outerH,
+        NULL, NULL, g_hInstance, NULL
+    );
+
+    ShowWindow(g_hPaletteWnd, SW_SHOW);
+    UpdateWindow(g_hPaletteWnd);
+}
+
+// Show context menu
+void ShowContextMenu(HWND hWnd) {
+    POINT pt;
+    GetCursorPos(&pt);
+    
+    HMENU hMenu = CreatePopupMenu();
+    AppendMenu(hMenu, MF_STRING, IDM_SHOW, L"Show Grid (Ctrl+Alt+M)");
+    AppendMenu(hMenu, MF_STRING, IDM_PALETTE, L"Palette...");
+    AppendMenu(hMenu, MF_STRING, IDM_EXPORT_LATENCY, L"Export Latency Stats...");
+    AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
+    AppendMenu(hMenu, MF_STRING, IDM_EXIT, L"Exit");
+    
+    SetForegroundWindow(hWnd);
+    TrackPopupMenu(hMenu, TPM_RIGHTBUTTON, pt.x, pt.y, 0, hWnd, NULL);
+    DestroyMenu(hMenu);
+}
+
+// Overlay window procedure
+LRESULT CALLBACK OverlayWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
+    switch (message) {
+    case WM_DPICHANGED:
+        OnDisplayChange();  // Keeps the overlay covering the virtual screen
+        return 0;
+    
+    case WM_ERASEBKGND:
+        return 1;  // Skip erase — we paint the full surface ourselves
+    
+    case WM_SETCURSOR:
+        // Show normal arrow cursor during mouse-move and scroll modes instead of cross
+        if (g_bMouseMoveMode || g_bScrollMode) {
+            SetCursor(LoadCursor(NULL, IDC_ARROW));
+            return TRUE;
+        }
+        return DefWindowProc(hWnd, message, wParam, lParam);
+    
+    case WM_PAINT: {
+        // PaintGrid reads the tiles and cells. ShowGrid readies them before the
+        // overlay is shown; a paint that arrives any other way waits here.
+        if (g_gridBuild.State() == STAGE_RUNNING) EnsureGridReady();
+        LatencyScope timing(g_paintLatency);
+        MarkStartup(STARTUP_FIRST_PAINT);
+        PAINTSTRUCT ps;
+        HDC hdc = BeginPaint(hWnd, &ps);
+        
+        // Double-buffer: paint to the persistent off-screen bitmap, then blit
+        RECT rc;
+        GetClientRect(hWnd, &rc);
+        int w = rc.right - rc.left;
+        int h = rc.bottom - rc.top;
+        HDC hdcMem = AcquireBackBuffer(g_overlayBackBuffer, hdc, w, h);
+        
+        PaintGrid(hdcMem, ps.rcPaint);
+        
+        BitBlt(hdc, ps.rcPaint.left, ps.rcPaint.top,
+               ps.rcPaint.right - ps.rcPaint.left, ps.rcPaint.bottom - ps.rcPaint.top,
+               hdcMem, ps.rcPaint.left, ps.rcPaint.top, SRCCOPY);
+        
+        EndPaint(hWnd, &ps);
+        return 0;
+    }
+    
+    case WM_KEYDOWN:
+    case WM_SYSKEYDOWN: {
+        // In scroll mode, only PgUp/PgDn/Escape are allowed; anything else exits
+        if (g_bScrollMode && wParam != VK_PRIOR && wParam != VK_NEXT && wParam != VK_ESCAPE) {
+            ExitScrollMode();
+            return 0;
+        }
+        
+        // In TAB/text mode, only allow relevant keys; block grid navigation
+        bool inTabMode = (g_highlightIndex >= 0 || g_bTabTextMode || !g_tabSearchStr.empty());
+        if (inTabMode) {
+            switch (wParam) {
+            case VK_ESCAPE:
+                HideGrid();
+                return 0;
+            case VK_RETURN: {
+                // Activate highlighted window (or single search match)
+                int totalNormal = (int)g_appWindows.size();
+                HWND targetWnd = NULL;
+                if (g_highlightIndex >= 0 && g_highlightIndex < totalNormal) {
+                    targetWnd = g_allAppWindows[g_appWindows[g_highlightIndex]].hwnd;
+                } else if (g_highlightIndex >= totalNormal && (g_highlightIndex - totalNormal) < (int)g_minimizedWindows.size()) {
+                    targetWnd = g_allMinimizedWindows[g_minimizedWindows[g_highlightIndex - totalNormal]].hwnd;
+                }
+                if (targetWnd) {
+                    HideGrid();
+                    Sleep(ACTIVATION_DELAY_MS);
+                    SetForegroundWindow(targetWnd);
+                    if (IsIconic(targetWnd)) {
+                        ShowWindow(targetWnd, SW_RESTORE);
+                    }
+                }
+                }
+                return 0;
+            case VK_TAB: {
+                // If in text search mode, TAB exits back to normal cycling
+                if (g_bTabTextMode || !g_tabSearchStr.empty()) {
+                    g_bTabTextMode = false;
+                    g_tabSearchStr.clear();
+                    // Restore to visible-only windows for normal cycling; hide minimized panel
+                    ResetWindowLists(false, false);
+                    if (!g_appWindows.empty()) g_highlightIndex = 0;
+                    else g_highlightIndex = -1;
+                    SetLayeredWindowAttributes(g_hOverlayWnd, g_palette.background, 0, LWA_COLORKEY);
+                    KillTimer(hWnd, TIMER_ID_TAB_TEXT);
+                    SetTimer(hWnd, TIMER_ID_TAB_TEXT, TAB_TEXT_TIMEOUT_MS, NULL);
+                    InvalidateRect(hWnd, NULL, TRUE);
+                } else {
+                    bool shiftTab = (GetKeyState(VK_SHIFT) & 0x8000) != 0;
+                    CycleHighlight(!shiftTab);
+                }
+                return 0;
+            }
+            case VK_BACK:
+                if (!g_tabSearchStr.empty()) {
+                    g_tabSearchStr.pop_back();
+                    if (g_tabSearchStr.empty()) {
+                        ResetWindowLists(g_bTabTextMode, true);
+                        if (!g_appWindows.empty()) g_highlightIndex = 0;
+                        else if (!g_minimizedWindows.empty()) g_highlightIndex = 0;
+                        else g_highlightIndex = -1;
+                    } else {
+                        FilterAppWindowsBySearch();
+                    }
+                    InvalidateRect(hWnd, NULL, TRUE);
+                }
+                return 0;
+            default:
+                // Block all other keys (arrows, space, etc.) in TAB mode
+                return 0;
+            }
+        }
+        
+        // Check modifiers for movement amount
+        bool shiftHeld = (GetKeyState(VK_SHIFT) & 0x8000) != 0;
+        bool ctrlHeld = (GetKeyState(VK_CONTROL) & 0x8000) != 0;
+        int moveAmount = shiftHeld ? 1 : (ctrlHeld ? 50 : 10);
+        
+        switch (wParam) {
+        case VK_ESCAPE:
+            HideGrid();
+            break;
+        case VK_LEFT:
+            MoveMouseByArrowKey(-moveAmount, 0, moveAmount);
+            break;
+        case VK_RIGHT:
+            MoveMouseByArrowKey(moveAmount, 0, moveAmount);
+            break;
+        case VK_UP:
+            MoveMouseByArrowKey(0, -moveAmount, moveAmount);
+            break;
+        case VK_DOWN:
+            MoveMouseByArrowKey(0, moveAmount, moveAmount);
+            break;
+        case VK_SHIFT:
+            // Make UI subtle when Shift is pressed (skip in highlight mode)
+            if (g_highlightIndex < 0) {
+                BYTE peekAlpha = g_bMouseMoveMode ? MOUSE_MOVE_ALPHA : SHIFT_PEEK_ALPHA;
+                SetLayeredWindowAttributes(g_hOverlayWnd, 0, peekAlpha, LWA_ALPHA);
+            }
+            break;
+        case VK_SPACE: {
+            // Hide the cursor and close the grid
+            HideGrid();
+            HideCursor();
+            break;
+        }
+        case VK_RETURN: {
+            // If in window highlight mode, activate the highlighted window
+            HWND targetWnd2 = NULL;
+            int totalNormal2 = (int)g_appWindows.size();
+            if (g_highlightIndex >= 0 && g_highlightIndex < totalNormal2) {
+                targetWnd2 = g_allAppWindows[g_appWindows[g_highlightIndex]].hwnd;
+            } else if (g_highlightIndex >= totalNormal2 && (g_highlightIndex - totalNormal2) < (int)g_minimizedWindows.size()) {
+                targetWnd2 = g_allMinimizedWindows[g_minimizedWindows[g_highlightIndex - totalNormal2]].hwnd;
+            }
+            if (targetWnd2) {
+                HideGrid();
+                Sleep(ACTIVATION_DELAY_MS);
+                // Activate the window
+                SetForegroundWindow(targetWnd2);
+                // If minimized, restore it
+                if (IsIconic(targetWnd2)) {
+                    ShowWindow(targetWnd2, SW_RESTORE);
+                }
+                break;
+            }
+            // If a complete label is typed, move to center before clicking
+            if (!g_typedChars.empty()) {
+                int cellIdx = FindCellByLabel(g_typedChars.c_str(), (int)g_typedChars.length());
+                if (cellIdx >= 0) {
+                    MoveMouse(g_cells.center[cellIdx]);
+                }
+            }
+            // Capture modifiers before hiding overlay/focus changes
+            bool altHeld = (GetKeyState(VK_MENU) & 0x8000) != 0;
+            bool ctrlHeldForClick = (GetKeyState(VK_CONTROL) & 0x8000) != 0;
+            HideGrid();
+            // Small delay to let grid disappear
+            Sleep(ACTIVATION_DELAY_MS);
+            // Check modifiers: Alt=right-click, Ctrl=double-click
+            if (altHeld) {
+                SendClick(true);    // Right click
+            } else if (ctrlHeldForClick) {
+                SendDoubleClick();  // Double click
+            } else {
+                SendClick(false);   // Left click
+            }
+            break;
+        }
+        case VK_TAB: {
+            bool shiftTab = (GetKeyState(VK_SHIFT) & 0x8000) != 0;
+            CycleHighlight(!shiftTab);
+            break;
+        }
+        case VK_BACK:
+            // In TAB search mode, delete from search string
+            if (g_highlightIndex >= 0 && !g_tabSearchStr.empty()) {
+                g_tabSearchStr.pop_back();
+                if (g_tabSearchStr.empty()) {
+                    // Restore to cycling mode with all visible windows
+                    ResetWindowLists(false, true);
+                    if (!g_appWindows.empty()) g_highlightIndex = 0;
+                    else if (!g_minimizedWindows.empty()) g_highlightIndex = 0;
+                    else g_highlightIndex = -1;
+                } else {
+                    FilterAppWindowsBySearch();
+                }
+                InvalidateRect(hWnd, NULL, TRUE);
+            } else if (!g_zoomRegions.empty()) {
+                ZoomOut();
+            } else if (!g_typedChars.empty()) {
+                g_typedChars.pop_back();
+                UpdateCellStates();
+            }
+            break;
+        case VK_PRIOR:   // PgUp
+        case VK_NEXT: {  // PgDn
+            // Enter scroll mode: make overlay invisible, send wheel to window under cursor
+            if (!g_bScrollMode) {
+                g_bScrollMode = true;
+                // Make overlay visually transparent via color key
+                SetLayeredWindowAttributes(g_hOverlayWnd, g_palette.background, 0, LWA_COLORKEY);
+                InvalidateRect(g_hOverlayWnd, NULL, TRUE);
+                UpdateWindow(g_hOverlayWnd);
+                SetCursor(LoadCursor(NULL, IDC_ARROW));
+                // Make overlay transparent to ALL input (mouse clicks, wheel, etc.)
+                LONG_PTR exStyle = GetWindowLongPtr(g_hOverlayWnd, GWL_EXSTYLE);
+                SetWindowLongPtr(g_hOverlayWnd, GWL_EXSTYLE, exStyle | WS_EX_TRANSPARENT);
+                // Have the hook thread watch for mouse movement
+                RequestMouseHook(HOOK_MSG_SCROLL_MOUSE, true);
+            }
+            // Simulate mouse wheel scroll (passes through to window under cursor)
+            {
+                INPUT input = {};
+                input.type = INPUT_MOUSE;
+                input.mi.dwFlags = MOUSEEVENTF_WHEEL;
+                input.mi.mouseData = (wParam == VK_PRIOR) ? (DWORD)(3 * WHEEL_DELTA) : (DWORD)(-3 * WHEEL_DELTA);
+                SendInput(1, &input, sizeof(INPUT));
+            }
+            break;
+        }
+        }
+        return 0;
+    }
+    
+    case WM_CHAR: {
+        wchar_t ch = (wchar_t)wParam;
+        // Any typing in scroll mode exits it
+        if (g_bScrollMode) {
+            ExitScrollMode();
+            return 0;
+        }
+        if (ch == L'*' && !g_bTabTextMode) {
+            // Enter "Select Window By Name" mode from grid or TAB mode
+            EnumerateAppWindows();
+            g_bTabTextMode = true;
+            g_tabSearchStr.clear();
+            KillTimer(hWnd, TIMER_ID_TAB_TEXT);
+            ResetWindowLists(true, true);
+            if (!g_appWindows.empty()) g_highlightIndex = 0;
+            else if (!g_minimizedWindows.empty()) g_highlightIndex = 0;
+            // Combine color-key + alpha: background pixels = invisible, panel = semi-transparent
+            SetLayeredWindowAttributes(g_hOverlayWnd, g_palette.background, GRID_ALPHA, LWA_COLORKEY | LWA_ALPHA);
+            InvalidateRect(hWnd, NULL, TRUE);
+            return 0;
+        }
+        if (ch >= L'a' && ch <= L'z') {
+            // In TAB highlight/text mode, typing filters windows by substring
+            if (g_highlightIndex >= 0 || g_bTabTextMode || !g_tabSearchStr.empty()) {
+                g_tabSearchStr += ch;
+                FilterAppWindowsBySearch();
+                // Reset the tab text timeout timer (don't use TIMER_ID_RESET for search)
+                KillTimer(hWnd, TIMER_ID_TAB_TEXT);
+                SetTimer(hWnd, TIMER_ID_TAB_TEXT, TAB_TEXT_TIMEOUT_MS, NULL);
+                InvalidateRect(hWnd, NULL, TRUE);
+            } else {
+                ProcessTypedChar(ch);
+            }
+        }
+        return 0;
+    }
+    
+    case WM_KEYUP: {
+        // Restore UI when Shift is released (skip in highlight mode)
+        if (wParam == VK_SHIFT && g_highlightIndex < 0) {
+            // Restore to mouse move mode transparency or full opacity
+            if (g_bMouseMoveMode) {
+                SetLayeredWindowAttributes(g_hOverlayWnd, 0, MOUSE_MOVE_ALPHA, LWA_ALPHA);
+            } else {
+                SetLayeredWindowAttributes(g_hOverlayWnd, 0, GRID_ALPHA, LWA_ALPHA);
+            }
+        }
+        return 0;
+    }
+    
+    case WM_KILLFOCUS:
+        // Hide grid when losing focus
+        HideGrid();
+        return 0;
+    
+    case WM_TIMER:
+        // Set only while the grid is shown, but both reach the cells or the palette
+        if (g_gridBuild.State() == STAGE_RUNNING) EnsureGridReady();
+        if (wParam == TIMER_ID_RESET) {
+            KillTimer(hWnd, TIMER_ID_RESET);
+            // In TAB search mode, clear search but stay in highlight mode
+            if ((g_highlightIndex >= 0 || g_bTabTextMode) && !g_tabSearchStr.empty()) {
+                g_tabSearchStr.clear();
+                // Restore all windows (if in text mode) or visible-area ones
+                ResetWindowLists(g_bTabTextMode, true);
+                if (!g_appWindows.empty()) g_highlightIndex = 0;
+                else if (!g_minimizedWindows.empty()) g_highlightIndex = 0;
+                else g_highlightIndex = -1;
+                InvalidateRect(hWnd, NULL, TRUE);
+            } else if (!g_typedChars.empty()) {
+                EndZoom();
+                g_typedChars.clear();
+                UpdateCellStates();
+            }
+        }
+        else if (wParam == TIMER_ID_TAB_TEXT) {
+            KillTimer(hWnd, TIMER_ID_TAB_TEXT);
+            // Enter "select by text" mode - show ALL windows highlighted
+            if (g_highlightIndex >= 0 && !g_bTabTextMode) {
+                g_bTabTextMode = true;
+                g_tabSearchStr.clear();
+                // Switch to all windows (including fully occluded)
+                ResetWindowLists(true, true);
+                if (!g_appWindows.empty()) g_highlightIndex = 0;
+                else if (!g_minimizedWindows.empty()) g_highlightIndex = 0;
+                // Combine color-key + alpha: background pixels = invisible, panel = semi-transparent
+                SetLayeredWindowAttributes(g_hOverlayWnd, g_palette.background, GRID_ALPHA, LWA_COLORKEY | LWA_ALPHA);
+                InvalidateRect(hWnd, NULL, TRUE);
+            }
+        }
+        return 0;
+    
+    default:
+        return DefWindowProc(hWnd, message, wParam, lParam);
+    }
+}
+
+// Main window procedure
+LRESULT CALLBACK MainWndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam) {
+    switch (message) {
+    case WM_CREATE:
+        CreateTrayIcon(hWnd);
+        MarkStartup(STARTUP_TRAY_ICON);
+        // Register global hotkey: Ctrl+Alt+M
+        if (!RegisterHotKey(hWnd, HOTKEY_ID_SHOW_GRID, MOD_CONTROL | MOD_ALT, 'M')) {
+            MessageBox(hWnd, L"Failed to register hotkey Ctrl+Alt+M", L"Error", MB_ICONERROR);
+        }
+        // Build the grid once startup has settled (or on first use)
+        SetTimer(hWnd, TIMER_ID_BUILD_GRID, GRID_BUILD_DELAY_MS, NULL);
+        // Install global keyboard hook for cursor hiding while typing
+        StartCursorWorker();
+        StartInputHooks();
+        // Keep a window list ready for Tab mode
+        StartWindowInventory();
+        return 0;
+    
+    case WM_HOOKEVENT:
+        ProcessHookEvents();
+        return 0;
+    
+    case WM_TIMER:
+        // Only FlushHueRecolor reaches grid data, and it waits for the worker
+        // itself; the click history is the UI thread's alone
+        if (wParam == TIMER_ID_BUILD_GRID) BeginGridBuild();
+        else if (wParam == TIMER_ID_RECOLOR) FlushHueRecolor();
+        else if (wParam == TIMER_ID_SAVE_CLICKS) SaveClickHistory();
+        return 0;
+    
+    case WM_SETTINGCHANGE:
+        // The cursor scheme or size may have changed; the worker picks it
+        // up once the system cursors are back
+        g_cursorSettingsChanged = true;
+        if (g_hCursorWake) SetEvent(g_hCursorWake);
+        return 0;
+    
+    case WM_ENDSESSION:
+        // Logoff or shutdown: the process ends without WM_DESTROY
+        if (wParam) SaveClickHistory();
+        return 0;
+    
+    case WM_GRIDREADY:
+        EnsureGridReady();  // Joins the finished worker
+        return 0;
+    
+    case WM_FOREGROUNDAPP:
+        OnForegroundAppChange();
+        return 0;
+    
+    case WM_DISPLAYCHANGE:
+    case WM_DPICHANGED:
+        OnDisplayChange();
+        return 0;
+    
+    case WM_HOTKEY:
+        if (wParam == HOTKEY_ID_SHOW_GRID) {
+            if (g_bGridVisible) {
+                HideGrid();
+            } else {
+                ShowGrid();
+            }
+        }
+        return 0;
+    
+    case WM_TRAYICON:
+        switch (LOWORD(lParam)) {
+        case WM_RBUTTONUP:
+            ShowContextMenu(hWnd);
+            break;
+        case WM_LBUTTONDBLCLK:
+            ShowGrid();
+            break;
+        }
+        return 0;
+    
+    case WM_COMMAND:
+        switch (LOWORD(wParam)) {
+        case IDM_EXIT:
+            DestroyWindow(hWnd);
+            break;
+        case IDM_SHOW:
+            ShowGrid();
+            break;
+        case IDM_PALETTE:
+            ShowPaletteWindow();
+            break;
+        case IDM_EXPORT_LATENCY:
+            ExportTelemetry(hWnd);
+            break;
+        }
+        return 0;
+    
+    case WM_DESTROY:
+        UnregisterHotKey(hWnd, HOTKEY_ID_SHOW_GRID);
+        RemoveTrayIcon();
+        if (g_gridBuild.State() == STAGE_RUNNING) EnsureGridReady();
+        ReleaseGridTiles();
+        ReleaseCellAtlases();
+        SaveClickHistory();
+        ReleaseBackBuffer(g_overlayBackBuffer);
+        StopInputHooks();  // Remove all low-level hooks
+        ReportLatency();
+        StopWindowInventory();
+        RestoreCursor();  // Make sure cursor is restored on exit
+        StopCursorWorker();
+        if (g_hOverlayWnd) {
+            DestroyWindow(g_hOverlayWnd);
+        }
+        PostQuitMessage(0);
+        return 0;
+    
+    default:
+        return DefWindowProc(hWnd, message, wParam, lParam);
+    }
+}
+
+// Entry point
+int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow) {
+    g_uiThreadId = GetCurrentThreadId();
+    
+    // Enable per-monitor DPI awareness for correct coordinates on mixed-DPI setups
+    SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
+    
+    LARGE_INTEGER qpcFreq;
+    QueryPerformanceFrequency(&qpcFreq);
+    g_qpcFrequency = qpcFreq.QuadPart;
+    g_startupQpc = QpcNow();
+    
+    g_hInstance = hInstance;
+
+    // Load saved hue from registry and apply it
+    g_baseHue = LoadHueFromRegistry();
+    LoadClickHistory();
+    g_palette = GeneratePalette(g_baseHue);
+    
+    // Save a copy of the default arrow cursor before we ever modify system cursors
+    HCURSOR hArrow = LoadCursor(NULL, IDC_ARROW);
+    if (hArrow) {
+        g_hSavedArrow = CopyCursor(hArrow);
+    }
+    
+    // Register cleanup handlers for crash/force-kill scenarios
+    atexit(ForceRestoreCursors);
+    SetUnhandledExceptionFilter(CrashHandler);
+    
+    // Register main window class
+    WNDCLASSEX wcMain = {};
+    wcMain.cbSize = sizeof(WNDCLASSEX);
+    wcMain.lpfnWndProc = MainWndProc;
+    wcMain.hInstance = hInstance;
+    wcMain.hIcon = LoadIcon(hInstance, MAKEINTRESOURCE(IDI_KEYBOARDJOCKEY));
+    wcMain.hCursor = LoadCursor(NULL, IDC_ARROW);
+    wcMain.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
+    wcMain.lpszClassName = L"KeyboardJockeyMain";
+    wcMain.hIconSm = LoadIcon(hInstance, MAKEINTRESOURCE(IDI_KEYBOARDJOCKEY));
+    
+    if (!RegisterClassEx(&wcMain)) {
+        MessageBox(NULL, L"Failed to register main window class", L"Error", MB_ICONERROR);
+        return 1;
+    }
+    
+    // Register overlay window class
+    WNDCLASSEX wcOverlay = {};
+    wcOverlay.cbSize = sizeof(WNDCLASSEX);
+    wcOverlay.lpfnWndProc = OverlayWndProc;
+    wcOverlay.hInstance = hInstance;
+    wcOverlay.hCursor = LoadCursor(NULL, IDC_CROSS);
+    wcOverlay.hbrBackground = NULL;
+    wcOverlay.lpszClassName = L"KeyboardJockeyOverlay";
+    
+    if (!RegisterClassEx(&wcOverlay)) {
+        MessageBox(NULL, L"Failed to register overlay window class", L"Error", MB_ICONERROR);
+        return 1;
+    }
+    
+    // Register palette picker window class
+    WNDCLASSEX wcPalette = {};
+    wcPalette.cbSize = sizeof(WNDCLASSEX);
+    wcPalette.lpfnWndProc = PaletteWndProc;
+    wcPalette.hInstance = hInstance;
+    wcPalette.hCursor = LoadCursor(NULL, IDC_ARROW);
+    wcPalette.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
+    wcPalette.lpszClassName = L"KeyboardJockeyPalette";
+    wcPalette.hIcon = LoadIcon(hInstance, MAKEINTRESOURCE(IDI_KEYBOARDJOCKEY));
+    wcPalette.hIconSm = LoadIcon(hInstance, MAKEINTRESOURCE(IDI_KEYBOARDJOCKEY));
+    RegisterClassEx(&wcPalette);
+    
+    // Create main window (hidden)
+    g_hMainWnd = CreateWindowEx(
+        0,
+        L"KeyboardJockeyMain",
+        L"Keyboard Jockey",
+        WS_OVERLAPPEDWINDOW,
+        CW_USEDEFAULT, CW_USEDEFAULT, 400, 300,
+        NULL, NULL, hInstance, NULL
+    );
+    
+    if (!g_hMainWnd) {
+        MessageBox(NULL, L"Failed to create main window", L"Error", MB_ICONERROR);
+        return 1;
+    }
+    
+    // Don't show the main window - it minimizes to tray immediately
+    // ShowWindow(g_hMainWnd, SW_HIDE);
+    
+    // Message loop
+    MSG msg;
+    while (GetMessage(&msg, NULL, 0, 0)) {
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
+    
+    return (int)msg.wParam;
+}
@@ -0,0 +1,44 @@
+// Bench.h - Timing helpers for the core benchmarks
+// Every benchmark takes --quick, which shrinks its workload so ctest can run
+// it as a smoke test; without it the numbers are worth reading.
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+inline bool BenchQuick(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) return true;
+    }
+    return false;
+}
+
+inline double BenchNowNs() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Keep value (and the work that produced it) from being optimized away
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// Best-of-reps wall time of fn(), in nanoseconds
+template <typename Fn>
+inline double BenchBestNs(int reps, Fn fn) {
+    double best = 1e300;
+    for (int r = 0; r < reps; r++) {
+        double t0 = BenchNowNs();
+        fn();
+        double t = BenchNowNs() - t0;
+        if (t < best) best = t;
+    }
+    return best;
+}
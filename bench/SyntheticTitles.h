@@ -0,0 +1,43 @@
+// SyntheticTitles.h - Window titles for the search benchmarks: documents,
+// browser tabs, terminals and editors whose titles share long prefixes and
+// suffixes, the way a busy desktop's do
+#pragma once
+
+#include <random>
+#include <string>
+#include <vector>
+
+inline std::vector<std::u16string> SyntheticTitles(int count, unsigned seed) {
+    static const char16_t* const words[] = {
+        u"Report", u"Quarterly", u"Budget", u"Draft", u"Notes", u"Meeting", u"Design", u"Review",
+        u"Keyboard", u"Jockey", u"Grid", u"Overlay", u"Search", u"Index", u"Latency", u"Palette",
+        u"README.md", u"main.cpp", u"CMakeLists.txt", u"issue", u"Pull", u"Request", u"Build",
+        u"Inbox", u"Calendar", u"Weather", u"News", u"Video", u"Music", u"Photos", u"Settings",
+    };
+    static const char16_t* const apps[] = {
+        u" - Google Chrome", u" - Microsoft Edge", u" - Visual Studio Code", u" - Notepad",
+        u" - Microsoft Word", u" - File Explorer", u" - Windows PowerShell", u" - Outlook",
+    };
+    const int wordCount = sizeof(words) / sizeof(words[0]), appCount = sizeof(apps) / sizeof(apps[0]);
+    std::mt19937 rng(seed);
+    std::vector<std::u16string> titles(count);
+    for (std::u16string& t : titles) {
+        int n = 1 + (int)(rng() % 5);
+        for (int k = 0; k < n; k++) {
+            if (k) t += rng() % 4 ? u" " : u" | ";
+            t += words[rng() % wordCount];
+        }
+        if (rng() % 3 == 0) t += u" (" + std::u16string(1, (char16_t)(u'0' + rng() % 10)) + u")";
+        t += apps[rng() % appCount];
+    }
+    return titles;
+}
+
+// Simple case folding for the ASCII titles above
+inline std::u16string FoldTitle(const std::u16string& title) {
+    std::u16string folded = title;
+    for (char16_t& c : folded) {
+        if (c >= u'A' && c <= u'Z') c = (char16_t)(c - u'A' + u'a');
+    }
+    return folded;
+}
@@ -0,0 +1,65 @@
+// Typing highlight repaint: cells and pixels invalidated per keystroke, and
+// the time to diff the states, while typing labels and a sub-cell letter on
+// three 4K monitors (at 100% and at 150% scaling). The prefix only dims the
+// other monitors (2/3 of the screen here, nothing on one monitor), the first
+// code letter touches every cell of the chosen one (1/3), and the letters
+// after it only the cells that stop matching (about 6% and 1% at 100%).
+#include "core/CellDiff.h"
+#include "tests/TestGrid.h"
+#include "bench/Bench.h"
+
+#include <random>
+#include <string>
+
+int main(int argc, char** argv) {
+    bool quick = BenchQuick(argc, argv);
+    const int targets = quick ? 20 : 500;
+    for (int dpi : { 96, 144 }) {
+        std::vector<TestMonitor> monitors;
+        for (int m = 0; m < 3; m++) monitors.push_back({ { m * 3840, 0, (m + 1) * 3840, 2160 }, dpi });
+        TestCells cells = {};
+        BuildTestGrid(monitors, cells);
+        const double screen = 3.0 * 3840 * 2160;
+        std::printf("3x4K at %d%%, %d cells\n", dpi * 100 / 96, cells.count);
+        std::printf("%-10s %10s %12s %10s %10s\n", "keystroke", "cells", "pixels", "screen %", "diff us");
+
+        // Per keystroke position: 0 = monitor prefix, then the code letters,
+        // then the sub-cell letter
+        const int positions = MAX_LABEL_LETTERS + 1;
+        double cellsAt[positions] = {}, pixelsAt[positions] = {}, nsAt[positions] = {};
+        int countAt[positions] = {};
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> pick(0, cells.count - 1);
+        for (int t = 0; t < targets; t++) {
+            UpdateTypedCellStates(cells, L"", [](const TestRect&) {});
+            wchar_t label[MAX_LABEL_LETTERS + 1];
+            FormatLabel(cells.label[pick(rng)], label);
+            std::wstring typed = std::wstring(label) + L'c';
+            for (size_t k = 1; k <= typed.size(); k++) {
+                std::wstring prefix = typed.substr(0, k);
+                long long pixels = 0;
+                double t0 = BenchNowNs();
+                int changed = UpdateTypedCellStates(cells, prefix, [&](const TestRect& rc) {
+                    pixels += (long long)(rc.right - rc.left) * (rc.bottom - rc.top);
+                });
+                double ns = BenchNowNs() - t0;
+                int at = k == typed.size() ? positions - 1 : (int)k - 1;
+                cellsAt[at] += changed;
+                pixelsAt[at] += (double)pixels;
+                nsAt[at] += ns;
+                countAt[at]++;
+            }
+        }
+        for (int at = 0; at < positions; at++) {
+            if (!countAt[at]) continue;
+            char name[16];
+            if (at == 0) snprintf(name, sizeof(name), "prefix");
+            else if (at == positions - 1) snprintf(name, sizeof(name), "sub-cell");
+            else snprintf(name, sizeof(name), "code %d", at);
+            double n = countAt[at];
+            std::printf("%-10s %10.1f %12.0f %10.2f %10.2f\n", name, cellsAt[at] / n, pixelsAt[at] / n,
+                        100.0 * pixelsAt[at] / n / screen, nsAt[at] / n / 1000);
+        }
+    }
+    return 0;
+}
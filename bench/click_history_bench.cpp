@@ -0,0 +1,96 @@
+// Click history: keystrokes per click when synthetic click traces are
+// replayed through the history (codes re-ranked on every app switch) against
+// codes in plain cell order, for each thing the history can do, on a 4K and
+// a 1080p monitor; then the time to record a click and to rank a monitor,
+// and the memory and file size the history takes
+#include "core/ClickHistory.h"
+#include "bench/Bench.h"
+#include "tests/ClickTrace.h"
+
+#include <string>
+#include <vector>
+
+static const char* const POLICY_NAMES[CLICK_POLICY_COUNT] = {
+    "cell order", "ranked, all apps", "ranked per app", "per app + sub-cell",
+};
+
+static size_t ModelBytes(const ClickModel& model) {
+    size_t bytes = sizeof(model) + model.histories.capacity() * sizeof(ClickHistory);
+    for (const ClickHistory& h : model.histories) bytes += h.cells.capacity() * sizeof(ClickCell);
+    return bytes;
+}
+
+int main(int argc, char** argv) {
+    bool quick = BenchQuick(argc, argv);
+    struct Setup {
+        const char* name;
+        int width, height, dpi;
+        ClickTraceSpec spec;
+    };
+    const int clicks = quick ? 4000 : 40000;
+    const Setup setups[] = {
+        { "4K, 8 apps", 3840, 2160, 96, { clicks, 8, 24, 6, 0.15f, 0.3f, 8, 1 } },
+        { "4K, 3 apps, focused", 3840, 2160, 96, { clicks, 3, 12, 4, 0.05f, 0.2f, 20, 2 } },
+        { "4K, 12 apps, scattered", 3840, 2160, 96, { clicks, 12, 60, 8, 0.35f, 0.5f, 4, 3 } },
+        { "1080p, 8 apps", 1920, 1080, 96, { clicks, 8, 24, 6, 0.15f, 0.3f, 8, 4 } },
+    };
+    std::vector<std::wstring> apps;
+    for (int a = 0; a < 12; a++) apps.push_back(L"app" + std::to_wstring(a) + L".exe");
+
+    std::printf("%-24s %-20s %10s %10s %8s\n", "trace", "codes", "keys/click", "sub keys", "saved");
+    for (const Setup& s : setups) {
+        GridSize size = PlanGridSize(s.width, s.height, s.dpi);
+        TraceMonitor mon = { L"\\\\.\\DISPLAY1", size.cols, size.rows };
+        std::vector<TraceClick> trace = SyntheticClickTrace(s.spec, mon);
+        double baseline = 0.0;
+        for (int policy = 0; policy < CLICK_POLICY_COUNT; policy++) {
+            ClickModel model;
+            ClickReplay r = ReplayClickTrace(trace, mon, apps, (ClickPolicy)policy, model);
+            if (policy == CLICKS_IGNORED) baseline = r.KeysPerClick();
+            std::printf("%-24s %-20s %10.3f %10.3f %7.1f%%\n", policy ? "" : s.name, POLICY_NAMES[policy],
+                        r.KeysPerClick(), (double)r.subLetters / r.clicks,
+                        100.0 * (1.0 - r.KeysPerClick() / baseline));
+        }
+    }
+
+    // Cost of the history itself, filled to its bounds: every history of
+    // a 4K layout holding CLICK_CELLS_PER_HISTORY cells
+    GridSize size = PlanGridSize(3840, 2160, 96);
+    TraceMonitor mon = { L"\\\\.\\DISPLAY1", size.cols, size.rows };
+    ClickModel model;
+    std::mt19937 rng(5);
+    for (int k = 0; k < 200000; k++) {
+        RecordClick(model, mon, apps[k % 12].c_str(), (int)(rng() % (size.cols * size.rows)), (int)(rng() % 9));
+    }
+    for (int a = 12; a < CLICK_HISTORY_ENTRIES; a++) {
+        std::wstring app = L"extra" + std::to_wstring(a) + L".exe";
+        for (int k = 0; k < 2000; k++) {
+            RecordClick(model, mon, app.c_str(), (int)(rng() % (size.cols * size.rows)), (int)(rng() % 9));
+        }
+    }
+    const int reps = quick ? 3 : 30;
+    const int batch = 1000;
+    int next = 0;
+    double recordNs = BenchBestNs(reps, [&] {
+        for (int k = 0; k < batch; k++, next++) {
+            RecordClick(model, mon, apps[next % 12].c_str(), (int)(rng() % (size.cols * size.rows)), 4);
+        }
+    }) / batch;
+    std::vector<int> byCode(size.cols * size.rows);
+    double rankNs = BenchBestNs(reps, [&] {
+        RankCellsByClicks(model, mon, apps[0].c_str(), byCode.data());
+        DoNotOptimize(byCode[0]);
+    });
+    std::string file;
+    WriteClickModel(model, file);
+    double loadNs = BenchBestNs(reps, [&] {
+        ClickModel loaded;
+        ReadClickModel(file, loaded);
+        DoNotOptimize(loaded.serial);
+    });
+    std::printf("\nfull history (%zu histories, %d cells on %dx%d): record %.0f ns/click, rank %.1f us, "
+                "load %.1f us\n", model.histories.size(), CLICK_CELLS_PER_HISTORY, size.cols, size.rows,
+                recordNs, rankNs / 1e3, loadNs / 1e3);
+    std::printf("memory %zu KB, file %zu KB\n", ModelBytes(model) >> 10, file.size() >> 10);
+    return model.histories.size() == CLICK_HISTORY_ENTRIES ? 0 : 1;
+}
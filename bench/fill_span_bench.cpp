@@ -0,0 +1,89 @@
+// Base grid fills for three 4K monitors with each fill kernel: the banded
+// rasterizer (one scanline per band, copied down) with the scalar, SSE2 and
+// AVX2 span kernels, against naive per-rect painting. Each result is
+// checked against the naive frame. The budget is 10 ms per 3 x 4K frame for
+// the banded path with the best kernel; a full run exits non-zero over it,
+// --quick runs only report.
+#include "core/GridRaster.h"
+#include "bench/Bench.h"
+#include "tests/TestGrid.h"
+#include "tests/TestRaster.h"
+
+#include <vector>
+
+static const double BUDGET_NS = 10e6;
+
+// Every rect painted pixel by pixel in draw order
+static void PaintNaive(PixelSurface& s, const SpanBatch& batch, const uint32_t* lut) {
+    for (const SpanRect& r : batch) {
+        for (int y = r.top; y < r.bottom; y++) {
+            uint32_t* row = s.pixels + (size_t)y * s.stride;
+            for (int x = r.left; x < r.right; x++) row[x] = lut[r.color];
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    bool quick = BenchQuick(argc, argv);
+    int reps = quick ? 1 : 20;
+    std::vector<TestMonitor> monitors = { { { 0, 0, 3840, 2160 }, 96 },
+                                          { { 3840, 0, 7680, 2160 }, 96 },
+                                          { { 7680, 0, 11520, 2160 }, 96 } };
+    TestCells cells = {};
+    BuildTestGrid(monitors, cells);
+    TestRasterBackend backend;
+
+    // Each monitor's spans and bands, and a surface for it
+    std::vector<BaseGridModel> models(monitors.size());
+    std::vector<std::vector<uint32_t>> pixels(monitors.size()), naive(monitors.size());
+    std::vector<PixelSurface> surfaces(monitors.size());
+    size_t spans = 0, bands = 0;
+    for (size_t m = 0; m < monitors.size(); m++) {
+        const TestMonitor& mon = monitors[m];
+        int w = mon.rc.right - mon.rc.left, h = mon.rc.bottom - mon.rc.top;
+        pixels[m].assign((size_t)w * h, 0);
+        naive[m].assign((size_t)w * h, 0);
+        surfaces[m] = { pixels[m].data(), w, h, w };
+        BuildBaseGridModel(models[m], surfaces[m], mon.rc.left, mon.rc.top, cells, mon.firstCell,
+                           mon.cellCount, backend);
+        spans += models[m].spans.size();
+        bands += models[m].bands.edges.size() - 1;
+    }
+    uint32_t lut[GRID_CLASS_COUNT];
+    for (int c = 0; c < GRID_CLASS_COUNT; c++) lut[c] = SurfacePixel(PALETTE_PRESETS[0].palette.*GRID_CLASS_COLORS[c]);
+
+    double naiveNs = BenchBestNs(reps, [&] {
+        for (size_t m = 0; m < monitors.size(); m++) {
+            PixelSurface s = { naive[m].data(), surfaces[m].width, surfaces[m].height, surfaces[m].stride };
+            PaintNaive(s, models[m].spans, lut);
+        }
+    });
+    std::printf("3 x 4K: %zu spans in %zu bands\n", spans, bands);
+    std::printf("%-16s %10s %8s\n", "fill", "ms/frame", "match");
+    std::printf("%-16s %10.2f %8s\n", "naive per-rect", naiveNs / 1e6, "-");
+
+    const char* names[] = { "bands + scalar", "bands + SSE2", "bands + AVX2" };
+    SimdLevel cpu = DetectSimdLevel();
+    double best = 1e300;
+    bool allMatch = true;
+    for (int level = SIMD_SCALAR; level <= SIMD_AVX2; level++) {
+        if (level > cpu) {
+            std::printf("%-16s %10s\n", names[level], "n/a");
+            continue;
+        }
+        FillSpanFn fill = SelectFillSpan((SimdLevel)level);
+        for (std::vector<uint32_t>& p : pixels) std::fill(p.begin(), p.end(), 0);
+        double ns = BenchBestNs(reps, [&] {
+            for (size_t m = 0; m < monitors.size(); m++) {
+                RasterizeBands(surfaces[m], models[m].spans, models[m].bands, lut, fill);
+            }
+        });
+        bool match = pixels == naive;
+        allMatch = allMatch && match;
+        if (ns < best) best = ns;
+        std::printf("%-16s %10.2f %8s\n", names[level], ns / 1e6, match ? "yes" : "NO");
+    }
+    std::printf("best banded: %.2f ms (budget %.0f ms)\n", best / 1e6, BUDGET_NS / 1e6);
+    if (!allMatch) return 1;
+    return quick || best <= BUDGET_NS ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+// Substring search over 5000 folded titles with each kernel, and with
+// std::u16string::find on a copy of each title as the search once did, for
+// several query lengths
+#include "core/FoldedSearch.h"
+#include "bench/Bench.h"
+#include "bench/SyntheticTitles.h"
+
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    bool quick = BenchQuick(argc, argv);
+    std::vector<std::u16string> titles = SyntheticTitles(5000, 1);
+    std::vector<char16_t> folded;
+    std::vector<int> offset, length;
+    for (const std::u16string& t : titles) {
+        std::u16string f = FoldTitle(t);
+        offset.push_back((int)folded.size());
+        length.push_back((int)f.size());
+        folded.insert(folded.end(), f.begin(), f.end());
+    }
+    const char16_t* const queries[] = { u"e", u"re", u"note", u"meeting", u"studio code", u"calendar | weather" };
+    SimdLevel cpu = DetectSimdLevel();
+    int reps = quick ? 1 : 50;
+    std::printf("%-20s %7s %10s %10s %10s %10s\n", "query", "hits", "find us", "scalar us", "sse2 us", "avx2 us");
+    for (const char16_t* q : queries) {
+        std::u16string query = q;
+        int n = (int)query.size();
+        auto scan = [&](FindFoldedFn<char16_t> kernel) {
+            int hits = 0;
+            for (size_t e = 0; e < offset.size(); e++) {
+                hits += length[e] >= n && kernel(folded.data() + offset[e], length[e], query.data(), n) >= 0;
+            }
+            return hits;
+        };
+        int hits = 0;
+        double find = BenchBestNs(reps, [&] {
+            int h = 0;
+            for (size_t e = 0; e < offset.size(); e++) {
+                std::u16string title(folded.data() + offset[e], length[e]);
+                h += title.find(query) != std::u16string::npos;
+            }
+            hits = h;
+        });
+        int check = 0;
+        double scalar = BenchBestNs(reps, [&] { check = scan(FindFoldedScalar<char16_t>); });
+        if (check != hits) return 1;
+        double sse2 = 0, avx = 0;
+        if (cpu >= SIMD_SSE2) {
+            sse2 = BenchBestNs(reps, [&] { check = scan(SelectFindFolded<char16_t>(SIMD_SSE2)); });
+            if (check != hits) return 1;
+        }
+        if (cpu >= SIMD_AVX2) {
+            avx = BenchBestNs(reps, [&] { check = scan(SelectFindFolded<char16_t>(SIMD_AVX2)); });
+            if (check != hits) return 1;
+        }
+        std::string name(query.begin(), query.end());
+        std::printf("%-20s %7d %10.1f %10.1f %10.1f %10.1f\n", name.c_str(), hits, find / 1000,
+                    scalar / 1000, sse2 / 1000, avx / 1000);
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+// Ranked fuzzy search over 2000 titles, typed one character at a time:
+// each keystroke updates the search levels and ranks the hits, and must
+// stay under 1 ms. Exits non-zero if the slowest keystroke of a full run
+// goes over budget; --quick runs only report.
+#include "core/FuzzyMatch.h"
+#include "bench/Bench.h"
+#include "bench/SyntheticTitles.h"
+
+#include <string>
+#include <vector>
+
+static const double BUDGET_NS = 1e6;
+
+int main(int argc, char** argv) {
+    bool quick = BenchQuick(argc, argv);
+    std::vector<std::u16string> titles = SyntheticTitles(2000, 9);
+    FoldedTitleIndex<char16_t> ix = {};
+    for (const std::u16string& t : titles) {
+        std::u16string f = FoldTitle(t);
+        AppendFoldedTitle(ix, f.data(), (int)f.size(), [](char16_t c) { return c; });
+    }
+    ix.normalCount = (int)titles.size();
+
+    const char16_t* const queries[] = { u"c", u"vsc", u"gc", u"qbr", u"meeting notes", u"readme code", u"zzz" };
+    int reps = quick ? 1 : 30;
+    double worst = 0;
+    std::printf("%-14s %6s %12s %12s\n", "query", "hits", "mean us/key", "worst us/key");
+    for (const char16_t* q : queries) {
+        std::u16string query = q;
+        size_t hits = 0;
+        double total = 0, keyWorst = 0;
+        for (size_t n = 1; n <= query.size(); n++) {
+            // Best of reps for the keystroke that brings the query to n characters
+            double best = 1e300;
+            for (int r = 0; r < reps; r++) {
+                std::vector<SearchLevel> levels;
+                std::u16string levelsQuery;
+                if (n > 1) UpdateSearchLevels(levels, levelsQuery, query.substr(0, n - 1), ix, FuzzyMatchTitle<char16_t>);
+                std::u16string typed = query.substr(0, n);
+                double t0 = BenchNowNs();
+                UpdateSearchLevels(levels, levelsQuery, typed, ix, FuzzyMatchTitle<char16_t>);
+                std::vector<SearchHit> ranked = levels.back().hits;
+                RankSearchHits(ranked, [](int a, int b) { return a < b; });
+                double t = BenchNowNs() - t0;
+                DoNotOptimize(ranked.data());
+                hits = ranked.size();
+                if (t < best) best = t;
+            }
+            total += best;
+            if (best > keyWorst) keyWorst = best;
+        }
+        if (keyWorst > worst) worst = keyWorst;
+        std::printf("%-14s %6zu %12.1f %12.1f\n", std::string(query.begin(), query.end()).c_str(), hits,
+                    total / query.size() / 1000, keyWorst / 1000);
+    }
+    std::printf("worst keystroke %.1f us, budget %.0f us\n", worst / 1000, BUDGET_NS / 1000);
+    return quick || worst <= BUDGET_NS ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+// Headless base-grid frames on the test backend: time to lay out and
+// rasterize every monitor's tile, to recolor them for a hue change, and to
+// composite the frame, for a mixed three-monitor desk and for three 4K
+// monitors
+#include "core/GridRaster.h"
+#include "bench/Bench.h"
+#include "tests/TestGrid.h"
+#include "tests/TestRaster.h"
+
+#include <vector>
+
+struct BenchLayout {
+    const char* name;
+    std::vector<TestMonitor> monitors;
+};
+
+int main(int argc, char** argv) {
+    bool quick = BenchQuick(argc, argv);
+    int reps = quick ? 1 : 10;
+    std::vector<BenchLayout> layouts = {
+        { "1080p + portrait + 1440p@150%", { { { 0, 0, 1920, 1080 }, 96 },
+                                             { { -1080, -400, 0, 1520 }, 96 },
+                                             { { 1920, 0, 4480, 1440 }, 144 } } },
+        { "3 x 4K", { { { 0, 0, 3840, 2160 }, 96 },
+                      { { 3840, 0, 7680, 2160 }, 96 },
+                      { { 7680, 0, 11520, 2160 }, 96 } } },
+    };
+    Palette a = PALETTE_PRESETS[0].palette, b = GeneratePalette(200.0f);
+    std::printf("%-30s %6s %10s %10s %10s %10s\n", "layout", "cells", "render ms", "recolor ms",
+                "frame ms", "tones KB");
+    for (BenchLayout& layout : layouts) {
+        TestCells cells = {};
+        BuildTestGrid(layout.monitors, cells);
+        TestRasterBackend backend;
+        std::vector<TestTile> tiles;
+        double render = BenchBestNs(reps, [&] {
+            ReleaseGridTiles(backend, tiles);
+            tiles.resize(layout.monitors.size());
+            for (size_t m = 0; m < layout.monitors.size(); m++) {
+                const TestMonitor& mon = layout.monitors[m];
+                RenderGridTile(backend, tiles[m], mon.rc, cells, mon.firstCell, mon.cellCount, a);
+            }
+        });
+        int flip = 0;
+        double recolor = BenchBestNs(reps, [&] {
+            for (TestTile& t : tiles) RecolorGridTile(backend, t, flip++ & 1 ? a : b);
+        });
+        double frame = BenchBestNs(reps, [&] {
+            TestFrame f = CompositeTestFrame(layout.monitors, tiles, a);
+            DoNotOptimize(f.pixels[0]);
+        });
+        size_t toneKb = (size_t)(MeasureGridMemory(layout.monitors, &TestMonitor::rc, &tiles).toneMapBytes >> 10);
+        std::printf("%-30s %6d %10.2f %10.2f %10.2f %10zu\n", layout.name, cells.count, render / 1e6,
+                    recolor / 1e6, frame / 1e6, toneKb);
+        ReleaseGridTiles(backend, tiles);
+    }
+    return 0;
+}
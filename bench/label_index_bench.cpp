@@ -0,0 +1,74 @@
+// Label lookup: the arithmetic per-monitor index of FindCellByLabel,
+// against a std::map of label strings and a linear scan of the labels, at
+// 1, 4 and 8 monitors of 26x26 cells.
+#include "core/LabelCodes.h"
+#include "bench/Bench.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+struct BenchMonitor {
+    wchar_t prefix;
+    LabelPlan codes;
+    int firstCell, cellCount;
+};
+
+int main(int argc, char** argv) {
+    bool quick = BenchQuick(argc, argv);
+    const int cellsPerMonitor = 26 * 26;
+    const int lookups = quick ? 20000 : 2000000;
+    std::printf("%-9s %8s %12s %12s %12s\n", "monitors", "cells", "index ns", "map ns", "scan ns");
+    for (int monitorCount : { 1, 4, 8 }) {
+        std::vector<BenchMonitor> monitors;
+        std::vector<int> byCode;
+        std::vector<std::wstring> labels;
+        std::map<std::wstring, int> byLabel;
+        std::mt19937 rng(monitorCount);
+        for (int m = 0; m < monitorCount; m++) {
+            BenchMonitor mon = { (wchar_t)(L'a' + m), PlanLabelCodes(cellsPerMonitor),
+                                 m * cellsPerMonitor, cellsPerMonitor };
+            monitors.push_back(mon);
+            std::vector<int> order(cellsPerMonitor);
+            for (int i = 0; i < cellsPerMonitor; i++) order[i] = i;
+            std::shuffle(order.begin(), order.end(), rng);  // Codes ranked by clicks
+            byCode.insert(byCode.end(), order.begin(), order.end());
+            labels.resize(byCode.size());
+            for (int rank = 0; rank < cellsPerMonitor; rank++) {
+                wchar_t text[MAX_LABEL_LETTERS + 1];
+                FormatLabel(MakeLabel(mon.prefix, mon.codes, rank), text);
+                labels[mon.firstCell + order[rank]] = text;
+                byLabel[text] = mon.firstCell + order[rank];
+            }
+        }
+        std::vector<int> queries(lookups);
+        std::uniform_int_distribution<int> pick(0, (int)labels.size() - 1);
+        for (int& q : queries) q = pick(rng);
+
+        long long sum = 0;
+        double index = BenchBestNs(3, [&] {
+            for (int q : queries) {
+                const std::wstring& l = labels[q];
+                sum += FindCellByLabel(monitors.data(), monitorCount, byCode.data(), l.c_str(), (int)l.size());
+            }
+        });
+        double map = BenchBestNs(3, [&] {
+            for (int q : queries) sum += byLabel.find(labels[q])->second;
+        });
+        int scanLookups = lookups / 20;
+        double scan = BenchBestNs(3, [&] {
+            for (int k = 0; k < scanLookups; k++) {
+                const std::wstring& l = labels[queries[k]];
+                for (size_t i = 0; i < labels.size(); i++) {
+                    if (labels[i] == l) { sum += (long long)i; break; }
+                }
+            }
+        });
+        DoNotOptimize(sum);
+        std::printf("%-9d %8zu %12.1f %12.1f %12.1f\n", monitorCount, labels.size(),
+                    index / lookups, map / lookups, scan / scanLookups);
+    }
+    return 0;
+}
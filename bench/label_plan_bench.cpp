@@ -0,0 +1,55 @@
+// Code planning: average keystrokes to name a cell (monitor prefix plus
+// code, over uniformly chosen cells) and the time to plan and label every
+// cell, for 1-8 identical monitors from 1080p up to 8K. "fixed" is the
+// length every code would need if all codes on a monitor were equally long.
+#include "core/GridLayout.h"
+#include "core/LabelCodes.h"
+#include "bench/Bench.h"
+
+#include <vector>
+
+struct Display {
+    const char* name;
+    int width, height, dpi;
+};
+
+int main(int argc, char** argv) {
+    bool quick = BenchQuick(argc, argv);
+    const Display displays[] = {
+        { "1080p@100%", 1920, 1080, 96 },
+        { "1440p@125%", 2560, 1440, 120 },
+        { "4K@100%", 3840, 2160, 96 },
+        { "4K@150%", 3840, 2160, 144 },
+        { "5K@200%", 5120, 2880, 192 },
+        { "8K@100%", 7680, 4320, 96 },
+        { "8K@200%", 7680, 4320, 192 },
+    };
+    const int reps = quick ? 2 : 50;
+    std::printf("%-11s %8s %7s %9s %7s %10s\n", "display", "monitors", "cells", "avg keys", "fixed", "plan us");
+    for (const Display& d : displays) {
+        for (int monitorCount = 1; monitorCount <= 8; monitorCount *= 2) {
+            std::vector<LabelCode> labels;
+            long long letters = 0;
+            int fixed = 0;
+            double ns = BenchBestNs(reps, [&] {
+                labels.clear();
+                letters = 0;
+                for (int m = 0; m < monitorCount; m++) {
+                    GridSize size = PlanGridSize(d.width, d.height, d.dpi);
+                    int count = size.cols * size.rows;
+                    LabelPlan plan = PlanLabelCodes(count);
+                    for (int rank = 0; rank < count; rank++) {
+                        LabelCode code = MakeLabel((wchar_t)(L'a' + m), plan, rank);
+                        letters += LabelLength(code);
+                        labels.push_back(code);
+                    }
+                    fixed = 1 + (plan.shortCodes < count ? plan.length + 1 : plan.length);
+                }
+            });
+            DoNotOptimize(labels.data());
+            std::printf("%-11s %8d %7zu %9.3f %7d %10.1f\n", d.name, monitorCount, labels.size(),
+                        (double)letters / labels.size(), fixed, ns / 1000);
+        }
+    }
+    return 0;
+}
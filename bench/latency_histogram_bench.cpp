@@ -0,0 +1,45 @@
+// Cost of LatencyHistogram::Record per sample, alone and with the two clock
+// reads a LatencyScope adds. The budget is 20 ns per sample for Record; a
+// full run exits non-zero if it goes over, --quick runs only report.
+#include "core/LatencyHistogram.h"
+#include "bench/Bench.h"
+
+#include <random>
+#include <vector>
+
+static const double BUDGET_NS = 20.0;
+
+static LatencyHistogram g_hist;
+
+int main(int argc, char** argv) {
+    bool quick = BenchQuick(argc, argv);
+    int samples = quick ? 100000 : 10000000;
+    // Hook-like latencies: mostly a few microseconds of QPC ticks, a long tail
+    std::mt19937 rng(3);
+    std::lognormal_distribution<double> dist(3.5, 1.0);
+    std::vector<long long> values(1 << 16);
+    for (long long& v : values) v = (long long)dist(rng);
+
+    double record = BenchBestNs(quick ? 1 : 5, [&] {
+        for (int i = 0; i < samples; i++) g_hist.Record(values[i & 0xFFFF]);
+    }) / samples;
+    double scoped = BenchBestNs(quick ? 1 : 5, [&] {
+        for (int i = 0; i < samples; i++) {
+            double t0 = BenchNowNs();
+            g_hist.Record((long long)(BenchNowNs() - t0));
+        }
+    }) / samples;
+    double clocks = BenchBestNs(quick ? 1 : 5, [&] {
+        double sum = 0;
+        for (int i = 0; i < samples; i++) sum += BenchNowNs() - BenchNowNs();
+        DoNotOptimize(sum);
+    }) / samples;
+    double percentile = BenchBestNs(quick ? 1 : 100, [&] { DoNotOptimize(g_hist.Percentile(99.0)); });
+
+    std::printf("Record:                %6.1f ns/sample (budget %.0f ns)\n", record, BUDGET_NS);
+    std::printf("Record + two clocks:   %6.1f ns/sample (clocks alone %.1f ns)\n", scoped, clocks);
+    std::printf("Percentile(99):        %6.1f ns\n", percentile);
+    std::printf("p50 %.0f p99 %.0f max %lld over %llu samples\n", g_hist.Percentile(50.0),
+                g_hist.Percentile(99.0), g_hist.Max(), g_hist.Count());
+    return quick || record <= BUDGET_NS ? 0 : 1;
+}
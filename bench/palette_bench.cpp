@@ -0,0 +1,70 @@
+// HSL conversion throughput: HslBatch against scalar hsl() for a whole
+// palette and for the palette picker's 3600-entry hue bar, plus a sweep
+// checking that GeneratePalette's batch path equals scalar hsl() for base
+// hues across [0, 359.9]. A full run sweeps every 16th float there, --quick
+// every 65536th; any mismatch exits non-zero.
+#include "core/Palette.h"
+#include "bench/Bench.h"
+
+#include <cstring>
+#include <vector>
+
+#define HUE_LUT_STEPS 3600
+
+static bool SamePalette(const Palette& a, const Palette& b) {
+    for (const PaletteTone& t : PALETTE_TONES) {
+        if (a.*t.color != b.*t.color) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool quick = BenchQuick(argc, argv);
+    int reps = quick ? 3 : 200;
+
+    // The hue bar: 3600 hues at full saturation, as the picker builds it
+    std::vector<float> hue(HUE_LUT_STEPS), sat(HUE_LUT_STEPS, 0.85f), light(HUE_LUT_STEPS, 0.50f);
+    for (int i = 0; i < HUE_LUT_STEPS; i++) hue[i] = (float)i * (360.0f / HUE_LUT_STEPS);
+    std::vector<PaletteColor> out(HUE_LUT_STEPS);
+    double barBatch = BenchBestNs(reps, [&] {
+        HslBatch(hue.data(), sat.data(), light.data(), out.data(), HUE_LUT_STEPS);
+        DoNotOptimize(out[0]);
+    });
+    double barScalar = BenchBestNs(reps, [&] {
+        for (int i = 0; i < HUE_LUT_STEPS; i++) out[i] = hsl(hue[i], sat[i], light[i]);
+        DoNotOptimize(out[0]);
+    });
+
+    // One palette for a hue no preset covers
+    volatile float runtimeHue = 123.4f;
+    int paletteReps = 1000;
+    double paletteBatch = BenchBestNs(reps, [&] {
+        for (int i = 0; i < paletteReps; i++) DoNotOptimize(GeneratePalette(runtimeHue));
+    }) / paletteReps;
+    double paletteScalar = BenchBestNs(reps, [&] {
+        for (int i = 0; i < paletteReps; i++) DoNotOptimize(TonePalette(runtimeHue));
+    }) / paletteReps;
+
+    std::printf("%-22s %10s %10s %8s\n", "", "batch ns", "scalar ns", "speedup");
+    std::printf("%-22s %10.0f %10.0f %7.1fx\n", "hue bar (3600)", barBatch, barScalar, barScalar / barBatch);
+    std::printf("%-22s %10.1f %10.1f %7.1fx\n", "palette (17 tones)", paletteBatch, paletteScalar,
+                paletteScalar / paletteBatch);
+
+    // Exactness sweep over the float bit patterns of [0, 359.9]
+    unsigned stride = quick ? 65536 : 16;
+    uint32_t lo = 0, hi;
+    float top = 359.9f;
+    std::memcpy(&hi, &top, sizeof(hi));
+    unsigned long long checked = 0, mismatches = 0;
+    double t0 = BenchNowNs();
+    for (uint64_t bits = lo; bits <= hi; bits += stride) {
+        uint32_t b = (uint32_t)bits;
+        float H;
+        std::memcpy(&H, &b, sizeof(H));
+        mismatches += !SamePalette(GeneratePalette(H), TonePalette(H));
+        checked++;
+    }
+    std::printf("exactness: %llu base hues checked, %llu mismatches (%.1f s)\n", checked, mismatches,
+                (BenchNowNs() - t0) / 1e9);
+    return mismatches == 0 ? 0 : 1;
+}
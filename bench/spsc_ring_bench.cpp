@@ -0,0 +1,97 @@
+// SpscRing with hook-event-sized items: uncontended push + pop, streaming
+// throughput between two threads, and ping-pong round trips. The streaming
+// test also runs a copy without the cache-line padding between head and tail.
+#include "core/SpscRing.h"
+#include "bench/Bench.h"
+
+#include <cstdint>
+#include <thread>
+
+struct Event {
+    uint8_t type;
+    long long qpc;
+};
+
+// SpscRing as it was before head and tail got their own cache lines
+template <typename T, unsigned N>
+struct UnpaddedRing {
+    T items[N];
+    std::atomic<unsigned> head{0};
+    std::atomic<unsigned> tail{0};
+    bool Push(const T& v) {
+        unsigned h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == N) return false;
+        items[h & (N - 1)] = v;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    bool Pop(T& v) {
+        unsigned t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        v = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+// ns per item streamed from one thread to another
+template <typename Ring>
+static double Stream(Ring& ring, long long count) {
+    double t0 = BenchNowNs();
+    std::thread producer([&] {
+        for (long long i = 0; i < count; ) {
+            if (ring.Push({ 0, i })) i++;
+            else std::this_thread::yield();  // Full; lets a single-core machine make progress
+        }
+    });
+    Event e;
+    long long sum = 0;
+    for (long long got = 0; got < count; ) {
+        if (ring.Pop(e)) { sum += e.qpc; got++; }
+        else std::this_thread::yield();
+    }
+    producer.join();
+    DoNotOptimize(sum);
+    return (BenchNowNs() - t0) / count;
+}
+
+int main(int argc, char** argv) {
+    bool quick = BenchQuick(argc, argv);
+    long long count = quick ? 100000 : 5000000;
+
+    static SpscRing<Event, 256> ring;
+    Event e = {};
+    double local = BenchBestNs(5, [&] {
+        for (long long i = 0; i < count; i++) {
+            ring.Push({ 1, i });
+            ring.Pop(e);
+        }
+        DoNotOptimize(e);
+    }) / count;
+    std::printf("push + pop, one thread:      %6.1f ns\n", local);
+
+    static SpscRing<Event, 256> padded;
+    static UnpaddedRing<Event, 256> unpadded;
+    std::printf("stream, padded head/tail:    %6.1f ns/item\n", Stream(padded, count));
+    std::printf("stream, unpadded head/tail:  %6.1f ns/item\n", Stream(unpadded, count));
+
+    // Round trip: push to the other thread, which pushes back
+    static SpscRing<Event, 256> there, back;
+    long long trips = count / 20;
+    std::thread echo([&] {
+        Event m;
+        for (long long i = 0; i < trips; ) {
+            if (there.Pop(m)) { while (!back.Push(m)) {} i++; }
+            else std::this_thread::yield();
+        }
+    });
+    double t0 = BenchNowNs();
+    for (long long i = 0; i < trips; i++) {
+        there.Push({ 2, i });
+        while (!back.Pop(e)) std::this_thread::yield();
+    }
+    double rt = (BenchNowNs() - t0) / trips;
+    echo.join();
+    std::printf("round trip between threads:  %6.1f ns\n", rt);
+    return 0;
+}
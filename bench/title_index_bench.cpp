@@ -0,0 +1,79 @@
+// Typing a query into the Tab search over 5000 titles, one character at a
+// time: the incremental search levels over the folded index, a full rescan
+// of the index per keystroke, and the old path that lowercased a copy of
+// every title and searched it with find
+#include "core/FoldedSearch.h"
+#include "core/TitleIndex.h"
+#include "bench/Bench.h"
+#include "bench/SyntheticTitles.h"
+
+#include <string>
+#include <vector>
+
+static char16_t FoldAscii(char16_t c) {
+    return (c >= u'A' && c <= u'Z') ? (char16_t)(c - u'A' + u'a') : c;
+}
+
+static bool SubstringMatch(const char16_t* title, int len, const char16_t* query, int n, int* pos, int* score) {
+    int at = FindFolded(title, len, query, n);
+    if (at < 0) return false;
+    for (int k = 0; k < n; k++) pos[k] = at + k;
+    *score = 0;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool quick = BenchQuick(argc, argv);
+    std::vector<std::u16string> titles = SyntheticTitles(5000, 3);
+    int reps = quick ? 1 : 20;
+
+    FoldedTitleIndex<char16_t> ix = {};
+    double build = BenchBestNs(reps, [&] {
+        ix = FoldedTitleIndex<char16_t>();
+        for (const std::u16string& t : titles) AppendFoldedTitle(ix, t.data(), (int)t.size(), FoldAscii);
+        ix.normalCount = (int)titles.size();
+    });
+    std::printf("index build: %.1f us for %zu titles\n", build / 1000, titles.size());
+
+    const char16_t* const queries[] = { u"no", u"note", u"meeting", u"studio code", u"quarterly budget" };
+    std::printf("%-18s %6s %14s %14s %14s\n", "query", "hits", "levels us/key", "rescan us/key", "copies us/key");
+    for (const char16_t* q : queries) {
+        std::u16string query = q;
+        size_t hits = 0;
+        double levels = BenchBestNs(reps, [&] {
+            std::vector<SearchLevel> lv;
+            std::u16string lvQuery;
+            for (size_t n = 1; n <= query.size(); n++) {
+                UpdateSearchLevels(lv, lvQuery, query.substr(0, n), ix, SubstringMatch);
+            }
+            hits = lv.back().hits.size();
+        });
+        size_t check = 0;
+        double rescan = BenchBestNs(reps, [&] {
+            for (size_t n = 1; n <= query.size(); n++) {
+                std::vector<SearchLevel> lv;
+                std::u16string lvQuery;
+                UpdateSearchLevels(lv, lvQuery, query.substr(0, n), ix, SubstringMatch);
+                check = lv.back().hits.size();
+            }
+        });
+        if (check != hits) return 1;
+        double copies = BenchBestNs(reps, [&] {
+            for (size_t n = 1; n <= query.size(); n++) {
+                std::u16string sub = query.substr(0, n);
+                std::vector<std::u16string> kept;
+                for (const std::u16string& t : titles) {
+                    std::u16string lower = t;
+                    for (char16_t& c : lower) c = FoldAscii(c);
+                    if (lower.find(sub) != std::u16string::npos) kept.push_back(t);
+                }
+                check = kept.size();
+            }
+        });
+        if (check != hits) return 1;
+        double keys = (double)query.size() * 1000;
+        std::string name(query.begin(), query.end());
+        std::printf("%-18s %6zu %14.1f %14.1f %14.1f\n", name.c_str(), hits, levels / keys, rescan / keys, copies / keys);
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+// Hue-change recolor of the base grid for three 4K monitors: memory kept per
+// tile and time per recolor for the recorded model (spans, bands and a
+// GlyphPixel per label pixel, repainted in full) against the tone map (a
+// tone table and row runs, remapped with each fill kernel). Each remap is
+// checked against the model's frame. It runs with the test face, whose ink
+// pixels each have their own coverage (every label pixel a tone of its own,
+// the worst case for runs), and with a face of solid strokes and a
+// partly covered edge, closer to what ClearType draws.
+#include "core/GridRaster.h"
+#include "bench/Bench.h"
+#include "tests/TestGrid.h"
+#include "tests/TestRaster.h"
+
+#include <vector>
+
+// Letters as solid stems and bars with one partly covered column
+struct StrokeRasterBackend : TestRasterBackend {
+    static void BuildStrokeFace(GlyphFace& face, int px) {
+        BuildTestFace(face, px);
+        std::fill(face.coverage.begin(), face.coverage.end(), 0u);
+        for (int c = 0; c < 26; c++) {
+            int left = face.x[c] + face.margin;
+            for (int y = face.height / 8; y < face.height - face.height / 8; y++) {
+                for (int x = 0; x < face.advance[c] - 1; x++) {
+                    bool ink = x < 2 || x == c % 3 + 3 || y == face.height / 2 || y == face.height / 8;
+                    uint32_t cov = ink ? 0xFFFFFFu : x == 2 ? 0x806040u : 0u;
+                    face.coverage[(size_t)y * face.maskW + left + x] = cov;
+                }
+            }
+        }
+    }
+    const GridGlyphs& Glyphs(int sh, int cellW) override {
+        for (const GridGlyphs& g : glyphs) {
+            if (g.sh == sh && g.cellW == cellW) return g;
+        }
+        GridGlyphs g;
+        g.sh = sh;
+        g.cellW = cellW;
+        BuildStrokeFace(g.main, sh * 60 / 100 < cellW / 5 ? sh * 60 / 100 : cellW / 5);
+        BuildStrokeFace(g.sub, sh * 30 / 100);
+        glyphs.push_back(g);
+        return glyphs.back();
+    }
+};
+
+static bool RunFace(const char* face, GridRasterBackend& backend, const std::vector<TestMonitor>& monitors,
+                    const TestCells& cells, int reps) {
+    std::vector<BaseGridModel> models(monitors.size());
+    std::vector<GridToneMap> maps(monitors.size());
+    std::vector<std::vector<uint32_t>> pixels(monitors.size()), expect(monitors.size());
+    std::vector<PixelSurface> surfaces(monitors.size());
+    size_t modelBytes = 0, mapBytes = 0, glyphPixels = 0, runs = 0, tones = 0;
+    for (size_t m = 0; m < monitors.size(); m++) {
+        const TestMonitor& mon = monitors[m];
+        int w = mon.rc.right - mon.rc.left, h = mon.rc.bottom - mon.rc.top;
+        pixels[m].assign((size_t)w * h, 0);
+        expect[m].assign((size_t)w * h, 0);
+        surfaces[m] = { pixels[m].data(), w, h, w };
+        BaseGridModel& model = models[m];
+        BuildBaseGridModel(model, surfaces[m], mon.rc.left, mon.rc.top, cells, mon.firstCell,
+                           mon.cellCount, backend);
+        IndexGridModel(maps[m], surfaces[m], model, GRID_CLASS_COUNT);
+        modelBytes += model.spans.size() * sizeof(SpanRect) + model.glyphs.size() * sizeof(GlyphPixel) +
+                      (model.bands.edges.size() + model.bands.start.size() + model.bands.rects.size()) * sizeof(int);
+        mapBytes += ToneMapBytes(maps[m]);
+        glyphPixels += model.glyphs.size();
+        runs += maps[m].runs.size();
+        tones += maps[m].tones.size();
+    }
+
+    Palette a = PALETTE_PRESETS[0].palette, b = GeneratePalette(200.0f);
+    int flip = 0;
+    double modelNs = BenchBestNs(reps, [&] {
+        const Palette& p = flip++ & 1 ? a : b;
+        for (size_t m = 0; m < monitors.size(); m++) {
+            PixelSurface s = { expect[m].data(), surfaces[m].width, surfaces[m].height, surfaces[m].stride };
+            PaintBaseGrid(s, models[m], p);
+        }
+    });
+    const Palette& last = (flip - 1) & 1 ? a : b;
+
+    std::printf("3 x 4K, %s: %zu glyph pixels; %zu tones, %zu runs\n", face, glyphPixels, tones, runs);
+    std::printf("%-18s %10s %10s %8s\n", "recolor", "KB kept", "ms/frame", "match");
+    std::printf("%-18s %10zu %10.2f %8s\n", "model repaint", modelBytes >> 10, modelNs / 1e6, "-");
+
+    uint32_t classLut[GRID_CLASS_COUNT];
+    for (int c = 0; c < GRID_CLASS_COUNT; c++) classLut[c] = SurfacePixel(last.*GRID_CLASS_COLORS[c]);
+    std::vector<std::vector<uint32_t>> toneLuts(monitors.size());
+    const char* names[] = { "remap + scalar", "remap + SSE2", "remap + AVX2" };
+    SimdLevel cpu = DetectSimdLevel();
+    bool allMatch = true;
+    for (int level = SIMD_SCALAR; level <= SIMD_AVX2; level++) {
+        if (level > cpu) {
+            std::printf("%-18s %10s %10s\n", names[level], "", "n/a");
+            continue;
+        }
+        FillSpanFn fill = SelectFillSpan((SimdLevel)level);
+        for (std::vector<uint32_t>& p : pixels) std::fill(p.begin(), p.end(), 0);
+        double ns = BenchBestNs(reps, [&] {
+            for (size_t m = 0; m < monitors.size(); m++) {
+                BuildToneLut(maps[m], classLut, toneLuts[m]);
+                RemapToneRuns(surfaces[m], maps[m], toneLuts[m].data(), fill);
+            }
+        });
+        bool match = true;
+        for (size_t m = 0; m < monitors.size(); m++) match = match && pixels[m] == expect[m];
+        allMatch = allMatch && match;
+        std::printf("%-18s %10zu %10.2f %8s\n", names[level], mapBytes >> 10, ns / 1e6, match ? "yes" : "NO");
+    }
+    std::printf("\n");
+    return allMatch;
+}
+
+int main(int argc, char** argv) {
+    bool quick = BenchQuick(argc, argv);
+    int reps = quick ? 1 : 20;
+    std::vector<TestMonitor> monitors = { { { 0, 0, 3840, 2160 }, 96 },
+                                          { { 3840, 0, 7680, 2160 }, 96 },
+                                          { { 7680, 0, 11520, 2160 }, 96 } };
+    TestCells cells = {};
+    BuildTestGrid(monitors, cells);
+    TestRasterBackend testFace;
+    StrokeRasterBackend strokeFace;
+    bool ok = RunFace("test face", testFace, monitors, cells, reps);
+    ok = RunFace("stroke face", strokeFace, monitors, cells, reps) && ok;
+    return ok ? 0 : 1;
+}
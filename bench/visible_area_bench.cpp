@@ -0,0 +1,116 @@
+// Visible areas of 10-1000 windows on a 3x4K desktop: the segment-tree
+// sweep, the band sweep it replaced (copied below) and region arithmetic as
+// CombineRgn did it, for random layouts and for a cascade where every
+// window spans most bands
+#include "core/VisibleArea.h"
+#include "tests/RegionReference.h"
+#include "bench/Bench.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// The previous ComputeVisibleAreas: band sweep with union-find skip links
+// over the x slabs and a sorted vector for the windows spanning a band
+static void BandSweepVisibleAreas(const TestRect* rects, int n, long long* area) {
+    std::vector<int> xs, ys;
+    for (int i = 0; i < n; i++) {
+        area[i] = 0;
+        if (rects[i].right <= rects[i].left || rects[i].bottom <= rects[i].top) continue;
+        xs.push_back(rects[i].left);  xs.push_back(rects[i].right);
+        ys.push_back(rects[i].top);   ys.push_back(rects[i].bottom);
+    }
+    std::sort(xs.begin(), xs.end());
+    xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+    std::sort(ys.begin(), ys.end());
+    ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+    if (xs.size() < 2 || ys.size() < 2) return;
+    std::vector<int> x0(n), x1(n);
+    for (int i = 0; i < n; i++) {
+        x0[i] = (int)(std::lower_bound(xs.begin(), xs.end(), rects[i].left) - xs.begin());
+        x1[i] = (int)(std::lower_bound(xs.begin(), xs.end(), rects[i].right) - xs.begin());
+    }
+    std::vector<int> byTop, byBottom;
+    for (int i = 0; i < n; i++) {
+        if (rects[i].bottom > rects[i].top && x0[i] < x1[i]) byTop.push_back(i);
+    }
+    byBottom = byTop;
+    std::sort(byTop.begin(), byTop.end(), [rects](int a, int b) { return rects[a].top < rects[b].top; });
+    std::sort(byBottom.begin(), byBottom.end(), [rects](int a, int b) { return rects[a].bottom < rects[b].bottom; });
+    size_t entered = 0, left = 0;
+    int slabs = (int)xs.size() - 1;
+    std::vector<int> next(slabs + 1);
+    for (int k = 0; k <= slabs; k++) next[k] = k;
+    std::vector<int> claimed, active;
+    for (size_t b = 0; b + 1 < ys.size(); b++) {
+        int bandTop = ys[b], bandBottom = ys[b + 1];
+        for (; entered < byTop.size() && rects[byTop[entered]].top <= bandTop; entered++) {
+            int i = byTop[entered];
+            active.insert(std::lower_bound(active.begin(), active.end(), i), i);
+        }
+        for (; left < byBottom.size() && rects[byBottom[left]].bottom <= bandTop; left++) {
+            active.erase(std::lower_bound(active.begin(), active.end(), byBottom[left]));
+        }
+        if (active.empty()) continue;
+        auto find = [&](int k) {
+            int root = k;
+            while (next[root] != root) root = next[root];
+            while (next[k] != root) { int up = next[k]; next[k] = root; k = up; }
+            return root;
+        };
+        long long bandH = bandBottom - bandTop;
+        for (int i : active) {
+            for (int k = find(x0[i]); k < x1[i]; k = find(k + 1)) {
+                area[i] += (xs[k + 1] - xs[k]) * bandH;
+                next[k] = k + 1;
+                claimed.push_back(k);
+            }
+        }
+        for (int k : claimed) next[k] = k;
+        claimed.clear();
+    }
+}
+
+static std::vector<TestRect> RandomDesktop(int n, std::mt19937& rng) {
+    std::uniform_int_distribution<int> w(400, 2400), h(300, 1600), x(0, 3 * 3840 - 400), y(0, 2160 - 300);
+    std::vector<TestRect> rects(n);
+    for (TestRect& r : rects) {
+        int left = x(rng), top = y(rng);
+        r = { left, top, std::min(left + w(rng), 3 * 3840), std::min(top + h(rng), 2160) };
+    }
+    return rects;
+}
+
+static std::vector<TestRect> Cascade(int n) {
+    std::vector<TestRect> rects(n);
+    for (int i = 0; i < n; i++) {
+        int step = i % 400;
+        rects[i] = { step * 20, step, step * 20 + 3000, step + 1700 };
+    }
+    return rects;
+}
+
+int main(int argc, char** argv) {
+    bool quick = BenchQuick(argc, argv);
+    std::mt19937 rng(99);
+    const int counts[] = { 10, 30, 100, 300, 1000 };
+    std::printf("%-8s %7s %12s %12s %12s\n", "layout", "windows", "sweep us", "bands us", "regions us");
+    for (int layout = 0; layout < 2; layout++) {
+        for (int n : counts) {
+            if (quick && n > 100) continue;
+            std::vector<TestRect> rects = layout ? Cascade(n) : RandomDesktop(n, rng);
+            std::vector<long long> a(n), b(n), c(n);
+            int reps = quick ? 1 : (n <= 100 ? 50 : 5);
+            double sweep = BenchBestNs(reps, [&] { ComputeVisibleAreas(rects.data(), n, a.data()); });
+            double bands = BenchBestNs(reps, [&] { BandSweepVisibleAreas(rects.data(), n, b.data()); });
+            double regions = BenchBestNs(n <= 300 ? reps : 1, [&] { ReferenceVisibleAreas(rects.data(), n, c.data()); });
+            if (a != b || a != c) {
+                std::printf("MISMATCH at %d windows\n", n);
+                return 1;
+            }
+            std::printf("%-8s %7d %12.1f %12.1f %12.1f\n", layout ? "cascade" : "random", n,
+                        sweep / 1000, bands / 1000, regions / 1000);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Replays a scripted ten-minute desktop session (typing, title changes,
+// drags, app switches and launches, Tab every few seconds) through the
+// window inventory with the old two wide hook ranges, with the narrow ones
+// and Tab checking every snapshot rect on the UI thread, and with the
+// current ones, which hook location changes instead: events delivered,
+// rebuilds, how long the snapshot was out of date, how many Tab presses had
+// to enumerate, and the latency from Tab to the first highlight under
+// assumed per-window costs (printed with the results)
+#include "core/WindowInventory.h"
+#include "tests/InventoryReplay.h"
+#include "bench/Bench.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+static const InventoryEventRange OLD_RANGES[] = {
+    { INV_OBJECT_CREATE, INV_OBJECT_NAMECHANGE },
+    { INV_SYSTEM_FOREGROUND, INV_SYSTEM_MINIMIZEEND },
+};
+
+// The narrow ranges before location changes were hooked
+static const InventoryEventRange TAB_CHECK_RANGES[] = {
+    { INV_OBJECT_CREATE, INV_OBJECT_HIDE },
+    { INV_OBJECT_NAMECHANGE, INV_OBJECT_NAMECHANGE },
+    { INV_SYSTEM_FOREGROUND, INV_SYSTEM_FOREGROUND },
+    { INV_SYSTEM_MOVESIZEEND, INV_SYSTEM_MOVESIZEEND },
+    { INV_SYSTEM_MINIMIZESTART, INV_SYSTEM_MINIMIZEEND },
+};
+
+static const int WINDOWS = 24;
+
+static void Session(long long endMs, std::mt19937& rng, std::vector<ScriptedEvent>& events,
+                    std::vector<long long>& tabs) {
+    std::uniform_int_distribution<int> window(0, 15), jitter(0, 999);
+    for (long long t = 0; t < endMs; t += 100) {
+        // Typing: value changes and caret moves in a child control
+        if ((t / 10000) % 2 == 0) {
+            events.push_back({ t, 0x800E, 0, false });                      // EVENT_OBJECT_VALUECHANGE
+            events.push_back({ t + 1, INV_OBJECT_LOCATIONCHANGE, 0, false });  // Caret
+        }
+        if (t % 5000 == 0) events.push_back({ t + 2, INV_OBJECT_NAMECHANGE, 1, true });  // Browser tab title
+        if (t % 4000 == 0) {
+            int w = window(rng);
+            events.push_back({ t + 3, INV_SYSTEM_FOREGROUND, w, true });
+            events.push_back({ t + 4, 0x8005, w, true });                   // EVENT_OBJECT_FOCUS
+        }
+        if (t % 20000 == 0) {
+            int w = window(rng);
+            events.push_back({ t + 5, 0x000A, w, true });                   // EVENT_SYSTEM_MOVESIZESTART
+            for (int k = 0; k < 60; k++) events.push_back({ t + 6 + 16 * k, INV_OBJECT_LOCATIONCHANGE, w, true });
+            events.push_back({ t + 6 + 16 * 60, INV_SYSTEM_MOVESIZEEND, w, true });
+        }
+        if (t % 90000 == 50000) {
+            int w = 16 + (int)(t / 90000) % (WINDOWS - 16);
+            events.push_back({ t + 7, INV_OBJECT_CREATE, w, true });
+            events.push_back({ t + 8, INV_OBJECT_SHOW, w, true });
+            events.push_back({ t + 9, INV_OBJECT_NAMECHANGE, w, true });
+        }
+        if (t % 3000 == 0) tabs.push_back(t + jitter(rng));
+    }
+    std::stable_sort(events.begin(), events.end(),
+                     [](const ScriptedEvent& a, const ScriptedEvent& b) { return a.ms < b.ms; });
+    std::sort(tabs.begin(), tabs.end());
+}
+
+static void Report(const char* name, const ReplayStats& s, long long endMs) {
+    std::printf("%-10s %10d %9d %9d %10.2f%% %8d/%d %6d %8.0f %8.0f\n", name, s.delivered, s.relevant,
+                s.rebuilds, 100.0 * s.staleMs / endMs, s.tabs - s.tabsFresh, s.tabs, s.tabsMoved,
+                s.TabLatencyPercentile(50), s.TabLatencyPercentile(99));
+}
+
+int main(int argc, char** argv) {
+    bool quick = BenchQuick(argc, argv);
+    long long endMs = quick ? 60000 : 600000;
+    std::mt19937 rng(7);
+    std::vector<ScriptedEvent> events;
+    std::vector<long long> tabs;
+    Session(endMs, rng, events, tabs);
+
+    // Assumed UI-thread costs: highlighting from a snapshot, and per window
+    // an inline enumeration (window text crosses into the owning process)
+    // and one GetWindowRect
+    TabCosts costs;
+    costs.highlightUs = 400;
+    costs.enumerateUsPerWindow = 60;
+    costs.rectCheckUsPerWindow = 2;
+    std::printf("costs: highlight %.0f us, enumerate %.0f us/window, rect check %.0f us/window, %d windows\n",
+                costs.highlightUs, costs.enumerateUsPerWindow, costs.rectCheckUsPerWindow, WINDOWS);
+    std::printf("%-10s %10s %9s %9s %11s %10s %6s %8s %8s\n", "hooks", "delivered", "relevant", "rebuilds",
+                "stale", "tab enum", "moved", "p50 us", "p99 us");
+    InventoryReplay old(OLD_RANGES, 2, 100, WINDOWS, costs);
+    Report("old", old.Run(events, tabs, endMs), endMs);
+    InventoryReplay checked(TAB_CHECK_RANGES, 5, 100, WINDOWS, costs, true);
+    Report("tab check", checked.Run(events, tabs, endMs), endMs);
+    InventoryReplay current(INVENTORY_EVENT_RANGES, INVENTORY_EVENT_RANGE_COUNT, 100, WINDOWS, costs);
+    Report("now", current.Run(events, tabs, endMs), endMs);
+
+    // Cost of the filter itself, per delivered event
+    int stales = 0;
+    double ns = BenchBestNs(quick ? 1 : 20, [&] {
+        for (const ScriptedEvent& e : events) stales += InventoryEventStales(e.event, true, e.topLevel);
+    });
+    DoNotOptimize(stales);
+    std::printf("filter: %.1f ns/event over %zu events\n", ns / events.size(), events.size());
+    return 0;
+}
@@ -0,0 +1,56 @@
+// BufferPool.h - Long-lived paint surfaces with memory accounting
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+// The caller supplies how a surface is created and destroyed; the pool only
+// decides when, and keeps count of the bytes held.
+#pragma once
+
+#include <cstddef>
+
+// Bytes held by every surface of a pool, and how often paints reused a
+// surface rather than allocating one
+struct BufferPoolStats {
+    size_t bytes;           // Currently allocated (4 bytes per pixel)
+    size_t peakBytes;       // High-water mark of bytes
+    unsigned allocations;   // Surfaces created
+    unsigned reuses;        // Acquires served by the surface already held
+};
+
+// One off-screen surface kept alive across paints. It is only reallocated
+// when the requested size changes (display topology change).
+template <typename Surface>
+struct PooledBuffer {
+    Surface surface;
+    int width, height;      // 0 x 0 = none held
+};
+
+inline size_t PooledBufferBytes(int w, int h) {
+    return (size_t)w * h * 4;
+}
+
+// Destroy the surface b holds, if any
+template <typename Surface, typename Destroy>
+void ReleasePooledBuffer(PooledBuffer<Surface>& b, BufferPoolStats& stats, Destroy&& destroy) {
+    if (!b.width) return;
+    destroy(b.surface);
+    stats.bytes -= PooledBufferBytes(b.width, b.height);
+    b = {};
+}
+
+// The surface of exactly w x h (both > 0), reusing the one b holds if it has
+// that size; otherwise it is destroyed and create(w, h) makes a new one
+template <typename Surface, typename Create, typename Destroy>
+Surface& AcquirePooledBuffer(PooledBuffer<Surface>& b, BufferPoolStats& stats, int w, int h,
+                             Create&& create, Destroy&& destroy) {
+    if (b.width == w && b.height == h) {
+        stats.reuses++;
+        return b.surface;
+    }
+    ReleasePooledBuffer(b, stats, destroy);
+    b.surface = create(w, h);
+    b.width = w;
+    b.height = h;
+    stats.allocations++;
+    stats.bytes += PooledBufferBytes(w, h);
+    if (stats.bytes > stats.peakBytes) stats.peakBytes = stats.bytes;
+    return b.surface;
+}
@@ -0,0 +1,160 @@
+// CellAtlas.h - Pre-rendered typing-highlight appearances of a cell size
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+// Rect is any type with int-like left/top/right/bottom.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/GridCells.h"
+#include "core/GridRaster.h"
+#include "core/Palette.h"
+#include "core/ZoomMath.h"
+
+// Main-label text styles used by the typing highlights
+enum LabelStyle { LABEL_DIM, LABEL_PARTIAL, LABEL_MATCH, LABEL_STYLE_COUNT };
+#define CELL_SPRITE_COUNT (CELL_MATCH_SUB_A + 8 - CELL_DIM)
+
+// Everything a highlighted cell of one size can look like, rendered once per
+// palette: a row of cell sprites (one per CellState above CELL_BASE, without
+// the main label) followed by one strip of the letters a-z per LabelStyle.
+// Repainting a highlighted cell is then one sprite blit plus a glyph blit
+// per letter.
+struct CellAtlasLayout {
+    int cellW, cellH;
+    int width, height;       // Whole atlas
+    int glyphH;              // Height of each glyph strip
+    int glyphX[26];          // Glyph offsets within a strip (same for all strips)
+    int glyphW[26];
+};
+
+// Palette entries the atlas is drawn in, as color classes for its spans and glyphs
+enum CellAtlasColor : uint8_t {
+    ATLAS_DIM_BG, ATLAS_PARTIAL_BG, ATLAS_MATCH_BG, ATLAS_MATCH_LINE, ATLAS_SUB_HIGHLIGHT_BG,
+    ATLAS_SUB_HIGHLIGHT_TEXT, ATLAS_SUB_LABEL_TEXT, ATLAS_DIM_TEXT, ATLAS_PARTIAL_TEXT,
+    ATLAS_MATCH_TEXT, ATLAS_COLOR_COUNT
+};
+
+static PaletteColor Palette::* const CELL_ATLAS_COLORS[ATLAS_COLOR_COUNT] = {
+    &Palette::dimBg, &Palette::partialMatchBg, &Palette::matchCellBg, &Palette::matchGridLine,
+    &Palette::matchSubHighlightBg, &Palette::matchSubHighlightText, &Palette::matchSubLabelText,
+    &Palette::dimText, &Palette::partialMatchText, &Palette::matchLabelText,
+};
+
+// Background and text of each LabelStyle's strip
+static const CellAtlasColor LABEL_STYLE_COLORS[LABEL_STYLE_COUNT][2] = {
+    { ATLAS_DIM_BG,     ATLAS_DIM_TEXT },
+    { ATLAS_PARTIAL_BG, ATLAS_PARTIAL_TEXT },
+    { ATLAS_MATCH_BG,   ATLAS_MATCH_TEXT },
+};
+
+// Lay out the atlas for cells of cellW x cellH whose main font is face
+inline CellAtlasLayout PlanCellAtlas(int cellW, int cellH, const GlyphFace& face) {
+    CellAtlasLayout a = {};
+    a.cellW = cellW;
+    a.cellH = cellH;
+    a.glyphH = face.height;
+    int stripW = 0;
+    for (int c = 0; c < 26; c++) {
+        a.glyphX[c] = stripW;
+        a.glyphW[c] = face.advance[c];
+        stripW += face.advance[c];
+    }
+    a.width = cellW * CELL_SPRITE_COUNT > stripW ? cellW * CELL_SPRITE_COUNT : stripW;
+    a.height = cellH + a.glyphH * LABEL_STYLE_COUNT;
+    return a;
+}
+
+// Record the atlas: sprites for dim, partial, match, then match with each
+// sub-cell highlighted, then the main-label letters on each style's
+// background. Letters in the strips are clipped to their advance.
+inline void BuildCellAtlasModel(BaseGridModel& m, const PixelSurface& s, const CellAtlasLayout& a,
+                                const GridGlyphs& glyphs) {
+    struct Box { int left, top, right, bottom; };
+    m.spans.clear();
+    m.glyphs.clear();
+    for (int state = CELL_DIM; state < CELL_MATCH_SUB_A + 8; state++) {
+        Box rc = { (state - CELL_DIM) * a.cellW, 0, (state - CELL_DIM + 1) * a.cellW, a.cellH };
+        uint8_t bg = state == CELL_DIM ? ATLAS_DIM_BG : state == CELL_PARTIAL ? ATLAS_PARTIAL_BG : ATLAS_MATCH_BG;
+        BatchFillRect(m.spans, s, rc, bg);
+        if (state < CELL_MATCH) continue;
+
+        for (int k = 1; k < 3; k++) {
+            int x = PartEdge(rc.left, rc.right, 3, k), y = PartEdge(rc.top, rc.bottom, 3, k);
+            BatchLine(m.spans, s, x, rc.top, x, rc.bottom, 1, ATLAS_MATCH_LINE);
+            BatchLine(m.spans, s, rc.left, y, rc.right, y, 1, ATLAS_MATCH_LINE);
+        }
+
+        int highlightIdx = state - CELL_MATCH_SUB_A;  // negative for plain match
+        int subLabelIdx = 0;
+        for (int k = 0; k < 9; k++) {
+            if (k == 4) continue;
+            Box subRect = SubCellRect(rc, k);
+            if (subLabelIdx == highlightIdx) BatchFillRect(m.spans, s, subRect, ATLAS_SUB_HIGHLIGHT_BG);
+            RecordText(m.glyphs, s, glyphs.sub, &SUB_LABELS[subLabelIdx], 1, subRect,
+                       subLabelIdx == highlightIdx ? ATLAS_SUB_HIGHLIGHT_TEXT : ATLAS_SUB_LABEL_TEXT);
+            subLabelIdx++;
+        }
+    }
+
+    for (int style = 0; style < LABEL_STYLE_COUNT; style++) {
+        int top = a.cellH + style * a.glyphH;
+        Box strip = { 0, top, a.width, top + a.glyphH };
+        BatchFillRect(m.spans, s, strip, LABEL_STYLE_COLORS[style][0]);
+        for (int c = 0; c < 26; c++) {
+            wchar_t ch = (wchar_t)(L'a' + c);
+            Box rcGlyph = { a.glyphX[c], top, a.glyphX[c] + a.glyphW[c], top + a.glyphH };
+            RecordText(m.glyphs, s, glyphs.main, &ch, 1, rcGlyph, LABEL_STYLE_COLORS[style][1]);
+        }
+    }
+    BuildSpanBands(s, m.spans, m.bands);
+}
+
+// Paint the atlas into s (at least a.width x a.height) in palette p
+inline void PaintCellAtlas(PixelSurface& s, const CellAtlasLayout& a, const GridGlyphs& glyphs,
+                           const Palette& p) {
+    BaseGridModel m;
+    BuildCellAtlasModel(m, s, a, glyphs);
+    uint32_t lut[ATLAS_COLOR_COUNT];
+    for (int c = 0; c < ATLAS_COLOR_COUNT; c++) lut[c] = SurfacePixel(p.*CELL_ATLAS_COLORS[c]);
+    PaintGridModel(s, m, lut);
+}
+
+// The glyph blits of an n-letter label centred in cell (like DT_CENTERED)
+// and clipped to clip: blit(dstX, dstY, w, h, srcX, srcY) copies a box of
+// the atlas in style's strip
+template <typename Rect, typename Blit>
+void ForEachLabelBlit(const CellAtlasLayout& a, int style, const wchar_t* label, int n,
+                      const Rect& cell, const Rect& clip, Blit blit) {
+    int textW = 0;
+    for (int k = 0; k < n; k++) textW += a.glyphW[label[k] - L'a'];
+    int x = (int)cell.left + ((int)(cell.right - cell.left) - textW) / 2;
+    int y = (int)cell.top + ((int)(cell.bottom - cell.top) - a.glyphH) / 2;
+    int srcY = a.cellH + style * a.glyphH;
+    int top = y > (int)clip.top ? y : (int)clip.top;
+    int bottom = y + a.glyphH < (int)clip.bottom ? y + a.glyphH : (int)clip.bottom;
+    for (int k = 0; k < n; k++) {
+        int c = label[k] - L'a';
+        int left = x > (int)clip.left ? x : (int)clip.left;
+        int right = x + a.glyphW[c] < (int)clip.right ? x + a.glyphW[c] : (int)clip.right;
+        if (left < right && top < bottom) {
+            blit(left, top, right - left, bottom - top, a.glyphX[c] + (left - x), srcY + (top - y));
+        }
+        x += a.glyphW[c];
+    }
+}
+
+// The clip of a cell's main label in state: inside the centre sub-cell for
+// full matches, so it never covers sub-grid lines, else the whole cell
+template <typename Rect>
+Rect LabelClip(const Rect& cell, int state) {
+    if (state < CELL_MATCH) return cell;
+    Rect center = SubCellRect(cell, 4);
+    center.left++;
+    center.top++;
+    return center;
+}
+
+inline int LabelStyleOf(int state) {
+    return state >= CELL_MATCH ? LABEL_MATCH : state == CELL_DIM ? LABEL_DIM : LABEL_PARTIAL;
+}
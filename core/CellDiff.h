@@ -0,0 +1,42 @@
+// CellDiff.h - Typing-highlight state diff over the grid cells
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+#pragma once
+
+#include <string>
+
+#include "core/GridCells.h"
+#include "core/LabelCodes.h"
+
+// Recompute every cell's CellState for the typed letters and report the
+// cells whose state changed, calling invalidate(rect) for each. Changed
+// cells that are horizontal neighbours in a grid row are merged into one
+// rect to keep the update region small. Returns the number of changed cells.
+template <typename Rect, typename Point, typename Invalidate>
+int UpdateTypedCellStates(GridCellArrays<Rect, Point>& cells, const std::wstring& typed,
+                          Invalidate&& invalidate) {
+    int typedLen = (int)typed.length();
+    LabelCode typedCode = PackTypedPrefix(typed, typedLen < MAX_LABEL_LETTERS ? typedLen : MAX_LABEL_LETTERS);
+    Rect run = {};
+    bool haveRun = false;
+    int changed = 0;
+
+    for (int i = 0; i < cells.count; i++) {
+        int labelLen = LabelLength(cells.label[i]);
+        wchar_t subChar = typedLen == labelLen + 1 ? typed[labelLen] : 0;
+        uint8_t state = TypedCellState(cells.label[i], typedCode, typedLen, subChar);
+        if (state == cells.state[i]) continue;
+        cells.state[i] = state;
+        changed++;
+
+        const Rect& rc = cells.rect[i];
+        if (haveRun && rc.left == run.right && rc.top == run.top && rc.bottom == run.bottom) {
+            run.right = rc.right;
+            continue;
+        }
+        if (haveRun) invalidate(run);
+        run = rc;
+        haveRun = true;
+    }
+    if (haveRun) invalidate(run);
+    return changed;
+}
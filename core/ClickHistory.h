@@ -0,0 +1,355 @@
+// ClickHistory.h - Decayed click counts that give the most clicked cells the shortest codes
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+// Monitor is any type with a NUL-terminated wchar_t device[] name and int
+// gridCols, gridRows; its cells are numbered row * gridCols + col.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cwchar>
+#include <string>
+#include <vector>
+
+#include "core/LabelCodes.h"
+
+#define CLICK_HALF_LIFE 500            // Clicks after which a click counts half
+#define CLICK_HISTORY_ENTRIES 32       // Histories kept; the least recently clicked is dropped
+#define CLICK_CELLS_PER_HISTORY 512    // Cells a history counts; the coldest makes way for a new one
+#define CLICK_APP_MIN_CLICKS 20        // Clicks before an app's own history ranks its codes
+#define CLICK_SUB_MIN_CLICKS 4         // Clicks on a cell before its sub-cells are predicted
+#define CLICK_SUB_MIN_SHARE 0.6f       // Share of a cell's clicks its predicted sub-cell needs
+#define CLICK_NAME_LEN 64              // Device and app names, NUL included
+#define CLICK_SUB_CENTER 4             // Sub-cell under the cell label, where codes land by default
+
+// Each monitor layout (device and grid size) has one history of every click
+// on it, and one per foreground app (its process image name) that clicked
+// there. A history counts clicks per cell and sub-cell, for the cells
+// clicked most recently and often; cells are ranked by their summed count.
+//
+// Decay is per click with a half-life of CLICK_HALF_LIFE clicks on that
+// history: instead of scaling every count, each click adds a weight that
+// grows by the inverse factor, and all counts are rescaled once that weight
+// gets large. Memory is bounded: at most CLICK_HISTORY_ENTRIES histories of
+// CLICK_CELLS_PER_HISTORY cells each (about 20 KB apiece).
+struct ClickCell {
+    uint16_t cell;
+    float sub[9];                    // Decayed clicks per sub-cell (row-major, centre 4)
+};
+
+struct ClickHistory {
+    wchar_t device[CLICK_NAME_LEN];  // Monitor the counts are for
+    wchar_t app[CLICK_NAME_LEN];     // Foreground app, lowercase; empty for every app together
+    int gridCols, gridRows;          // Its layout; a different layout starts over
+    float weight;                    // Added by the next click
+    float total;                     // Sum of cells' counts
+    uint32_t lastUse;                // ClickModel::serial of the last click
+    std::vector<ClickCell> cells;    // Sorted by cell
+};
+
+struct ClickModel {
+    std::vector<ClickHistory> histories;  // At most CLICK_HISTORY_ENTRIES
+    uint32_t serial = 0;                  // Clicks recorded, for least-recent eviction
+};
+
+inline float ClickCellCount(const ClickCell& c) {
+    float sum = 0.0f;
+    for (float v : c.sub) sum += v;
+    return sum;
+}
+
+// Clicks a count amounts to after decay, to the nearest click: the last
+// click counts 1 and each one before it a little less
+inline int RoundedClicks(const ClickHistory& h, float count) {
+    return (int)(count / h.weight * exp2f(1.0f / CLICK_HALF_LIFE) + 0.5f);
+}
+
+inline void CopyClickName(wchar_t* dst, const wchar_t* src) {
+    int n = 0;
+    while (src[n] && n < CLICK_NAME_LEN - 1) {
+        dst[n] = src[n];
+        n++;
+    }
+    dst[n] = 0;
+}
+
+template <typename Monitor>
+const ClickHistory* FindClickHistory(const ClickModel& model, const Monitor& mon, const wchar_t* app) {
+    for (const ClickHistory& h : model.histories) {
+        if (h.gridCols == mon.gridCols && h.gridRows == mon.gridRows && wcscmp(h.app, app) == 0 &&
+            wcsncmp(h.device, mon.device, CLICK_NAME_LEN - 1) == 0) return &h;
+    }
+    return NULL;
+}
+
+// The history that ranks mon's codes while app is in front: the app's own
+// once it has CLICK_APP_MIN_CLICKS, else the one of every app (NULL if the
+// layout was never clicked)
+template <typename Monitor>
+const ClickHistory* RankingClickHistory(const ClickModel& model, const Monitor& mon, const wchar_t* app) {
+    if (app[0]) {
+        const ClickHistory* own = FindClickHistory(model, mon, app);
+        if (own && RoundedClicks(*own, own->total) >= CLICK_APP_MIN_CLICKS) return own;
+    }
+    return FindClickHistory(model, mon, L"");
+}
+
+// Count one click with the history's current weight
+inline void AddClick(ClickHistory& h, int cell, int sub) {
+    auto byCell = [](const ClickCell& c, int cell) { return c.cell < cell; };
+    auto it = std::lower_bound(h.cells.begin(), h.cells.end(), cell, byCell);
+    if (it == h.cells.end() || it->cell != cell) {
+        if (h.cells.size() >= CLICK_CELLS_PER_HISTORY) {
+            auto coldest = std::min_element(h.cells.begin(), h.cells.end(), [](const ClickCell& a, const ClickCell& b) {
+                return ClickCellCount(a) < ClickCellCount(b);
+            });
+            h.total -= ClickCellCount(*coldest);
+            h.cells.erase(coldest);
+            it = std::lower_bound(h.cells.begin(), h.cells.end(), cell, byCell);
+        }
+        ClickCell fresh = {};
+        fresh.cell = (uint16_t)cell;
+        it = h.cells.insert(it, fresh);
+    }
+    it->sub[sub] += h.weight;
+    h.total += h.weight;
+    h.weight *= exp2f(1.0f / CLICK_HALF_LIFE);
+    if (h.weight > 1e6f) {
+        h.total = 0.0f;
+        for (ClickCell& c : h.cells) {
+            for (float& v : c.sub) v /= h.weight;
+            h.total += ClickCellCount(c);
+        }
+        h.weight = 1.0f;
+    }
+}
+
+// Count a click on sub-cell sub of cell on mon, made over app (may be
+// empty), in mon's history and the app's. A new history replaces the least
+// recently clicked one once there are CLICK_HISTORY_ENTRIES.
+template <typename Monitor>
+void RecordClick(ClickModel& model, const Monitor& mon, const wchar_t* app, int cell, int sub) {
+    if (cell < 0 || cell >= mon.gridCols * mon.gridRows || sub < 0 || sub >= 9) return;
+    model.serial++;
+    const wchar_t* keys[2] = { L"", app };
+    for (int k = 0; k < (app[0] ? 2 : 1); k++) {
+        ClickHistory* h = const_cast<ClickHistory*>(FindClickHistory(model, mon, keys[k]));
+        if (!h) {
+            if (model.histories.size() >= CLICK_HISTORY_ENTRIES) {
+                model.histories.erase(std::min_element(model.histories.begin(), model.histories.end(),
+                    [](const ClickHistory& a, const ClickHistory& b) { return a.lastUse < b.lastUse; }));
+            }
+            model.histories.emplace_back();
+            h = &model.histories.back();
+            CopyClickName(h->device, mon.device);
+            CopyClickName(h->app, keys[k]);
+            h->gridCols = mon.gridCols;
+            h->gridRows = mon.gridRows;
+            h->weight = 1.0f;
+            h->total = 0.0f;
+        }
+        AddClick(*h, cell, sub);
+        h->lastUse = model.serial;
+    }
+}
+
+// Fill byCode[rank] with mon's cells, most clicked first while app is in
+// front (see RankingClickHistory). An app's ties fall back to every app's
+// counts; remaining ties, and layouts never clicked, keep cell order.
+template <typename Monitor>
+void RankCellsByClicks(const ClickModel& model, const Monitor& mon, const wchar_t* app, int* byCode) {
+    int count = mon.gridCols * mon.gridRows;
+    for (int i = 0; i < count; i++) byCode[i] = i;
+    const ClickHistory* h = RankingClickHistory(model, mon, app);
+    if (!h) return;
+    const ClickHistory* all = h->app[0] ? FindClickHistory(model, mon, L"") : NULL;
+    std::vector<float> heat(count, 0.0f), tie(count, 0.0f);
+    for (const ClickCell& c : h->cells) {
+        if (c.cell < count) heat[c.cell] = ClickCellCount(c);
+    }
+    if (all) {
+        for (const ClickCell& c : all->cells) {
+            if (c.cell < count) tie[c.cell] = ClickCellCount(c);
+        }
+    }
+    std::stable_sort(byCode, byCode + count, [&heat, &tie](int a, int b) {
+        return heat[a] != heat[b] ? heat[a] > heat[b] : tie[a] > tie[b];
+    });
+}
+
+// Sub-cell a completed code should land on: the one that took at least
+// CLICK_SUB_MIN_SHARE of the cell's clicks, once there are
+// CLICK_SUB_MIN_CLICKS of them, else the centre
+template <typename Monitor>
+int PredictSubCell(const ClickModel& model, const Monitor& mon, const wchar_t* app, int cell) {
+    const ClickHistory* h = RankingClickHistory(model, mon, app);
+    if (!h) return CLICK_SUB_CENTER;
+    auto it = std::lower_bound(h->cells.begin(), h->cells.end(), cell,
+                               [](const ClickCell& c, int cell) { return c.cell < cell; });
+    if (it == h->cells.end() || it->cell != cell) return CLICK_SUB_CENTER;
+    float sum = ClickCellCount(*it);
+    if (RoundedClicks(*h, sum) < CLICK_SUB_MIN_CLICKS) return CLICK_SUB_CENTER;
+    int best = (int)(std::max_element(it->sub, it->sub + 9) - it->sub);
+    return it->sub[best] >= CLICK_SUB_MIN_SHARE * sum ? best : CLICK_SUB_CENTER;
+}
+
+// File layout, little-endian: "KJCH", uint32 version, uint32 history count,
+// uint32 serial; then per history the device and app names (uint8 length
+// and that many UTF-16 units each), uint16 columns and rows, uint32 last
+// use and uint16 cell count, followed per cell by uint16 cell, a uint16
+// mask of the sub-cells clicked and a float count for each. Cells are in
+// ascending order and counts are stored with the weight normalized to 1.
+// Version 1 files (one history per layout, a device name of 32 units, and
+// per cell a uint32-counted (uint16 cell, float count) list) load as every
+// app's histories with their clicks on the centre sub-cells.
+static const char CLICK_HISTORY_MAGIC[4] = { 'K', 'J', 'C', 'H' };
+#define CLICK_HISTORY_VERSION 2
+
+inline void AppendBytes(std::string& out, const void* p, size_t n) {
+    out.append(reinterpret_cast<const char*>(p), n);
+}
+
+inline bool ReadBytes(const std::string& in, size_t& pos, void* p, size_t n) {
+    if (in.size() - pos < n) return false;
+    memcpy(p, in.data() + pos, n);
+    pos += n;
+    return true;
+}
+
+inline void AppendClickName(std::string& out, const wchar_t* name) {
+    uint8_t n = 0;
+    while (name[n] && n < CLICK_NAME_LEN - 1) n++;
+    AppendBytes(out, &n, 1);
+    for (int k = 0; k < n; k++) {
+        uint16_t unit = (uint16_t)name[k];
+        AppendBytes(out, &unit, 2);
+    }
+}
+
+inline bool ReadClickName(const std::string& in, size_t& pos, wchar_t* name) {
+    uint8_t n = 0;
+    if (!ReadBytes(in, pos, &n, 1) || n >= CLICK_NAME_LEN) return false;
+    for (int k = 0; k < n; k++) {
+        uint16_t unit = 0;
+        if (!ReadBytes(in, pos, &unit, 2) || unit == 0) return false;
+        name[k] = (wchar_t)unit;
+    }
+    name[n] = 0;
+    return true;
+}
+
+inline void WriteClickModel(const ClickModel& model, std::string& out) {
+    uint32_t version = CLICK_HISTORY_VERSION, count = (uint32_t)model.histories.size(), serial = model.serial;
+    AppendBytes(out, CLICK_HISTORY_MAGIC, 4);
+    AppendBytes(out, &version, 4);
+    AppendBytes(out, &count, 4);
+    AppendBytes(out, &serial, 4);
+    for (const ClickHistory& h : model.histories) {
+        // Counts too small to survive normalizing are dropped
+        std::vector<ClickCell> cells;
+        for (const ClickCell& c : h.cells) {
+            ClickCell n = c;
+            bool any = false;
+            for (float& v : n.sub) any |= (v /= h.weight) > 0.0f;
+            if (any) cells.push_back(n);
+        }
+        uint16_t cols = (uint16_t)h.gridCols, rows = (uint16_t)h.gridRows, cellCount = (uint16_t)cells.size();
+        AppendClickName(out, h.device);
+        AppendClickName(out, h.app);
+        AppendBytes(out, &cols, 2);
+        AppendBytes(out, &rows, 2);
+        AppendBytes(out, &h.lastUse, 4);
+        AppendBytes(out, &cellCount, 2);
+        for (const ClickCell& c : cells) {
+            uint16_t mask = 0;
+            for (int k = 0; k < 9; k++) mask |= (uint16_t)((c.sub[k] > 0.0f) << k);
+            AppendBytes(out, &c.cell, 2);
+            AppendBytes(out, &mask, 2);
+            for (int k = 0; k < 9; k++) {
+                if (mask & (1 << k)) AppendBytes(out, &c.sub[k], 4);
+            }
+        }
+    }
+}
+
+// Version 1 histories: full device name, (cell, count) pairs
+inline bool ReadClickHistoryV1(const std::string& in, size_t& pos, ClickHistory& h) {
+    uint16_t device[32], cols = 0, rows = 0;
+    uint32_t entries = 0;
+    if (!ReadBytes(in, pos, device, sizeof(device))) return false;
+    for (int k = 0; k < 32; k++) h.device[k] = (wchar_t)device[k];
+    h.device[31] = 0;
+    if (!ReadBytes(in, pos, &cols, 2) || !ReadBytes(in, pos, &rows, 2)) return false;
+    if (!ReadBytes(in, pos, &h.lastUse, 4) || !ReadBytes(in, pos, &entries, 4)) return false;
+    int count = (int)cols * rows;
+    if (count == 0 || count > MAX_CELLS_PER_MONITOR || entries > (uint32_t)count) return false;
+    h.gridCols = cols;
+    h.gridRows = rows;
+    for (uint32_t e = 0; e < entries; e++) {
+        ClickCell c = {};
+        float v = 0.0f;
+        if (!ReadBytes(in, pos, &c.cell, 2) || !ReadBytes(in, pos, &v, 4)) return false;
+        if (c.cell >= count || !(v >= 0.0f && v < 1e30f)) return false;
+        if (v == 0.0f) continue;
+        c.sub[CLICK_SUB_CENTER] = v;
+        h.cells.push_back(c);
+    }
+    std::stable_sort(h.cells.begin(), h.cells.end(), [](const ClickCell& a, const ClickCell& b) {
+        return a.sub[CLICK_SUB_CENTER] > b.sub[CLICK_SUB_CENTER];
+    });
+    if (h.cells.size() > CLICK_CELLS_PER_HISTORY) h.cells.resize(CLICK_CELLS_PER_HISTORY);
+    std::sort(h.cells.begin(), h.cells.end(), [](const ClickCell& a, const ClickCell& b) { return a.cell < b.cell; });
+    for (size_t k = 1; k < h.cells.size(); k++) {
+        if (h.cells[k].cell == h.cells[k - 1].cell) return false;
+    }
+    return true;
+}
+
+inline bool ReadClickHistoryV2(const std::string& in, size_t& pos, ClickHistory& h) {
+    uint16_t cols = 0, rows = 0, cells = 0;
+    if (!ReadClickName(in, pos, h.device) || !ReadClickName(in, pos, h.app)) return false;
+    if (!ReadBytes(in, pos, &cols, 2) || !ReadBytes(in, pos, &rows, 2)) return false;
+    if (!ReadBytes(in, pos, &h.lastUse, 4) || !ReadBytes(in, pos, &cells, 2)) return false;
+    int count = (int)cols * rows;
+    if (count == 0 || count > MAX_CELLS_PER_MONITOR || cells > CLICK_CELLS_PER_HISTORY) return false;
+    h.gridCols = cols;
+    h.gridRows = rows;
+    h.cells.resize(cells);
+    for (int i = 0; i < cells; i++) {
+        ClickCell& c = h.cells[i];
+        uint16_t mask = 0;
+        if (!ReadBytes(in, pos, &c.cell, 2) || !ReadBytes(in, pos, &mask, 2)) return false;
+        if (c.cell >= count || (i && c.cell <= h.cells[i - 1].cell) || mask == 0 || mask >= 1 << 9) return false;
+        for (int k = 0; k < 9; k++) {
+            c.sub[k] = 0.0f;
+            if (!(mask & (1 << k))) continue;
+            if (!ReadBytes(in, pos, &c.sub[k], 4) || !(c.sub[k] > 0.0f && c.sub[k] < 1e30f)) return false;
+        }
+    }
+    return true;
+}
+
+// Parse a saved model, version 1 or 2; a malformed one leaves model as it was
+inline bool ReadClickModel(const std::string& in, ClickModel& model) {
+    size_t pos = 0;
+    char magic[4];
+    uint32_t version = 0, count = 0, serial = 0;
+    if (!ReadBytes(in, pos, magic, 4) || memcmp(magic, CLICK_HISTORY_MAGIC, 4) != 0) return false;
+    if (!ReadBytes(in, pos, &version, 4) || (version != 1 && version != CLICK_HISTORY_VERSION)) return false;
+    if (!ReadBytes(in, pos, &count, 4) || count > CLICK_HISTORY_ENTRIES) return false;
+    if (!ReadBytes(in, pos, &serial, 4)) return false;
+
+    std::vector<ClickHistory> loaded(count);
+    for (ClickHistory& h : loaded) {
+        h.app[0] = 0;
+        if (!(version == 1 ? ReadClickHistoryV1(in, pos, h) : ReadClickHistoryV2(in, pos, h))) return false;
+        h.weight = 1.0f;
+        h.total = 0.0f;
+        for (const ClickCell& c : h.cells) h.total += ClickCellCount(c);
+    }
+    if (pos != in.size()) return false;
+    model.histories.swap(loaded);
+    model.serial = serial;
+    return true;
+}
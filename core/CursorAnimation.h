@@ -0,0 +1,109 @@
+// CursorAnimation.h - Restore-animation frame sizes and cursor image scaling
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define CURSOR_ANIM_START_SIZE 128  // Cursor restore animation: first frame size (px at 96 DPI)
+#define CURSOR_ANIM_END_SIZE 32     // Cursor restore animation: last frame size (px at 96 DPI)
+#define CURSOR_ANIM_STEPS 15        // Cursor restore animation: frames after the first
+#define CURSOR_ANIM_MS 500          // Cursor restore animation: total duration
+#define CURSOR_ANIM_BASE_DPI 96
+#define CURSOR_BASE_SIZE_MAX 256    // Largest cursor size setting Windows offers (px at 96 DPI)
+
+// Cursor size at animation step 0..CURSOR_ANIM_STEPS for a display at dpi:
+// quadratic ease-out, fast shrink at start, slow at end. baseSize is the
+// cursor size setting (px at 96 DPI): the animation ends at it and starts
+// as many times larger as the default schedule does.
+inline int CursorAnimationSize(int step, int dpi, int baseSize = CURSOR_ANIM_END_SIZE) {
+    float t = (float)step / (float)CURSOR_ANIM_STEPS;
+    float eased = 1.0f - (1.0f - t) * (1.0f - t);
+    int start = CURSOR_ANIM_START_SIZE * baseSize / CURSOR_ANIM_END_SIZE * dpi / CURSOR_ANIM_BASE_DPI;
+    int end = baseSize * dpi / CURSOR_ANIM_BASE_DPI;
+    int size = start - (int)((start - end) * eased);
+    return size > end ? size : end;
+}
+
+// Hotspot coordinate hot of a cursor origSize pixels across, moved to one
+// targetSize pixels across; always inside the scaled image
+inline int ScaleCursorHotspot(int hot, int origSize, int targetSize) {
+    if (origSize <= 0) return 0;
+    int scaled = (int)((long long)hot * targetSize / origSize);
+    if (scaled < 0) return 0;
+    return scaled < targetSize ? scaled : targetSize - 1;
+}
+
+// Pixels are 0xAARRGGBB with straight (not premultiplied) alpha, rows top
+// down with no padding.
+
+// A cursor with a color bitmap but no alpha (all alpha bytes 0) takes its
+// transparency from the AND mask instead, read as 32-bit pixels: black is
+// opaque, anything else transparent
+inline void ApplyCursorMaskAlpha(uint32_t* argb, const uint32_t* mask, int count) {
+    for (int i = 0; i < count; i++) {
+        if (argb[i] >> 24) return;
+    }
+    for (int i = 0; i < count; i++) {
+        argb[i] = (mask[i] & 0xFFFFFF) ? 0 : (argb[i] | 0xFF000000u);
+    }
+}
+
+// Resample src (sw x sh) to dst (dw x dh) by area: every destination pixel
+// averages the source area it covers, weighted by coverage, in premultiplied
+// alpha so transparent pixels don't darken the edges. Works for shrinking
+// and enlarging alike.
+inline void ScaleCursorImage(const uint32_t* src, int sw, int sh, uint32_t* dst, int dw, int dh) {
+    // Source x is measured in 1/dw pixels and y in 1/dh, so every edge is
+    // an integer: destination column x covers [x * sw, (x + 1) * sw)
+    for (int y = 0; y < dh; y++) {
+        long long y0 = (long long)y * sh, y1 = (long long)(y + 1) * sh;
+        for (int x = 0; x < dw; x++) {
+            long long x0 = (long long)x * sw, x1 = (long long)(x + 1) * sw;
+            double a = 0, r = 0, g = 0, b = 0;
+            for (long long sy = y0 / dh; sy * dh < y1; sy++) {
+                long long top = sy * dh > y0 ? sy * dh : y0;
+                long long bottom = (sy + 1) * dh < y1 ? (sy + 1) * dh : y1;
+                for (long long sx = x0 / dw; sx * dw < x1; sx++) {
+                    long long left = sx * dw > x0 ? sx * dw : x0;
+                    long long right = (sx + 1) * dw < x1 ? (sx + 1) * dw : x1;
+                    double w = (double)((right - left) * (bottom - top));
+                    uint32_t p = src[sy * sw + sx];
+                    double pa = (double)(p >> 24) * w;
+                    a += pa;
+                    r += ((p >> 16) & 0xFF) * pa;
+                    g += ((p >> 8) & 0xFF) * pa;
+                    b += (p & 0xFF) * pa;
+                }
+            }
+            double area = (double)sw * sh;  // Total weight of one destination pixel
+            uint32_t outA = (uint32_t)(a / area + 0.5);
+            uint32_t outR = 0, outG = 0, outB = 0;
+            if (a > 0) {
+                outR = (uint32_t)(r / a + 0.5);
+                outG = (uint32_t)(g / a + 0.5);
+                outB = (uint32_t)(b / a + 0.5);
+            }
+            dst[y * dw + x] = (outA << 24) | (outR << 16) | (outG << 8) | outB;
+        }
+    }
+}
+
+// Bytes per row of a 1-bit mask for CreateBitmap, whose rows are WORD aligned
+inline int CursorMaskRowBytes(int width) {
+    return (width + 15) / 16 * 2;
+}
+
+// AND mask for a scaled image: bit set (transparent) where alpha is 0,
+// most significant bit first
+inline std::vector<uint8_t> BuildCursorMask(const uint32_t* argb, int width, int height) {
+    int rowBytes = CursorMaskRowBytes(width);
+    std::vector<uint8_t> mask((size_t)rowBytes * height, 0);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if ((argb[y * width + x] >> 24) == 0) mask[y * rowBytes + x / 8] |= (uint8_t)(0x80 >> (x % 8));
+        }
+    }
+    return mask;
+}
@@ -0,0 +1,94 @@
+// FoldedSearch.h - Substring search in case-folded UTF-16 titles
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+// Char is any 16-bit character type: wchar_t on Windows, char16_t elsewhere.
+#pragma once
+
+#include <cstring>
+
+#include "core/Simd.h"
+
+// Titles and query are both case-folded up front, so matching is an exact
+// UTF-16 substring test. The vector kernels compare the needle's first and
+// last characters against 8 (SSE2) or 16 (AVX2) haystack positions per step
+// and only verify the middle where both agree. The kernel is picked once
+// from CPUID; all return the first match position or -1, and all need
+// needleLen of at least 1.
+
+template <typename Char>
+int FindFoldedScalar(const Char* hay, int hayLen, const Char* needle, int needleLen) {
+    for (int i = 0; i + needleLen <= hayLen; i++) {
+        if (hay[i] == needle[0] && memcmp(hay + i, needle, needleLen * sizeof(Char)) == 0) return i;
+    }
+    return -1;
+}
+
+#if KJ_SIMD_X86
+template <typename Char>
+int FindFoldedSse2(const Char* hay, int hayLen, const Char* needle, int needleLen) {
+    static_assert(sizeof(Char) == 2, "The vector kernels compare 16-bit characters");
+    int last = needleLen - 1;
+    __m128i first = _mm_set1_epi16((short)needle[0]);
+    __m128i lastCh = _mm_set1_epi16((short)needle[last]);
+    int i = 0;
+    for (; i + last + 8 <= hayLen; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(hay + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(hay + i + last));
+        // Two mask bits per 16-bit lane
+        unsigned mask = (unsigned)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi16(a, first), _mm_cmpeq_epi16(b, lastCh)));
+        while (mask) {
+            int bit = LowestSetBit(mask);
+            int pos = i + (bit >> 1);
+            if (memcmp(hay + pos + 1, needle + 1, last * sizeof(Char)) == 0) return pos;
+            mask &= ~(3u << bit);
+        }
+    }
+    int tail = FindFoldedScalar(hay + i, hayLen - i, needle, needleLen);
+    return tail < 0 ? -1 : i + tail;
+}
+
+template <typename Char>
+KJ_TARGET_AVX2 int FindFoldedAvx2(const Char* hay, int hayLen, const Char* needle, int needleLen) {
+    static_assert(sizeof(Char) == 2, "The vector kernels compare 16-bit characters");
+    int last = needleLen - 1;
+    __m256i first = _mm256_set1_epi16((short)needle[0]);
+    __m256i lastCh = _mm256_set1_epi16((short)needle[last]);
+    int i = 0;
+    for (; i + last + 16 <= hayLen; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(hay + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(hay + i + last));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi16(a, first), _mm256_cmpeq_epi16(b, lastCh)));
+        while (mask) {
+            int bit = LowestSetBit(mask);
+            int pos = i + (bit >> 1);
+            if (memcmp(hay + pos + 1, needle + 1, last * sizeof(Char)) == 0) return pos;
+            mask &= ~(3u << bit);
+        }
+    }
+    int tail = FindFoldedSse2(hay + i, hayLen - i, needle, needleLen);
+    return tail < 0 ? -1 : i + tail;
+}
+#endif
+
+template <typename Char>
+using FindFoldedFn = int (*)(const Char* hay, int hayLen, const Char* needle, int needleLen);
+
+template <typename Char>
+FindFoldedFn<Char> SelectFindFolded(SimdLevel level) {
+    switch (level) {
+#if KJ_SIMD_X86
+    case SIMD_AVX2: return FindFoldedAvx2<Char>;
+    case SIMD_SSE2: return FindFoldedSse2<Char>;
+#endif
+    default:        return FindFoldedScalar<Char>;
+    }
+}
+
+// First position of needle in hay, or -1. needleLen must be at least 1.
+template <typename Char>
+int FindFolded(const Char* hay, int hayLen, const Char* needle, int needleLen) {
+    static const FindFoldedFn<Char> kernel = SelectFindFolded<Char>(DetectSimdLevel());
+    if (needleLen > hayLen) return -1;
+    return kernel(hay, hayLen, needle, needleLen);
+}
@@ -0,0 +1,107 @@
+// FuzzyMatch.h - Ranked fuzzy matching of a search query against window titles
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+// Char is the title character type: wchar_t on Windows, char16_t elsewhere.
+#pragma once
+
+#include <algorithm>
+#include <cwctype>
+#include <vector>
+
+#include "core/FoldedSearch.h"
+#include "core/TitleIndex.h"
+
+#define SEARCH_SCORE_MATCH 16      // Per matched query character
+#define SEARCH_BONUS_WORD 10       // Match at a word start (title start or after a non-alphanumeric)
+#define SEARCH_BONUS_ADJACENT 8    // Match right after the previous matched character
+#define SEARCH_PENALTY_GAP 3       // Opening a gap between matched characters
+#define SEARCH_PENALTY_GAP_EXT 1   // Each further skipped character in a gap
+
+// Letters and digits continue a word; anything else starts the next one
+template <typename Char>
+inline bool IsTitleWordChar(Char c) {
+    return iswalnum((wint_t)c) != 0;
+}
+
+// Score a title alignment: every matched character earns a base score,
+// more at word starts and when adjacent to the previous match; gaps cost
+template <typename Char>
+int ScoreAlignment(const Char* title, const int* pos, int n) {
+    int score = 0;
+    for (int k = 0; k < n; k++) {
+        int p = pos[k];
+        score += SEARCH_SCORE_MATCH;
+        if (p == 0 || !IsTitleWordChar(title[p - 1])) score += SEARCH_BONUS_WORD;
+        if (k > 0) {
+            int gap = p - pos[k - 1] - 1;
+            if (gap == 0) score += SEARCH_BONUS_ADJACENT;
+            else score -= SEARCH_PENALTY_GAP + SEARCH_PENALTY_GAP_EXT * (gap - 1);
+        }
+    }
+    return score;
+}
+
+// ScoreAlignment of the contiguous alignment pos[k] = start + k
+template <typename Char>
+int ScoreContiguous(const Char* title, int start, int n) {
+    int score = n * SEARCH_SCORE_MATCH + (n - 1) * SEARCH_BONUS_ADJACENT;
+    for (int p = start; p < start + n; p++) {
+        if (p == 0 || !IsTitleWordChar(title[p - 1])) score += SEARCH_BONUS_WORD;
+    }
+    return score;
+}
+
+// Fuzzy-match a folded query against a folded title as a subsequence.
+// Candidates are the leftmost subsequence tightened from its end back to the
+// shortest window and aligned both left and right inside it, plus every
+// contiguous occurrence; the best-scoring one wins. This is a heuristic, not
+// an exhaustive search over alignments. Fills pos[0..n) and returns true on
+// a match. Costs O(len) for the subsequence plus O(n) per contiguous
+// occurrence, so O(len * n) at worst.
+template <typename Char>
+bool FuzzyMatchTitle(const Char* title, int len, const Char* query, int n, int* pos, int* score) {
+    // Leftmost end of any subsequence match
+    int j = 0, end = -1;
+    for (int i = 0; i < len; i++) {
+        if (title[i] == query[j] && ++j == n) { end = i; break; }
+    }
+    if (end < 0) return false;
+    // Latest positions walking back from that end; this also gives the
+    // shortest window [begin, end]
+    auto alignRight = [&]() {
+        for (int i = end, k = n - 1; k >= 0; i--) {
+            if (title[i] == query[k]) pos[k--] = i;
+        }
+    };
+    alignRight();
+    int begin = pos[0];
+    int rightScore = ScoreAlignment(title, pos, n);
+    // Earliest positions inside the window; keep whichever scores better
+    for (int i = begin, k = 0; k < n; i++) {
+        if (title[i] == query[k]) pos[k++] = i;
+    }
+    int leftScore = ScoreAlignment(title, pos, n);
+    if (rightScore > leftScore) alignRight();
+    *score = leftScore > rightScore ? leftScore : rightScore;
+    
+    // Contiguous occurrences, kept only if they beat the subsequence
+    int bestStart = -1;
+    for (int start = FindFolded(title, len, query, n); start >= 0; ) {
+        int s = ScoreContiguous(title, start, n);
+        if (s > *score) { *score = s; bestStart = start; }
+        int next = FindFolded(title + start + 1, len - start - 1, query, n);
+        start = next < 0 ? -1 : start + 1 + next;
+    }
+    if (bestStart >= 0) {
+        for (int k = 0; k < n; k++) pos[k] = bestStart + k;
+    }
+    return true;
+}
+
+// Best score first; ties go to whichever entry tieBefore(a, b) puts first
+template <typename TieBefore>
+void RankSearchHits(std::vector<SearchHit>& hits, TieBefore tieBefore) {
+    std::sort(hits.begin(), hits.end(), [&](const SearchHit& a, const SearchHit& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return tieBefore(a.entry, b.entry);
+    });
+}
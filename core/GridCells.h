@@ -0,0 +1,88 @@
+// GridCells.h - Grid cells as arena-backed arrays, and their typing state
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+// Rect is any type with int-like left/top/right/bottom, Point any with x/y.
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "core/LabelCodes.h"
+
+// Typing-highlight state of a cell; PaintGrid draws from these
+enum CellState : uint8_t {
+    CELL_BASE,          // Untouched - shows the cached base grid
+    CELL_DIM,           // Does not match the typed prefix
+    CELL_PARTIAL,       // Matches the typed prefix, not yet the whole label
+    CELL_MATCH,         // Full label match
+    CELL_MATCH_SUB_A,   // Full match with sub-cell a-h highlighted (A..A+7)
+};
+
+// Grid cells as a structure-of-arrays carved out of one arena allocation
+template <typename Rect, typename Point>
+struct GridCellArrays {
+    int count;
+    Rect* rect;
+    Point* center;
+    Point (*subPoints)[9];  // 3x3 sub-grid points (0-8, center is 4)
+    LabelCode* label;       // Monitor prefix + cell code
+    int* byCode;            // Per monitor slice: the cell (index within the monitor) with each code rank
+    short* gridRow;         // Position in the monitor grid (for checkerboard)
+    short* gridCol;
+    uint8_t* state;         // CellState as of the last update
+    std::vector<uint8_t> arena;
+};
+
+// Size the arena for count cells and point each array at its slice.
+// Arrays are ordered by decreasing alignment so no padding is needed.
+template <typename Rect, typename Point>
+void AllocateGridCells(GridCellArrays<Rect, Point>& cells, int count) {
+    static_assert(alignof(Rect) >= alignof(Point) && alignof(Point) >= alignof(LabelCode) &&
+                  alignof(LabelCode) >= alignof(int) && alignof(int) >= alignof(short),
+                  "arrays must be laid out by decreasing alignment");
+    size_t perCell = sizeof(Rect) + sizeof(Point) * 10 + sizeof(LabelCode) + sizeof(int) + sizeof(short) * 2 + 1;
+    cells.arena.assign(perCell * count, 0);
+    uint8_t* p = cells.arena.data();
+    cells.count = count;
+    cells.rect = reinterpret_cast<Rect*>(p);                 p += sizeof(Rect) * count;
+    cells.center = reinterpret_cast<Point*>(p);              p += sizeof(Point) * count;
+    cells.subPoints = reinterpret_cast<Point(*)[9]>(p);      p += sizeof(Point) * 9 * count;
+    cells.label = reinterpret_cast<LabelCode*>(p);           p += sizeof(LabelCode) * count;
+    cells.byCode = reinterpret_cast<int*>(p);                p += sizeof(int) * count;
+    cells.gridRow = reinterpret_cast<short*>(p);             p += sizeof(short) * count;
+    cells.gridCol = reinterpret_cast<short*>(p);             p += sizeof(short) * count;
+    cells.state = p;
+}
+
+// Copy count cells starting at fromFirst in `from` to toFirst in `to`
+template <typename Rect, typename Point>
+void CopyGridCells(GridCellArrays<Rect, Point>& to, const GridCellArrays<Rect, Point>& from,
+                   int fromFirst, int toFirst, int count) {
+    memcpy(to.rect + toFirst, from.rect + fromFirst, sizeof(Rect) * count);
+    memcpy(to.center + toFirst, from.center + fromFirst, sizeof(Point) * count);
+    memcpy(to.subPoints + toFirst, from.subPoints + fromFirst, sizeof(Point) * 9 * count);
+    memcpy(to.label + toFirst, from.label + fromFirst, sizeof(LabelCode) * count);
+    memcpy(to.byCode + toFirst, from.byCode + fromFirst, sizeof(int) * count);
+    memcpy(to.gridRow + toFirst, from.gridRow + fromFirst, sizeof(short) * count);
+    memcpy(to.gridCol + toFirst, from.gridCol + fromFirst, sizeof(short) * count);
+}
+
+// CellState of a cell with label after typedLen letters, whose first
+// MAX_LABEL_LETTERS are packed in typedCode. Letters past a complete label
+// pick a sub-position; subChar is the letter right after the label, if any.
+// The monitor prefix alone leaves its own monitor's cells on the base grid,
+// so the first letter repaints only the monitors it dims.
+inline uint8_t TypedCellState(LabelCode label, LabelCode typedCode, int typedLen, wchar_t subChar) {
+    if (typedLen == 0) return CELL_BASE;
+    int labelLen = LabelLength(label);
+    if (typedLen > labelLen + 1 ||
+        !LabelHasPrefix(label, typedCode, typedLen < labelLen ? typedLen : labelLen)) {
+        return CELL_DIM;
+    }
+    if (typedLen == 1 && labelLen > 1) return CELL_BASE;
+    if (typedLen < labelLen) return CELL_PARTIAL;
+    if (typedLen == labelLen + 1 && subChar >= L'a' && subChar <= L'h') {
+        return (uint8_t)(CELL_MATCH_SUB_A + (subChar - L'a'));
+    }
+    return CELL_MATCH;
+}
@@ -0,0 +1,41 @@
+// GridLayout.h - Grid cell layout per monitor
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+#pragma once
+
+#include "core/LabelCodes.h"
+
+#define TARGET_CELL_SIZE_DIP 86  // Target cell size in device-independent pixels (at 96 DPI)
+#define DEFAULT_DPI 96           // Standard Windows DPI baseline
+
+struct GridSize {
+    int cols, rows;
+};
+
+// Cell columns and rows for a width x height monitor at dpi: cells of
+// about TARGET_CELL_SIZE_DIP, as many as MAX_CODE_LETTERS can label
+inline GridSize PlanGridSize(int width, int height, int dpi) {
+    int targetCellPx = TARGET_CELL_SIZE_DIP * dpi / DEFAULT_DPI;
+    GridSize size = { width / targetCellPx, height / targetCellPx };
+    if (size.cols < 1) size.cols = 1;
+    if (size.rows < 1) size.rows = 1;
+    // Codes grow with the cell count; cap at what MAX_CODE_LETTERS can label
+    while (size.cols * size.rows > MAX_CELLS_PER_MONITOR) {
+        if (size.cols > size.rows) size.cols--; else size.rows--;
+    }
+    return size;
+}
+
+// Rect of the cell at col, row of a monitor split into size cells. The
+// last column and row take the pixels the division left over, so the cells
+// tile the monitor.
+template <typename Rect>
+Rect GridCellRect(const Rect& monitor, GridSize size, int col, int row) {
+    int cellWidth = (monitor.right - monitor.left) / size.cols;
+    int cellHeight = (monitor.bottom - monitor.top) / size.rows;
+    Rect rc = monitor;
+    rc.left = monitor.left + col * cellWidth;
+    rc.top = monitor.top + row * cellHeight;
+    rc.right = col == size.cols - 1 ? monitor.right : rc.left + cellWidth;
+    rc.bottom = row == size.rows - 1 ? monitor.bottom : rc.top + cellHeight;
+    return rc;
+}
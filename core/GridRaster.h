@@ -0,0 +1,657 @@
+// GridRaster.h - Software rasterizer for the base grid
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+// Rect is any type with int-like left/top/right/bottom, Point any with x/y.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "core/GridCells.h"
+#include "core/Palette.h"
+#include "core/Simd.h"
+#include "core/ZoomMath.h"
+
+// The base grid is drawn into plain 32bpp memory rather than through a
+// device context; solid rects, axis-aligned lines and glyph blits are all it
+// needs. The platform's part, behind GridRasterBackend, shrinks to
+// rasterizing the letters a-z once per font size and handing out the tile
+// memory it presents.
+
+static const wchar_t* const SUB_LABELS = L"abcdefgh";  // Sub-cells, row-major around the centre
+
+// Top-down 0x00RRGGBB pixels, the layout of a 32bpp DIB section
+struct PixelSurface {
+    uint32_t* pixels;
+    int width, height;
+    int stride;             // Pixels per row
+};
+
+inline uint32_t SurfacePixel(PaletteColor c) {
+    return ((c & 0xFF) << 16) | (c & 0xFF00) | ((c >> 16) & 0xFF);
+}
+
+// Base grid pixels come from a handful of palette entries, so the grid is
+// recorded by color class rather than color and looked up through a table
+// when drawn. A hue change then repaints from the recorded grid without
+// laying anything out again.
+enum GridColorClass : uint8_t {
+    GRID_BACKGROUND, GRID_CELL_EVEN, GRID_CELL_ODD, GRID_LINE, GRID_SUB_LINE,
+    GRID_MAIN_LABEL, GRID_SUB_LABEL, GRID_CLASS_COUNT
+};
+
+static PaletteColor Palette::* const GRID_CLASS_COLORS[GRID_CLASS_COUNT] = {
+    &Palette::background, &Palette::cellBgEven, &Palette::cellBgOdd, &Palette::gridLine,
+    &Palette::subGridLine, &Palette::mainLabelText, &Palette::subLabelText,
+};
+
+// Solid fills are batched rather than drawn one by one. Rows only change
+// where some rect starts or ends, so each band between those edges is
+// rasterized as a single scanline and copied down the rest of the band.
+// A full grid is then a few span fills per band plus row copies, instead of
+// a pass over every pixel of every cell and line.
+
+// A solid rect already clipped to the surface. color indexes the lut the
+// batch is drawn with: a GridColorClass for the base grid.
+struct SpanRect {
+    int left, top, right, bottom;
+    uint8_t color;
+};
+
+// Fills in draw order; later ones paint over earlier ones
+typedef std::vector<SpanRect> SpanBatch;
+
+// A batch split into bands: rows [edges[b], edges[b + 1]) are all alike and
+// covered by batch[rects[k]] for k in [start[b], start[b + 1]), in draw order
+struct SpanBands {
+    std::vector<int> edges;
+    std::vector<int> start;
+    std::vector<int> rects;
+};
+
+typedef void (*FillSpanFn)(uint32_t* dst, int n, uint32_t px);
+
+inline void FillSpanScalar(uint32_t* dst, int n, uint32_t px) {
+    for (int i = 0; i < n; i++) dst[i] = px;
+}
+
+#if KJ_SIMD_X86
+inline void FillSpanSse2(uint32_t* dst, int n, uint32_t px) {
+    __m128i v = _mm_set1_epi32((int)px);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_si128((__m128i*)(dst + i), v);
+    FillSpanScalar(dst + i, n - i, px);
+}
+
+KJ_TARGET_AVX2 inline void FillSpanAvx2(uint32_t* dst, int n, uint32_t px) {
+    __m256i v = _mm256_set1_epi32((int)px);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) _mm256_storeu_si256((__m256i*)(dst + i), v);
+    FillSpanSse2(dst + i, n - i, px);
+}
+#endif
+
+inline FillSpanFn SelectFillSpan(SimdLevel level) {
+    switch (level) {
+#if KJ_SIMD_X86
+    case SIMD_AVX2: return FillSpanAvx2;
+    case SIMD_SSE2: return FillSpanSse2;
+#endif
+    default:        return FillSpanScalar;
+    }
+}
+
+// Queue rc, clipped to the surface, like FillRect with a solid brush
+template <typename Rect>
+void BatchFillRect(SpanBatch& batch, const PixelSurface& s, const Rect& rc, uint8_t color) {
+    SpanRect r;
+    r.left = (std::max)((int)rc.left, 0);
+    r.right = (std::min)((int)rc.right, s.width);
+    r.top = (std::max)((int)rc.top, 0);
+    r.bottom = (std::min)((int)rc.bottom, s.height);
+    if (r.left >= r.right || r.top >= r.bottom) return;
+    r.color = color;
+    batch.push_back(r);
+}
+
+// Horizontal or vertical line covering the pixels MoveToEx/LineTo would with
+// a PS_SOLID pen of this width: a 1-pixel pen leaves out the end point, wider
+// pens are centred on the line and cover both ends. GDI rounds those end
+// caps where this squares them off, which only shows where no other line meets.
+inline void BatchLine(SpanBatch& batch, const PixelSurface& s,
+                      int x0, int y0, int x1, int y1, int width, uint8_t color) {
+    int half = width / 2;
+    SpanRect rc;
+    if (y0 == y1) {
+        int lo = (std::min)(x0, x1), hi = (std::max)(x0, x1) + 1;
+        if (width <= 1) { if (x0 < x1) hi--; else lo++; }
+        else { lo -= half; hi += width - half - 1; }
+        rc.left = lo; rc.right = hi;
+        rc.top = y0 - half; rc.bottom = rc.top + width;
+    } else {
+        int lo = (std::min)(y0, y1), hi = (std::max)(y0, y1) + 1;
+        if (width <= 1) { if (y0 < y1) hi--; else lo++; }
+        else { lo -= half; hi += width - half - 1; }
+        rc.top = lo; rc.bottom = hi;
+        rc.left = x0 - half; rc.right = rc.left + width;
+    }
+    BatchFillRect(batch, s, rc, color);
+}
+
+inline void BuildSpanBands(const PixelSurface& s, const SpanBatch& batch, SpanBands& bands) {
+    // Band edges: every row where some rect starts or ends
+    std::vector<int>& edges = bands.edges;
+    edges.clear();
+    edges.reserve(batch.size() * 2 + 2);
+    edges.push_back(0);
+    edges.push_back(s.height);
+    for (const SpanRect& r : batch) {
+        edges.push_back(r.top);
+        edges.push_back(r.bottom);
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    int bandCount = (int)edges.size() - 1;
+
+    // Bucket the rects by the bands they cover, keeping draw order in each
+    std::vector<int> firstBand(batch.size()), lastBand(batch.size());
+    std::vector<int>& bandStart = bands.start;
+    bandStart.assign(bandCount + 1, 0);
+    for (size_t k = 0; k < batch.size(); k++) {
+        firstBand[k] = (int)(std::lower_bound(edges.begin(), edges.end(), batch[k].top) - edges.begin());
+        lastBand[k] = (int)(std::lower_bound(edges.begin(), edges.end(), batch[k].bottom) - edges.begin());
+        for (int b = firstBand[k]; b < lastBand[k]; b++) bandStart[b + 1]++;
+    }
+    for (int b = 0; b < bandCount; b++) bandStart[b + 1] += bandStart[b];
+    bands.rects.resize(bandStart[bandCount]);
+    std::vector<int> fillPos(bandStart.begin(), bandStart.end() - 1);
+    for (size_t k = 0; k < batch.size(); k++) {
+        for (int b = firstBand[k]; b < lastBand[k]; b++) bands.rects[fillPos[b]++] = (int)k;
+    }
+}
+
+// Surfaces at least this big are copied down with non-temporal stores: a
+// monitor-sized tile is far bigger than the cache, so writing around it
+// saves the read of each line a normal store would do first
+#define STREAM_MIN_BYTES (4u << 20)
+
+// dst[0..n) = src[0..n), streaming past the cache wherever dst is aligned
+inline void StreamRow(uint32_t* dst, const uint32_t* src, int n) {
+#if KJ_SIMD_X86
+    int i = 0;
+    for (; i < n && ((uintptr_t)(dst + i) & 15); i++) dst[i] = src[i];
+    for (; i + 4 <= n; i += 4) _mm_stream_si128((__m128i*)(dst + i), _mm_loadu_si128((const __m128i*)(src + i)));
+    for (; i < n; i++) dst[i] = src[i];
+#else
+    memcpy(dst, src, n * sizeof(uint32_t));
+#endif
+}
+
+// Orders the streamed rows before whatever presents the surface
+inline void StreamFence() {
+#if KJ_SIMD_X86
+    _mm_sfence();
+#endif
+}
+
+// Draw the batch one scanline per band, copied down the band, with colors
+// looked up in lut by class. fillSpan defaults to the widest kernel the CPU has.
+inline void RasterizeBands(PixelSurface& s, const SpanBatch& batch, const SpanBands& bands,
+                           const uint32_t* lut, FillSpanFn fillSpan = NULL) {
+    static const FillSpanFn best = SelectFillSpan(DetectSimdLevel());
+    if (!fillSpan) fillSpan = best;
+    size_t rowBytes = (size_t)s.width * sizeof(uint32_t);
+    bool stream = (size_t)s.height * rowBytes >= STREAM_MIN_BYTES;
+    for (size_t b = 0; b + 1 < bands.edges.size(); b++) {
+        uint32_t* row = s.pixels + (size_t)bands.edges[b] * s.stride;
+        for (int k = bands.start[b]; k < bands.start[b + 1]; k++) {
+            const SpanRect& r = batch[bands.rects[k]];
+            fillSpan(row + r.left, r.right - r.left, lut[r.color]);
+        }
+        for (int y = bands.edges[b] + 1; y < bands.edges[b + 1]; y++) {
+            if (stream) StreamRow(s.pixels + (size_t)y * s.stride, row, s.width);
+            else memcpy(s.pixels + (size_t)y * s.stride, row, rowBytes);
+        }
+    }
+    if (stream) StreamFence();
+}
+
+// Per-channel blend toward src by coverage (0-255 in each channel)
+inline uint32_t BlendCoverage(uint32_t dst, uint32_t src, uint32_t cov) {
+    uint32_t out = 0;
+    for (int shift = 0; shift <= 16; shift += 8) {
+        int d = (dst >> shift) & 0xFF, v = (src >> shift) & 0xFF, c = (cov >> shift) & 0xFF;
+        int delta = (v - d) * c;
+        out |= (uint32_t)(d + (delta + (delta >= 0 ? 127 : -127)) / 255) << shift;
+    }
+    return out;
+}
+
+// Coverage masks for the letters a-z in one font, with each channel holding
+// its subpixel's coverage (GDI renders them as white ClearType text on
+// black). Every glyph box has a margin on both sides for overhang past the
+// advance.
+struct GlyphFace {
+    int height;             // Line height, which DT_VCENTER centres
+    int margin;
+    int advance[26];
+    int x[26];              // Left edge of each glyph's box in the mask
+    int maskW;
+    std::vector<uint32_t> coverage;  // maskW x height
+};
+
+// Both grid fonts for one cell size (the CreateGridFonts arguments)
+struct GridGlyphs {
+    int sh, cellW;
+    GlyphFace main, sub;
+};
+
+// What the rasterizer needs from the platform: the grid fonts' letters for
+// a cell size, and the memory of the tiles it draws
+struct GridRasterBackend {
+    virtual ~GridRasterBackend() {}
+    // Glyphs for cells of width cellW whose sub-cells are sh high. The
+    // reference is only good until the next call.
+    virtual const GridGlyphs& Glyphs(int sh, int cellW) = 0;
+    // A top-down width x height surface with stride width, or NULL; *handle
+    // is what ReleaseTile takes back
+    virtual uint32_t* CreateTile(int width, int height, void** handle) = 0;
+    virtual void ReleaseTile(void* handle) = 0;
+};
+
+// One label pixel: blend toward lut entry (cov >> 24) by the per-channel
+// coverage in the low 24 bits of cov
+struct GlyphPixel {
+    uint32_t offset;
+    uint32_t cov;
+};
+
+// The base grid by color class: fills and lines as spans, then label pixels
+// blended over them in draw order. Recorded while a tile is drawn and
+// dropped once it is indexed (see GridToneMap). Cell atlases are recorded
+// the same way, with their own color classes.
+struct BaseGridModel {
+    SpanBatch spans;
+    SpanBands bands;
+    std::vector<GlyphPixel> glyphs;
+};
+
+// A drawn tile is kept by tone rather than by color: tones below the class
+// count are the color classes, and every other tone is an earlier tone
+// blended toward a class by one coverage value. Label ink, overlaps
+// included, then costs a table entry per distinct tone instead of a record
+// per pixel, and a hue change is a table rebuild plus one lookup per run.
+#define TONE_RUN_LENGTH_BITS 10
+#define TONE_RUN_MAX_LENGTH (1 << TONE_RUN_LENGTH_BITS)
+#define TONE_ID_LIMIT (1u << (32 - TONE_RUN_LENGTH_BITS))
+
+struct GridTone {
+    uint32_t base;       // Tone blended over
+    uint32_t cov;        // Class and coverage, as in GlyphPixel
+};
+
+// runs[first, first + count); a row with the same runs as the row above
+// shares them
+struct ToneRow {
+    uint32_t first, count;
+};
+
+struct GridToneMap {
+    int width, height;
+    int classCount;
+    std::vector<GridTone> tones;    // Tone classCount + k is tones[k]
+    std::vector<ToneRow> rows;      // Empty if the tile has no map
+    std::vector<uint32_t> runs;     // tone << TONE_RUN_LENGTH_BITS | (length - 1)
+};
+
+// Draw m into s as tone ids and run-length encode them into map. Fails,
+// leaving map empty, if s has toneLimit tones or more; s holds tone ids
+// rather than colors either way.
+inline bool IndexGridModel(GridToneMap& map, PixelSurface& s, const BaseGridModel& m, int classCount,
+                           uint32_t toneLimit = TONE_ID_LIMIT) {
+    map.width = s.width;
+    map.height = s.height;
+    map.classCount = classCount;
+    map.tones.clear();
+    map.rows.clear();
+    map.runs.clear();
+    uint32_t classIds[256];
+    for (uint32_t c = 0; c < 256; c++) classIds[c] = c;
+    RasterizeBands(s, m.spans, m.bands, classIds);
+
+    std::unordered_map<uint64_t, uint32_t> toneIds;
+    for (const GlyphPixel& g : m.glyphs) {
+        uint32_t& px = s.pixels[g.offset];
+        uint64_t key = (uint64_t)px << 32 | g.cov;
+        auto it = toneIds.find(key);
+        if (it == toneIds.end()) {
+            uint32_t id = (uint32_t)(classCount + map.tones.size());
+            if (id >= toneLimit) {
+                map.tones.clear();
+                return false;
+            }
+            GridTone tone = { px, g.cov };
+            map.tones.push_back(tone);
+            it = toneIds.emplace(key, id).first;
+        }
+        px = it->second;
+    }
+
+    map.rows.resize(s.height);
+    for (int y = 0; y < s.height; y++) {
+        const uint32_t* row = s.pixels + (size_t)y * s.stride;
+        if (y > 0 && memcmp(row, row - s.stride, (size_t)s.width * sizeof(uint32_t)) == 0) {
+            map.rows[y] = map.rows[y - 1];
+            continue;
+        }
+        ToneRow r = { (uint32_t)map.runs.size(), 0 };
+        for (int x = 0; x < s.width;) {
+            int n = 1;
+            while (x + n < s.width && row[x + n] == row[x] && n < TONE_RUN_MAX_LENGTH) n++;
+            map.runs.push_back(row[x] << TONE_RUN_LENGTH_BITS | (uint32_t)(n - 1));
+            x += n;
+        }
+        r.count = (uint32_t)map.runs.size() - r.first;
+        map.rows[y] = r;
+    }
+    return true;
+}
+
+// The color of every tone of map, for class colors classLut
+inline void BuildToneLut(const GridToneMap& map, const uint32_t* classLut, std::vector<uint32_t>& lut) {
+    lut.resize(map.classCount + map.tones.size());
+    for (int c = 0; c < map.classCount; c++) lut[c] = classLut[c];
+    for (size_t k = 0; k < map.tones.size(); k++) {
+        const GridTone& tone = map.tones[k];
+        lut[map.classCount + k] = BlendCoverage(lut[tone.base], classLut[tone.cov >> 24], tone.cov);
+    }
+}
+
+// The remap kernel: each run filled with its tone's color from toneLut, and
+// rows that share runs with the row above copied down from it, streaming
+// on big surfaces as RasterizeBands does
+inline void RemapToneRuns(PixelSurface& s, const GridToneMap& map, const uint32_t* toneLut,
+                          FillSpanFn fillSpan = NULL) {
+    static const FillSpanFn best = SelectFillSpan(DetectSimdLevel());
+    if (!fillSpan) fillSpan = best;
+    size_t rowBytes = (size_t)map.width * sizeof(uint32_t);
+    bool stream = (size_t)map.height * rowBytes >= STREAM_MIN_BYTES;
+    const uint32_t* source = NULL;   // Last row drawn from runs
+    for (int y = 0; y < map.height; y++) {
+        uint32_t* dst = s.pixels + (size_t)y * s.stride;
+        const ToneRow& r = map.rows[y];
+        if (y > 0 && r.first == map.rows[y - 1].first) {
+            if (stream) StreamRow(dst, source, map.width);
+            else memcpy(dst, source, rowBytes);
+            continue;
+        }
+        source = dst;
+        for (uint32_t k = r.first; k < r.first + r.count; k++) {
+            uint32_t run = map.runs[k];
+            int n = (int)(run & (TONE_RUN_MAX_LENGTH - 1)) + 1;
+            uint32_t px = toneLut[run >> TONE_RUN_LENGTH_BITS];
+            if (n < 16) {
+                for (int i = 0; i < n; i++) dst[i] = px;
+            } else {
+                fillSpan(dst, n, px);
+            }
+            dst += n;
+        }
+    }
+    if (stream) StreamFence();
+}
+
+// The cached base grid of one monitor, so the dead space of the virtual
+// screen's bounding box is never allocated. A hue change recolors it in place.
+template <typename Rect>
+struct BaseGridTile {
+    void* handle;        // The backend's tile; NULL until rendered
+    uint32_t* bits;      // Its pixels
+    Rect rc;             // Monitor rect it covers, in screen coordinates
+    GridToneMap tones;
+};
+
+// Record n letters (a-z) centred in rc and clipped to it, as DrawText does
+// with DT_CENTERED. color indexes the lut, as for spans.
+template <typename Rect>
+void RecordText(std::vector<GlyphPixel>& out, const PixelSurface& s, const GlyphFace& face,
+                const wchar_t* text, int n, const Rect& rc, uint8_t color) {
+    int textW = 0;
+    for (int k = 0; k < n; k++) textW += face.advance[text[k] - L'a'];
+    int x = (int)rc.left + ((int)(rc.right - rc.left) - textW) / 2;
+    int y = (int)rc.top + ((int)(rc.bottom - rc.top) - face.height) / 2;
+    int clipL = (std::max)((int)rc.left, 0), clipR = (std::min)((int)rc.right, s.width);
+    int clipT = (std::max)((int)rc.top, 0), clipB = (std::min)((int)rc.bottom, s.height);
+    int y0 = (std::max)(y, clipT), y1 = (std::min)(y + face.height, clipB);
+    uint32_t classBits = (uint32_t)color << 24;
+
+    for (int k = 0; k < n; k++) {
+        int c = text[k] - L'a';
+        int boxL = x - face.margin;
+        int x0 = (std::max)(boxL, clipL);
+        int x1 = (std::min)(boxL + face.advance[c] + 2 * face.margin, clipR);
+        for (int row = y0; row < y1; row++) {
+            const uint32_t* cov = &face.coverage[(size_t)(row - y) * face.maskW + face.x[c] + (x0 - boxL)];
+            uint32_t offset = (uint32_t)((size_t)row * s.stride + x0);
+            for (int i = 0; i < x1 - x0; i++) {
+                if (cov[i]) {
+                    GlyphPixel g = { offset + i, (cov[i] & 0xFFFFFF) | classBits };
+                    out.push_back(g);
+                }
+            }
+        }
+        x += face.advance[c];
+    }
+}
+
+// Record the static base grid (background, checkerboard, lines, labels and
+// sub-labels) for count cells from first, with the surface's top-left at
+// (originX, originY)
+template <typename Rect, typename Point>
+void BuildBaseGridModel(BaseGridModel& m, const PixelSurface& s, int originX, int originY,
+                        const GridCellArrays<Rect, Point>& cells, int first, int count,
+                        GridRasterBackend& backend) {
+    SpanBatch& batch = m.spans;
+    batch.clear();
+    batch.reserve(1 + count * 9);
+    m.glyphs.clear();
+    auto local = [&](int i) {
+        Rect adj = cells.rect[i];
+        adj.left -= originX; adj.right -= originX;
+        adj.top -= originY; adj.bottom -= originY;
+        return adj;
+    };
+
+    // Background fill
+    SpanRect rcFull = { 0, 0, s.width, s.height, GRID_BACKGROUND };
+    BatchFillRect(batch, s, rcFull, GRID_BACKGROUND);
+
+    // Checkerboard cell backgrounds
+    for (int i = first; i < first + count; i++) {
+        bool isEven = ((cells.gridRow[i] + cells.gridCol[i]) % 2 == 0);
+        BatchFillRect(batch, s, local(i), isEven ? GRID_CELL_EVEN : GRID_CELL_ODD);
+    }
+
+    // Grid lines
+    int gridPenWidth = (std::max)(1, s.height / 800);
+    int subPenWidth = (std::max)(1, gridPenWidth / 2);
+    for (int i = first; i < first + count; i++) {
+        Rect adj = local(i);
+        // Sub-grid lines sit on the sub-cell edges (see SubCellRect)
+        int x1 = PartEdge(adj.left, adj.right, 3, 1), x2 = PartEdge(adj.left, adj.right, 3, 2);
+        int y1 = PartEdge(adj.top, adj.bottom, 3, 1), y2 = PartEdge(adj.top, adj.bottom, 3, 2);
+
+        GridColorClass line = GRID_LINE;
+        BatchLine(batch, s, adj.left, adj.top, adj.right, adj.top, gridPenWidth, line);
+        BatchLine(batch, s, adj.right, adj.top, adj.right, adj.bottom, gridPenWidth, line);
+        BatchLine(batch, s, adj.right, adj.bottom, adj.left, adj.bottom, gridPenWidth, line);
+        BatchLine(batch, s, adj.left, adj.bottom, adj.left, adj.top, gridPenWidth, line);
+
+        GridColorClass subLine = GRID_SUB_LINE;
+        BatchLine(batch, s, x1, adj.top, x1, adj.bottom, subPenWidth, subLine);
+        BatchLine(batch, s, x2, adj.top, x2, adj.bottom, subPenWidth, subLine);
+        BatchLine(batch, s, adj.left, y1, adj.right, y1, subPenWidth, subLine);
+        BatchLine(batch, s, adj.left, y2, adj.right, y2, subPenWidth, subLine);
+    }
+
+    BuildSpanBands(s, batch, m.bands);
+
+    // Labels
+    const GridGlyphs* glyphs = NULL;
+    for (int i = first; i < first + count; i++) {
+        Rect adj = local(i);
+        int sw = (adj.right - adj.left) / 3;
+        int sh = (adj.bottom - adj.top) / 3;
+        if (!glyphs || glyphs->sh != sh || glyphs->cellW != sw * 3) {
+            glyphs = &backend.Glyphs(sh, sw * 3);
+        }
+
+        // Center label
+        wchar_t label[MAX_LABEL_LETTERS + 1];
+        int labelLen = FormatLabel(cells.label[i], label);
+        RecordText(m.glyphs, s, glyphs->main, label, labelLen, adj, GRID_MAIN_LABEL);
+
+        // Sub-labels
+        int subLabelIdx = 0;
+        for (int sy = 0; sy < 3; sy++) {
+            for (int sx = 0; sx < 3; sx++) {
+                if (sx == 1 && sy == 1) continue;
+                Rect subRect = SubCellRect(adj, sy * 3 + sx);
+                RecordText(m.glyphs, s, glyphs->sub, &SUB_LABELS[subLabelIdx], 1, subRect, GRID_SUB_LABEL);
+                subLabelIdx++;
+            }
+        }
+    }
+}
+
+// Draw a recorded model with its color classes looked up in lut
+inline void PaintGridModel(PixelSurface& s, const BaseGridModel& m, const uint32_t* lut) {
+    RasterizeBands(s, m.spans, m.bands, lut);
+    for (const GlyphPixel& g : m.glyphs) {
+        s.pixels[g.offset] = BlendCoverage(s.pixels[g.offset], lut[g.cov >> 24], g.cov);
+    }
+}
+
+// Draw a recorded base grid in the colors of palette p
+inline void PaintBaseGrid(PixelSurface& s, const BaseGridModel& m, const Palette& p) {
+    uint32_t lut[GRID_CLASS_COUNT];
+    for (int c = 0; c < GRID_CLASS_COUNT; c++) lut[c] = SurfacePixel(p.*GRID_CLASS_COLORS[c]);
+    PaintGridModel(s, m, lut);
+}
+
+// Draw an indexed base grid in the colors of palette p
+inline void PaintBaseGridTones(PixelSurface& s, const GridToneMap& map, const Palette& p) {
+    uint32_t classLut[GRID_CLASS_COUNT];
+    for (int c = 0; c < GRID_CLASS_COUNT; c++) classLut[c] = SurfacePixel(p.*GRID_CLASS_COLORS[c]);
+    std::vector<uint32_t> toneLut;
+    BuildToneLut(map, classLut, toneLut);
+    RemapToneRuns(s, map, toneLut.data());
+}
+
+template <typename Rect>
+PixelSurface TileSurface(const BaseGridTile<Rect>& tile) {
+    int width = (int)(tile.rc.right - tile.rc.left);
+    PixelSurface s = { tile.bits, width, (int)(tile.rc.bottom - tile.rc.top), width };
+    return s;
+}
+
+// Render the base grid of the monitor at rc, cells [first, first + count),
+// into tile unless it already holds it
+template <typename Rect, typename Point>
+void RenderGridTile(GridRasterBackend& backend, BaseGridTile<Rect>& tile, const Rect& rc,
+                    const GridCellArrays<Rect, Point>& cells, int first, int count, const Palette& p) {
+    if (tile.handle) return;
+    tile.rc = rc;
+    tile.bits = backend.CreateTile((int)(rc.right - rc.left), (int)(rc.bottom - rc.top), &tile.handle);
+    if (!tile.bits) {
+        tile.handle = NULL;
+        return;
+    }
+    PixelSurface surface = TileSurface(tile);
+    BaseGridModel model;
+    BuildBaseGridModel(model, surface, (int)rc.left, (int)rc.top, cells, first, count, backend);
+    if (IndexGridModel(tile.tones, surface, model, GRID_CLASS_COUNT)) PaintBaseGridTones(surface, tile.tones, p);
+    else PaintBaseGrid(surface, model, p);
+}
+
+// Repaint a rendered tile in palette p from its tone map. A tile too
+// detailed to index is released instead, for RenderGridTile to draw again in
+// p; false if the tile needs that.
+template <typename Rect>
+bool RecolorGridTile(GridRasterBackend& backend, BaseGridTile<Rect>& tile, const Palette& p) {
+    if (tile.handle && tile.tones.rows.empty()) {
+        backend.ReleaseTile(tile.handle);
+        tile.handle = NULL;
+    }
+    if (!tile.handle) return false;
+    PixelSurface surface = TileSurface(tile);
+    PaintBaseGridTones(surface, tile.tones, p);
+    return true;
+}
+
+// Drop every tile (display change, exit)
+template <typename Rect>
+void ReleaseGridTiles(GridRasterBackend& backend, std::vector<BaseGridTile<Rect>>& tiles) {
+    for (BaseGridTile<Rect>& t : tiles) {
+        if (t.handle) backend.ReleaseTile(t.handle);
+    }
+    tiles.clear();
+}
+
+// Line the tiles up with a new monitor list: kept[m] is the index of monitor
+// m's tile in the old order if its layout is unchanged, or -1 if it must be
+// redrawn. Tiles of detached or changed monitors are released.
+template <typename Rect>
+void RemapGridTiles(GridRasterBackend& backend, std::vector<BaseGridTile<Rect>>& tiles,
+                    const std::vector<int>& kept) {
+    std::vector<BaseGridTile<Rect>> remapped(kept.size());
+    for (size_t m = 0; m < kept.size(); m++) {
+        if (kept[m] < 0 || kept[m] >= (int)tiles.size()) continue;
+        remapped[m] = std::move(tiles[kept[m]]);
+        tiles[kept[m]].handle = NULL;
+    }
+    ReleaseGridTiles(backend, tiles);
+    tiles.swap(remapped);
+}
+
+// Bytes a tile keeps for recoloring besides its pixels
+inline unsigned long long ToneMapBytes(const GridToneMap& map) {
+    return map.tones.size() * sizeof(GridTone) + map.rows.size() * sizeof(ToneRow) +
+           map.runs.size() * sizeof(uint32_t);
+}
+
+// Base grid memory: bytes the per-monitor tiles hold, against a single 32bpp
+// bitmap over the bounding box of all monitors
+struct GridMemoryUsage {
+    unsigned long long tileBytes;         // Tile pixels, one tile per monitor rect
+    unsigned long long toneMapBytes;      // The tiles' tone maps, if tiles are given
+    unsigned long long boundingBoxBytes;
+};
+
+// Memory for monitors, whose rects are their rc members, with the tone maps
+// of tiles if it is not NULL
+template <typename Monitor, typename Rect>
+GridMemoryUsage MeasureGridMemory(const std::vector<Monitor>& monitors, Rect Monitor::*rc,
+                                  const std::vector<BaseGridTile<Rect>>* tiles = NULL) {
+    GridMemoryUsage usage = {};
+    if (tiles) {
+        for (const BaseGridTile<Rect>& tile : *tiles) {
+            if (tile.handle) usage.toneMapBytes += ToneMapBytes(tile.tones);
+        }
+    }
+    if (monitors.empty()) return usage;
+    const Rect& first = monitors[0].*rc;
+    long long left = first.left, top = first.top, right = first.right, bottom = first.bottom;
+    for (const Monitor& mon : monitors) {
+        const Rect& r = mon.*rc;
+        usage.tileBytes += 4ull * (unsigned long long)(r.right - r.left) * (unsigned long long)(r.bottom - r.top);
+        left = (std::min)(left, (long long)r.left);
+        top = (std::min)(top, (long long)r.top);
+        right = (std::max)(right, (long long)r.right);
+        bottom = (std::max)(bottom, (long long)r.bottom);
+    }
+    usage.boundingBoxBytes = 4ull * (unsigned long long)(right - left) * (unsigned long long)(bottom - top);
+    return usage;
+}
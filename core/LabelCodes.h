@@ -0,0 +1,152 @@
+// LabelCodes.h - Variable-length grid cell codes and packed labels
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+#pragma once
+
+#include <cstdint>
+#include <cwchar>
+#include <string>
+
+// Cell codes are variable-length and prefix-free over a home-row-first
+// alphabet: a monitor with N cells uses codes of `length` letters for the
+// first shortCodes cells, and one letter more for the rest, which is the
+// fewest letters N codes can average. A code is complete as soon as it
+// matches a cell, so the next letter always picks a sub-position.
+static const wchar_t LABEL_ALPHABET[] = L"asdfghjklqwertyuiopzxcvbnm";
+#define LABEL_RADIX 26
+#define MAX_CODE_LETTERS 3          // Letters in the longest cell code
+#define MAX_LABEL_LETTERS (1 + MAX_CODE_LETTERS)
+#define MAX_CELLS_PER_MONITOR (LABEL_RADIX * LABEL_RADIX * LABEL_RADIX)
+
+struct LabelPlan {
+    int length;      // Letters in a short code
+    int shortCodes;  // Cells with a short code; the others get length + 1 letters
+};
+
+// Codes for count cells (at most MAX_CELLS_PER_MONITOR): all codes of the
+// shortest length that fits, with just enough of them split into RADIX
+// longer codes each to cover the rest. The split ones are taken from the
+// end of the alphabet so short codes keep the home-row letters.
+inline LabelPlan PlanLabelCodes(int count) {
+    LabelPlan plan = { 1, count };
+    int full = LABEL_RADIX;
+    while (full * LABEL_RADIX <= count) {
+        plan.length++;
+        full *= LABEL_RADIX;
+    }
+    if (count > full) {
+        int split = (count - full + LABEL_RADIX - 2) / (LABEL_RADIX - 1);
+        plan.shortCodes = full - split;
+    }
+    return plan;
+}
+
+// Alphabet digits of the code for rank (0 = first short code); returns its length
+inline int EncodeLabelRank(const LabelPlan& plan, int rank, int digits[MAX_CODE_LETTERS]) {
+    int value = rank, n = plan.length;
+    if (rank >= plan.shortCodes) {
+        int j = rank - plan.shortCodes;
+        value = plan.shortCodes + j / LABEL_RADIX;
+        digits[n++] = j % LABEL_RADIX;
+    }
+    for (int k = plan.length - 1; k >= 0; k--) {
+        digits[k] = value % LABEL_RADIX;
+        value /= LABEL_RADIX;
+    }
+    return n;
+}
+
+// Rank of the code with n alphabet digits among count cells, or -1 if no
+// cell has that code
+inline int DecodeLabelRank(const LabelPlan& plan, int count, const int* digits, int n) {
+    if (n != plan.length && n != plan.length + 1) return -1;
+    int value = 0;
+    for (int k = 0; k < plan.length; k++) value = value * LABEL_RADIX + digits[k];
+    if (n == plan.length) return value < plan.shortCodes ? value : -1;
+    if (value < plan.shortCodes) return -1;
+    int rank = plan.shortCodes + (value - plan.shortCodes) * LABEL_RADIX + digits[n - 1];
+    return rank < count ? rank : -1;
+}
+
+// Position of a letter in LABEL_ALPHABET, or -1
+inline int LabelDigit(wchar_t ch) {
+    const wchar_t* p = wcschr(LABEL_ALPHABET, ch);
+    return (p && ch) ? (int)(p - LABEL_ALPHABET) : -1;
+}
+
+// Rank of the n-letter code among count cells planned by plan, or -1 if
+// the letters are not a complete code
+inline int DecodeLabelLetters(const LabelPlan& plan, int count, const wchar_t* letters, int n) {
+    if (n < 1 || n > MAX_CODE_LETTERS) return -1;
+    int digits[MAX_CODE_LETTERS];
+    for (int k = 0; k < n; k++) {
+        digits[k] = LabelDigit(letters[k]);
+        if (digits[k] < 0) return -1;
+    }
+    return DecodeLabelRank(plan, count, digits, n);
+}
+
+// Packed label: monitor prefix, then the code letters, one per byte from the
+// top, each stored as letter - 'a' + 1 so unused trailing bytes are 0.
+// Prefix tests compare the top n bytes.
+typedef uint32_t LabelCode;
+
+// Packed label of the code of rank in plan, behind the monitor prefix
+inline LabelCode MakeLabel(wchar_t prefix, const LabelPlan& plan, int rank) {
+    int digits[MAX_CODE_LETTERS];
+    int n = EncodeLabelRank(plan, rank, digits);
+    LabelCode code = (LabelCode)(prefix - L'a' + 1) << 24;
+    for (int k = 0; k < n; k++) {
+        code |= (LabelCode)(LABEL_ALPHABET[digits[k]] - L'a' + 1) << (16 - 8 * k);
+    }
+    return code;
+}
+
+// Pack the first n (1-MAX_LABEL_LETTERS) letters into the top bytes of a LabelCode
+inline LabelCode PackTypedPrefix(const std::wstring& typed, int n) {
+    LabelCode code = 0;
+    for (int i = 0; i < MAX_LABEL_LETTERS; i++) {
+        code <<= 8;
+        if (i < n) code |= (LabelCode)(typed[i] - L'a' + 1);
+    }
+    return code;
+}
+
+// Number of letters in a label, prefix included
+inline int LabelLength(LabelCode code) {
+    return (code & 0xFF) ? 4 : (code & 0xFF00) ? 3 : (code & 0xFF0000) ? 2 : 1;
+}
+
+// True if the first n letters of label equal the packed typed prefix
+inline bool LabelHasPrefix(LabelCode label, LabelCode typed, int n) {
+    int shift = (MAX_LABEL_LETTERS - n) * 8;
+    return (label >> shift) == (typed >> shift);
+}
+
+// Write the label as a string; returns its length
+inline int FormatLabel(LabelCode code, wchar_t out[MAX_LABEL_LETTERS + 1]) {
+    int n = LabelLength(code);
+    for (int k = 0; k < n; k++) {
+        out[k] = (wchar_t)(L'a' + ((code >> (24 - 8 * k)) & 0xFF) - 1);
+    }
+    out[n] = 0;
+    return n;
+}
+
+// Index of the cell the n-letter label names, or -1 if it is not a complete
+// label. monitors[0..monitorCount) have prefix, codes, firstCell and
+// cellCount, as MonitorInfo does; byCode is the per-monitor table of the
+// cell (index within its monitor) with each code rank. The lookup is pure
+// arithmetic plus one table read: the prefix picks the monitor, the code
+// its rank and byCode the cell.
+template <typename Monitor>
+int FindCellByLabel(const Monitor* monitors, int monitorCount, const int* byCode,
+                    const wchar_t* label, int n) {
+    if (n < 2 || n > MAX_LABEL_LETTERS) return -1;
+    for (int m = 0; m < monitorCount; m++) {
+        const Monitor& mon = monitors[m];
+        if (mon.prefix != label[0]) continue;
+        int rank = DecodeLabelLetters(mon.codes, mon.cellCount, label + 1, n - 1);
+        return rank >= 0 ? mon.firstCell + byCode[mon.firstCell + rank] : -1;
+    }
+    return -1;
+}
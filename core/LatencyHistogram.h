@@ -0,0 +1,69 @@
+// LatencyHistogram.h - Fixed-memory HDR-style latency histogram
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Fixed-memory latency histogram in the HDR layout: each power of two is
+// split into 16 linear sub-buckets, so any value is kept to within ~6%.
+// Safe to read while one thread records. Zero-initialized, so give
+// instances static storage.
+struct LatencyHistogram {
+    static const int SUB_BITS = 4;
+    static const int SUB_COUNT = 1 << SUB_BITS;
+    static const int BUCKET_COUNT = (64 - SUB_BITS + 1) * SUB_COUNT;  // Covers every 64-bit value
+    std::atomic<unsigned> counts[BUCKET_COUNT];
+    std::atomic<unsigned long long> total;
+    std::atomic<long long> maxValue;
+    
+    static int HighestBit(unsigned long long v) {
+#if defined(_MSC_VER)
+        unsigned long idx;
+        if (_BitScanReverse(&idx, (unsigned long)(v >> 32))) return (int)idx + 32;
+        _BitScanReverse(&idx, (unsigned long)v);
+        return (int)idx;
+#else
+        return 63 - __builtin_clzll(v);
+#endif
+    }
+    static int BucketOf(unsigned long long v) {
+        if (v < SUB_COUNT) return (int)v;
+        int shift = HighestBit(v) - SUB_BITS;
+        return (shift + 1) * SUB_COUNT + (int)((v >> shift) & (SUB_COUNT - 1));
+    }
+    static unsigned long long BucketLow(int b) {
+        if (b < SUB_COUNT) return (unsigned long long)b;
+        int shift = b / SUB_COUNT - 1;
+        return (unsigned long long)(SUB_COUNT + b % SUB_COUNT) << shift;
+    }
+    
+    void Record(long long v) {
+        if (v < 0) v = 0;
+        counts[BucketOf((unsigned long long)v)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        if (v > maxValue.load(std::memory_order_relaxed)) maxValue.store(v, std::memory_order_relaxed);
+    }
+    unsigned long long Count() const { return total.load(std::memory_order_relaxed); }
+    long long Max() const { return maxValue.load(std::memory_order_relaxed); }
+    // Value at percentile p (0-100): midpoint of the bucket holding it
+    double Percentile(double p) const {
+        unsigned long long n = Count();
+        if (n == 0) return 0.0;
+        unsigned long long target = (unsigned long long)ceil(p / 100.0 * (double)n);
+        if (target < 1) target = 1;
+        unsigned long long seen = 0;
+        for (int b = 0; b < BUCKET_COUNT; b++) {
+            seen += counts[b].load(std::memory_order_relaxed);
+            if (seen >= target) {
+                unsigned long long width = b < SUB_COUNT ? 1 : 1ULL << (b / SUB_COUNT - 1);
+                double mid = (double)BucketLow(b) + (double)(width - 1) / 2.0;
+                return mid < (double)Max() ? mid : (double)Max();
+            }
+        }
+        return (double)Max();
+    }
+};
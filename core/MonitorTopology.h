@@ -0,0 +1,85 @@
+// MonitorTopology.h - Label prefixes and layout diffs across display changes
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+// Monitor is any type with a NUL-terminated wchar_t device[] name, a
+// rcMonitor rect (int-like left/top/right/bottom), dpiX, dpiY and a wchar_t
+// prefix.
+#pragma once
+
+#include <cwchar>
+#include <vector>
+
+template <typename Rect>
+bool SameMonitorRect(const Rect& a, const Rect& b) {
+    return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+}
+
+// Same physical monitor: matched by device name, or by position when the
+// name is unavailable
+template <typename Monitor>
+bool SameMonitor(const Monitor& a, const Monitor& b) {
+    if (a.device[0] || b.device[0]) return wcscmp(a.device, b.device) == 0;
+    return SameMonitorRect(a.rcMonitor, b.rcMonitor);
+}
+
+// Give each monitor its label prefix: a monitor that was already attached
+// keeps its letter, so labels learned for it stay valid after another
+// monitor is plugged in, unplugged or rearranged; new monitors take the
+// lowest free letters. There are only 26 prefixes: monitors left without
+// one are dropped from the list and get no grid, rather than sharing a
+// letter and colliding labels. Returns, per kept monitor, its index in
+// previous or -1.
+template <typename Monitor>
+std::vector<int> AssignMonitorPrefixes(std::vector<Monitor>& monitors, const std::vector<Monitor>& previous) {
+    std::vector<int> match(monitors.size(), -1);
+    bool taken[26] = {};
+    for (size_t m = 0; m < monitors.size(); m++) {
+        for (size_t p = 0; p < previous.size(); p++) {
+            int letter = previous[p].prefix - L'a';
+            if (!taken[letter] && SameMonitor(monitors[m], previous[p])) {
+                match[m] = (int)p;
+                monitors[m].prefix = previous[p].prefix;
+                taken[letter] = true;
+                break;
+            }
+        }
+    }
+    int next = 0;
+    size_t kept = 0;
+    for (size_t m = 0; m < monitors.size(); m++) {
+        if (match[m] < 0) {
+            while (next < 26 && taken[next]) next++;
+            if (next == 26) continue;  // Out of prefixes
+            monitors[m].prefix = (wchar_t)(L'a' + next);
+            taken[next] = true;
+        }
+        monitors[kept] = monitors[m];
+        match[kept] = match[m];
+        kept++;
+    }
+    monitors.resize(kept);
+    match.resize(kept);
+    return match;
+}
+
+// Which monitors' grids survive a display change: kept[m] is monitor m's
+// index in previous if it was attached before at the same position, size
+// and DPI (its cells and tile can be reused), else -1. match comes from
+// AssignMonitorPrefixes. The work area is not compared: cells cover the
+// whole monitor rect, taskbar included. Returns false if nothing changed,
+// which includes the same monitors enumerated in another order.
+template <typename Monitor>
+bool DiffMonitorLayouts(const std::vector<Monitor>& monitors, const std::vector<Monitor>& previous,
+                        const std::vector<int>& match, std::vector<int>& kept) {
+    kept.assign(monitors.size(), -1);
+    bool changed = monitors.size() != previous.size();
+    for (size_t m = 0; m < monitors.size(); m++) {
+        const Monitor* old = match[m] >= 0 ? &previous[match[m]] : NULL;
+        if (old && SameMonitorRect(old->rcMonitor, monitors[m].rcMonitor) &&
+            old->dpiX == monitors[m].dpiX && old->dpiY == monitors[m].dpiY) {
+            kept[m] = match[m];
+        } else {
+            changed = true;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,314 @@
+// Palette.h - The UI palette: every color derived from one base hue
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "core/Simd.h"
+
+// A color laid out like a Win32 COLORREF: 0x00BBGGRR
+typedef uint32_t PaletteColor;
+
+static constexpr PaletteColor PaletteRgb(int r, int g, int b) {
+    return (PaletteColor)r | ((PaletteColor)g << 8) | ((PaletteColor)b << 16);
+}
+
+// Centralized color palette – all colors generated from a single base hue
+struct Palette {
+    // Base grid
+    PaletteColor background;              // Overall background fill
+    PaletteColor cellBgEven;              // Checkerboard cell fill (even)
+    PaletteColor cellBgOdd;               // Checkerboard cell fill (odd)
+    PaletteColor gridLine;                // Major cell border lines
+    PaletteColor subGridLine;             // 3×3 sub-grid lines inside each cell
+    PaletteColor mainLabelText;           // Main 3-letter label text
+    PaletteColor subLabelText;            // Sub-label text (a–h)
+
+    // Typing – fully matched cell
+    PaletteColor matchCellBg;             // Background of the matched cell
+    PaletteColor matchGridLine;           // Sub-grid lines on the matched cell
+    PaletteColor matchLabelText;          // Main label on the matched cell
+    PaletteColor matchSubLabelText;       // Sub-labels on the matched cell
+    PaletteColor matchSubHighlightBg;     // Highlighted sub-cell background
+    PaletteColor matchSubHighlightText;   // Highlighted sub-cell text
+
+    // Typing – partial match
+    PaletteColor partialMatchBg;          // Partially matched cell background
+    PaletteColor partialMatchText;        // Text on partially matched cell
+
+    // Typing – non-match (dimmed)
+    PaletteColor dimBg;                   // Dimmed non-matching cell background
+    PaletteColor dimText;                 // Dimmed non-matching cell text
+
+    // Window highlight (TAB mode) reuses: mainLabelText, gridLine,
+    //   matchCellBg, cellBgEven, matchLabelText
+    // Minimized panel reuses: background, gridLine, mainLabelText,
+    //   subLabelText, matchSubHighlightBg, matchSubHighlightText
+};
+
+// --- HSL → RGB conversion for generative palette ---
+// constexpr so the preset palettes below are worked out at compile time.
+// fmodf and fabsf are not constexpr: for hues in [-360, 720) the wraps below
+// are exact, so they give what fmodf would, and other hues go through fmodf.
+static constexpr float AbsF(float v) { return v < 0.0f ? -v : v; }
+
+// A 0..1 channel as 0..255, rounded and clamped
+static constexpr int HslChannel(float v) {
+    int i = (int)(v * 255.0f + 0.5f);
+    return i < 0 ? 0 : i > 255 ? 255 : i;
+}
+
+static constexpr PaletteColor hsl(float h, float s, float l) {
+    if (h < -360.0f || h >= 720.0f) h = fmodf(h, 360.0f);
+    if (h >= 360.0f) h -= 360.0f;
+    if (h < 0.0f) h += 360.0f;
+    float c = (1.0f - AbsF(2.0f * l - 1.0f)) * s;
+    float sector = h / 60.0f;
+    float x = c * (1.0f - AbsF(sector - (float)(int)(sector * 0.5f) * 2.0f - 1.0f));
+    float m = l - c / 2.0f;
+    float r = 0, g = 0, b = 0;
+    if      (h < 60.0f)  { r = c; g = x; b = 0; }
+    else if (h < 120.0f) { r = x; g = c; b = 0; }
+    else if (h < 180.0f) { r = 0; g = c; b = x; }
+    else if (h < 240.0f) { r = 0; g = x; b = c; }
+    else if (h < 300.0f) { r = x; g = 0; b = c; }
+    else                  { r = c; g = 0; b = x; }
+    return PaletteRgb(HslChannel(r + m), HslChannel(g + m), HslChannel(b + m));
+}
+
+// Four hsl() conversions at once for hues in [-360, 720). Every float
+// operation is the one hsl() performs, in the same order, so the results
+// are identical.
+#if KJ_SIMD_X86
+inline void Hsl4Sse2(const float* h, const float* s, const float* l, PaletteColor* out) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 full = _mm_set1_ps(360.0f);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 hv = _mm_loadu_ps(h);
+    __m128 sv = _mm_loadu_ps(s);
+    __m128 lv = _mm_loadu_ps(l);
+    
+    hv = _mm_sub_ps(hv, _mm_and_ps(_mm_cmpge_ps(hv, full), full));
+    hv = _mm_add_ps(hv, _mm_and_ps(_mm_cmplt_ps(hv, zero), full));
+    __m128 c = _mm_mul_ps(_mm_sub_ps(one, _mm_and_ps(_mm_sub_ps(_mm_mul_ps(two, lv), one), absMask)), sv);
+    __m128 q = _mm_div_ps(hv, _mm_set1_ps(60.0f));
+    __m128 wrap = _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(q, _mm_set1_ps(0.5f)))), two);
+    __m128 x = _mm_mul_ps(c, _mm_sub_ps(one, _mm_and_ps(_mm_sub_ps(_mm_sub_ps(q, wrap), one), absMask)));
+    __m128 m = _mm_sub_ps(lv, _mm_div_ps(c, two));
+    
+    // Sextant masks
+    __m128 lt60 = _mm_cmplt_ps(hv, _mm_set1_ps(60.0f));
+    __m128 lt120 = _mm_cmplt_ps(hv, _mm_set1_ps(120.0f));
+    __m128 lt180 = _mm_cmplt_ps(hv, _mm_set1_ps(180.0f));
+    __m128 lt240 = _mm_cmplt_ps(hv, _mm_set1_ps(240.0f));
+    __m128 lt300 = _mm_cmplt_ps(hv, _mm_set1_ps(300.0f));
+    __m128 s1 = _mm_andnot_ps(lt60, lt120);
+    __m128 s2 = _mm_andnot_ps(lt120, lt180);
+    __m128 s3 = _mm_andnot_ps(lt180, lt240);
+    __m128 s4 = _mm_andnot_ps(lt240, lt300);
+    __m128 s5 = _mm_andnot_ps(lt300, _mm_castsi128_ps(_mm_set1_epi32(-1)));
+    __m128 r = _mm_or_ps(_mm_and_ps(_mm_or_ps(lt60, s5), c), _mm_and_ps(_mm_or_ps(s1, s4), x));
+    __m128 g = _mm_or_ps(_mm_and_ps(_mm_or_ps(s1, s2), c), _mm_and_ps(_mm_or_ps(lt60, s3), x));
+    __m128 b = _mm_or_ps(_mm_and_ps(_mm_or_ps(s3, s4), c), _mm_and_ps(_mm_or_ps(s2, s5), x));
+    
+    // (int)(v * 255 + 0.5) clamped to 0..255; clamping first truncates the same
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    __m128i ri = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(r, m), scale), half), scale), zero));
+    __m128i gi = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(g, m), scale), half), scale), zero));
+    __m128i bi = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(b, m), scale), half), scale), zero));
+    __m128i rgb = _mm_or_si128(ri, _mm_or_si128(_mm_slli_epi32(gi, 8), _mm_slli_epi32(bi, 16)));
+    _mm_storeu_si128((__m128i*)out, rgb);
+}
+#endif
+
+// out[i] = hsl(h[i], s[i], l[i]) for n entries, four at a time where SSE2 allows
+inline void HslBatch(const float* h, const float* s, const float* l, PaletteColor* out, int n) {
+    int i = 0;
+#if KJ_SIMD_X86
+    static const bool sse2 = DetectSimdLevel() >= SIMD_SSE2;
+    if (sse2) {
+        for (; i + 4 <= n; i += 4) {
+            __m128 hv = _mm_loadu_ps(h + i);
+            __m128 inRange = _mm_and_ps(_mm_cmpge_ps(hv, _mm_set1_ps(-360.0f)),
+                                        _mm_cmplt_ps(hv, _mm_set1_ps(720.0f)));
+            if (_mm_movemask_ps(inRange) == 0xF) {
+                Hsl4Sse2(h + i, s + i, l + i, out + i);
+            } else {
+                for (int k = i; k < i + 4; k++) out[k] = hsl(h[k], s[k], l[k]);
+            }
+        }
+    }
+#endif
+    for (; i < n; i++) out[i] = hsl(h[i], s[i], l[i]);
+}
+
+// Color wheel:  0°=Red  30°=Orange  60°=Yellow  120°=Green
+//               180°=Cyan  210°=Azure  240°=Blue  270°=Purple  300°=Magenta
+//
+// ► Change BASE_HUE to shift the entire UI to your favorite color.
+#define BASE_HUE_DEFAULT 30.0f  // 30 = woodsy amber (default)
+                                  // Try: 270 = purple, 210 = ocean blue, 0 = crimson,
+                                  //      160 = teal, 340 = rose, 60 = golden
+
+
+// One palette entry: a hue offset from the base hue H or the accent hue A
+// (H + 90°, for natural contrast), plus saturation and lightness
+struct PaletteTone {
+    PaletteColor Palette::* color;
+    bool accent;
+    float hueOffset;
+    float sat, light;
+};
+
+static constexpr PaletteTone PALETTE_TONES[] = {
+    //                                    Hue             Sat    Light
+    // -- base grid ------------------------------------------------
+    { &Palette::background,            false,   0.0f,  0.40f, 0.04f },  // very dark base
+    { &Palette::cellBgEven,            false,   0.0f,  0.40f, 0.12f },  // dark base tint
+    { &Palette::cellBgOdd,             true,    0.0f,  0.35f, 0.12f },  // dark accent (checker)
+    { &Palette::gridLine,              false,   0.0f,  0.25f, 0.32f },  // medium base
+    { &Palette::subGridLine,           false,  45.0f,  0.20f, 0.25f },  // muted mid-tone
+    { &Palette::mainLabelText,         false,  10.0f,  0.65f, 0.65f },  // bright warm label
+    { &Palette::subLabelText,          true,  -20.0f,  0.30f, 0.58f },  // medium accent
+
+    // -- typing: full match ---------------------------------------
+    { &Palette::matchCellBg,           true,    0.0f,  0.45f, 0.20f },  // rich accent bg
+    { &Palette::matchGridLine,         true,    0.0f,  0.45f, 0.33f },  // bright accent lines
+    { &Palette::matchLabelText,        false,   0.0f,  0.20f, 0.90f },  // near-white base tint
+    { &Palette::matchSubLabelText,     true,    0.0f,  0.35f, 0.72f },  // light accent
+    { &Palette::matchSubHighlightBg,   true,    0.0f,  0.55f, 0.33f },  // vivid accent
+    { &Palette::matchSubHighlightText, false,   0.0f,  0.10f, 0.95f },  // near-white
+
+    // -- typing: partial match ------------------------------------
+    { &Palette::partialMatchBg,        true,    0.0f,  0.35f, 0.12f },  // subtle accent
+    { &Palette::partialMatchText,      true,    0.0f,  0.45f, 0.75f },  // bright accent
+
+    // -- typing: non-match (dimmed) -------------------------------
+    { &Palette::dimBg,                 false,   0.0f,  0.30f, 0.04f },  // fade to background
+    { &Palette::dimText,               false,   0.0f,  0.20f, 0.25f },  // muted base
+};
+#define PALETTE_TONE_COUNT (sizeof(PALETTE_TONES) / sizeof(PALETTE_TONES[0]))
+
+// The palette for base hue H, one hsl() call per tone; for constant H this
+// is evaluated by the compiler
+static constexpr Palette TonePalette(float H) {
+    Palette p = {};
+    for (const PaletteTone& t : PALETTE_TONES) {
+        p.*t.color = hsl((t.accent ? H + 90.0f : H) + t.hueOffset, t.sat, t.light);
+    }
+    return p;
+}
+
+// The suggested hues above, with palettes computed at compile time
+struct PalettePreset {
+    float hue;
+    Palette palette;
+};
+
+static constexpr PalettePreset PALETTE_PRESETS[] = {
+    {  30.0f, TonePalette(30.0f)  },  // woodsy amber (default)
+    { 270.0f, TonePalette(270.0f) },  // purple
+    { 210.0f, TonePalette(210.0f) },  // ocean blue
+    {   0.0f, TonePalette(0.0f)   },  // crimson
+    { 160.0f, TonePalette(160.0f) },  // teal
+    { 340.0f, TonePalette(340.0f) },  // rose
+    {  60.0f, TonePalette(60.0f)  },  // golden
+};
+
+// Every tone of every preset, in PALETTE_TONES order, as hsl() computed them
+// at run time before the palettes moved to compile time
+static constexpr PaletteColor PALETTE_PRESET_RGB[][PALETTE_TONE_COUNT] = {
+    {  // 30
+        PaletteRgb(14, 10, 6), PaletteRgb(43, 31, 18), PaletteRgb(20, 41, 20), PaletteRgb(102, 82, 61),
+        PaletteRgb(70, 77, 51), PaletteRgb(224, 185, 108), PaletteRgb(137, 180, 116), PaletteRgb(28, 74, 28),
+        PaletteRgb(46, 122, 46), PaletteRgb(235, 230, 224), PaletteRgb(159, 209, 159), PaletteRgb(38, 130, 38),
+        PaletteRgb(244, 242, 241), PaletteRgb(20, 41, 20), PaletteRgb(163, 220, 163), PaletteRgb(13, 10, 7),
+        PaletteRgb(77, 64, 51)
+    },
+    {  // 270
+        PaletteRgb(10, 6, 14), PaletteRgb(31, 18, 43), PaletteRgb(41, 20, 20), PaletteRgb(82, 61, 102),
+        PaletteRgb(77, 51, 70), PaletteRgb(185, 108, 224), PaletteRgb(180, 116, 137), PaletteRgb(74, 28, 28),
+        PaletteRgb(122, 46, 46), PaletteRgb(230, 224, 235), PaletteRgb(209, 159, 159), PaletteRgb(130, 38, 38),
+        PaletteRgb(242, 241, 244), PaletteRgb(41, 20, 20), PaletteRgb(220, 163, 163), PaletteRgb(10, 7, 13),
+        PaletteRgb(64, 51, 77)
+    },
+    {  // 210
+        PaletteRgb(6, 10, 14), PaletteRgb(18, 31, 43), PaletteRgb(41, 20, 41), PaletteRgb(61, 82, 102),
+        PaletteRgb(57, 51, 77), PaletteRgb(108, 146, 224), PaletteRgb(159, 116, 180), PaletteRgb(74, 28, 74),
+        PaletteRgb(122, 46, 122), PaletteRgb(224, 230, 235), PaletteRgb(209, 159, 209), PaletteRgb(130, 38, 130),
+        PaletteRgb(241, 242, 244), PaletteRgb(41, 20, 41), PaletteRgb(220, 163, 220), PaletteRgb(7, 10, 13),
+        PaletteRgb(51, 64, 77)
+    },
+    {  // 0
+        PaletteRgb(14, 6, 6), PaletteRgb(43, 18, 18), PaletteRgb(31, 41, 20), PaletteRgb(102, 61, 61),
+        PaletteRgb(77, 70, 51), PaletteRgb(224, 127, 108), PaletteRgb(169, 180, 116), PaletteRgb(51, 74, 28),
+        PaletteRgb(84, 122, 46), PaletteRgb(235, 224, 224), PaletteRgb(184, 209, 159), PaletteRgb(84, 130, 38),
+        PaletteRgb(244, 241, 241), PaletteRgb(31, 41, 20), PaletteRgb(191, 220, 163), PaletteRgb(13, 7, 7),
+        PaletteRgb(77, 51, 51)
+    },
+    {  // 160
+        PaletteRgb(6, 14, 12), PaletteRgb(18, 43, 35), PaletteRgb(23, 20, 41), PaletteRgb(61, 102, 88),
+        PaletteRgb(51, 66, 77), PaletteRgb(108, 224, 204), PaletteRgb(116, 126, 180), PaletteRgb(36, 28, 74),
+        PaletteRgb(59, 46, 122), PaletteRgb(224, 235, 231), PaletteRgb(167, 159, 209), PaletteRgb(53, 38, 130),
+        PaletteRgb(241, 244, 243), PaletteRgb(23, 20, 41), PaletteRgb(172, 163, 220), PaletteRgb(7, 13, 11),
+        PaletteRgb(51, 77, 68)
+    },
+    {  // 340
+        PaletteRgb(14, 6, 9), PaletteRgb(43, 18, 27), PaletteRgb(38, 41, 20), PaletteRgb(102, 61, 75),
+        PaletteRgb(77, 62, 51), PaletteRgb(224, 108, 127), PaletteRgb(180, 169, 116), PaletteRgb(66, 74, 28),
+        PaletteRgb(109, 122, 46), PaletteRgb(235, 224, 228), PaletteRgb(200, 209, 159), PaletteRgb(115, 130, 38),
+        PaletteRgb(244, 241, 242), PaletteRgb(38, 41, 20), PaletteRgb(210, 220, 163), PaletteRgb(13, 7, 9),
+        PaletteRgb(77, 51, 60)
+    },
+    {  // 60
+        PaletteRgb(14, 14, 6), PaletteRgb(43, 43, 18), PaletteRgb(20, 41, 31), PaletteRgb(102, 102, 61),
+        PaletteRgb(57, 77, 51), PaletteRgb(204, 224, 108), PaletteRgb(116, 180, 126), PaletteRgb(28, 74, 51),
+        PaletteRgb(46, 122, 84), PaletteRgb(235, 235, 224), PaletteRgb(159, 209, 184), PaletteRgb(38, 130, 84),
+        PaletteRgb(244, 244, 241), PaletteRgb(20, 41, 31), PaletteRgb(163, 220, 191), PaletteRgb(13, 13, 7),
+        PaletteRgb(77, 77, 51)
+    }
+};
+#define PALETTE_PRESET_COUNT (sizeof(PALETTE_PRESETS) / sizeof(PALETTE_PRESETS[0]))
+
+// True if every tone of every preset matches PALETTE_PRESET_RGB
+static constexpr bool PresetsMatchRuntimeHsl() {
+    for (size_t p = 0; p < PALETTE_PRESET_COUNT; p++) {
+        for (size_t i = 0; i < PALETTE_TONE_COUNT; i++) {
+            if (PALETTE_PRESETS[p].palette.*PALETTE_TONES[i].color != PALETTE_PRESET_RGB[p][i]) return false;
+        }
+    }
+    return true;
+}
+
+static_assert(PALETTE_PRESETS[0].hue == BASE_HUE_DEFAULT, "First preset is the default hue");
+static_assert(sizeof(Palette) == PALETTE_TONE_COUNT * sizeof(PaletteColor), "Every palette entry needs a tone");
+static_assert(sizeof(PALETTE_PRESET_RGB) / sizeof(PALETTE_PRESET_RGB[0]) == PALETTE_PRESET_COUNT,
+              "Every preset needs its reference colors");
+static_assert(PresetsMatchRuntimeHsl(), "Preset palette differs from hsl()");
+
+// Palette for any base hue: a preset's precomputed palette, or one batch
+// conversion of all tones
+inline Palette GeneratePalette(float H) {
+    for (const PalettePreset& preset : PALETTE_PRESETS) {
+        if (preset.hue == H) return preset.palette;
+    }
+    float A = H + 90.0f;
+    float hue[PALETTE_TONE_COUNT], sat[PALETTE_TONE_COUNT], light[PALETTE_TONE_COUNT];
+    for (size_t i = 0; i < PALETTE_TONE_COUNT; i++) {
+        const PaletteTone& t = PALETTE_TONES[i];
+        hue[i] = (t.accent ? A : H) + t.hueOffset;
+        sat[i] = t.sat;
+        light[i] = t.light;
+    }
+    PaletteColor colors[PALETTE_TONE_COUNT];
+    HslBatch(hue, sat, light, colors, (int)PALETTE_TONE_COUNT);
+    
+    Palette p;
+    for (size_t i = 0; i < PALETTE_TONE_COUNT; i++) p.*PALETTE_TONES[i].color = colors[i];
+    return p;
+}
@@ -0,0 +1,84 @@
+// Simd.h - CPU feature detection for the runtime-dispatched kernels
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+#pragma once
+
+// The vector kernels are SSE2 and AVX2. Elsewhere (ARM64) they are left out,
+// DetectSimdLevel reports SIMD_SCALAR and every Select* hands back the
+// scalar kernel.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define KJ_SIMD_X86 1
+#else
+#define KJ_SIMD_X86 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if KJ_SIMD_X86
+#include <immintrin.h>
+#if !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+#endif
+
+enum SimdLevel { SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2 };
+
+// MSVC emits AVX2 instructions anywhere; GCC and Clang only inside
+// functions that ask for them
+#if defined(_MSC_VER) && !defined(__clang__)
+#define KJ_TARGET_AVX2
+#else
+#define KJ_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// Widest vector instruction set both the CPU and the OS support
+inline SimdLevel DetectSimdLevel() {
+#if !KJ_SIMD_X86
+    return SIMD_SCALAR;
+#else
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 &&
+                 (_xgetbv(0) & 6) == 6;  // OS saves XMM and YMM state
+    bool avx2 = false;
+    if (osAvx && maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    unsigned a, b, c, d;
+    unsigned maxLeaf = __get_cpuid_max(0, 0);
+    if (maxLeaf < 1) return SIMD_SCALAR;
+    __cpuid(1, a, b, c, d);
+    bool sse2 = (d & (1u << 26)) != 0;
+    bool osAvx = false;
+    if ((c & (1u << 27)) && (c & (1u << 28))) {
+        unsigned lo, hi;
+        __asm__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        osAvx = (lo & 6) == 6;  // OS saves XMM and YMM state
+    }
+    bool avx2 = false;
+    if (osAvx && maxLeaf >= 7) {
+        __cpuid_count(7, 0, a, b, c, d);
+        avx2 = (b & (1u << 5)) != 0;
+    }
+#endif
+    if (avx2) return SIMD_AVX2;
+    return sse2 ? SIMD_SSE2 : SIMD_SCALAR;
+#endif
+}
+
+// Index of the lowest set bit; mask must not be 0
+inline int LowestSetBit(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long bit;
+    _BitScanForward(&bit, mask);
+    return (int)bit;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
@@ -0,0 +1,69 @@
+// SpscRing.h - Lock-free queue between exactly one producer and one consumer
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+#pragma once
+
+#include <atomic>
+
+// Fixed-capacity lock-free queue for exactly one producer thread and one
+// consumer thread. N must be a power of two. head and tail sit on their own
+// cache lines so the two threads don't invalidate each other's index on
+// every operation.
+template <typename T, unsigned N>
+struct SpscRing {
+    static_assert((N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+    T items[N];
+    alignas(64) std::atomic<unsigned> head{0};  // Next slot to write (producer)
+    alignas(64) std::atomic<unsigned> tail{0};  // Next slot to read (consumer)
+
+    bool Push(const T& v) {
+        unsigned h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == N) return false;  // Full
+        items[h & (N - 1)] = v;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    bool Pop(T& v) {
+        unsigned t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;  // Empty
+        v = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+// SpscRing whose producer never waits: when the ring is full the value goes
+// to a one-slot overflow instead, replacing any value already there (latest
+// wins). For commands where only the newest matters once the consumer falls
+// behind. The overflow is tagged with the ring's head when it was stored,
+// and the consumer takes it only after popping everything queued before it,
+// so what the consumer sees stays in posting order. T is an enum or
+// integer of at most 31 bits.
+template <typename T, unsigned N>
+struct CoalescingSpscRing {
+    SpscRing<T, N> ring;
+    // (head << 32) | (value + 1); 0 = empty. Only the producer fills it and
+    // only the consumer empties it.
+    alignas(64) std::atomic<unsigned long long> overflow{0};
+
+    // Returns false if the value went to the overflow slot
+    bool Post(T v) {
+        if (overflow.load(std::memory_order_acquire) == 0 && ring.Push(v)) return true;
+        // Nothing enters the ring while the overflow is full, so head stays put
+        unsigned long long h = ring.head.load(std::memory_order_relaxed);
+        overflow.store((h << 32) | ((unsigned)v + 1), std::memory_order_release);
+        return false;
+    }
+    bool Take(T& v) {
+        for (;;) {
+            if (ring.Pop(v)) return true;
+            unsigned long long p = overflow.load(std::memory_order_acquire);
+            if (p == 0) return false;
+            // Ring items from before the overflow are already published; pop them first
+            if ((unsigned)(p >> 32) != ring.tail.load(std::memory_order_relaxed)) continue;
+            if (overflow.compare_exchange_strong(p, 0, std::memory_order_acq_rel)) {
+                v = (T)((unsigned)p - 1);
+                return true;
+            }
+        }
+    }
+};
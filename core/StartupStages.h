@@ -0,0 +1,95 @@
+// StartupStages.h - Deferred background build and startup milestone trace
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <thread>
+
+// Startup milestones, in the order they are usually reached
+enum StartupMark { STARTUP_TRAY_ICON, STARTUP_GRID_READY, STARTUP_FIRST_PAINT, STARTUP_MARK_COUNT };
+static const char* const STARTUP_MARK_NAMES[STARTUP_MARK_COUNT] = { "tray_icon", "grid_ready", "first_paint" };
+
+// When each milestone was first reached, in clock ticks after startup
+// (0 = not reached yet). Zero-initialized, so give instances static storage.
+struct StartupTrace {
+    std::atomic<long long> marks[STARTUP_MARK_COUNT];
+
+    // Record mark at ticks after startup the first time it is reached;
+    // later calls leave it alone. Callable from any thread.
+    void Mark(StartupMark mark, long long ticks) {
+        long long expected = 0;
+        marks[mark].compare_exchange_strong(expected, ticks > 0 ? ticks : 1);
+    }
+    long long At(StartupMark mark) const { return marks[mark].load(); }
+};
+
+// How far a StagedBuild has got
+enum StageState { STAGE_PENDING, STAGE_RUNNING, STAGE_READY };
+
+// Data built on a worker some time after startup, for an owner thread (the
+// UI thread) that may need it sooner. The data has one owner at a time: the
+// worker from Run until Finish joins it, the owner thread the rest of the
+// time. Nothing locks it, so code that touches it asserts OwnedByCaller.
+// Apart from OwnedByCaller, members are for the owner thread only.
+class StagedBuild {
+public:
+    StagedBuild() = default;
+    StagedBuild(const StagedBuild&) = delete;
+    StagedBuild& operator=(const StagedBuild&) = delete;
+    ~StagedBuild() {
+        if (thread_.joinable()) thread_.join();
+    }
+
+    StageState State() const { return state_; }
+
+    // Hand the data to a worker that runs work() on it. Not while one runs.
+    template <typename Work>
+    void Run(Work work) {
+        assert(state_ != STAGE_RUNNING);
+        state_ = STAGE_RUNNING;
+        onWorker_.store(true, std::memory_order_release);
+        thread_ = std::thread([this, work]() mutable {
+            Worker() = this;
+            work();
+        });
+    }
+
+    // Start the first build unless it has already started; returns false
+    // if it had
+    template <typename Work>
+    bool Begin(Work work) {
+        if (state_ != STAGE_PENDING) return false;
+        Run(work);
+        return true;
+    }
+
+    // Wait for the worker, if one runs, and take the data back. Blocks only
+    // while the worker finishes; the build must have begun.
+    void Finish() {
+        assert(state_ != STAGE_PENDING);
+        if (thread_.joinable()) thread_.join();
+        onWorker_.store(false, std::memory_order_release);
+        state_ = STAGE_READY;
+    }
+
+    // True if the calling thread may touch the data: this build's worker
+    // while it runs, otherwise the owner thread (onOwnerThread says whether
+    // the caller is it). Callable from any thread.
+    bool OwnedByCaller(bool onOwnerThread) const {
+        bool onWorker = onWorker_.load(std::memory_order_acquire);
+        if (Worker() == this) return onWorker;
+        return !onWorker && onOwnerThread;
+    }
+
+private:
+    // The build whose worker the calling thread is, if any
+    static const StagedBuild*& Worker() {
+        static thread_local const StagedBuild* worker = nullptr;
+        return worker;
+    }
+
+    StageState state_ = STAGE_PENDING;
+    std::atomic<bool> onWorker_{false};
+    std::thread thread_;
+};
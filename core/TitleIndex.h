@@ -0,0 +1,72 @@
+// TitleIndex.h - Case-folded window titles and incremental search levels
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+// Char is the title character type: wchar_t on Windows, char16_t elsewhere.
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Case-folded titles packed into one buffer; entry i spans
+// folded[offset[i] .. offset[i] + length[i])
+template <typename Char>
+struct FoldedTitleIndex {
+    std::vector<Char> folded;
+    std::vector<int> offset;
+    std::vector<int> length;
+    int normalCount;  // Entries [0, normalCount) are visible windows, the rest minimized
+};
+
+// Append a title to the index, folding each character with fold(c)
+template <typename Char, typename Fold>
+void AppendFoldedTitle(FoldedTitleIndex<Char>& ix, const Char* title, int len, Fold fold) {
+    ix.offset.push_back((int)ix.folded.size());
+    ix.length.push_back(len);
+    for (int i = 0; i < len; i++) ix.folded.push_back((Char)fold(title[i]));
+}
+
+// levels[n - 1] holds the index entries matching the first n characters of
+// the query; each level only re-scans the one before it
+struct SearchHit {
+    int entry;    // Title index entry
+    int score;    // Match score for this query prefix
+    int matchAt;  // Where its n matched positions start in the level's positions
+};
+struct SearchLevel {
+    std::vector<SearchHit> hits;
+    std::vector<int> positions;
+};
+
+// Bring levels, built for levelsQuery, up to date for the folded query.
+// Levels for the prefix both queries share are kept, so typing a character
+// adds one level and Backspace just drops back to a saved one. A title
+// matching n characters must also match their first n - 1, which is what
+// lets a level scan only the previous level's hits.
+// match(title, len, query, n, pos, &score) fills the n matched positions.
+template <typename Char, typename Match>
+void UpdateSearchLevels(std::vector<SearchLevel>& levels, std::basic_string<Char>& levelsQuery,
+                        const std::basic_string<Char>& query, const FoldedTitleIndex<Char>& ix,
+                        Match match) {
+    size_t keep = 0;
+    while (keep < levelsQuery.size() && keep < query.size() && levelsQuery[keep] == query[keep]) keep++;
+    levels.resize(keep);
+    levelsQuery = query;
+
+    const Char* folded = ix.folded.data();
+    int entryCount = (int)ix.offset.size();
+    std::vector<int> pos(query.size());
+    for (size_t n = keep + 1; n <= query.size(); n++) {
+        const std::vector<SearchHit>* prev = n > 1 ? &levels[n - 2].hits : nullptr;
+        int candidates = prev ? (int)prev->size() : entryCount;
+        SearchLevel level;
+        level.hits.reserve(candidates);
+        for (int k = 0; k < candidates; k++) {
+            int e = prev ? (*prev)[k].entry : k;
+            int score;
+            if (match(folded + ix.offset[e], ix.length[e], query.c_str(), (int)n, pos.data(), &score)) {
+                level.hits.push_back({ e, score, (int)level.positions.size() });
+                level.positions.insert(level.positions.end(), pos.begin(), pos.begin() + n);
+            }
+        }
+        levels.push_back(std::move(level));
+    }
+}
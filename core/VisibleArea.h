@@ -0,0 +1,205 @@
+// VisibleArea.h - Unoccluded area of each window in a Z-ordered stack
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+// Rect is any type with int-like left/top/right/bottom.
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <set>
+#include <vector>
+
+// The sweep below moves down the stack's distinct top/bottom edges. Along the
+// sweep line, every x belongs to the front-most window covering it; that
+// owner function is kept as pieces [x0, x1) with the owner and the y the
+// piece started at, so a piece adds its width times its height to its
+// owner's area when it ends. A segment tree over the compressed x edges
+// holds each window's span in the usual canonical nodes and finds, in
+// O(log n), the next x whose owner is in front of or behind a given window.
+// A window entering the sweep only claims the runs it is in front of, and
+// one leaving hands only its own runs to the windows behind it, so the
+// whole sweep is O((n + k) log^2 n) for n windows whose visible parts form
+// k pieces, without region arithmetic.
+class VisibleAreaSweep {
+public:
+    // Area of rects[i] not covered by rects[0..i-1] (front to back)
+    template <typename Rect>
+    static void Compute(const Rect* rects, int n, long long* visibleArea) {
+        VisibleAreaSweep sweep;
+        sweep.Run(rects, n, visibleArea);
+    }
+
+private:
+    static constexpr int NONE = INT_MAX;  // Owner of an x no window covers
+
+    struct Piece {
+        int end;      // Slab after the last one in the piece
+        int owner;
+        int since;    // y the piece started at
+    };
+
+    std::vector<int> xs_;                 // Distinct x edges; slab k is [xs_[k], xs_[k + 1])
+    int slabs_ = 0;
+    std::vector<std::set<int>> cover_;    // Windows whose span canonically includes the node
+    std::vector<int> lowest_;             // Per node: min over its leaves of the owner below it
+    std::vector<int> highest_;            // Per node: max over its leaves of the owner below it
+    std::map<int, Piece> pieces_;         // By first slab
+    std::vector<int> x0_, x1_;            // Slab span of each window
+    long long* area_ = nullptr;
+
+    int CoverMin(int v) const { return cover_[v].empty() ? NONE : *cover_[v].begin(); }
+
+    void Pull(int v, bool leaf) {
+        int own = CoverMin(v);
+        if (leaf) {
+            lowest_[v] = highest_[v] = own;
+        } else {
+            lowest_[v] = (std::min)(own, (std::min)(lowest_[2 * v], lowest_[2 * v + 1]));
+            highest_[v] = (std::min)(own, (std::max)(highest_[2 * v], highest_[2 * v + 1]));
+        }
+    }
+
+    void Update(int v, int l, int r, int a, int b, int id, bool add) {
+        if (b <= l || r <= a) return;
+        if (a <= l && r <= b) {
+            if (add) cover_[v].insert(id); else cover_[v].erase(id);
+        } else {
+            int m = (l + r) / 2;
+            Update(2 * v, l, m, a, b, id, add);
+            Update(2 * v + 1, m, r, a, b, id, add);
+        }
+        Pull(v, r - l == 1);
+    }
+
+    // First slab in [x, q) whose owner is behind t (above = true) or at or
+    // in front of t (above = false); q if none. above ancestors is the min
+    // cover of v's ancestors.
+    int Find(int v, int l, int r, int x, int q, int above, int t, bool behind) const {
+        if (q <= l || r <= x) return q;
+        if (behind ? (std::min)(above, highest_[v]) <= t : (std::min)(above, lowest_[v]) > t) return q;
+        if (r - l == 1) return l;
+        int m = (l + r) / 2;
+        int anc = (std::min)(above, CoverMin(v));
+        int found = Find(2 * v, l, m, x, q, anc, t, behind);
+        return found < q ? found : Find(2 * v + 1, m, r, x, q, anc, t, behind);
+    }
+    int FirstBehind(int x, int q, int t) const { return Find(1, 0, slabs_, x, q, NONE, t, true); }
+    int FirstNotBehind(int x, int q, int t) const { return Find(1, 0, slabs_, x, q, NONE, t, false); }
+
+    int OwnerAt(int x) const {
+        int v = 1, l = 0, r = slabs_, owner = NONE;
+        for (;;) {
+            owner = (std::min)(owner, CoverMin(v));
+            if (r - l == 1) return owner;
+            int m = (l + r) / 2;
+            if (x < m) { v = 2 * v; r = m; } else { v = 2 * v + 1; l = m; }
+        }
+    }
+
+    // Make x the first slab of a piece if a piece spans it
+    void Split(int x) {
+        auto it = pieces_.upper_bound(x);
+        if (it == pieces_.begin()) return;
+        --it;
+        if (it->first < x && x < it->second.end) {
+            Piece tail = it->second;
+            it->second.end = x;
+            pieces_.emplace(x, tail);
+        }
+    }
+
+    // End every piece in [a, b) at y
+    void Close(int a, int b, int y) {
+        Split(a);
+        Split(b);
+        for (auto it = pieces_.lower_bound(a); it != pieces_.end() && it->first < b; ) {
+            const Piece& p = it->second;
+            area_[p.owner] += (long long)(xs_[p.end] - xs_[it->first]) * (y - p.since);
+            it = pieces_.erase(it);
+        }
+    }
+
+    void Enter(int i, int y) {
+        for (int x = x0_[i]; ; ) {
+            int p = FirstBehind(x, x1_[i], i);
+            if (p == x1_[i]) break;
+            int e = FirstNotBehind(p, x1_[i], i);
+            Close(p, e, y);
+            pieces_.emplace(p, Piece{ e, i, y });
+            x = e;
+        }
+        Update(1, 0, slabs_, x0_[i], x1_[i], i, true);
+    }
+
+    void Leave(int i, int y) {
+        // i owns exactly the slabs of its span with no owner in front of it
+        std::vector<std::pair<int, int>> runs;
+        for (int x = x0_[i]; ; ) {
+            int p = FirstBehind(x, x1_[i], i - 1);
+            if (p == x1_[i]) break;
+            int e = FirstNotBehind(p, x1_[i], i - 1);
+            runs.push_back({ p, e });
+            x = e;
+        }
+        Update(1, 0, slabs_, x0_[i], x1_[i], i, false);
+        for (const auto& run : runs) {
+            Close(run.first, run.second, y);
+            for (int x = run.first; x < run.second; ) {
+                int w = OwnerAt(x);
+                if (w == NONE) {
+                    x = FirstNotBehind(x, run.second, NONE - 1);
+                    continue;
+                }
+                int e = (std::min)(x1_[w], FirstNotBehind(x, run.second, w - 1));
+                pieces_.emplace(x, Piece{ e, w, y });
+                x = e;
+            }
+        }
+    }
+
+    template <typename Rect>
+    void Run(const Rect* rects, int n, long long* visibleArea) {
+        area_ = visibleArea;
+        std::vector<int> ys;
+        for (int i = 0; i < n; i++) {
+            visibleArea[i] = 0;
+            if (rects[i].right <= rects[i].left || rects[i].bottom <= rects[i].top) continue;
+            xs_.push_back((int)rects[i].left);
+            xs_.push_back((int)rects[i].right);
+        }
+        std::sort(xs_.begin(), xs_.end());
+        xs_.erase(std::unique(xs_.begin(), xs_.end()), xs_.end());
+        if (xs_.size() < 2) return;
+        slabs_ = (int)xs_.size() - 1;
+        cover_.resize(4 * slabs_);
+        lowest_.assign(4 * slabs_, NONE);
+        highest_.assign(4 * slabs_, NONE);
+
+        // Windows enter the sweep at their top edge and leave at their bottom
+        x0_.assign(n, 0);
+        x1_.assign(n, 0);
+        std::vector<int> byTop;
+        for (int i = 0; i < n; i++) {
+            if (rects[i].right <= rects[i].left || rects[i].bottom <= rects[i].top) continue;
+            x0_[i] = (int)(std::lower_bound(xs_.begin(), xs_.end(), (int)rects[i].left) - xs_.begin());
+            x1_[i] = (int)(std::lower_bound(xs_.begin(), xs_.end(), (int)rects[i].right) - xs_.begin());
+            byTop.push_back(i);
+        }
+        std::vector<int> byBottom = byTop;
+        std::sort(byTop.begin(), byTop.end(), [rects](int a, int b) { return rects[a].top < rects[b].top; });
+        std::sort(byBottom.begin(), byBottom.end(), [rects](int a, int b) { return rects[a].bottom < rects[b].bottom; });
+
+        size_t entered = 0, left = 0;
+        while (left < byBottom.size()) {
+            int y = (int)rects[byBottom[left]].bottom;
+            if (entered < byTop.size()) y = (std::min)(y, (int)rects[byTop[entered]].top);
+            for (; left < byBottom.size() && rects[byBottom[left]].bottom == y; left++) Leave(byBottom[left], y);
+            for (; entered < byTop.size() && rects[byTop[entered]].top == y; entered++) Enter(byTop[entered], y);
+        }
+    }
+};
+
+template <typename Rect>
+void ComputeVisibleAreas(const Rect* rects, int n, long long* visibleArea) {
+    VisibleAreaSweep::Compute(rects, n, visibleArea);
+}
@@ -0,0 +1,60 @@
+// WindowInventory.h - Which shell events make the window snapshot stale
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+#pragma once
+
+// WinEvent IDs from WinUser.h, repeated here so the tests can script them;
+// KeyboardJockey.cpp checks them against the real constants
+enum InventoryEvent : unsigned {
+    INV_SYSTEM_FOREGROUND     = 0x0003,
+    INV_SYSTEM_MOVESIZEEND    = 0x000B,
+    INV_SYSTEM_MINIMIZESTART  = 0x0016,
+    INV_SYSTEM_MINIMIZEEND    = 0x0017,
+    INV_OBJECT_CREATE         = 0x8000,
+    INV_OBJECT_DESTROY        = 0x8001,
+    INV_OBJECT_SHOW           = 0x8002,
+    INV_OBJECT_HIDE           = 0x8003,
+    INV_OBJECT_LOCATIONCHANGE = 0x800B,
+    INV_OBJECT_NAMECHANGE     = 0x800C,
+};
+
+struct InventoryEventRange {
+    unsigned first, last;
+};
+
+// One hook per range. CREATE..NAMECHANGE and FOREGROUND..MINIMIZEEND as
+// single ranges would also deliver focus, selection, state, value, menu and
+// scroll events, which arrive by the hundred while dragging or typing and
+// say nothing about which windows exist or where they are. Location changes
+// are hooked for the snapshot's rects: they are frequent too, but only a
+// top-level window in the snapshot counts, which the inventory thread tells
+// from a lookup before asking the window anything.
+static constexpr InventoryEventRange INVENTORY_EVENT_RANGES[] = {
+    { INV_OBJECT_CREATE, INV_OBJECT_HIDE },
+    { INV_OBJECT_LOCATIONCHANGE, INV_OBJECT_NAMECHANGE },
+    { INV_SYSTEM_FOREGROUND, INV_SYSTEM_FOREGROUND },
+    { INV_SYSTEM_MOVESIZEEND, INV_SYSTEM_MOVESIZEEND },
+    { INV_SYSTEM_MINIMIZESTART, INV_SYSTEM_MINIMIZEEND },
+};
+#define INVENTORY_EVENT_RANGE_COUNT 5
+
+inline bool InventoryEventHooked(unsigned event) {
+    for (const InventoryEventRange& r : INVENTORY_EVENT_RANGES) {
+        if (event >= r.first && event <= r.last) return true;
+    }
+    return false;
+}
+
+// Whether an event on a window object makes the snapshot stale, once hooked.
+// A dead window can't be queried, so a destroy counts only if the window
+// was in the snapshot; a move only if it was and is top-level (the snapshot
+// holds nothing else); everything else counts only for top-level windows.
+inline bool InventoryWindowEventStales(unsigned event, bool knownWindow, bool topLevel) {
+    if (event == INV_OBJECT_DESTROY) return knownWindow;
+    if (event == INV_OBJECT_LOCATIONCHANGE) return knownWindow && topLevel;
+    return topLevel;
+}
+
+// The same for the events INVENTORY_EVENT_RANGES delivers; false for the rest
+inline bool InventoryEventStales(unsigned event, bool knownWindow, bool topLevel) {
+    return InventoryEventHooked(event) && InventoryWindowEventStales(event, knownWindow, topLevel);
+}
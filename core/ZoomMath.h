@@ -0,0 +1,67 @@
+// ZoomMath.h - Sub-cell and zoom region geometry
+// Platform-neutral: used by KeyboardJockey.cpp and by the tests under tests/.
+// Rect is any type with int-like left/top/right/bottom, Point any with x/y.
+#pragma once
+
+#define ZOOM_FANOUT 5            // Zoom levels split a region into up to this many columns and rows
+
+// Edge k (0-parts) of lo..hi split into parts: the parts of a cell or zoom
+// region always end where the next begins, and spread the pixels the
+// division leaves over among them
+inline int PartEdge(int lo, int hi, int parts, int k) {
+    return lo + (hi - lo) * k / parts;
+}
+
+// Columns and rows a region splits into: ZOOM_FANOUT each, fewer where the
+// region is not that many pixels across
+template <typename Rect>
+void ZoomGridSize(const Rect& r, int* cols, int* rows) {
+    int w = (int)(r.right - r.left), h = (int)(r.bottom - r.top);
+    *cols = w < ZOOM_FANOUT ? w : ZOOM_FANOUT;
+    *rows = h < ZOOM_FANOUT ? h : ZOOM_FANOUT;
+}
+
+// Part k (row-major) of r split into cols x rows
+template <typename Rect>
+Rect ZoomSubRegion(const Rect& r, int cols, int rows, int k) {
+    int col = k % cols, row = k / cols;
+    Rect part = r;
+    part.left = PartEdge(r.left, r.right, cols, col);
+    part.top = PartEdge(r.top, r.bottom, rows, row);
+    part.right = PartEdge(r.left, r.right, cols, col + 1);
+    part.bottom = PartEdge(r.top, r.bottom, rows, row + 1);
+    return part;
+}
+
+// Sub-cell k (0-8 row-major, centre 4) of a cell. Sub-grid lines, sub-labels,
+// sub-points and the zoom region of a picked sub-cell all come from here.
+template <typename Rect>
+Rect SubCellRect(const Rect& cell, int k) {
+    return ZoomSubRegion(cell, 3, 3, k);
+}
+
+// True if the cols x rows parts of r cover it exactly: none is empty, each
+// starts where its left and upper neighbours end, and the last column and
+// row end on r's edges
+template <typename Rect>
+bool ZoomPartsTile(const Rect& r, int cols, int rows) {
+    for (int k = 0; k < cols * rows; k++) {
+        int col = k % cols, row = k / cols;
+        Rect p = ZoomSubRegion(r, cols, rows, k);
+        if (p.left >= p.right || p.top >= p.bottom) return false;
+        if (p.left != (col ? ZoomSubRegion(r, cols, rows, k - 1).right : r.left)) return false;
+        if (p.top != (row ? ZoomSubRegion(r, cols, rows, k - cols).bottom : r.top)) return false;
+        if (col == cols - 1 && p.right != r.right) return false;
+        if (row == rows - 1 && p.bottom != r.bottom) return false;
+    }
+    return true;
+}
+
+// The pixel the mouse goes to for a region (a 1x1 region's only pixel)
+template <typename Point, typename Rect>
+Point ZoomTarget(const Rect& r) {
+    Point pt = {};
+    pt.x = r.left + (r.right - r.left) / 2;
+    pt.y = r.top + (r.bottom - r.top) / 2;
+    return pt;
+}
@@ -0,0 +1,34 @@
+// Check.h - Minimal assertion helpers for the core tests
+#pragma once
+
+#include <cstdio>
+
+static int g_checkFailures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            g_checkFailures++;                                                   \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                           \
+    do {                                                                         \
+        long long va_ = (long long)(a), vb_ = (long long)(b);                    \
+        if (va_ != vb_) {                                                        \
+            std::fprintf(stderr, "%s:%d: CHECK_EQ failed: %s == %s (%lld vs %lld)\n", \
+                         __FILE__, __LINE__, #a, #b, va_, vb_);                  \
+            g_checkFailures++;                                                   \
+        }                                                                        \
+    } while (0)
+
+// Process exit code for main: 0 if every check passed
+inline int CheckResult(const char* name) {
+    if (g_checkFailures) {
+        std::fprintf(stderr, "%s: %d check(s) failed\n", name, g_checkFailures);
+        return 1;
+    }
+    std::printf("%s: ok\n", name);
+    return 0;
+}
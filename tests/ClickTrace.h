@@ -0,0 +1,136 @@
+// ClickTrace.h - Synthetic click traces replayed through core/ClickHistory.h,
+// counting the keystrokes each click would take with the codes the history
+// hands out against codes in plain cell order
+#pragma once
+
+#include <random>
+#include <vector>
+
+#include "core/ClickHistory.h"
+#include "core/GridLayout.h"
+#include "core/LabelCodes.h"
+
+// The fields of MonitorInfo the click history reads
+struct TraceMonitor {
+    wchar_t device[32];
+    int gridCols, gridRows;
+};
+
+struct TraceClick {
+    int app;   // Index into ClickTraceSpec::apps
+    int cell;
+    int sub;   // Sub-cell the click lands in (CLICK_SUB_CENTER needs no letter)
+};
+
+// A desktop session: the user switches between apps, clicking a few times
+// in each. Every app has its own targets (toolbar buttons, tabs, list rows),
+// clicked with Zipf-like frequency, a few shared ones (taskbar, window
+// controls) and some clicks anywhere. Halfway through, some of each app's
+// targets move, as when a window is rearranged.
+struct ClickTraceSpec {
+    int clicks;
+    int apps;
+    int targetsPerApp;
+    int sharedTargets;
+    float anywhereShare;    // Clicks on a uniformly random cell and sub-cell
+    float movedShare;       // Targets that move halfway through
+    int sessionClicks;      // Mean clicks before switching apps
+    unsigned seed;
+};
+
+inline std::vector<TraceClick> SyntheticClickTrace(const ClickTraceSpec& spec, const TraceMonitor& mon) {
+    std::mt19937 rng(spec.seed);
+    int cells = mon.gridCols * mon.gridRows;
+    auto target = [&]() {
+        TraceClick t = {};
+        t.cell = (int)(rng() % cells);
+        t.sub = (int)(rng() % 9);
+        return t;
+    };
+    std::vector<TraceClick> shared(spec.sharedTargets);
+    for (TraceClick& t : shared) t = target();
+    std::vector<std::vector<TraceClick>> own(spec.apps, std::vector<TraceClick>(spec.targetsPerApp));
+    for (auto& targets : own) {
+        for (TraceClick& t : targets) t = target();
+    }
+    // Zipf weights 1/k over an app's own targets then the shared ones
+    std::vector<double> weights;
+    for (int k = 0; k < spec.targetsPerApp + spec.sharedTargets; k++) weights.push_back(1.0 / (k + 1));
+    std::discrete_distribution<int> pick(weights.begin(), weights.end());
+    std::vector<double> appWeights;
+    for (int a = 0; a < spec.apps; a++) appWeights.push_back(1.0 / (a + 1));
+    std::discrete_distribution<int> pickApp(appWeights.begin(), appWeights.end());
+    std::geometric_distribution<int> sessionLength(1.0 / spec.sessionClicks);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<TraceClick> trace;
+    while ((int)trace.size() < spec.clicks) {
+        int app = pickApp(rng);
+        int n = 1 + sessionLength(rng);
+        for (int k = 0; k < n && (int)trace.size() < spec.clicks; k++) {
+            if ((int)trace.size() == spec.clicks / 2) {
+                for (auto& targets : own) {
+                    for (TraceClick& t : targets) {
+                        if (unit(rng) < spec.movedShare) t = target();
+                    }
+                }
+            }
+            TraceClick c;
+            if (unit(rng) < spec.anywhereShare) {
+                c = target();
+            } else {
+                int i = pick(rng);
+                c = i < spec.targetsPerApp ? own[app][i] : shared[i - spec.targetsPerApp];
+            }
+            c.app = app;
+            trace.push_back(c);
+        }
+    }
+    return trace;
+}
+
+// What the replay lets the click history do
+enum ClickPolicy {
+    CLICKS_IGNORED,      // Codes in cell order, landing on the centre (no history)
+    CLICKS_PER_LAYOUT,   // Codes ranked by every app's clicks together
+    CLICKS_PER_APP,      // Codes ranked by the foreground app's clicks
+    CLICKS_PREDICT_SUB,  // Per app, and codes land on the predicted sub-cell
+    CLICK_POLICY_COUNT
+};
+
+struct ClickReplay {
+    long long clicks = 0;
+    long long keys = 0;        // Prefix, code, sub-cell letter if needed, Enter
+    long long subLetters = 0;  // Clicks that needed a sub-cell letter
+    double KeysPerClick() const { return clicks ? (double)keys / clicks : 0.0; }
+};
+
+// Replay trace on mon with apps' image names. Codes are re-ranked whenever
+// the foreground app changes, as the grid is relabelled in the background
+// then, and stay put while one app is in front.
+inline ClickReplay ReplayClickTrace(const std::vector<TraceClick>& trace, const TraceMonitor& mon,
+                                    const std::vector<std::wstring>& apps, ClickPolicy policy,
+                                    ClickModel& model) {
+    int cells = mon.gridCols * mon.gridRows;
+    LabelPlan plan = PlanLabelCodes(cells);
+    std::vector<int> byCode(cells), rankOf(cells);
+    for (int i = 0; i < cells; i++) rankOf[i] = i;
+    ClickReplay r;
+    int front = -1;
+    for (const TraceClick& c : trace) {
+        const wchar_t* app = policy >= CLICKS_PER_APP ? apps[c.app].c_str() : L"";
+        if (c.app != front && policy != CLICKS_IGNORED) {
+            RankCellsByClicks(model, mon, app, byCode.data());
+            for (int rank = 0; rank < cells; rank++) rankOf[byCode[rank]] = rank;
+        }
+        front = c.app;
+        int digits[MAX_CODE_LETTERS];
+        int landing = policy == CLICKS_PREDICT_SUB ? PredictSubCell(model, mon, app, c.cell) : CLICK_SUB_CENTER;
+        bool subLetter = c.sub != landing;
+        r.clicks++;
+        r.keys += 1 + EncodeLabelRank(plan, rankOf[c.cell], digits) + subLetter + 1;
+        r.subLetters += subLetter;
+        if (policy != CLICKS_IGNORED) RecordClick(model, mon, app, c.cell, c.sub);
+    }
+    return r;
+}
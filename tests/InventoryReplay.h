@@ -0,0 +1,194 @@
+// InventoryReplay.h - Replays a scripted desktop session through the window
+// inventory's event filter and debounce on a simulated clock, to see how
+// long each Tab takes to its first highlight and whether the snapshot it
+// used was right
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "core/WindowInventory.h"
+
+struct ScriptedEvent {
+    long long ms;    // Simulated time
+    unsigned event;  // WinEvent ID
+    int window;      // Index into the session's windows
+    bool topLevel;   // False for child controls, tooltips' children and the like
+};
+
+struct ReplayWindow {
+    struct { int left, top, right, bottom; } rect;
+    bool alive;
+};
+
+// What the UI thread spends between Tab and the first highlight, in us.
+// Every Tab copies a snapshot, indexes the titles and paints; with no
+// usable snapshot it first walks the windows itself.
+struct TabCosts {
+    double highlightUs = 0;           // Copy, title index and first paint
+    double enumerateUsPerWindow = 0;  // EnumWindows, GetWindowText, GetWindowRect, visible-area sweep
+    double rectCheckUsPerWindow = 0;  // GetWindowRect on a snapshot window, when Tab checks rects
+};
+
+struct ReplayStats {
+    int delivered = 0;   // Events the hooks would deliver to the inventory thread
+    int relevant = 0;    // Of those, events that made the snapshot stale
+    int rebuilds = 0;    // Background enumerations
+    int tabs = 0;        // Tab presses replayed
+    int tabsFresh = 0;   // Tab presses served from the background snapshot
+    int tabsMoved = 0;   // Of those, ones whose snapshot had a window in the wrong place
+    long long staleMs = 0;  // Total time the snapshot was not the desktop
+    std::vector<double> tabLatencyUs;  // Tab to first highlight, per Tab press
+
+    // Latency at percentile p (0-100) of the Tab presses, nearest rank
+    double TabLatencyPercentile(double p) const {
+        if (tabLatencyUs.empty()) return 0.0;
+        std::vector<double> sorted = tabLatencyUs;
+        std::sort(sorted.begin(), sorted.end());
+        size_t rank = (size_t)(p / 100.0 * (double)sorted.size() + 0.999999);
+        if (rank < 1) rank = 1;
+        return sorted[(std::min)(rank, sorted.size()) - 1];
+    }
+};
+
+// Replays events against hooks on ranges[0..rangeCount), with the debounce
+// and stale rules the inventory thread uses. A top-level
+// INV_OBJECT_LOCATIONCHANGE also moves its window, hooked or not, and
+// CREATE/DESTROY bring windows to life and end them. tabAt lists the times
+// Tab is pressed. checkRectsOnTab replays the earlier design, where Tab
+// compared every snapshot window's rect on the UI thread and enumerated
+// inline (and asked for a rebuild) on a mismatch.
+class InventoryReplay {
+public:
+    InventoryReplay(const InventoryEventRange* ranges, int rangeCount, int debounceMs, int windowCount,
+                    const TabCosts& costs = TabCosts(), bool checkRectsOnTab = false)
+        : ranges_(ranges), rangeCount_(rangeCount), debounceMs_(debounceMs), windows_(windowCount),
+          costs_(costs), checkRectsOnTab_(checkRectsOnTab) {
+        for (int i = 0; i < windowCount; i++) windows_[i] = { { i, i, i + 100, i + 100 }, true };
+        Rebuild();
+    }
+
+    ReplayStats Run(const std::vector<ScriptedEvent>& events, const std::vector<long long>& tabAt,
+                    long long endMs) {
+        size_t t = 0;
+        long long now = 0;
+        auto stale = [&](long long until) {
+            if (!Fresh()) stats_.staleMs += until - now;
+            now = until;
+        };
+        // Run the debounce timer and Tab presses up to time to
+        auto advance = [&](long long to) {
+            for (;;) {
+                bool tab = t < tabAt.size() && tabAt[t] <= to;
+                long long next = tab ? tabAt[t] : to;
+                if (dueMs_ >= 0 && dueMs_ <= next) {
+                    stale(dueMs_);
+                    dueMs_ = -1;
+                    Rebuild();
+                    stats_.rebuilds++;
+                    continue;
+                }
+                stale(next);
+                if (!tab) break;
+                t++;
+                Tab();
+            }
+        };
+        for (const ScriptedEvent& e : events) {
+            advance(e.ms);
+            Apply(e);
+        }
+        advance(endMs);
+        return stats_;
+    }
+
+    // True if the snapshot is the desktop: no stale event since it began
+    // and every window still where it was
+    bool Fresh() const { return snapSeq_ == seq_ && RectsCurrent(); }
+
+private:
+    struct Snap {
+        int index;
+        decltype(ReplayWindow::rect) rect;
+    };
+
+    bool Hooked(unsigned event) const {
+        for (int i = 0; i < rangeCount_; i++) {
+            if (event >= ranges_[i].first && event <= ranges_[i].last) return true;
+        }
+        return false;
+    }
+
+    bool RectsCurrent() const {
+        for (const Snap& s : snapshot_) {
+            const ReplayWindow& w = windows_[s.index];
+            if (!w.alive || w.rect.left != s.rect.left || w.rect.top != s.rect.top ||
+                w.rect.right != s.rect.right || w.rect.bottom != s.rect.bottom) return false;
+        }
+        return true;
+    }
+
+    int AliveCount() const {
+        int n = 0;
+        for (const ReplayWindow& w : windows_) n += w.alive;
+        return n;
+    }
+
+    // The UI thread's side of a Tab press: use the snapshot if nothing
+    // staled it, else enumerate inline
+    void Tab() {
+        stats_.tabs++;
+        double us = costs_.highlightUs;
+        bool usable = snapSeq_ == seq_;
+        if (usable && checkRectsOnTab_) {
+            us += costs_.rectCheckUsPerWindow * (double)snapshot_.size();
+            if (!RectsCurrent()) {
+                usable = false;
+                Rebuild();  // The rebuild Tab asks for
+                stats_.rebuilds++;
+            }
+        }
+        if (usable) {
+            stats_.tabsFresh++;
+            stats_.tabsMoved += !RectsCurrent();
+        } else {
+            us += costs_.enumerateUsPerWindow * (double)AliveCount();
+        }
+        stats_.tabLatencyUs.push_back(us);
+    }
+
+    void Apply(const ScriptedEvent& e) {
+        ReplayWindow& w = windows_[e.window];
+        if (e.event == INV_OBJECT_CREATE) w.alive = true;
+        if (e.event == INV_OBJECT_LOCATIONCHANGE && e.topLevel) { w.rect.left++; w.rect.right++; }
+        bool known = false;
+        for (const Snap& s : snapshot_) known = known || s.index == e.window;
+        if (e.event == INV_OBJECT_DESTROY) w.alive = false;
+        if (!Hooked(e.event)) return;
+        stats_.delivered++;
+        if (!InventoryWindowEventStales(e.event, known, e.topLevel)) return;
+        stats_.relevant++;
+        seq_++;
+        dueMs_ = e.ms + debounceMs_;
+    }
+
+    void Rebuild() {
+        snapSeq_ = seq_;
+        snapshot_.clear();
+        for (int i = 0; i < (int)windows_.size(); i++) {
+            if (windows_[i].alive) snapshot_.push_back({ i, windows_[i].rect });
+        }
+    }
+
+    const InventoryEventRange* ranges_;
+    int rangeCount_;
+    int debounceMs_;
+    std::vector<ReplayWindow> windows_;
+    TabCosts costs_;
+    bool checkRectsOnTab_;
+    std::vector<Snap> snapshot_;
+    unsigned seq_ = 0, snapSeq_ = 0;
+    long long dueMs_ = -1;
+    ReplayStats stats_;
+};
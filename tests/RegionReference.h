@@ -0,0 +1,41 @@
+// RegionReference.h - Visible areas by region arithmetic, the way the app
+// computed them with CombineRgn before the sweep: each window's visible
+// region is its rect minus the union of the windows in front of it
+#pragma once
+
+#include <vector>
+
+#include "tests/TestGrid.h"
+
+// r minus cut, as up to four disjoint rects appended to out
+inline void SubtractRect(const TestRect& r, const TestRect& cut, std::vector<TestRect>& out) {
+    if (cut.right <= r.left || r.right <= cut.left || cut.bottom <= r.top || r.bottom <= cut.top) {
+        out.push_back(r);
+        return;
+    }
+    int top = r.top > cut.top ? r.top : cut.top;
+    int bottom = r.bottom < cut.bottom ? r.bottom : cut.bottom;
+    if (r.top < cut.top) out.push_back({ r.left, r.top, r.right, cut.top });
+    if (cut.bottom < r.bottom) out.push_back({ r.left, cut.bottom, r.right, r.bottom });
+    if (r.left < cut.left) out.push_back({ r.left, top, cut.left, bottom });
+    if (cut.right < r.right) out.push_back({ cut.right, top, r.right, bottom });
+}
+
+inline void ReferenceVisibleAreas(const TestRect* rects, int n, long long* visibleArea) {
+    std::vector<TestRect> covered;  // Union of the windows so far, as disjoint rects
+    for (int i = 0; i < n; i++) {
+        visibleArea[i] = 0;
+        if (rects[i].right <= rects[i].left || rects[i].bottom <= rects[i].top) continue;
+        std::vector<TestRect> visible(1, rects[i]), next;
+        for (const TestRect& c : covered) {
+            next.clear();
+            for (const TestRect& v : visible) SubtractRect(v, c, next);
+            visible.swap(next);
+            if (visible.empty()) break;
+        }
+        for (const TestRect& v : visible) {
+            visibleArea[i] += (long long)(v.right - v.left) * (v.bottom - v.top);
+        }
+        covered.insert(covered.end(), visible.begin(), visible.end());
+    }
+}
@@ -0,0 +1,50 @@
+// TestGrid.h - Grid cells for tests and benchmarks, laid out as
+// BuildGridCells lays them out (code ranks in cell order)
+#pragma once
+
+#include <vector>
+
+#include "core/GridCells.h"
+#include "core/GridLayout.h"
+#include "core/LabelCodes.h"
+
+struct TestRect { int left, top, right, bottom; };
+struct TestPoint { int x, y; };
+typedef GridCellArrays<TestRect, TestPoint> TestCells;
+
+// Tests set rc and dpi; BuildTestGrid fills in the rest
+struct TestMonitor {
+    TestRect rc;
+    int dpi;
+    wchar_t prefix = 0;
+    GridSize size = {};
+    LabelPlan codes = {};
+    int firstCell = 0, cellCount = 0;
+};
+
+// Lay out cells for monitors, labelled from prefixes[m] (AssignMonitorPrefixes
+// order) or else from the monitor's position
+inline void BuildTestGrid(std::vector<TestMonitor>& monitors, TestCells& cells,
+                          const wchar_t* prefixes = NULL) {
+    int total = 0;
+    for (size_t m = 0; m < monitors.size(); m++) {
+        TestMonitor& mon = monitors[m];
+        mon.prefix = prefixes ? prefixes[m] : (wchar_t)(L'a' + m);
+        mon.size = PlanGridSize(mon.rc.right - mon.rc.left, mon.rc.bottom - mon.rc.top, mon.dpi);
+        mon.cellCount = mon.size.cols * mon.size.rows;
+        mon.codes = PlanLabelCodes(mon.cellCount);
+        mon.firstCell = total;
+        total += mon.cellCount;
+    }
+    AllocateGridCells(cells, total);
+    for (const TestMonitor& mon : monitors) {
+        for (int k = 0; k < mon.cellCount; k++) {
+            int i = mon.firstCell + k;
+            cells.rect[i] = GridCellRect(mon.rc, mon.size, k % mon.size.cols, k / mon.size.cols);
+            cells.gridCol[i] = (short)(k % mon.size.cols);
+            cells.gridRow[i] = (short)(k / mon.size.cols);
+            cells.byCode[i] = k;
+            cells.label[i] = MakeLabel(mon.prefix, mon.codes, k);
+        }
+    }
+}
@@ -0,0 +1,201 @@
+// TestRaster.h - A headless backend for core/GridRaster.h, with synthetic
+// glyphs, and frames composited the way PaintGrid composites the tiles
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "core/GridRaster.h"
+#include "tests/TestGrid.h"
+
+// Glyph masks made up from the letter and font size instead of a font, so
+// frames are the same on every platform. Sizes follow CreateGridFonts
+// loosely: the main font is most of a sub-cell high, the sub font less.
+inline void BuildTestFace(GlyphFace& face, int px) {
+    if (px < 3) px = 3;
+    face.height = px + px / 4;
+    face.margin = face.height / 4 + 1;
+    face.maskW = 0;
+    for (int c = 0; c < 26; c++) {
+        face.advance[c] = px / 2 + c % 4;
+        face.x[c] = face.maskW;
+        face.maskW += face.advance[c] + 2 * face.margin;
+    }
+    face.coverage.assign((size_t)face.maskW * face.height, 0);
+    for (int c = 0; c < 26; c++) {
+        // An outline box per letter, its ink a few pixels into the margins,
+        // with per-channel coverage that differs by letter and position
+        int left = face.x[c] + face.margin - 1, right = face.x[c] + face.margin + face.advance[c] + 1;
+        for (int y = face.height / 8; y < face.height - face.height / 8; y++) {
+            for (int x = left; x < right; x++) {
+                bool edge = x == left || x == right - 1 || y == face.height / 8 || (x + y + c) % 5 == 0;
+                if (!edge) continue;
+                uint32_t r = (uint32_t)(40 + (x * 7 + c * 13) % 216);
+                uint32_t g = (uint32_t)(40 + (y * 11 + c * 5) % 216);
+                uint32_t b = (uint32_t)(40 + (x * 3 + y * 5 + c) % 216);
+                face.coverage[(size_t)y * face.maskW + x] = (r << 16) | (g << 8) | b;
+            }
+        }
+    }
+}
+
+struct TestRasterBackend : GridRasterBackend {
+    std::vector<GridGlyphs> glyphs;
+    int liveTiles = 0;
+    size_t liveBytes = 0;  // Pixel bytes of the live tiles
+
+    const GridGlyphs& Glyphs(int sh, int cellW) override {
+        for (const GridGlyphs& g : glyphs) {
+            if (g.sh == sh && g.cellW == cellW) return g;
+        }
+        GridGlyphs g;
+        g.sh = sh;
+        g.cellW = cellW;
+        int mainPx = sh * 60 / 100 < cellW / 5 ? sh * 60 / 100 : cellW / 5;
+        BuildTestFace(g.main, mainPx);
+        BuildTestFace(g.sub, sh * 30 / 100);
+        glyphs.push_back(g);
+        return glyphs.back();
+    }
+    uint32_t* CreateTile(int width, int height, void** handle) override {
+        std::vector<uint32_t>* bits = new std::vector<uint32_t>((size_t)width * height, 0);
+        *handle = bits;
+        liveTiles++;
+        liveBytes += bits->size() * sizeof(uint32_t);
+        return bits->data();
+    }
+    void ReleaseTile(void* handle) override {
+        std::vector<uint32_t>* bits = (std::vector<uint32_t>*)handle;
+        liveBytes -= bits->size() * sizeof(uint32_t);
+        delete bits;
+        liveTiles--;
+    }
+};
+
+typedef BaseGridTile<TestRect> TestTile;
+
+// Reference painter: every fill, line and glyph pixel written straight into
+// the surface in draw order, with no batching, banding or recording
+struct ReferencePainter {
+    std::vector<uint32_t> px;
+    int w, h;
+
+    void Fill(int l, int t, int r, int b, uint32_t color) {
+        for (int y = t; y < b; y++) {
+            for (int x = l; x < r; x++) {
+                if (x >= 0 && x < w && y >= 0 && y < h) px[(size_t)y * w + x] = color;
+            }
+        }
+    }
+    // PS_SOLID pen: a 1-pixel pen stops short of the end point, wider pens
+    // are centred and take both ends plus square caps
+    void Line(int x0, int y0, int x1, int y1, int width, uint32_t color) {
+        int half = width / 2;
+        if (y0 == y1) {
+            int step = x1 > x0 ? 1 : -1;
+            if (width <= 1) {
+                for (int x = x0; x != x1; x += step) Fill(x, y0, x + 1, y0 + 1, color);
+            } else {
+                int lo = x0 < x1 ? x0 : x1, hi = x0 < x1 ? x1 : x0;
+                Fill(lo - half, y0 - half, hi + width - half, y0 - half + width, color);
+            }
+        } else {
+            int step = y1 > y0 ? 1 : -1;
+            if (width <= 1) {
+                for (int y = y0; y != y1; y += step) Fill(x0, y, x0 + 1, y + 1, color);
+            } else {
+                int lo = y0 < y1 ? y0 : y1, hi = y0 < y1 ? y1 : y0;
+                Fill(x0 - half, lo - half, x0 - half + width, hi + width - half, color);
+            }
+        }
+    }
+    static uint32_t Blend(uint32_t dst, uint32_t src, uint32_t cov) {
+        uint32_t out = 0;
+        for (int shift = 0; shift <= 16; shift += 8) {
+            int d = (dst >> shift) & 0xFF, v = (src >> shift) & 0xFF, c = (cov >> shift) & 0xFF;
+            out |= (uint32_t)(d + lround((double)(v - d) * c / 255.0)) << shift;
+        }
+        return out;
+    }
+    void Text(const GlyphFace& face, const wchar_t* text, int n, const TestRect& rc, uint32_t color) {
+        Text(face, text, n, rc, rc, color);
+    }
+    // Text centred in rc but clipped to clip
+    void Text(const GlyphFace& face, const wchar_t* text, int n, const TestRect& rc, const TestRect& clip,
+              uint32_t color) {
+        int textW = 0;
+        for (int k = 0; k < n; k++) textW += face.advance[text[k] - L'a'];
+        int x = rc.left + (rc.right - rc.left - textW) / 2;
+        int y = rc.top + (rc.bottom - rc.top - face.height) / 2;
+        for (int k = 0; k < n; k++) {
+            int c = text[k] - L'a';
+            for (int gy = 0; gy < face.height; gy++) {
+                for (int gx = 0; gx < face.advance[c] + 2 * face.margin; gx++) {
+                    int sx = x - face.margin + gx, sy = y + gy;
+                    if (sx < clip.left || sx >= clip.right || sy < clip.top || sy >= clip.bottom) continue;
+                    if (sx < 0 || sx >= w || sy < 0 || sy >= h) continue;
+                    uint32_t cov = face.coverage[(size_t)gy * face.maskW + face.x[c] + gx];
+                    if (cov) px[(size_t)sy * w + sx] = Blend(px[(size_t)sy * w + sx], color, cov);
+                }
+            }
+            x += face.advance[c];
+        }
+    }
+};
+
+// The virtual screen as PaintGrid shows it: background, then every tile at
+// its monitor's place in the bounding box
+struct TestFrame {
+    TestRect bounds;
+    std::vector<uint32_t> pixels;
+};
+
+inline TestFrame CompositeTestFrame(const std::vector<TestMonitor>& monitors,
+                                    const std::vector<TestTile>& tiles, const Palette& p) {
+    TestFrame f;
+    f.bounds = monitors[0].rc;
+    for (const TestMonitor& mon : monitors) {
+        if (mon.rc.left < f.bounds.left) f.bounds.left = mon.rc.left;
+        if (mon.rc.top < f.bounds.top) f.bounds.top = mon.rc.top;
+        if (mon.rc.right > f.bounds.right) f.bounds.right = mon.rc.right;
+        if (mon.rc.bottom > f.bounds.bottom) f.bounds.bottom = mon.rc.bottom;
+    }
+    int w = f.bounds.right - f.bounds.left, h = f.bounds.bottom - f.bounds.top;
+    f.pixels.assign((size_t)w * h, SurfacePixel(p.background));
+    for (const TestTile& tile : tiles) {
+        if (!tile.handle) continue;
+        int tw = tile.rc.right - tile.rc.left, th = tile.rc.bottom - tile.rc.top;
+        for (int y = 0; y < th; y++) {
+            memcpy(&f.pixels[(size_t)(tile.rc.top - f.bounds.top + y) * w + (tile.rc.left - f.bounds.left)],
+                   tile.bits + (size_t)y * tw, tw * sizeof(uint32_t));
+        }
+    }
+    return f;
+}
+
+// Render every monitor's tile and composite the frame
+inline TestFrame RenderTestFrame(TestRasterBackend& backend, const std::vector<TestMonitor>& monitors,
+                                 const TestCells& cells, std::vector<TestTile>& tiles, const Palette& p) {
+    tiles.resize(monitors.size());
+    for (size_t m = 0; m < monitors.size(); m++) {
+        RenderGridTile(backend, tiles[m], monitors[m].rc, cells, monitors[m].firstCell,
+                       monitors[m].cellCount, p);
+    }
+    return CompositeTestFrame(monitors, tiles, p);
+}
+
+// FNV-1a of a frame's size and pixels, for golden comparisons
+inline uint64_t HashTestFrame(const TestFrame& f) {
+    uint64_t h = 14695981039346656037ULL;
+    auto mix = [&h](uint32_t v) {
+        for (int k = 0; k < 4; k++) {
+            h ^= (v >> (8 * k)) & 0xFF;
+            h *= 1099511628211ULL;
+        }
+    };
+    mix((uint32_t)(f.bounds.right - f.bounds.left));
+    mix((uint32_t)(f.bounds.bottom - f.bounds.top));
+    for (uint32_t px : f.pixels) mix(px);
+    return h;
+}
@@ -0,0 +1,74 @@
+// Tests for core/BufferPool.h
+#include "core/BufferPool.h"
+#include "tests/Check.h"
+
+struct FakeSurface {
+    int id, width, height;
+};
+
+static int g_created = 0, g_destroyed = 0;
+
+static FakeSurface CreateFake(int w, int h) {
+    return { ++g_created, w, h };
+}
+
+static void DestroyFake(FakeSurface& s) {
+    CHECK(s.id > 0);
+    g_destroyed++;
+    s.id = -1;
+}
+
+// Paints at one size keep one surface; only a size change reallocates
+static void TestReuseAcrossPaints() {
+    BufferPoolStats stats = {};
+    PooledBuffer<FakeSurface> overlay = {};
+    for (int paint = 0; paint < 100; paint++) {
+        FakeSurface& s = AcquirePooledBuffer(overlay, stats, 7680, 2160, CreateFake, DestroyFake);
+        CHECK_EQ(s.id, 1);
+    }
+    CHECK_EQ(g_created, 1);
+    CHECK_EQ(stats.allocations, 1);
+    CHECK_EQ(stats.reuses, 99);
+    CHECK_EQ(stats.bytes, 7680ull * 2160 * 4);
+
+    // Display topology change: the old surface goes before the new one is made
+    FakeSurface& s = AcquirePooledBuffer(overlay, stats, 3840, 2160, CreateFake, DestroyFake);
+    CHECK_EQ(s.id, 2);
+    CHECK_EQ(s.width, 3840);
+    CHECK_EQ(g_destroyed, 1);
+    CHECK_EQ(stats.bytes, 3840ull * 2160 * 4);
+    CHECK_EQ(stats.peakBytes, 7680ull * 2160 * 4);
+
+    ReleasePooledBuffer(overlay, stats, DestroyFake);
+    ReleasePooledBuffer(overlay, stats, DestroyFake);  // Nothing held: no-op
+    CHECK_EQ(g_destroyed, 2);
+    CHECK_EQ(stats.bytes, 0);
+    CHECK_EQ(overlay.width, 0);
+}
+
+// Buffers sharing stats add up, and the peak is their largest sum
+static void TestSharedStats() {
+    g_created = g_destroyed = 0;
+    BufferPoolStats stats = {};
+    PooledBuffer<FakeSurface> overlay = {}, palette = {};
+    AcquirePooledBuffer(overlay, stats, 1920, 1080, CreateFake, DestroyFake);
+    AcquirePooledBuffer(palette, stats, 400, 300, CreateFake, DestroyFake);
+    size_t both = PooledBufferBytes(1920, 1080) + PooledBufferBytes(400, 300);
+    CHECK_EQ(stats.bytes, both);
+    ReleasePooledBuffer(palette, stats, DestroyFake);
+    AcquirePooledBuffer(overlay, stats, 1600, 900, CreateFake, DestroyFake);
+    CHECK_EQ(stats.bytes, PooledBufferBytes(1600, 900));
+    CHECK_EQ(stats.peakBytes, both);
+    AcquirePooledBuffer(overlay, stats, 1920, 1200, CreateFake, DestroyFake);
+    CHECK_EQ(stats.peakBytes, PooledBufferBytes(1920, 1200));
+    AcquirePooledBuffer(palette, stats, 400, 300, CreateFake, DestroyFake);
+    CHECK_EQ(stats.peakBytes, PooledBufferBytes(1920, 1200) + PooledBufferBytes(400, 300));
+    CHECK_EQ(stats.allocations, 5);
+    CHECK_EQ(g_created - g_destroyed, 2);
+}
+
+int main() {
+    TestReuseAcrossPaints();
+    TestSharedStats();
+    return CheckResult("buffer_pool_test");
+}
@@ -0,0 +1,141 @@
+// Tests for core/CellAtlas.h: every highlighted cell appearance assembled
+// from the atlas (one sprite blit plus a blit per label letter) compared
+// pixel for pixel with the same cell painted directly by the reference
+// painter, for each cell state, several labels and cell sizes, in a preset
+// and a generated palette
+#include "core/CellAtlas.h"
+#include "tests/Check.h"
+#include "tests/TestGrid.h"
+#include "tests/TestRaster.h"
+
+#include <cstdio>
+
+// The strips clip each letter to its advance, which is what lets a label be
+// assembled from them; BuildTestFace inks a pixel either side on purpose, so
+// the main face here keeps only the ink inside the advance
+static void TrimToAdvance(GlyphFace& face) {
+    for (int c = 0; c < 26; c++) {
+        for (int y = 0; y < face.height; y++) {
+            uint32_t* row = &face.coverage[(size_t)y * face.maskW + face.x[c]];
+            for (int x = 0; x < face.advance[c] + 2 * face.margin; x++) {
+                if (x < face.margin || x >= face.margin + face.advance[c]) row[x] = 0;
+            }
+        }
+    }
+}
+
+// A cell in state, label and all, painted straight into r at cell
+static void ReferenceCell(ReferencePainter& r, const GridGlyphs& g, const TestRect& cell, int state,
+                          const wchar_t* label, int n, const Palette& p) {
+    uint32_t bg = SurfacePixel(state == CELL_DIM ? p.dimBg : state == CELL_PARTIAL ? p.partialMatchBg : p.matchCellBg);
+    r.Fill(cell.left, cell.top, cell.right, cell.bottom, bg);
+    if (state >= CELL_MATCH) {
+        int w = cell.right - cell.left, h = cell.bottom - cell.top;
+        for (int k = 1; k < 3; k++) {
+            r.Line(cell.left + w * k / 3, cell.top, cell.left + w * k / 3, cell.bottom, 1, SurfacePixel(p.matchGridLine));
+            r.Line(cell.left, cell.top + h * k / 3, cell.right, cell.top + h * k / 3, 1, SurfacePixel(p.matchGridLine));
+        }
+        int highlight = state - CELL_MATCH_SUB_A, sub = 0;
+        for (int k = 0; k < 9; k++) {
+            if (k == 4) continue;
+            TestRect rc = SubCellRect(cell, k);
+            if (sub == highlight) r.Fill(rc.left, rc.top, rc.right, rc.bottom, SurfacePixel(p.matchSubHighlightBg));
+            r.Text(g.sub, &SUB_LABELS[sub], 1, rc,
+                   SurfacePixel(sub == highlight ? p.matchSubHighlightText : p.matchSubLabelText));
+            sub++;
+        }
+    }
+    PaletteColor text = state == CELL_DIM ? p.dimText : state == CELL_PARTIAL ? p.partialMatchText : p.matchLabelText;
+    TestRect clip = cell;
+    if (state >= CELL_MATCH) {
+        clip = SubCellRect(cell, 4);
+        clip.left++;
+        clip.top++;
+    }
+    r.Text(g.main, label, n, cell, clip, SurfacePixel(text));
+}
+
+// Every state and label of one cell size, at an offset in a larger target
+// so blits that slip by a pixel show up
+static bool TestCellSize(int cellW, int cellH, const Palette& p) {
+    TestRasterBackend backend;
+    GridGlyphs g = backend.Glyphs(cellH / 3, cellW / 3 * 3);
+    TrimToAdvance(g.main);
+
+    CellAtlasLayout a = PlanCellAtlas(cellW, cellH, g.main);
+    std::vector<uint32_t> atlasPx((size_t)a.width * a.height, 0xDEADBEEF);
+    PixelSurface atlas = { atlasPx.data(), a.width, a.height, a.width };
+    PaintCellAtlas(atlas, a, g, p);
+
+    static const wchar_t* const LABELS[] = { L"a", L"fj", L"mw", L"xyz", L"qqq", L"bdhlptx" };
+    const int pad = 3;
+    int w = cellW + 2 * pad, h = cellH + 2 * pad;
+    TestRect cell = { pad, pad, pad + cellW, pad + cellH };
+    int mismatches = 0;
+    for (int state = CELL_DIM; state < CELL_MATCH_SUB_A + 8; state++) {
+        for (const wchar_t* label : LABELS) {
+            int n = 0;
+            while (label[n]) n++;
+            if (n > MAX_LABEL_LETTERS) n = MAX_LABEL_LETTERS;
+
+            ReferencePainter r;
+            r.w = w;
+            r.h = h;
+            r.px.assign((size_t)w * h, SurfacePixel(p.background));
+            ReferenceCell(r, g, cell, state, label, n, p);
+
+            std::vector<uint32_t> out((size_t)w * h, SurfacePixel(p.background));
+            auto blit = [&](int dstX, int dstY, int bw, int bh, int srcX, int srcY) {
+                for (int y = 0; y < bh; y++) {
+                    for (int x = 0; x < bw; x++) {
+                        out[(size_t)(dstY + y) * w + dstX + x] = atlasPx[(size_t)(srcY + y) * a.width + srcX + x];
+                    }
+                }
+            };
+            blit(cell.left, cell.top, cellW, cellH, (state - CELL_DIM) * cellW, 0);
+            ForEachLabelBlit(a, LabelStyleOf(state), label, n, cell, LabelClip(cell, state), blit);
+
+            for (size_t i = 0; i < out.size(); i++) {
+                if (out[i] != r.px[i] && mismatches++ < 3) {
+                    printf("  %dx%d state %d \"%ls\": pixel (%d,%d) atlas %06X direct %06X\n", cellW, cellH,
+                           state, label, (int)(i % w), (int)(i / w), out[i], r.px[i]);
+                }
+            }
+        }
+    }
+    return mismatches == 0;
+}
+
+static void TestAtlasMatchesDirect() {
+    static const int SIZES[][2] = { { 12, 9 }, { 60, 45 }, { 91, 67 }, { 128, 72 }, { 200, 151 } };
+    Palette palettes[2] = { PALETTE_PRESETS[0].palette, GeneratePalette(123.4f) };
+    for (const Palette& p : palettes) {
+        for (const auto& size : SIZES) {
+            CHECK(TestCellSize(size[0], size[1], p));
+        }
+    }
+}
+
+// The layout holds every sprite and a full strip per style, and labels
+// clipped away entirely produce no blits
+static void TestLayout() {
+    TestRasterBackend backend;
+    const GridGlyphs& g = backend.Glyphs(20, 90);
+    CellAtlasLayout a = PlanCellAtlas(90, 60, g.main);
+    CHECK(a.width >= 90 * CELL_SPRITE_COUNT);
+    CHECK_EQ(a.glyphX[25] + a.glyphW[25] <= a.width, true);
+    CHECK_EQ(a.height, 60 + g.main.height * LABEL_STYLE_COUNT);
+
+    int blits = 0;
+    TestRect cell = { 0, 0, 90, 60 }, none = { 40, 30, 40, 30 };
+    ForEachLabelBlit(a, LABEL_MATCH, L"abc", 3, cell, none, [&](int, int, int, int, int, int) { blits++; });
+    CHECK_EQ(blits, 0);
+    ForEachLabelBlit(a, LABEL_MATCH, L"abc", 3, cell, cell, [&](int, int, int, int, int, int) { blits++; });
+    CHECK_EQ(blits, 3);
+}
+
+int main() {
+    TestAtlasMatchesDirect();
+    TestLayout();
+    return CheckResult("cell_atlas_test");
+}
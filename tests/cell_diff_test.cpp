@@ -0,0 +1,108 @@
+// Tests for core/CellDiff.h: after every keystroke the invalidated rects
+// cover exactly the cells whose state changed
+#include "core/CellDiff.h"
+#include "tests/Check.h"
+#include "tests/TestGrid.h"
+
+#include <string>
+#include <vector>
+
+static bool Overlaps(const TestRect& a, const TestRect& b) {
+    return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+static bool Contains(const TestRect& outer, const TestRect& inner) {
+    return outer.left <= inner.left && inner.right <= outer.right &&
+           outer.top <= inner.top && inner.bottom <= outer.bottom;
+}
+
+// Apply typed and check the reported rects against the state changes
+static void CheckUpdate(TestCells& cells, const std::wstring& typed) {
+    std::vector<uint8_t> before(cells.state, cells.state + cells.count);
+    std::vector<TestRect> rects;
+    int changed = UpdateTypedCellStates(cells, typed, [&](const TestRect& rc) { rects.push_back(rc); });
+
+    int typedLen = (int)typed.length();
+    LabelCode typedCode = PackTypedPrefix(typed, typedLen < MAX_LABEL_LETTERS ? typedLen : MAX_LABEL_LETTERS);
+    int expectChanged = 0;
+    long long changedArea = 0, rectArea = 0;
+    for (int i = 0; i < cells.count; i++) {
+        int labelLen = LabelLength(cells.label[i]);
+        wchar_t subChar = typedLen == labelLen + 1 ? typed[labelLen] : 0;
+        CHECK_EQ(cells.state[i], TypedCellState(cells.label[i], typedCode, typedLen, subChar));
+        bool covered = false, touched = false;
+        for (const TestRect& rc : rects) {
+            covered |= Contains(rc, cells.rect[i]);
+            touched |= Overlaps(rc, cells.rect[i]);
+        }
+        const TestRect& c = cells.rect[i];
+        if (cells.state[i] != before[i]) {
+            expectChanged++;
+            changedArea += (long long)(c.right - c.left) * (c.bottom - c.top);
+            CHECK(covered);
+        } else {
+            CHECK(!touched);
+        }
+    }
+    for (const TestRect& rc : rects) rectArea += (long long)(rc.right - rc.left) * (rc.bottom - rc.top);
+    CHECK_EQ(changed, expectChanged);
+    CHECK_EQ(rectArea, changedArea);  // Rects do not overlap or spill past the changed cells
+}
+
+static void TestTypingSequence() {
+    // A landscape monitor next to a shorter portrait one
+    std::vector<TestMonitor> monitors = { { { 0, 0, 1920, 1080 }, 96 }, { { 1920, 0, 3000, 1920 }, 120 } };
+    TestCells cells = {};
+    BuildTestGrid(monitors, cells);
+
+    // The first letter only dims the other monitor, in one rect per grid row
+    std::vector<TestRect> rects;
+    int changed = UpdateTypedCellStates(cells, std::wstring(1, monitors[0].prefix),
+                                        [&](const TestRect& rc) { rects.push_back(rc); });
+    CHECK_EQ(changed, monitors[1].cellCount);
+    CHECK_EQ((int)rects.size(), monitors[1].size.rows);
+    for (const TestRect& rc : rects) CHECK(rc.left >= monitors[1].rc.left);
+
+    // Type a label and a sub-cell, back off, then start over on the other monitor
+    wchar_t label[MAX_LABEL_LETTERS + 1];
+    FormatLabel(cells.label[monitors[0].firstCell + 57], label);
+    std::wstring typed;
+    for (const wchar_t* p = label; *p; p++) {
+        typed += *p;
+        CheckUpdate(cells, typed);
+    }
+    for (const wchar_t* sub : { L"c", L"x", L"h" }) {
+        CheckUpdate(cells, typed + sub);
+    }
+    CheckUpdate(cells, typed + L"hz");
+    while (!typed.empty()) {
+        typed.pop_back();
+        CheckUpdate(cells, typed);
+    }
+    CheckUpdate(cells, std::wstring(1, monitors[1].prefix));
+    CheckUpdate(cells, std::wstring(1, monitors[1].prefix) + L"q");
+
+    // Nothing changed, nothing invalidated
+    rects.clear();
+    CHECK_EQ(UpdateTypedCellStates(cells, std::wstring(1, monitors[1].prefix) + L"q",
+                                   [&](const TestRect& rc) { rects.push_back(rc); }), 0);
+    CHECK(rects.empty());
+}
+
+// On a single monitor the prefix repaints nothing
+static void TestSingleMonitorPrefix() {
+    std::vector<TestMonitor> monitors = { { { 0, 0, 3840, 2160 }, 96 } };
+    TestCells cells = {};
+    BuildTestGrid(monitors, cells);
+    std::vector<TestRect> rects;
+    CHECK_EQ(UpdateTypedCellStates(cells, std::wstring(1, monitors[0].prefix),
+                                   [&](const TestRect& rc) { rects.push_back(rc); }), 0);
+    CHECK(rects.empty());
+    CheckUpdate(cells, std::wstring(1, monitors[0].prefix) + L"a");
+}
+
+int main() {
+    TestTypingSequence();
+    TestSingleMonitorPrefix();
+    return CheckResult("cell_diff_test");
+}
@@ -0,0 +1,278 @@
+// Tests for core/ClickHistory.h: decay by half-life, ranking per layout and
+// per app, sub-cell prediction, the memory bounds, the file format (both
+// versions, and every truncation rejected), and a replayed trace that
+// takes fewer keystrokes than codes in cell order
+#include "core/ClickHistory.h"
+#include "tests/Check.h"
+#include "tests/ClickTrace.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+static const TraceMonitor WIDE = { L"\\\\.\\DISPLAY1", 10, 6 };
+static const TraceMonitor SIDE = { L"\\\\.\\DISPLAY2", 4, 5 };
+
+static std::vector<int> Ranking(const ClickModel& model, const TraceMonitor& mon, const wchar_t* app) {
+    std::vector<int> byCode(mon.gridCols * mon.gridRows);
+    RankCellsByClicks(model, mon, app, byCode.data());
+    return byCode;
+}
+
+// Decayed clicks on a cell, in clicks
+static double Clicks(const ClickModel& model, const TraceMonitor& mon, const wchar_t* app, int cell) {
+    const ClickHistory* h = FindClickHistory(model, mon, app);
+    if (!h) return 0.0;
+    for (const ClickCell& c : h->cells) {
+        if (c.cell == cell) return ClickCellCount(c) / h->weight;
+    }
+    return 0.0;
+}
+
+// A click counts half after CLICK_HALF_LIFE more, and the rescaling that
+// keeps the weight finite changes no count
+static void TestDecay() {
+    ClickModel model;
+    RecordClick(model, WIDE, L"", 0, 4);
+    for (int k = 0; k < CLICK_HALF_LIFE - 1; k++) RecordClick(model, WIDE, L"", 1, 4);
+    CHECK(std::fabs(Clicks(model, WIDE, L"", 0) - 0.5) < 0.005);
+
+    for (int k = 0; k < 12 * CLICK_HALF_LIFE; k++) RecordClick(model, WIDE, L"", 2 + k % 2, 4);
+    const ClickHistory* h = FindClickHistory(model, WIDE, L"");
+    CHECK(h->weight < 1e6f);
+    double half = Clicks(model, WIDE, L"", 2);
+    CHECK(std::fabs(half - Clicks(model, WIDE, L"", 3)) / half < 0.01);
+    // Two cells clicked alternately each hold half of the steady state of
+    // 1 / (1 - 2^(-1/H)) clicks
+    double steady = 1.0 / (1.0 - std::exp2(-1.0 / CLICK_HALF_LIFE));
+    CHECK(std::fabs(2 * half - steady) / steady < 0.01);
+    CHECK(std::fabs(h->total / h->weight - steady) / steady < 0.01);
+}
+
+// Most clicked first; ties and unclicked layouts keep cell order
+static void TestRanking() {
+    ClickModel model;
+    std::vector<int> plain = Ranking(model, WIDE, L"");
+    for (int i = 0; i < (int)plain.size(); i++) CHECK_EQ(plain[i], i);
+
+    for (int k = 0; k < 3; k++) RecordClick(model, WIDE, L"", 7, 4);
+    for (int k = 0; k < 2; k++) RecordClick(model, WIDE, L"", 42, 0);
+    RecordClick(model, WIDE, L"", 5, 8);
+    std::vector<int> ranked = Ranking(model, WIDE, L"");
+    CHECK(std::vector<int>(ranked.begin(), ranked.begin() + 5) == std::vector<int>({ 7, 42, 5, 0, 1 }));
+    // Another monitor, or the same one laid out again, starts over
+    CHECK_EQ(Ranking(model, SIDE, L"")[0], 0);
+    TraceMonitor resized = WIDE;
+    resized.gridCols = 12;
+    CHECK_EQ(Ranking(model, resized, L"")[0], 0);
+    // Out-of-range clicks are ignored
+    RecordClick(model, WIDE, L"", 60, 4);
+    RecordClick(model, WIDE, L"", 0, 9);
+    CHECK_EQ(model.serial, 6u);
+}
+
+// An app ranks by its own clicks once it has CLICK_APP_MIN_CLICKS, its
+// ties falling back to every app's; until then it ranks like every app
+static void TestPerApp() {
+    ClickModel model;
+    for (int k = 0; k < CLICK_APP_MIN_CLICKS + 5; k++) RecordClick(model, WIDE, L"editor.exe", 11, 4);
+    for (int k = 0; k < 5; k++) RecordClick(model, WIDE, L"browser.exe", 23, 4);
+    CHECK_EQ(Ranking(model, WIDE, L"editor.exe")[0], 11);
+    CHECK_EQ(Ranking(model, WIDE, L"editor.exe")[1], 23);
+    CHECK_EQ(Ranking(model, WIDE, L"browser.exe")[0], 11);
+    CHECK_EQ(Ranking(model, WIDE, L"mail.exe")[0], 11);
+    CHECK_EQ(Ranking(model, WIDE, L"")[0], 11);
+
+    for (int k = 0; k < CLICK_APP_MIN_CLICKS; k++) RecordClick(model, WIDE, L"browser.exe", 23, 4);
+    CHECK_EQ(Ranking(model, WIDE, L"browser.exe")[0], 23);
+    CHECK_EQ(Ranking(model, WIDE, L"browser.exe")[1], 11);
+    CHECK_EQ(Ranking(model, WIDE, L"editor.exe")[0], 11);
+    // Every app's history saw every click
+    CHECK(std::fabs(Clicks(model, WIDE, L"", 23) - (CLICK_APP_MIN_CLICKS + 5)) < 0.5);
+    CHECK(Clicks(model, WIDE, L"editor.exe", 23) == 0.0);
+}
+
+// Codes land on a sub-cell that took most of a cell's clicks, else the centre
+static void TestSubPrediction() {
+    ClickModel model;
+    CHECK_EQ(PredictSubCell(model, WIDE, L"", 3), CLICK_SUB_CENTER);
+    for (int k = 0; k < CLICK_SUB_MIN_CLICKS - 1; k++) RecordClick(model, WIDE, L"", 3, 2);
+    CHECK_EQ(PredictSubCell(model, WIDE, L"", 3), CLICK_SUB_CENTER);
+    RecordClick(model, WIDE, L"", 3, 2);
+    CHECK_EQ(PredictSubCell(model, WIDE, L"", 3), 2);
+    for (int k = 0; k < 3; k++) RecordClick(model, WIDE, L"", 3, 6);
+    CHECK_EQ(PredictSubCell(model, WIDE, L"", 3), CLICK_SUB_CENTER);  // 4 of 7 is not enough
+    CHECK_EQ(PredictSubCell(model, WIDE, L"", 4), CLICK_SUB_CENTER);
+
+    // Per app, once the app ranks by its own history
+    for (int k = 0; k < CLICK_APP_MIN_CLICKS; k++) RecordClick(model, WIDE, L"paint.exe", 3, 8);
+    CHECK_EQ(PredictSubCell(model, WIDE, L"paint.exe", 3), 8);
+    CHECK_EQ(PredictSubCell(model, WIDE, L"", 3), 8);
+}
+
+// At most CLICK_HISTORY_ENTRIES histories, the least recently clicked
+// dropped, and at most CLICK_CELLS_PER_HISTORY cells each, the coldest dropped
+static void TestBounds() {
+    ClickModel model;
+    for (int a = 0; a < CLICK_HISTORY_ENTRIES + 8; a++) {
+        std::wstring app = L"app" + std::to_wstring(a) + L".exe";
+        RecordClick(model, a % 2 ? SIDE : WIDE, app.c_str(), a % 20, 4);
+    }
+    CHECK_EQ(model.histories.size(), (size_t)CLICK_HISTORY_ENTRIES);
+    CHECK(FindClickHistory(model, WIDE, L"") != NULL);
+    CHECK(FindClickHistory(model, SIDE, L"") != NULL);
+    CHECK(FindClickHistory(model, WIDE, L"app0.exe") == NULL);
+    CHECK(FindClickHistory(model, SIDE, L"app39.exe") != NULL);
+
+    TraceMonitor big = { L"\\\\.\\DISPLAY3", 40, 30 };
+    ClickModel cells;
+    for (int k = 0; k < 3; k++) RecordClick(cells, big, L"", 1000, 4);
+    for (int c = 0; c < CLICK_CELLS_PER_HISTORY + 100; c++) RecordClick(cells, big, L"", c, 4);
+    const ClickHistory* h = FindClickHistory(cells, big, L"");
+    CHECK_EQ(h->cells.size(), (size_t)CLICK_CELLS_PER_HISTORY);
+    CHECK(Clicks(cells, big, L"", 1000) > 1.0);  // Three clicks outlast the older single ones
+    CHECK(Clicks(cells, big, L"", 0) == 0.0);
+    CHECK(Clicks(cells, big, L"", CLICK_CELLS_PER_HISTORY + 99) > 0.0);
+    double total = 0.0;
+    for (const ClickCell& c : h->cells) total += ClickCellCount(c);
+    CHECK(std::fabs(total - h->total) / total < 1e-3);
+
+    // Long names are cut, not overrun
+    std::wstring longName(200, L'x');
+    RecordClick(cells, big, longName.c_str(), 0, 4);
+    CHECK(FindClickHistory(cells, big, longName.substr(0, CLICK_NAME_LEN - 1).c_str()) != NULL);
+}
+
+static ClickModel SampleModel() {
+    ClickModel model;
+    std::mt19937 rng(7);
+    const wchar_t* apps[] = { L"", L"editor.exe", L"browser.exe", L"éditeur.exe" };
+    for (int k = 0; k < 3000; k++) {
+        const TraceMonitor& mon = k % 3 ? WIDE : SIDE;
+        RecordClick(model, mon, apps[rng() % 4], (int)(rng() % 7), (int)(rng() % 9));
+    }
+    return model;
+}
+
+// What the model does, for comparing a loaded one with the one saved
+static std::vector<int> Behaviour(const ClickModel& model) {
+    std::vector<int> out;
+    const wchar_t* apps[] = { L"", L"editor.exe", L"browser.exe", L"éditeur.exe" };
+    for (const TraceMonitor* mon : { &WIDE, &SIDE }) {
+        for (const wchar_t* app : apps) {
+            std::vector<int> r = Ranking(model, *mon, app);
+            out.insert(out.end(), r.begin(), r.end());
+            for (int c = 0; c < 7; c++) out.push_back(PredictSubCell(model, *mon, app, c));
+        }
+    }
+    return out;
+}
+
+static void TestRoundTrip() {
+    ClickModel model = SampleModel();
+    std::string file;
+    WriteClickModel(model, file);
+    ClickModel loaded;
+    CHECK(ReadClickModel(file, loaded));
+    CHECK_EQ(loaded.serial, model.serial);
+    CHECK_EQ(loaded.histories.size(), model.histories.size());
+    CHECK(Behaviour(loaded) == Behaviour(model));
+    std::string again;
+    WriteClickModel(loaded, again);
+    CHECK(again == file);
+
+    // Every truncation, trailing bytes and bad headers leave the model as it was
+    int accepted = 0;
+    for (size_t n = 0; n < file.size(); n++) {
+        ClickModel keep = model;
+        accepted += ReadClickModel(file.substr(0, n), keep);
+        if (n % 97 == 0) CHECK(Behaviour(keep) == Behaviour(model));
+    }
+    CHECK_EQ(accepted, 0);
+    CHECK(!ReadClickModel(file + '\0', loaded));
+    std::string bad = file;
+    bad[4] = 3;
+    CHECK(!ReadClickModel(bad, loaded));
+    bad = file;
+    bad[0] = 'X';
+    CHECK(!ReadClickModel(bad, loaded));
+    CHECK(Behaviour(loaded) == Behaviour(model));
+}
+
+// Version 1 files load as every app's histories, clicks on the centres
+static void TestVersion1() {
+    std::string v1;
+    uint32_t header[3] = { 1, 1, 9 };
+    AppendBytes(v1, CLICK_HISTORY_MAGIC, 4);
+    AppendBytes(v1, header, sizeof(header));
+    uint16_t device[32] = {};
+    for (int k = 0; WIDE.device[k]; k++) device[k] = (uint16_t)WIDE.device[k];
+    uint16_t cols = 10, rows = 6;
+    uint32_t lastUse = 9, entries = 2;
+    AppendBytes(v1, device, sizeof(device));
+    AppendBytes(v1, &cols, 2);
+    AppendBytes(v1, &rows, 2);
+    AppendBytes(v1, &lastUse, 4);
+    AppendBytes(v1, &entries, 4);
+    uint16_t cells[2] = { 17, 33 };
+    float counts[2] = { 2.5f, 6.0f };
+    for (int e = 0; e < 2; e++) {
+        AppendBytes(v1, &cells[e], 2);
+        AppendBytes(v1, &counts[e], 4);
+    }
+
+    ClickModel model;
+    CHECK(ReadClickModel(v1, model));
+    CHECK_EQ(model.serial, 9u);
+    std::vector<int> ranked = Ranking(model, WIDE, L"editor.exe");
+    CHECK_EQ(ranked[0], 33);
+    CHECK_EQ(ranked[1], 17);
+    CHECK(std::fabs(Clicks(model, WIDE, L"", 33) - 6.0) < 1e-4);
+    CHECK_EQ(PredictSubCell(model, WIDE, L"", 33), CLICK_SUB_CENTER);
+
+    // Saved again, it is a version 2 file
+    std::string v2;
+    WriteClickModel(model, v2);
+    uint32_t version = 0;
+    memcpy(&version, v2.data() + 4, 4);
+    CHECK_EQ(version, (uint32_t)CLICK_HISTORY_VERSION);
+    ClickModel reloaded;
+    CHECK(ReadClickModel(v2, reloaded));
+    CHECK(Behaviour(reloaded) == Behaviour(model));
+}
+
+// The replayed session: each thing the history does saves keystrokes, and
+// together they save at least a sixth of them
+static void TestReplay() {
+    TraceMonitor mon = { L"\\\\.\\DISPLAY1", 0, 0 };
+    GridSize size = PlanGridSize(1920, 1080, 96);
+    mon.gridCols = size.cols;
+    mon.gridRows = size.rows;
+    ClickTraceSpec spec = { 6000, 8, 24, 6, 0.15f, 0.3f, 8, 11 };
+    std::vector<TraceClick> trace = SyntheticClickTrace(spec, mon);
+    std::vector<std::wstring> apps;
+    for (int a = 0; a < spec.apps; a++) apps.push_back(L"app" + std::to_wstring(a) + L".exe");
+    double keys[CLICK_POLICY_COUNT];
+    for (int p = 0; p < CLICK_POLICY_COUNT; p++) {
+        ClickModel model;
+        ClickReplay r = ReplayClickTrace(trace, mon, apps, (ClickPolicy)p, model);
+        CHECK_EQ(r.clicks, (long long)trace.size());
+        keys[p] = r.KeysPerClick();
+    }
+    CHECK(keys[CLICKS_PER_LAYOUT] < keys[CLICKS_IGNORED]);
+    CHECK(keys[CLICKS_PER_APP] < keys[CLICKS_PER_LAYOUT]);
+    CHECK(keys[CLICKS_PREDICT_SUB] < keys[CLICKS_PER_APP]);
+    CHECK(keys[CLICKS_PREDICT_SUB] < keys[CLICKS_IGNORED] * 5 / 6);
+}
+
+int main() {
+    TestDecay();
+    TestRanking();
+    TestPerApp();
+    TestSubPrediction();
+    TestBounds();
+    TestRoundTrip();
+    TestVersion1();
+    TestReplay();
+    return CheckResult("click_history_test");
+}
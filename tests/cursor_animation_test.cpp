@@ -0,0 +1,136 @@
+// Tests for core/CursorAnimation.h: restore-animation frame sizes at several
+// DPIs and cursor sizes, hotspot scaling, and the area-weighted cursor image scaling
+#include "core/CursorAnimation.h"
+#include "tests/Check.h"
+
+#include <vector>
+
+static void TestFrameSizes() {
+    const int dpis[] = { 96, 120, 144, 192 };
+    for (int dpi : dpis) {
+        CHECK_EQ(CursorAnimationSize(0, dpi), CURSOR_ANIM_START_SIZE * dpi / 96);
+        CHECK_EQ(CursorAnimationSize(CURSOR_ANIM_STEPS, dpi), CURSOR_ANIM_END_SIZE * dpi / 96);
+        for (int step = 1; step <= CURSOR_ANIM_STEPS; step++) {
+            CHECK(CursorAnimationSize(step, dpi) <= CursorAnimationSize(step - 1, dpi));
+        }
+        // Ease-out: the first step shrinks more than the last
+        int first = CursorAnimationSize(0, dpi) - CursorAnimationSize(1, dpi);
+        int last = CursorAnimationSize(CURSOR_ANIM_STEPS - 1, dpi) - CursorAnimationSize(CURSOR_ANIM_STEPS, dpi);
+        CHECK(first > 4 * last);
+    }
+    // The 96 DPI schedule
+    const int expect[CURSOR_ANIM_STEPS + 1] = { 128, 116, 105, 94, 84, 75, 67, 60, 53, 48, 43, 39, 36, 34, 33, 32 };
+    for (int step = 0; step <= CURSOR_ANIM_STEPS; step++) CHECK_EQ(CursorAnimationSize(step, 96), expect[step]);
+}
+
+// A larger cursor size setting scales the whole schedule, and the default
+// setting gives the default schedule
+static void TestBaseSizes() {
+    for (int step = 0; step <= CURSOR_ANIM_STEPS; step++) {
+        CHECK_EQ(CursorAnimationSize(step, 120, CURSOR_ANIM_END_SIZE), CursorAnimationSize(step, 120));
+    }
+    CHECK_EQ(CursorAnimationSize(0, 96, 64), 256);
+    CHECK_EQ(CursorAnimationSize(CURSOR_ANIM_STEPS, 96, 64), 64);
+    CHECK_EQ(CursorAnimationSize(CURSOR_ANIM_STEPS, 144, 48), 72);
+    const int bases[] = { 32, 48, 64, 96, 128, CURSOR_BASE_SIZE_MAX };
+    for (int base : bases) {
+        for (int step = 0; step <= CURSOR_ANIM_STEPS; step++) {
+            CHECK(CursorAnimationSize(step, 96, base) >= base);
+            if (step > 0) CHECK(CursorAnimationSize(step, 96, base) <= CursorAnimationSize(step - 1, 96, base));
+            if (base > 32) CHECK(CursorAnimationSize(step, 96, base) >= CursorAnimationSize(step, 96, 32));
+        }
+    }
+}
+
+static void TestHotspots() {
+    CHECK_EQ(ScaleCursorHotspot(0, 32, 128), 0);        // Arrow tip stays at the corner
+    CHECK_EQ(ScaleCursorHotspot(16, 32, 128), 64);      // Centered hotspot (cross, size-all) stays centered
+    CHECK_EQ(ScaleCursorHotspot(16, 32, 47), 23);
+    CHECK_EQ(ScaleCursorHotspot(31, 32, 128), 124);
+    CHECK_EQ(ScaleCursorHotspot(9, 48, 32), 6);         // Shrinking a large-scheme cursor
+    CHECK_EQ(ScaleCursorHotspot(47, 48, 32), 31);
+    CHECK_EQ(ScaleCursorHotspot(5, 0, 32), 0);
+    for (int size = 1; size <= 256; size++) {
+        for (int hot = 0; hot < 32; hot++) {
+            int h = ScaleCursorHotspot(hot, 32, size);
+            CHECK(h >= 0 && h < size);
+        }
+    }
+}
+
+static void TestScaling() {
+    // Opaque solid color survives any scale
+    std::vector<uint32_t> solid(32 * 32, 0xFF336699u), out(128 * 128);
+    ScaleCursorImage(solid.data(), 32, 32, out.data(), 128, 128);
+    for (uint32_t p : out) CHECK_EQ(p, 0xFF336699u);
+    ScaleCursorImage(solid.data(), 32, 32, out.data(), 47, 47);
+    for (int i = 0; i < 47 * 47; i++) CHECK_EQ(out[i], 0xFF336699u);
+
+    // 2x2 -> 1x1 averages, in premultiplied alpha: the transparent pixels
+    // lower the alpha but don't darken the color
+    uint32_t quad[4] = { 0xFFFF0000u, 0x00000000u, 0xFF0000FFu, 0x00000000u };
+    uint32_t one;
+    ScaleCursorImage(quad, 2, 2, &one, 1, 1);
+    CHECK_EQ(one, 0x80800080u);
+    uint32_t halfRed[2] = { 0x80FF0000u, 0xFF0000FFu };
+    ScaleCursorImage(halfRed, 2, 1, &one, 1, 1);
+    CHECK_EQ(one >> 24, 0xC0);
+    CHECK_EQ((one >> 16) & 0xFF, 0x55);  // Red weighted 128 against blue's 255
+    CHECK_EQ(one & 0xFF, 0xAA);
+
+    // 3 -> 2 pixels: the middle source pixel is split between both
+    uint32_t row[3] = { 0xFF000000u, 0xFF0000FFu, 0xFF000000u }, two[2];
+    ScaleCursorImage(row, 3, 1, two, 2, 1);
+    CHECK_EQ(two[0], 0xFF000055u);
+    CHECK_EQ(two[1], 0xFF000055u);
+
+    // Total coverage is kept: a shrunk arrow-like shape has the same alpha mass
+    std::vector<uint32_t> arrow(32 * 32, 0);
+    long long mass = 0;
+    for (int y = 0; y < 32; y++) {
+        for (int x = 0; x <= y / 2; x++) { arrow[y * 32 + x] = 0xFFFFFFFFu; mass += 255; }
+    }
+    std::vector<uint32_t> big(128 * 128);
+    ScaleCursorImage(arrow.data(), 32, 32, big.data(), 128, 128);
+    long long bigMass = 0;
+    for (uint32_t p : big) bigMass += p >> 24;
+    CHECK_EQ(bigMass, mass * 16);
+}
+
+static void TestMasks() {
+    // Colors without alpha take it from the AND mask
+    uint32_t color[4] = { 0x00112233u, 0x00445566u, 0x00000000u, 0x00FFFFFFu };
+    uint32_t mask[4] = { 0x000000u, 0xFFFFFFu, 0x000000u, 0xFFFFFFu };
+    ApplyCursorMaskAlpha(color, mask, 4);
+    CHECK_EQ(color[0], 0xFF112233u);
+    CHECK_EQ(color[1], 0u);
+    CHECK_EQ(color[2], 0xFF000000u);
+    CHECK_EQ(color[3], 0u);
+    // Colors with alpha keep it
+    uint32_t alpha[2] = { 0x80112233u, 0x00445566u };
+    ApplyCursorMaskAlpha(alpha, mask, 2);
+    CHECK_EQ(alpha[0], 0x80112233u);
+    CHECK_EQ(alpha[1], 0x00445566u);
+
+    // AND mask rows are WORD aligned, bit set where transparent
+    CHECK_EQ(CursorMaskRowBytes(1), 2);
+    CHECK_EQ(CursorMaskRowBytes(16), 2);
+    CHECK_EQ(CursorMaskRowBytes(17), 4);
+    std::vector<uint32_t> img(17 * 2, 0xFF000000u);
+    img[0] = 0;
+    img[16] = 0;
+    img[17 + 9] = 0;
+    std::vector<uint8_t> bits = BuildCursorMask(img.data(), 17, 2);
+    CHECK_EQ(bits.size(), 8);
+    const uint8_t expect[8] = { 0x80, 0x00, 0x80, 0x00, 0x00, 0x40, 0x00, 0x00 };
+    for (int i = 0; i < 8; i++) CHECK_EQ(bits[i], expect[i]);
+}
+
+int main() {
+    TestFrameSizes();
+    TestBaseSizes();
+    TestHotspots();
+    TestScaling();
+    TestMasks();
+    return CheckResult("cursor_animation_test");
+}
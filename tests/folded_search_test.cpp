@@ -0,0 +1,68 @@
+// Differential fuzz test for core/FoldedSearch.h: every kernel the CPU can
+// run must return the same first match as std::u16string::find
+#include "core/FoldedSearch.h"
+#include "tests/Check.h"
+
+#include <random>
+#include <string>
+
+static void CheckKernels(const std::u16string& hay, const std::u16string& needle) {
+    size_t found = hay.find(needle);
+    int expect = found == std::u16string::npos ? -1 : (int)found;
+    int hayLen = (int)hay.size(), needleLen = (int)needle.size();
+    SimdLevel cpu = DetectSimdLevel();
+    for (int level = SIMD_SCALAR; level <= cpu; level++) {
+        FindFoldedFn<char16_t> kernel = SelectFindFolded<char16_t>((SimdLevel)level);
+        CHECK_EQ(kernel(hay.data(), hayLen, needle.data(), needleLen), expect);
+    }
+    CHECK_EQ(FindFolded(hay.data(), hayLen, needle.data(), needleLen), expect);
+}
+
+static std::u16string RandomText(std::mt19937& rng, const std::u16string& alphabet, int len) {
+    std::uniform_int_distribution<int> pick(0, (int)alphabet.size() - 1);
+    std::u16string s(len, u' ');
+    for (char16_t& c : s) c = alphabet[pick(rng)];
+    return s;
+}
+
+static void TestFixed() {
+    CheckKernels(u"", u"a");
+    CheckKernels(u"a", u"a");
+    CheckKernels(u"ab", u"abc");
+    CheckKernels(u"visual studio code", u"code");
+    CheckKernels(u"visual studio code", u"visual studio code");
+    CheckKernels(u"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab", u"aab");  // Match after the vector loop
+    CheckKernels(u"abcabcabcabcabcabcabcabcabcabcabcabcabcabcabcx", u"abcx");
+    // First and last characters agree at many positions, the middle doesn't
+    CheckKernels(u"axbaxbaxbaxbaxbaxbaxbaxbaxbaxbaxbaxbayb", u"ayb");
+    // Lanes whose low or high byte alone equals the needle's
+    CheckKernels(u"š愀a慡", u"慡");
+    CheckKernels(u"Ā\u0001Ā\u0001ā", u"ā");
+}
+
+// Small alphabets make partial matches common; lengths straddle the 8- and
+// 16-lane steps and the scalar tail
+static void TestRandom() {
+    std::mt19937 rng(2024);
+    const std::u16string alphabets[] = { u"ab", u"abc ", u"abcdefghijklmnopqrstuvwxyz -", u"aé中￿" };
+    for (const std::u16string& alphabet : alphabets) {
+        for (int iter = 0; iter < 20000; iter++) {
+            int hayLen = (int)(rng() % 80);
+            int needleLen = 1 + (int)(rng() % 10);
+            std::u16string hay = RandomText(rng, alphabet, hayLen);
+            std::u16string needle;
+            if (hayLen >= needleLen && rng() % 2) {
+                needle = hay.substr(rng() % (hayLen - needleLen + 1), needleLen);  // Planted
+            } else {
+                needle = RandomText(rng, alphabet, needleLen);
+            }
+            CheckKernels(hay, needle);
+        }
+    }
+}
+
+int main() {
+    TestFixed();
+    TestRandom();
+    return CheckResult("folded_search_test");
+}
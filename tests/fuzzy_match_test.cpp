@@ -0,0 +1,131 @@
+// Tests for core/FuzzyMatch.h: matches are exactly the subsequence matches,
+// reported positions and scores agree, scores never beat the best possible
+// alignment, and the ranking puts the intended window first
+#include "core/FuzzyMatch.h"
+#include "tests/Check.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+static bool IsSubsequence(const std::u16string& title, const std::u16string& q) {
+    size_t j = 0;
+    for (size_t i = 0; i < title.size() && j < q.size(); i++) j += title[i] == q[j];
+    return j == q.size();
+}
+
+// Highest ScoreAlignment over every alignment, by dynamic programming over
+// (query character, title position); -1e9 if none
+static int BestScore(const std::u16string& title, const std::u16string& q) {
+    int len = (int)title.size(), n = (int)q.size();
+    const int NONE = -1000000000;
+    std::vector<int> best(len, NONE), next(len, NONE);
+    for (int p = 0; p < len; p++) {
+        if (title[p] != q[0]) continue;
+        best[p] = SEARCH_SCORE_MATCH + ((p == 0 || !IsTitleWordChar(title[p - 1])) ? SEARCH_BONUS_WORD : 0);
+    }
+    for (int k = 1; k < n; k++) {
+        for (int p = 0; p < len; p++) {
+            next[p] = NONE;
+            if (title[p] != q[k]) continue;
+            int base = SEARCH_SCORE_MATCH + ((p == 0 || !IsTitleWordChar(title[p - 1])) ? SEARCH_BONUS_WORD : 0);
+            for (int prev = 0; prev < p; prev++) {
+                if (best[prev] == NONE) continue;
+                int gap = p - prev - 1;
+                int link = gap == 0 ? SEARCH_BONUS_ADJACENT
+                                    : -(SEARCH_PENALTY_GAP + SEARCH_PENALTY_GAP_EXT * (gap - 1));
+                next[p] = std::max(next[p], best[prev] + base + link);
+            }
+        }
+        best.swap(next);
+    }
+    int top = NONE;
+    for (int v : best) top = std::max(top, v);
+    return top;
+}
+
+static void CheckMatch(const std::u16string& title, const std::u16string& q) {
+    int n = (int)q.size();
+    std::vector<int> pos(n);
+    int score = 0;
+    bool matched = FuzzyMatchTitle(title.data(), (int)title.size(), q.data(), n, pos.data(), &score);
+    CHECK_EQ(matched, IsSubsequence(title, q));
+    if (!matched) return;
+    for (int k = 0; k < n; k++) {
+        CHECK(pos[k] >= 0 && pos[k] < (int)title.size());
+        CHECK(title[pos[k]] == q[k]);
+        if (k) CHECK(pos[k] > pos[k - 1]);
+    }
+    CHECK_EQ(score, ScoreAlignment(title.data(), pos.data(), n));
+    CHECK(score <= BestScore(title, q));
+    // A contiguous occurrence is always found when one exists
+    size_t at = title.find(q);
+    if (at != std::u16string::npos) CHECK(score >= ScoreContiguous(title.data(), (int)at, n));
+}
+
+static int Score(const std::u16string& title, const std::u16string& q) {
+    std::vector<int> pos(q.size());
+    int score = 0;
+    if (!FuzzyMatchTitle(title.data(), (int)title.size(), q.data(), (int)q.size(), pos.data(), &score)) return -1000;
+    return score;
+}
+
+static void TestScoring() {
+    // Word starts beat the middle of words, runs beat scattered letters
+    CHECK(Score(u"visual studio code", u"vsc") > Score(u"services cache", u"vsc"));
+    CHECK(Score(u"main.cpp - editor", u"main") > Score(u"domain - editor", u"main"));
+    CHECK(Score(u"report draft", u"rep") > Score(u"prepare", u"rep"));
+    CHECK(Score(u"notepad", u"note") > Score(u"no time for tea", u"note"));
+    // The left alignment in the shortest window is not always the best
+    CheckMatch(u"a-b ab", u"ab");
+    CheckMatch(u"xaxb ab", u"ab");
+    CheckMatch(u"", u"a");
+}
+
+// Titles that share prefixes: the abbreviation of one tab's words must rank
+// it first
+static void TestRanking() {
+    std::vector<std::u16string> titles;
+    for (int i = 0; i < 40; i++) {
+        titles.push_back(u"pull request " + std::u16string(1, (char16_t)(u'a' + i % 26)) + u" - google chrome");
+    }
+    titles.push_back(u"quarterly budget review - microsoft word");
+    titles.push_back(u"quarterly business report - google chrome");
+    FoldedTitleIndex<char16_t> ix = {};
+    for (const std::u16string& t : titles) AppendFoldedTitle(ix, t.data(), (int)t.size(), [](char16_t c) { return c; });
+    ix.normalCount = (int)titles.size();
+    std::vector<SearchLevel> levels;
+    std::u16string levelsQuery;
+    UpdateSearchLevels(levels, levelsQuery, std::u16string(u"qbr"), ix, FuzzyMatchTitle<char16_t>);
+    std::vector<SearchHit> ranked = levels.back().hits;
+    RankSearchHits(ranked, [](int a, int b) { return a > b; });  // Ties: later entry first
+    CHECK_EQ(ranked.size(), 4);     // Two "pull request b" tabs match too
+    CHECK_EQ(ranked[0].entry, 40);  // Word starts q, b, r with the shortest gaps
+    CHECK_EQ(ranked[1].entry, 41);
+    // Equal scores fall back to the tie-breaker
+    UpdateSearchLevels(levels, levelsQuery, std::u16string(u"pull request"), ix, FuzzyMatchTitle<char16_t>);
+    ranked = levels.back().hits;
+    RankSearchHits(ranked, [](int a, int b) { return a > b; });
+    CHECK_EQ(ranked.size(), 40);
+    CHECK_EQ(ranked[0].entry, 39);
+    CHECK_EQ(ranked[39].entry, 0);
+}
+
+static void TestRandom() {
+    std::mt19937 rng(11);
+    const std::u16string alphabet = u"abc -";
+    for (int iter = 0; iter < 20000; iter++) {
+        std::u16string title, q;
+        int len = (int)(rng() % 24), n = 1 + (int)(rng() % 4);
+        for (int k = 0; k < len; k++) title += alphabet[rng() % alphabet.size()];
+        for (int k = 0; k < n; k++) q += alphabet[rng() % 3];
+        CheckMatch(title, q);
+    }
+}
+
+int main() {
+    TestScoring();
+    TestRanking();
+    TestRandom();
+    return CheckResult("fuzzy_match_test");
+}
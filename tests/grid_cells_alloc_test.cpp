@@ -0,0 +1,130 @@
+// Tests for core/GridCells.h: arena layout, and no heap allocation on the
+// per-keystroke path (label lookup plus a state for every cell). Global
+// operator new is replaced to count allocations.
+#include "core/GridCells.h"
+#include "core/GridLayout.h"
+#include "core/LabelCodes.h"
+#include "tests/Check.h"
+#include "tests/TestGrid.h"
+
+#include <cstdlib>
+#include <new>
+#include <string>
+
+static long g_allocations = 0;
+
+void* operator new(size_t size) {
+    g_allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// Three 4K monitors at 100%: 1100 cells each, codes of 2 and 3 letters
+static void BuildCells(TestCells& cells, std::vector<TestMonitor>& monitors) {
+    for (int m = 0; m < 3; m++) monitors.push_back({ { m * 3840, 0, (m + 1) * 3840, 2160 }, 96 });
+    BuildTestGrid(monitors, cells);
+    for (const TestMonitor& mon : monitors) {
+        for (int rank = 0; rank < mon.cellCount; rank++) {
+            int cell = (rank * 7) % mon.cellCount;  // Any permutation will do
+            cells.byCode[mon.firstCell + rank] = cell;
+            cells.label[mon.firstCell + cell] = MakeLabel(mon.prefix, mon.codes, rank);
+        }
+    }
+}
+
+static void TestArenaLayout() {
+    TestCells cells = {};
+    AllocateGridCells(cells, 37);
+    CHECK_EQ(cells.count, 37);
+    const uint8_t* begin = cells.arena.data();
+    const uint8_t* end = begin + cells.arena.size();
+    CHECK((const uint8_t*)cells.rect == begin);
+    CHECK((const uint8_t*)(cells.rect + 37) == (const uint8_t*)cells.center);
+    CHECK((const uint8_t*)(cells.center + 37) == (const uint8_t*)cells.subPoints);
+    CHECK((const uint8_t*)(cells.subPoints + 37) == (const uint8_t*)cells.label);
+    CHECK((const uint8_t*)(cells.label + 37) == (const uint8_t*)cells.byCode);
+    CHECK((const uint8_t*)(cells.byCode + 37) == (const uint8_t*)cells.gridRow);
+    CHECK((const uint8_t*)(cells.gridRow + 37) == (const uint8_t*)cells.gridCol);
+    CHECK((const uint8_t*)(cells.gridCol + 37) == cells.state);
+    CHECK(cells.state + 37 == end);
+
+    TestCells copy = {};
+    AllocateGridCells(copy, 40);
+    for (int i = 0; i < 37; i++) {
+        cells.rect[i] = { i, i + 1, i + 2, i + 3 };
+        cells.label[i] = (LabelCode)i;
+        cells.subPoints[i][8] = { i, -i };
+    }
+    CopyGridCells(copy, cells, 5, 10, 20);
+    CHECK_EQ(copy.rect[10].left, 5);
+    CHECK_EQ(copy.label[29], 24);
+    CHECK_EQ(copy.subPoints[29][8].y, -24);
+    CHECK_EQ(copy.label[30], 0);
+}
+
+static void TestTypingDoesNotAllocate() {
+    TestCells cells = {};
+    std::vector<TestMonitor> monitors;
+    BuildCells(cells, monitors);
+    std::wstring typed;
+    typed.reserve(MAX_LABEL_LETTERS + 1);  // As ShowGrid does
+
+    // Type the full label and sub-cell letter of every 97th cell
+    long typedLetters = 0;
+    long before = g_allocations;
+    for (int target = 0; target < cells.count; target += 97) {
+        wchar_t text[MAX_LABEL_LETTERS + 2];
+        int n = FormatLabel(cells.label[target], text);
+        text[n++] = L'c';
+        typed.clear();
+        for (int k = 0; k < n; k++) {
+            typed += text[k];
+            typedLetters++;
+            int typedLen = (int)typed.length();
+            int found = -1;
+            for (const TestMonitor& mi : monitors) {
+                if (mi.prefix != typed[0] || typedLen < 2) continue;
+                int rank = DecodeLabelLetters(mi.codes, mi.cellCount, typed.c_str() + 1, typedLen - 1);
+                if (rank >= 0) found = mi.firstCell + cells.byCode[mi.firstCell + rank];
+            }
+            if (k == n - 2) CHECK_EQ(found, target);
+            LabelCode typedCode = PackTypedPrefix(typed, typedLen < MAX_LABEL_LETTERS ? typedLen : MAX_LABEL_LETTERS);
+            for (int i = 0; i < cells.count; i++) {
+                int labelLen = LabelLength(cells.label[i]);
+                wchar_t subChar = typedLen == labelLen + 1 ? typed[labelLen] : 0;
+                cells.state[i] = TypedCellState(cells.label[i], typedCode, typedLen, subChar);
+            }
+            if (k == n - 1) CHECK_EQ(cells.state[target], CELL_MATCH_SUB_A + 2);
+        }
+    }
+    long allocations = g_allocations - before;
+    std::printf("%ld allocations over %ld typed letters\n", allocations, typedLetters);
+    CHECK_EQ(allocations, 0);
+}
+
+static void TestCellStates() {
+    LabelPlan plan = PlanLabelCodes(100);
+    LabelCode label = MakeLabel(L'b', plan, 30);  // "b" + 2-letter code
+    wchar_t text[MAX_LABEL_LETTERS + 1];
+    FormatLabel(label, text);
+    std::wstring typed(text);
+    CHECK_EQ(TypedCellState(label, 0, 0, 0), CELL_BASE);
+    CHECK_EQ(TypedCellState(label, PackTypedPrefix(typed, 1), 1, 0), CELL_BASE);  // Prefix alone
+    CHECK_EQ(TypedCellState(label, PackTypedPrefix(typed, 2), 2, 0), CELL_PARTIAL);
+    CHECK_EQ(TypedCellState(label, PackTypedPrefix(L"c", 1), 1, 0), CELL_DIM);
+    CHECK_EQ(TypedCellState(label, PackTypedPrefix(typed, 3), 3, 0), CELL_MATCH);
+    std::wstring sub = typed + L"h";
+    CHECK_EQ(TypedCellState(label, PackTypedPrefix(sub, 4), 4, L'h'), CELL_MATCH_SUB_A + 7);
+    sub = typed + L"x";
+    CHECK_EQ(TypedCellState(label, PackTypedPrefix(sub, 4), 4, L'x'), CELL_MATCH);
+    CHECK_EQ(TypedCellState(label, PackTypedPrefix(sub, 4), 5, 0), CELL_DIM);
+}
+
+int main() {
+    TestArenaLayout();
+    TestCellStates();
+    TestTypingDoesNotAllocate();
+    return CheckResult("grid_cells_alloc_test");
+}
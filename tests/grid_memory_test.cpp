@@ -0,0 +1,74 @@
+// Tests for MeasureGridMemory in core/GridRaster.h: on staggered layouts
+// (portrait beside ultrawide, a laptop offset below, monitors stacked out of
+// line) per-monitor tiles hold less than one bitmap over the bounding box,
+// and the accounting agrees with what the backend actually allocated and
+// with the frame the tiles are composited into
+#include "core/GridRaster.h"
+#include "tests/Check.h"
+#include "tests/TestGrid.h"
+#include "tests/TestRaster.h"
+
+struct MemoryLayout {
+    const char* name;
+    std::vector<TestMonitor> monitors;
+    unsigned long long tileBytes, boundingBoxBytes;
+};
+
+static void TestStaggeredLayouts() {
+    std::vector<MemoryLayout> layouts = {
+        { "portrait + ultrawide", { { { -1440, -560, 0, 2000 }, 96 }, { { 0, 0, 3440, 1440 }, 96 } },
+          34560000ull, 49971200ull },
+        { "ultrawide + laptop below", { { { 0, 0, 3440, 1440 }, 96 }, { { 800, 1440, 2720, 2520 }, 144 } },
+          28108800ull, 34675200ull },
+        { "portrait + ultrawide + portrait", { { { -1440, -560, 0, 2000 }, 96 }, { { 0, 0, 3440, 1440 }, 96 },
+                                               { { 3440, -560, 4880, 2000 }, 96 } },
+          49305600ull, 64716800ull },
+        { "1080p + 1440p above, offset", { { { 0, 0, 1920, 1080 }, 96 }, { { 960, -1440, 3520, 0 }, 96 } },
+          23040000ull, 35481600ull },
+        { "2 x 1080p in a row", { { { 0, 0, 1920, 1080 }, 96 }, { { 1920, 0, 3840, 1080 }, 96 } },
+          16588800ull, 16588800ull },
+    };
+    const Palette& p = PALETTE_PRESETS[0].palette;
+    std::printf("%-32s %10s %10s %10s %8s\n", "layout", "tiles MB", "tones MB", "bbox MB", "saved");
+    for (MemoryLayout& layout : layouts) {
+        TestCells cells = {};
+        BuildTestGrid(layout.monitors, cells);
+        TestRasterBackend backend;
+        std::vector<TestTile> tiles;
+        TestFrame frame = RenderTestFrame(backend, layout.monitors, cells, tiles, p);
+        GridMemoryUsage usage = MeasureGridMemory(layout.monitors, &TestMonitor::rc, &tiles);
+
+        CHECK_EQ(usage.tileBytes, layout.tileBytes);
+        CHECK_EQ(usage.boundingBoxBytes, layout.boundingBoxBytes);
+        CHECK_EQ(usage.tileBytes, backend.liveBytes);
+        CHECK_EQ(usage.boundingBoxBytes, frame.pixels.size() * sizeof(uint32_t));
+        unsigned long long toneBytes = 0;
+        for (const TestTile& tile : tiles) toneBytes += ToneMapBytes(tile.tones);
+        CHECK(toneBytes > 0);
+        CHECK_EQ(usage.toneMapBytes, toneBytes);
+        if (layout.tileBytes < layout.boundingBoxBytes) {
+            CHECK(usage.tileBytes + usage.toneMapBytes < usage.boundingBoxBytes);
+        }
+        std::printf("%-32s %10.1f %10.1f %10.1f %7.0f%%\n", layout.name, usage.tileBytes / 1048576.0,
+                    usage.toneMapBytes / 1048576.0, usage.boundingBoxBytes / 1048576.0,
+                    100.0 - 100.0 * usage.tileBytes / usage.boundingBoxBytes);
+
+        // Released tiles keep no tone maps
+        ReleaseGridTiles(backend, tiles);
+        CHECK_EQ(MeasureGridMemory(layout.monitors, &TestMonitor::rc, &tiles).toneMapBytes, 0);
+        CHECK_EQ(backend.liveBytes, 0);
+    }
+}
+
+static void TestNoMonitors() {
+    GridMemoryUsage usage = MeasureGridMemory(std::vector<TestMonitor>(), &TestMonitor::rc);
+    CHECK_EQ(usage.tileBytes, 0);
+    CHECK_EQ(usage.toneMapBytes, 0);
+    CHECK_EQ(usage.boundingBoxBytes, 0);
+}
+
+int main() {
+    TestStaggeredLayouts();
+    TestNoMonitors();
+    return CheckResult("grid_memory_test");
+}
@@ -0,0 +1,287 @@
+// Tests for core/GridRaster.h on a headless backend: multi-monitor frames
+// compared pixel for pixel with a direct reference painter and against
+// golden hashes, recoloring, tile remapping, clipping at tile edges, and
+// the fill and row-streaming kernels against plain loops
+#include "core/GridRaster.h"
+#include "tests/Check.h"
+#include "tests/TestGrid.h"
+#include "tests/TestRaster.h"
+
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+
+static std::vector<uint32_t> ReferenceTile(TestRasterBackend& backend, const TestMonitor& mon,
+                                           const TestCells& cells, const Palette& p) {
+    ReferencePainter r;
+    r.w = mon.rc.right - mon.rc.left;
+    r.h = mon.rc.bottom - mon.rc.top;
+    r.px.assign((size_t)r.w * r.h, SurfacePixel(p.background));
+    auto local = [&](int i) {
+        TestRect rc = cells.rect[i];
+        return TestRect{ rc.left - mon.rc.left, rc.top - mon.rc.top, rc.right - mon.rc.left, rc.bottom - mon.rc.top };
+    };
+    int last = mon.firstCell + mon.cellCount;
+    for (int i = mon.firstCell; i < last; i++) {
+        TestRect c = local(i);
+        bool even = (cells.gridRow[i] + cells.gridCol[i]) % 2 == 0;
+        r.Fill(c.left, c.top, c.right, c.bottom, SurfacePixel(even ? p.cellBgEven : p.cellBgOdd));
+    }
+    int pen = r.h / 800 > 1 ? r.h / 800 : 1;
+    int subPen = pen / 2 > 1 ? pen / 2 : 1;
+    for (int i = mon.firstCell; i < last; i++) {
+        TestRect c = local(i);
+        uint32_t line = SurfacePixel(p.gridLine), sub = SurfacePixel(p.subGridLine);
+        r.Line(c.left, c.top, c.right, c.top, pen, line);
+        r.Line(c.right, c.top, c.right, c.bottom, pen, line);
+        r.Line(c.right, c.bottom, c.left, c.bottom, pen, line);
+        r.Line(c.left, c.bottom, c.left, c.top, pen, line);
+        int x1 = c.left + (c.right - c.left) / 3, x2 = c.left + (c.right - c.left) * 2 / 3;
+        int y1 = c.top + (c.bottom - c.top) / 3, y2 = c.top + (c.bottom - c.top) * 2 / 3;
+        r.Line(x1, c.top, x1, c.bottom, subPen, sub);
+        r.Line(x2, c.top, x2, c.bottom, subPen, sub);
+        r.Line(c.left, y1, c.right, y1, subPen, sub);
+        r.Line(c.left, y2, c.right, y2, subPen, sub);
+    }
+    for (int i = mon.firstCell; i < last; i++) {
+        TestRect c = local(i);
+        const GridGlyphs& g = backend.Glyphs((c.bottom - c.top) / 3, (c.right - c.left) / 3 * 3);
+        wchar_t label[MAX_LABEL_LETTERS + 1];
+        int n = FormatLabel(cells.label[i], label);
+        r.Text(g.main, label, n, c, SurfacePixel(p.mainLabelText));
+        int sub = 0;
+        for (int k = 0; k < 9; k++) {
+            if (k == 4) continue;
+            r.Text(g.sub, &SUB_LABELS[sub++], 1, SubCellRect(c, k), SurfacePixel(p.subLabelText));
+        }
+    }
+    return r.px;
+}
+
+struct GoldenLayout {
+    const char* name;
+    std::vector<TestMonitor> monitors;
+    // Frame hash in PALETTE_PRESETS[0] and in GeneratePalette(123.4), recorded
+    // from frames that matched the reference painter. A rasterizer change
+    // that alters any pixel fails here even if it fools the reference too.
+    uint64_t golden[2];
+};
+
+static std::vector<GoldenLayout> Layouts() {
+    std::vector<GoldenLayout> layouts;
+    layouts.push_back({ "1080p", { { { 0, 0, 1920, 1080 }, 96 } },
+                        { 0x1f7e73434d80b599ULL, 0x3b84ce8753783bc2ULL } });
+    // Landscape, a portrait monitor up and to the left, and a 1440p one at 150%
+    layouts.push_back({ "three monitors", { { { 0, 0, 1920, 1080 }, 96 },
+                                            { { -1080, -400, 0, 1520 }, 96 },
+                                            { { 1920, 0, 4480, 1440 }, 144 } },
+                        { 0xaec8c6d5bb326400ULL, 0xb721c02667c3b052ULL } });
+    // Odd sizes, so cells and sub-cells take leftover pixels, and a 4K
+    // monitor whose 2-pixel pens exercise the wide-pen rules
+    layouts.push_back({ "odd sizes and 4K", { { { 0, 0, 333, 257 }, 120 },
+                                              { { 333, 0, 4173, 2160 }, 96 } },
+                        { 0xd35d8a70951a53b3ULL, 0x88f581cdd5e28f34ULL } });
+    return layouts;
+}
+
+static void TestFramesMatchReferenceAndGoldens() {
+    Palette palettes[2] = { PALETTE_PRESETS[0].palette, GeneratePalette(123.4f) };
+    for (GoldenLayout& layout : Layouts()) {
+        TestCells cells = {};
+        BuildTestGrid(layout.monitors, cells);
+        for (int p = 0; p < 2; p++) {
+            TestRasterBackend backend;
+            std::vector<TestTile> tiles;
+            TestFrame frame = RenderTestFrame(backend, layout.monitors, cells, tiles, palettes[p]);
+            for (size_t m = 0; m < layout.monitors.size(); m++) {
+                std::vector<uint32_t> ref = ReferenceTile(backend, layout.monitors[m], cells, palettes[p]);
+                int diffs = 0;
+                for (size_t k = 0; k < ref.size(); k++) diffs += tiles[m].bits[k] != ref[k];
+                CHECK_EQ(diffs, 0);
+            }
+            uint64_t hash = HashTestFrame(frame);
+            if (hash != layout.golden[p]) {
+                std::fprintf(stderr, "%s, palette %d: frame hash 0x%016llxULL, golden 0x%016llxULL\n",
+                             layout.name, p, (unsigned long long)hash, (unsigned long long)layout.golden[p]);
+                CHECK(hash == layout.golden[p]);
+            }
+            ReleaseGridTiles(backend, tiles);
+            CHECK_EQ(backend.liveTiles, 0);
+        }
+    }
+}
+
+// Recoloring a rendered tile gives what rendering in the new palette gives
+static void TestRecolor() {
+    std::vector<GoldenLayout> layouts = Layouts();
+    std::vector<TestMonitor>& monitors = layouts[1].monitors;
+    TestCells cells = {};
+    BuildTestGrid(monitors, cells);
+    Palette a = PALETTE_PRESETS[1].palette, b = GeneratePalette(77.0f);
+    TestRasterBackend backend;
+    std::vector<TestTile> recolored, fresh;
+    RenderTestFrame(backend, monitors, cells, recolored, a);
+    for (TestTile& t : recolored) CHECK(RecolorGridTile(backend, t, b));
+    TestFrame expect = RenderTestFrame(backend, monitors, cells, fresh, b);
+    TestFrame got = CompositeTestFrame(monitors, recolored, b);
+    CHECK(got.pixels == expect.pixels);
+    ReleaseGridTiles(backend, recolored);
+    ReleaseGridTiles(backend, fresh);
+    CHECK_EQ(backend.liveTiles, 0);
+}
+
+// A tile indexed by tone and remapped draws what the recorded model draws,
+// in any palette, across runs longer than a run can hold. A tile with too
+// many tones is drawn from the model, and released on recolor to be drawn
+// again.
+static void TestToneMap() {
+    TestMonitor mon = { { 0, 0, 2600, 700 }, 96 };
+    std::vector<TestMonitor> monitors = { mon };
+    TestCells cells = {};
+    BuildTestGrid(monitors, cells);
+    TestRasterBackend backend;
+    int w = mon.rc.right, h = mon.rc.bottom;
+    std::vector<uint32_t> indexed((size_t)w * h), direct((size_t)w * h);
+    PixelSurface si = { indexed.data(), w, h, w }, sd = { direct.data(), w, h, w };
+    BaseGridModel model;
+    BuildBaseGridModel(model, si, 0, 0, cells, monitors[0].firstCell, monitors[0].cellCount, backend);
+    GridToneMap map;
+    CHECK(IndexGridModel(map, si, model, GRID_CLASS_COUNT));
+    CHECK_EQ(map.rows.size(), (size_t)h);
+    size_t maxRun = 0;
+    for (uint32_t run : map.runs) maxRun = (std::max)(maxRun, (size_t)(run & (TONE_RUN_MAX_LENGTH - 1)) + 1);
+    CHECK_EQ(maxRun, (size_t)TONE_RUN_MAX_LENGTH);  // The background above the cells is split
+    CHECK(map.tones.size() < model.glyphs.size() / 4);
+    for (const Palette& p : { PALETTE_PRESETS[2].palette, GeneratePalette(311.0f) }) {
+        PaintBaseGridTones(si, map, p);
+        PaintBaseGrid(sd, model, p);
+        CHECK(indexed == direct);
+    }
+
+    GridToneMap none;
+    CHECK(!IndexGridModel(none, si, model, GRID_CLASS_COUNT, GRID_CLASS_COUNT + 1));
+    CHECK(none.rows.empty() && none.tones.empty());
+
+    std::vector<TestTile> tiles;
+    TestFrame before = RenderTestFrame(backend, monitors, cells, tiles, PALETTE_PRESETS[0].palette);
+    tiles[0].tones = GridToneMap();  // As a tile that failed to index
+    CHECK(!RecolorGridTile(backend, tiles[0], PALETTE_PRESETS[0].palette));
+    CHECK_EQ(backend.liveTiles, 0);
+    TestFrame after = RenderTestFrame(backend, monitors, cells, tiles, PALETTE_PRESETS[0].palette);
+    CHECK(after.pixels == before.pixels);
+    ReleaseGridTiles(backend, tiles);
+}
+
+// Kept tiles survive a remap untouched; the rest are released and redrawn
+static void TestRemap() {
+    std::vector<GoldenLayout> layouts = Layouts();
+    std::vector<TestMonitor> monitors = layouts[1].monitors;
+    TestCells cells = {};
+    BuildTestGrid(monitors, cells);
+    const Palette& p = PALETTE_PRESETS[0].palette;
+    TestRasterBackend backend;
+    std::vector<TestTile> tiles;
+    TestFrame before = RenderTestFrame(backend, monitors, cells, tiles, p);
+    CHECK_EQ(backend.liveTiles, 3);
+    void* kept = tiles[2].handle;
+
+    // Monitor 2 moves to the front, monitor 0 is unplugged, monitor 1 changed
+    std::vector<int> remap = { 2, -1 };
+    RemapGridTiles(backend, tiles, remap);
+    CHECK_EQ(backend.liveTiles, 1);
+    CHECK(tiles.size() == 2 && tiles[0].handle == kept && tiles[1].handle == NULL);
+
+    std::vector<TestMonitor> after = { monitors[2], monitors[1] };
+    TestCells afterCells = {};
+    BuildTestGrid(after, afterCells);
+    // The kept tile holds monitor 2's old labels; the redrawn one gets the new layout's
+    TestFrame frame = RenderTestFrame(backend, after, afterCells, tiles, p);
+    CHECK_EQ(backend.liveTiles, 2);
+    std::vector<uint32_t> ref = ReferenceTile(backend, after[1], afterCells, p);
+    CHECK(std::equal(ref.begin(), ref.end(), tiles[1].bits));
+    int w = before.bounds.right - before.bounds.left;
+    int diffs = 0;
+    const TestRect& rc = monitors[2].rc;
+    for (int y = 0; y < rc.bottom - rc.top; y++) {
+        for (int x = 0; x < rc.right - rc.left; x++) {
+            diffs += tiles[0].bits[(size_t)y * (rc.right - rc.left) + x] !=
+                     before.pixels[(size_t)(rc.top - before.bounds.top + y) * w + (rc.left - before.bounds.left + x)];
+        }
+    }
+    CHECK_EQ(diffs, 0);
+    ReleaseGridTiles(backend, tiles);
+    CHECK_EQ(backend.liveTiles, 0);
+}
+
+// Fills and lines past the surface are clipped; bands cover every row once
+static void TestClipping() {
+    std::vector<uint32_t> px(40 * 30, 0);
+    PixelSurface s = { px.data(), 40, 30, 40 };
+    SpanBatch batch;
+    BatchFillRect(batch, s, SpanRect{ -10, -10, 100, 100, GRID_CELL_EVEN }, GRID_CELL_EVEN);
+    BatchFillRect(batch, s, SpanRect{ 50, 5, 60, 10, GRID_LINE }, GRID_LINE);  // Entirely outside
+    BatchLine(batch, s, 39, -5, 39, 50, 3, GRID_LINE);
+    BatchLine(batch, s, -5, 0, 10, 0, 1, GRID_SUB_LINE);
+    BatchLine(batch, s, 10, 20, 2, 20, 1, GRID_MAIN_LABEL);  // Drawn right to left
+    CHECK_EQ(batch.size(), 4);
+    for (const SpanRect& r : batch) CHECK(r.left >= 0 && r.top >= 0 && r.right <= 40 && r.bottom <= 30);
+    SpanBands bands;
+    BuildSpanBands(s, batch, bands);
+    CHECK_EQ(bands.edges.front(), 0);
+    CHECK_EQ(bands.edges.back(), 30);
+    uint32_t lut[GRID_CLASS_COUNT] = { 1, 2, 3, 4, 5, 6, 7 };
+    RasterizeBands(s, batch, bands, lut);
+    CHECK_EQ(px[0], 5);           // Sub line over the fill on row 0
+    CHECK_EQ(px[10], 2);          // The 1-pixel line stops short of its end point
+    CHECK_EQ(px[5 * 40 + 38], 4);  // Wide line centred on column 39, clipped on the right
+    CHECK_EQ(px[5 * 40 + 37], 2);
+    CHECK_EQ(px[29 * 40 + 20], 2);
+    CHECK_EQ(px[20 * 40 + 10], 6);  // Leaves out its end point on the left instead
+    CHECK_EQ(px[20 * 40 + 3], 6);
+    CHECK_EQ(px[20 * 40 + 2], 2);
+}
+
+// Every fill kernel the CPU has writes exactly [dst, dst + n) at every
+// alignment, and StreamRow copies exactly n pixels
+static void TestFillKernels() {
+    SimdLevel cpu = DetectSimdLevel();
+    std::vector<uint32_t> buf(128), src(128);
+    for (size_t i = 0; i < src.size(); i++) src[i] = 0xA0000000u + (uint32_t)i;
+    for (int level = SIMD_SCALAR; level <= cpu; level++) {
+        FillSpanFn fill = SelectFillSpan((SimdLevel)level);
+        for (int offset = 0; offset < 8; offset++) {
+            for (int n = 0; n <= 70; n++) {
+                std::fill(buf.begin(), buf.end(), 0xDEADBEEFu);
+                fill(buf.data() + 8 + offset, n, 0x00123456u);
+                int wrong = 0;
+                for (int i = 0; i < (int)buf.size(); i++) {
+                    bool inside = i >= 8 + offset && i < 8 + offset + n;
+                    wrong += buf[i] != (inside ? 0x00123456u : 0xDEADBEEFu);
+                }
+                CHECK_EQ(wrong, 0);
+            }
+        }
+    }
+    for (int offset = 0; offset < 8; offset++) {
+        for (int n = 0; n <= 70; n++) {
+            std::fill(buf.begin(), buf.end(), 0xDEADBEEFu);
+            StreamRow(buf.data() + 8 + offset, src.data() + 3, n);
+            int wrong = 0;
+            for (int i = 0; i < (int)buf.size(); i++) {
+                bool inside = i >= 8 + offset && i < 8 + offset + n;
+                wrong += buf[i] != (inside ? src[3 + i - 8 - offset] : 0xDEADBEEFu);
+            }
+            CHECK_EQ(wrong, 0);
+        }
+    }
+}
+
+int main() {
+    TestFramesMatchReferenceAndGoldens();
+    TestRecolor();
+    TestToneMap();
+    TestRemap();
+    TestClipping();
+    TestFillKernels();
+    return CheckResult("grid_raster_test");
+}
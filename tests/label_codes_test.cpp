@@ -0,0 +1,136 @@
+// Tests for core/LabelCodes.h: code plans, packed labels and the label lookup
+#include "core/LabelCodes.h"
+#include "tests/Check.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+// Every rank of a plan encodes to a distinct code of length or length + 1
+// letters, decodes back to itself, and no code is a prefix of another
+static void CheckPlan(int count) {
+    LabelPlan plan = PlanLabelCodes(count);
+    std::set<std::wstring> codes;
+    for (int rank = 0; rank < count; rank++) {
+        int digits[MAX_CODE_LETTERS];
+        int n = EncodeLabelRank(plan, rank, digits);
+        CHECK(n == plan.length || n == plan.length + 1);
+        CHECK_EQ(DecodeLabelRank(plan, count, digits, n), rank);
+        std::wstring code;
+        for (int k = 0; k < n; k++) code += LABEL_ALPHABET[digits[k]];
+        CHECK_EQ(DecodeLabelLetters(plan, count, code.c_str(), n), rank);
+        codes.insert(code);
+    }
+    CHECK_EQ((int)codes.size(), count);
+    for (auto it = codes.begin(); it != codes.end(); ++it) {
+        auto next = std::next(it);
+        if (next != codes.end()) CHECK(next->compare(0, it->size(), *it) != 0);
+    }
+}
+
+// A plan never uses longer codes than needed: short codes alone cannot fit
+// count, and one more short code would leave too few long ones
+static void CheckPlanIsShortest(int count) {
+    LabelPlan plan = PlanLabelCodes(count);
+    int full = 1;
+    for (int k = 0; k < plan.length; k++) full *= LABEL_RADIX;
+    if (plan.shortCodes < count) {
+        CHECK(full < count);
+        CHECK(plan.shortCodes + (full - plan.shortCodes) * LABEL_RADIX >= count);
+        CHECK((plan.shortCodes + 1) + (full - plan.shortCodes - 1) * LABEL_RADIX < count);
+    } else {
+        CHECK(count <= full);
+        CHECK(plan.length == 1 || count > full / LABEL_RADIX);
+    }
+}
+
+static void TestPlans() {
+    for (int count = 1; count <= 2000; count++) {
+        CheckPlan(count);
+        CheckPlanIsShortest(count);
+    }
+    for (int count = 2000; count <= MAX_CELLS_PER_MONITOR; count += 997) CheckPlanIsShortest(count);
+    CheckPlan(MAX_CELLS_PER_MONITOR);
+    CHECK_EQ(PlanLabelCodes(26).length, 1);
+    CHECK_EQ(PlanLabelCodes(27).length, 1);
+    CHECK_EQ(PlanLabelCodes(27).shortCodes, 25);
+    CHECK_EQ(PlanLabelCodes(676).length, 2);
+    CHECK_EQ(PlanLabelCodes(676).shortCodes, 676);
+}
+
+static void TestDecodeRejects() {
+    LabelPlan plan = PlanLabelCodes(100);  // 22 one-letter codes, 78 two-letter ones
+    CHECK_EQ(DecodeLabelLetters(plan, 100, L"", 0), -1);
+    CHECK_EQ(DecodeLabelLetters(plan, 100, L"A", 1), -1);
+    CHECK_EQ(DecodeLabelLetters(plan, 100, L"a1", 2), -1);
+    CHECK_EQ(DecodeLabelLetters(plan, 100, L"aa", 2), -1);   // 'a' is a complete short code
+    CHECK_EQ(DecodeLabelLetters(plan, 100, L"m", 1), -1);    // 'm' only starts long codes
+    CHECK_EQ(DecodeLabelLetters(plan, 100, L"mmm", 3), -1);
+    CHECK_EQ(DecodeLabelLetters(plan, 100, L"a", 1), 0);
+    CHECK_EQ(LabelDigit(0), -1);
+    CHECK_EQ(LabelDigit(L'a'), 0);
+    CHECK_EQ(LabelDigit(L'm'), 25);
+}
+
+static void TestPackedLabels() {
+    LabelPlan plan = PlanLabelCodes(700);
+    for (int rank = 0; rank < 700; rank++) {
+        LabelCode code = MakeLabel(L'c', plan, rank);
+        wchar_t text[MAX_LABEL_LETTERS + 1];
+        int n = FormatLabel(code, text);
+        CHECK_EQ(n, LabelLength(code));
+        CHECK(text[0] == L'c');
+        CHECK_EQ(DecodeLabelLetters(plan, 700, text + 1, n - 1), rank);
+        std::wstring typed(text);
+        for (int k = 1; k <= n; k++) {
+            CHECK(LabelHasPrefix(code, PackTypedPrefix(typed, k), k));
+        }
+        CHECK(!LabelHasPrefix(code, PackTypedPrefix(L"d", 1), 1));
+    }
+}
+
+struct LookupMonitor {
+    wchar_t prefix;
+    LabelPlan codes;
+    int firstCell, cellCount;
+};
+
+// Every label of a multi-monitor layout, with codes ranked out of cell
+// order, resolves through FindCellByLabel to the cell it was made for, and
+// nothing short of a whole label resolves at all
+static void TestFindCellRoundTrip() {
+    const int counts[] = { 1, 26, 300, 700, MAX_CELLS_PER_MONITOR };
+    const wchar_t prefixes[] = { L'a', L's', L'd', L'f', L'j' };
+    std::vector<LookupMonitor> monitors;
+    std::vector<int> byCode;
+    std::vector<LabelCode> labels;
+    for (int m = 0; m < 5; m++) {
+        LookupMonitor mon = { prefixes[m], PlanLabelCodes(counts[m]), (int)byCode.size(), counts[m] };
+        monitors.push_back(mon);
+        labels.resize(mon.firstCell + mon.cellCount);
+        for (int rank = 0; rank < mon.cellCount; rank++) {
+            int cell = (int)((rank * 7919LL + m) % mon.cellCount);  // Some permutation
+            byCode.push_back(cell);
+            labels[mon.firstCell + cell] = MakeLabel(mon.prefix, mon.codes, rank);
+        }
+    }
+    for (int i = 0; i < (int)labels.size(); i++) {
+        wchar_t text[MAX_LABEL_LETTERS + 1];
+        int n = FormatLabel(labels[i], text);
+        CHECK_EQ(FindCellByLabel(monitors.data(), (int)monitors.size(), byCode.data(), text, n), i);
+        for (int k = 1; k < n; k++) {
+            CHECK_EQ(FindCellByLabel(monitors.data(), (int)monitors.size(), byCode.data(), text, k), -1);
+        }
+        text[0] = L'q';  // No monitor has it
+        CHECK_EQ(FindCellByLabel(monitors.data(), (int)monitors.size(), byCode.data(), text, n), -1);
+    }
+    CHECK_EQ(FindCellByLabel(monitors.data(), 0, byCode.data(), L"aa", 2), -1);
+}
+
+int main() {
+    TestPlans();
+    TestDecodeRejects();
+    TestPackedLabels();
+    TestFindCellRoundTrip();
+    return CheckResult("label_codes_test");
+}
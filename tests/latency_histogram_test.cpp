@@ -0,0 +1,105 @@
+// Tests for core/LatencyHistogram.h: bucket bounds, relative error,
+// percentiles and max on known distributions, and a reader running while
+// one thread records
+#include "core/LatencyHistogram.h"
+#include "tests/Check.h"
+
+#include <atomic>
+#include <climits>
+#include <thread>
+
+// Every bucket's low bound maps back to it, bounds increase, and the top
+// bucket holds the largest 64-bit value
+static void TestBuckets() {
+    typedef LatencyHistogram H;
+    for (int b = 0; b < H::BUCKET_COUNT; b++) {
+        CHECK_EQ(H::BucketOf(H::BucketLow(b)), b);
+        if (b > 0) CHECK(H::BucketLow(b) > H::BucketLow(b - 1));
+        if (b + 1 < H::BUCKET_COUNT) CHECK_EQ(H::BucketOf(H::BucketLow(b + 1) - 1), b);
+    }
+    CHECK_EQ(H::BucketOf(ULLONG_MAX), H::BUCKET_COUNT - 1);
+    for (unsigned long long v = 0; v < H::SUB_COUNT; v++) CHECK_EQ(H::BucketOf(v), (long long)v);
+}
+
+// A bucket is at most 1/16 of its low bound wide, so the reported midpoint
+// is within 1/32 of any value in it
+static void TestRelativeError() {
+    static LatencyHistogram h;
+    unsigned long long v = 1;
+    for (int i = 0; i < 4000; i++) {
+        int b = LatencyHistogram::BucketOf(v);
+        double low = (double)LatencyHistogram::BucketLow(b);
+        double high = b + 1 < LatencyHistogram::BUCKET_COUNT
+            ? (double)LatencyHistogram::BucketLow(b + 1) : 18446744073709551616.0;
+        CHECK(high - low <= (low < 16 ? 1.0 : low / 16.0));
+        v += v / 97 + 1;
+        if (v > (1ULL << 62)) break;
+    }
+    h.Record(1000003);
+    double p = h.Percentile(50.0);
+    CHECK(p >= 1000003 * (1 - 1.0 / 32) && p <= 1000003);  // Clamped to Max()
+}
+
+static void TestPercentiles() {
+    static LatencyHistogram h;
+    CHECK_EQ(h.Count(), 0);
+    CHECK(h.Percentile(99.0) == 0.0);
+    for (int v = 1; v <= 1000; v++) h.Record(v);
+    CHECK_EQ(h.Count(), 1000);
+    CHECK_EQ(h.Max(), 1000);
+    double p50 = h.Percentile(50.0), p99 = h.Percentile(99.0);
+    CHECK(p50 >= 500 * (1 - 1.0 / 16) && p50 <= 500 * (1 + 1.0 / 16));
+    CHECK(p99 >= 990 * (1 - 1.0 / 16) && p99 <= 1000);
+    CHECK(h.Percentile(100.0) <= 1000);
+    CHECK(h.Percentile(0.0) == 1.0);  // Smallest sample, exact below SUB_COUNT
+
+    // A long tail: 99 fast samples and one slow one
+    static LatencyHistogram tail;
+    for (int i = 0; i < 99; i++) tail.Record(10);
+    tail.Record(5000000);
+    CHECK(tail.Percentile(99.0) == 10.0);
+    CHECK(tail.Percentile(99.5) > 4500000);
+    CHECK_EQ(tail.Max(), 5000000);
+}
+
+static void TestNegativeClamps() {
+    static LatencyHistogram h;
+    h.Record(-5);
+    CHECK_EQ(h.Count(), 1);
+    CHECK_EQ(h.Max(), 0);
+    CHECK(h.Percentile(50.0) == 0.0);
+    CHECK_EQ(h.counts[0].load(), 1);
+}
+
+// Percentile and Count from another thread never see more samples than
+// were recorded, and see all of them once the writer is joined
+static void TestConcurrentReader() {
+    static LatencyHistogram h;
+    const int N = 200000;
+    std::atomic<bool> done(false);
+    std::thread writer([&] {
+        for (int i = 0; i < N; i++) h.Record(i % 5000);
+        done.store(true);
+    });
+    unsigned long long last = 0;
+    while (!done.load()) {
+        unsigned long long n = h.Count();
+        CHECK(n >= last && n <= (unsigned long long)N);
+        last = n;
+        double p = h.Percentile(90.0);
+        CHECK(p >= 0.0 && p <= 5000.0);
+        std::this_thread::yield();
+    }
+    writer.join();
+    CHECK_EQ(h.Count(), N);
+    CHECK_EQ(h.Max(), 4999);
+}
+
+int main() {
+    TestBuckets();
+    TestRelativeError();
+    TestPercentiles();
+    TestNegativeClamps();
+    TestConcurrentReader();
+    return CheckResult("latency_histogram_test");
+}
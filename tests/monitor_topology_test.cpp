@@ -0,0 +1,175 @@
+// Tests for core/MonitorTopology.h through plug, unplug, reorder, move and
+// DPI-change sequences: prefixes stay with their monitors, only changed
+// monitors lose their cells and tiles, and the grid the kept tiles make up
+// with the redrawn ones is pixel for pixel a grid built from scratch
+#include "core/MonitorTopology.h"
+#include "tests/Check.h"
+#include "tests/TestGrid.h"
+#include "tests/TestRaster.h"
+
+#include <string>
+
+// The fields of MonitorInfo the topology code reads
+struct TestDisplay {
+    wchar_t device[32];
+    TestRect rcMonitor;
+    unsigned dpiX, dpiY;
+    wchar_t prefix;
+};
+
+static TestDisplay Display(const wchar_t* device, TestRect rc, unsigned dpi) {
+    TestDisplay d = {};
+    for (int k = 0; device[k] && k < 31; k++) d.device[k] = device[k];
+    d.rcMonitor = rc;
+    d.dpiX = dpi;
+    d.dpiY = dpi;
+    return d;
+}
+
+// The displays and tiles as BuildGridCells and RenderBaseGridTiles keep them
+struct Desk {
+    std::vector<TestDisplay> displays;
+    TestRasterBackend backend;
+    std::vector<TestTile> tiles;
+    std::vector<int> kept;
+
+    // A display change to now; false if nothing changed
+    bool Change(std::vector<TestDisplay> now) {
+        std::vector<int> match = AssignMonitorPrefixes(now, displays);
+        if (!DiffMonitorLayouts(now, displays, match, kept)) return false;
+        displays.swap(now);
+        RemapGridTiles(backend, tiles, kept);
+        return true;
+    }
+    std::wstring Prefixes() const {
+        std::wstring s;
+        for (const TestDisplay& d : displays) s += d.prefix;
+        return s;
+    }
+    // Redraw the tiles that are missing; the frame must match a desk drawn
+    // from nothing
+    bool FrameMatchesFresh() {
+        std::vector<TestMonitor> monitors;
+        for (const TestDisplay& d : displays) monitors.push_back({ d.rcMonitor, (int)d.dpiX });
+        std::wstring prefixes = Prefixes();
+        TestCells cells = {};
+        BuildTestGrid(monitors, cells, prefixes.c_str());
+        const Palette& p = PALETTE_PRESETS[0].palette;
+        TestFrame frame = RenderTestFrame(backend, monitors, cells, tiles, p);
+        TestRasterBackend freshBackend;
+        std::vector<TestTile> freshTiles;
+        TestFrame fresh = RenderTestFrame(freshBackend, monitors, cells, freshTiles, p);
+        ReleaseGridTiles(freshBackend, freshTiles);
+        return backend.liveTiles == (int)displays.size() && frame.pixels == fresh.pixels;
+    }
+};
+
+static const TestRect LAPTOP = { 0, 0, 1280, 800 };
+static const TestRect LEFT = { 1280, 0, 2880, 900 };
+static const TestRect RIGHT = { 2880, 0, 4160, 1024 };
+
+// Dock, reorder, DPI change, unplug, plug a new one in, move one
+static void TestDockingSequence() {
+    Desk desk;
+    CHECK(desk.Change({ Display(L"DISPLAY1", LAPTOP, 144) }));
+    CHECK(desk.Prefixes() == L"a");
+    CHECK(desk.FrameMatchesFresh());
+    void* laptopTile = desk.tiles[0].handle;
+
+    // Dock: two externals appear; the laptop keeps its letter and tile
+    CHECK(desk.Change({ Display(L"DISPLAY1", LAPTOP, 144), Display(L"DISPLAY2", LEFT, 96),
+                        Display(L"DISPLAY3", RIGHT, 96) }));
+    CHECK(desk.Prefixes() == L"abc");
+    CHECK(desk.kept == std::vector<int>({ 0, -1, -1 }));
+    CHECK(desk.tiles[0].handle == laptopTile);
+    CHECK(desk.FrameMatchesFresh());
+    void* rightTile = desk.tiles[2].handle;
+
+    // The same monitors enumerated in another order change nothing
+    CHECK(!desk.Change({ Display(L"DISPLAY3", RIGHT, 96), Display(L"DISPLAY1", LAPTOP, 144),
+                         Display(L"DISPLAY2", LEFT, 96) }));
+    CHECK(desk.Prefixes() == L"abc");
+
+    // DISPLAY2 goes to 125%: only its grid is rebuilt
+    CHECK(desk.Change({ Display(L"DISPLAY1", LAPTOP, 144), Display(L"DISPLAY2", LEFT, 120),
+                        Display(L"DISPLAY3", RIGHT, 96) }));
+    CHECK(desk.Prefixes() == L"abc");
+    CHECK(desk.kept == std::vector<int>({ 0, -1, 2 }));
+    CHECK(desk.tiles[0].handle == laptopTile && desk.tiles[2].handle == rightTile);
+    CHECK(desk.FrameMatchesFresh());
+
+    // Lid closed: the laptop panel goes, the others keep b and c
+    CHECK(desk.Change({ Display(L"DISPLAY2", LEFT, 120), Display(L"DISPLAY3", RIGHT, 96) }));
+    CHECK(desk.Prefixes() == L"bc");
+    CHECK(desk.kept == std::vector<int>({ 1, 2 }));
+    CHECK(desk.tiles[1].handle == rightTile);
+    CHECK(desk.FrameMatchesFresh());
+
+    // A new monitor takes the lowest free letter, wherever it enumerates
+    CHECK(desk.Change({ Display(L"DISPLAY4", LAPTOP, 96), Display(L"DISPLAY2", LEFT, 120),
+                        Display(L"DISPLAY3", RIGHT, 96) }));
+    CHECK(desk.Prefixes() == L"abc");
+    CHECK(desk.kept == std::vector<int>({ -1, 0, 1 }));
+    CHECK(desk.tiles[2].handle == rightTile);
+    CHECK(desk.FrameMatchesFresh());
+
+    // Rearranged in display settings: DISPLAY3 moves above, keeping c
+    TestRect above = { 0, -1024, 1280, 0 };
+    CHECK(desk.Change({ Display(L"DISPLAY4", LAPTOP, 96), Display(L"DISPLAY2", LEFT, 120),
+                        Display(L"DISPLAY3", above, 96) }));
+    CHECK(desk.Prefixes() == L"abc");
+    CHECK(desk.kept == std::vector<int>({ 0, 1, -1 }));
+    CHECK(desk.FrameMatchesFresh());
+
+    ReleaseGridTiles(desk.backend, desk.tiles);
+    CHECK_EQ(desk.backend.liveTiles, 0);
+}
+
+// Monitors without a device name are told apart by position
+static void TestNamelessMonitors() {
+    std::vector<TestDisplay> before = { Display(L"", LAPTOP, 96), Display(L"", LEFT, 96) };
+    std::vector<int> match = AssignMonitorPrefixes(before, std::vector<TestDisplay>());
+    CHECK(match == std::vector<int>({ -1, -1 }));
+    std::vector<TestDisplay> after = { Display(L"", LEFT, 96), Display(L"", RIGHT, 96) };
+    match = AssignMonitorPrefixes(after, before);
+    CHECK(match == std::vector<int>({ 1, -1 }));
+    CHECK(after[0].prefix == L'b' && after[1].prefix == L'a');
+    std::vector<int> kept;
+    CHECK(DiffMonitorLayouts(after, before, match, kept));
+    CHECK(kept == std::vector<int>({ 1, -1 }));
+
+    // A named monitor never matches a nameless one at the same place
+    std::vector<TestDisplay> named = { Display(L"DISPLAY1", LEFT, 96) };
+    match = AssignMonitorPrefixes(named, before);
+    CHECK_EQ(match[0], -1);
+}
+
+// Past 26 monitors the extras get no prefix and no grid; unplugging one
+// frees its letter for the next
+static void TestOutOfPrefixes() {
+    std::vector<TestDisplay> wall;
+    for (int k = 0; k < 27; k++) {
+        wchar_t name[16] = L"WALL";
+        name[4] = (wchar_t)(L'A' + k / 10);
+        name[5] = (wchar_t)(L'0' + k % 10);
+        wall.push_back(Display(name, TestRect{ k * 100, 0, k * 100 + 100, 100 }, 96));
+    }
+    std::vector<TestDisplay> attached = wall;
+    std::vector<int> match = AssignMonitorPrefixes(attached, std::vector<TestDisplay>());
+    CHECK_EQ(attached.size(), (size_t)26);
+    CHECK(attached[25].prefix == L'z');
+
+    std::vector<TestDisplay> fewer(wall.begin() + 1, wall.end());
+    match = AssignMonitorPrefixes(fewer, attached);
+    CHECK_EQ(fewer.size(), (size_t)26);
+    CHECK(fewer[25].prefix == L'a');  // The 27th takes the unplugged first one's letter
+    CHECK_EQ(match[25], -1);
+    CHECK_EQ(match[0], 1);
+}
+
+int main() {
+    TestDockingSequence();
+    TestNamelessMonitors();
+    TestOutOfPrefixes();
+    return CheckResult("monitor_topology_test");
+}
@@ -0,0 +1,134 @@
+// Tests for core/Palette.h: the compile-time preset palettes against the
+// run-time scalar hsl(), HslBatch and Hsl4Sse2 for every preset and tone,
+// and GeneratePalette's batch conversion against scalar hsl() over the
+// hues the palette picker can produce
+#include "core/Palette.h"
+#include "tests/Check.h"
+
+#include <cstring>
+#include <random>
+
+static bool SamePalette(const Palette& a, const Palette& b) {
+    for (const PaletteTone& t : PALETTE_TONES) {
+        if (a.*t.color != b.*t.color) return false;
+    }
+    return true;
+}
+
+// The hsl() inputs of every tone for base hue H, as GeneratePalette forms them
+static void ToneInputs(float H, float* hue, float* sat, float* light) {
+    for (size_t i = 0; i < PALETTE_TONE_COUNT; i++) {
+        const PaletteTone& t = PALETTE_TONES[i];
+        hue[i] = (t.accent ? H + 90.0f : H) + t.hueOffset;
+        sat[i] = t.sat;
+        light[i] = t.light;
+    }
+}
+
+// Every tone of every preset, worked out by the compiler, equals the same
+// conversion done at run time by each kernel, and the reference table
+static void TestPresetsMatchRuntime() {
+    for (size_t p = 0; p < PALETTE_PRESET_COUNT; p++) {
+        volatile float runtimeHue = PALETTE_PRESETS[p].hue;  // Keep the compiler out of it
+        float H = runtimeHue;
+        float hue[PALETTE_TONE_COUNT + 3], sat[PALETTE_TONE_COUNT + 3], light[PALETTE_TONE_COUNT + 3];
+        ToneInputs(H, hue, sat, light);
+        for (int k = 0; k < 3; k++) hue[PALETTE_TONE_COUNT + k] = sat[PALETTE_TONE_COUNT + k] = light[PALETTE_TONE_COUNT + k] = 0.0f;
+        PaletteColor batch[PALETTE_TONE_COUNT], sse2[PALETTE_TONE_COUNT + 3];
+        HslBatch(hue, sat, light, batch, (int)PALETTE_TONE_COUNT);
+#if KJ_SIMD_X86
+        for (size_t i = 0; i < PALETTE_TONE_COUNT; i += 4) Hsl4Sse2(hue + i, sat + i, light + i, sse2 + i);
+#else
+        for (size_t i = 0; i < PALETTE_TONE_COUNT; i++) sse2[i] = hsl(hue[i], sat[i], light[i]);
+#endif
+        for (size_t i = 0; i < PALETTE_TONE_COUNT; i++) {
+            PaletteColor compiled = PALETTE_PRESETS[p].palette.*PALETTE_TONES[i].color;
+            CHECK_EQ(compiled, PALETTE_PRESET_RGB[p][i]);
+            CHECK_EQ(hsl(hue[i], sat[i], light[i]), compiled);
+            CHECK_EQ(batch[i], compiled);
+            CHECK_EQ(sse2[i], compiled);
+        }
+        CHECK(SamePalette(TonePalette(H), PALETTE_PRESETS[p].palette));
+        CHECK(SamePalette(GeneratePalette(H), PALETTE_PRESETS[p].palette));
+    }
+}
+
+// GeneratePalette (presets, else HslBatch) equals TonePalette run as plain
+// scalar hsl() calls for base hue H
+static int CountGenerateMismatches(float H) {
+    return SamePalette(GeneratePalette(H), TonePalette(H)) ? 0 : 1;
+}
+
+// The picker clamps hues to [0, 359.9] and sets them from hue bar pixels
+// (x / width * 360) or the registry. Cover every pixel of bars up to 1000
+// wide, every hundredth of a degree, and the floats around each preset.
+static void TestGeneratePaletteExact() {
+    int mismatches = 0;
+    for (int w = 1; w <= 1000; w++) {
+        for (int x = 0; x <= w; x++) {
+            float H = (float)x / (float)w * 360.0f;
+            if (H > 359.9f) H = 359.9f;
+            mismatches += CountGenerateMismatches(H);
+        }
+    }
+    for (int i = 0; i <= 35990; i++) mismatches += CountGenerateMismatches((float)i / 100.0f);
+    for (const PalettePreset& preset : PALETTE_PRESETS) {
+        float below = preset.hue, above = preset.hue;
+        for (int k = 0; k < 64; k++) {
+            below = nextafterf(below, -1.0f);
+            above = nextafterf(above, 360.0f);
+            if (below >= 0.0f) mismatches += CountGenerateMismatches(below);
+            mismatches += CountGenerateMismatches(above);
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+#if KJ_SIMD_X86
+// Hsl4Sse2 lane by lane against hsl() over its whole input range, with
+// sextant boundaries and their neighbours mixed in
+static void TestHsl4Sse2Lanes() {
+    std::mt19937 rng(18);
+    std::uniform_real_distribution<float> hueDist(-360.0f, 720.0f), unit(0.0f, 1.0f);
+    int mismatches = 0;
+    for (int n = 0; n < 250000; n++) {
+        float h[4], s[4], l[4];
+        for (int k = 0; k < 4; k++) {
+            h[k] = hueDist(rng);
+            if (rng() % 8 == 0) {
+                float edge = (float)((int)(rng() % 19) * 60 - 360);
+                h[k] = rng() % 2 ? edge : nextafterf(edge, rng() % 2 ? -1000.0f : 1000.0f);
+                if (h[k] < -360.0f || h[k] >= 720.0f) h[k] = edge;
+            }
+            s[k] = unit(rng);
+            l[k] = unit(rng);
+        }
+        PaletteColor out[4];
+        Hsl4Sse2(h, s, l, out);
+        for (int k = 0; k < 4; k++) mismatches += out[k] != hsl(h[k], s[k], l[k]);
+    }
+    CHECK_EQ(mismatches, 0);
+}
+#endif
+
+// Hues outside [-360, 720) take the scalar path with fmodf
+static void TestBatchOutOfRange() {
+    float h[] = { 1000.0f, -500.0f, 30.0f, 90.0f, 719.0f, 720.0f, -360.0f, -361.0f, 5000.5f };
+    float s[9], l[9];
+    for (int i = 0; i < 9; i++) { s[i] = 0.5f; l[i] = 0.4f; }
+    PaletteColor out[9];
+    HslBatch(h, s, l, out, 9);
+    for (int i = 0; i < 9; i++) CHECK_EQ(out[i], hsl(h[i], s[i], l[i]));
+    CHECK_EQ(hsl(720.0f, 0.5f, 0.4f), hsl(0.0f, 0.5f, 0.4f));
+    CHECK_EQ(hsl(-361.0f, 0.5f, 0.4f), hsl(359.0f, 0.5f, 0.4f));
+}
+
+int main() {
+    TestPresetsMatchRuntime();
+    TestGeneratePaletteExact();
+#if KJ_SIMD_X86
+    TestHsl4Sse2Lanes();
+#endif
+    TestBatchOutOfRange();
+    return CheckResult("palette_test");
+}
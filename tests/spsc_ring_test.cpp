@@ -0,0 +1,180 @@
+// Tests for core/SpscRing.h: capacity, FIFO order across index wraparound,
+// an ordered hand-off of a million items between two threads, and the
+// coalescing ring's latest-wins overflow, alone and under a stress of
+// interleaved cursor commands. Configure with -DKJ_SANITIZE_THREAD=ON to
+// run the threaded cases under ThreadSanitizer.
+#include "core/SpscRing.h"
+#include "tests/Check.h"
+
+#include <climits>
+#include <random>
+#include <thread>
+#include <vector>
+
+static void TestCapacity() {
+    SpscRing<int, 8> ring;
+    int v = 0;
+    CHECK(!ring.Pop(v));
+    for (int i = 0; i < 8; i++) CHECK(ring.Push(i));
+    CHECK(!ring.Push(8));  // Full
+    for (int i = 0; i < 8; i++) {
+        CHECK(ring.Pop(v));
+        CHECK_EQ(v, i);
+    }
+    CHECK(!ring.Pop(v));
+}
+
+// The indices are free-running unsigned counters; order must survive them
+// wrapping past UINT_MAX
+static void TestWraparound() {
+    SpscRing<int, 4> ring;
+    ring.head.store(UINT_MAX - 5);
+    ring.tail.store(UINT_MAX - 5);
+    int next = 0, expect = 0, v = -1;
+    for (int round = 0; round < 20; round++) {
+        while (ring.Push(next)) next++;
+        CHECK_EQ(next - expect, 4);
+        for (int k = 0; k < 1 + round % 4; k++) {
+            CHECK(ring.Pop(v));
+            CHECK_EQ(v, expect++);
+        }
+    }
+}
+
+static void TestTwoThreads() {
+    static SpscRing<unsigned, 64> ring;
+    const unsigned COUNT = 1000000;
+    std::thread producer([] {
+        for (unsigned i = 0; i < COUNT; ) {
+            if (ring.Push(i)) i++;
+            else std::this_thread::yield();
+        }
+    });
+    unsigned expect = 0, v, outOfOrder = 0;
+    while (expect < COUNT) {
+        if (!ring.Pop(v)) {
+            std::this_thread::yield();
+            continue;
+        }
+        outOfOrder += v != expect;
+        expect++;
+    }
+    producer.join();
+    CHECK_EQ(outOfOrder, 0);
+    CHECK(!ring.Pop(v));
+}
+
+// A full ring sends posts to the overflow, the newest replacing the rest,
+// and the consumer gets it only after everything queued before it
+static void TestCoalescingOverflow() {
+    CoalescingSpscRing<int, 4> q;
+    int v = -1;
+    CHECK(!q.Take(v));
+    for (int i = 0; i < 4; i++) CHECK(q.Post(i));
+    CHECK(!q.Post(4));
+    CHECK(!q.Post(5));  // Replaces 4
+    CHECK(q.Take(v));
+    CHECK_EQ(v, 0);
+    CHECK(!q.Post(6));  // The ring has room, but 6 must not pass the overflow
+    for (int expect : { 1, 2, 3, 6 }) {
+        CHECK(q.Take(v));
+        CHECK_EQ(v, expect);
+    }
+    CHECK(!q.Take(v));
+    CHECK(q.Post(7));  // Overflow empty again: back to the ring
+    CHECK(q.Take(v));
+    CHECK_EQ(v, 7);
+    CHECK(!q.Take(v));
+}
+
+// A producer that never waits against a consumer that keeps falling behind:
+// the values taken are a strictly increasing subsequence ending with the
+// last one posted
+static void TestCoalescingStress() {
+    static CoalescingSpscRing<unsigned, 8> q;
+    const unsigned COUNT = 2000000;
+    std::atomic<bool> done(false);
+    std::thread producer([&] {
+        for (unsigned i = 0; i < COUNT; i++) {
+            q.Post(i);
+            if ((i & 1023) == 0) std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+    });
+    unsigned last = 0, taken = 0, outOfOrder = 0, v;
+    bool any = false;
+    for (;;) {
+        bool finished = done.load(std::memory_order_acquire);
+        bool got = false;
+        while (q.Take(v)) {
+            outOfOrder += any && v <= last;
+            last = v;
+            any = got = true;
+            taken++;
+        }
+        if (finished) break;
+        if (!got) std::this_thread::yield();
+    }
+    producer.join();
+    CHECK_EQ(outOfOrder, 0);
+    CHECK(any);
+    CHECK_EQ(last, COUNT - 1);
+    CHECK(taken <= COUNT);
+    CHECK(!q.Take(v));
+}
+
+// The cursor worker's contract: thousands of interleaved hide and restore
+// commands, posted without waiting, leave the worker in the state of the
+// last one. A quit posted while the worker lags may replace that last
+// command, which is fine: quit restores the system cursors itself.
+enum TestCursorCommand { TEST_CMD_HIDE, TEST_CMD_RESTORE, TEST_CMD_RESTORE_NOW, TEST_CMD_QUIT };
+
+static void TestCursorCommandStress() {
+    for (int round = 0; round < 20; round++) {
+        static CoalescingSpscRing<TestCursorCommand, 16> q;
+        std::mt19937 rng(round);
+        std::vector<TestCursorCommand> script(5000);
+        for (TestCursorCommand& c : script) c = (TestCursorCommand)(rng() % 3);
+        std::atomic<bool> done(false);
+        std::thread ui([&] {
+            for (size_t i = 0; i < script.size(); i++) {
+                q.Post(script[i]);
+                if (rng() % 64 == 0) std::this_thread::yield();
+            }
+            done.store(true, std::memory_order_release);
+        });
+        TestCursorCommand state = TEST_CMD_RESTORE_NOW, cmd = TEST_CMD_HIDE;
+        int received = 0;
+        for (;;) {
+            bool finished = done.load(std::memory_order_acquire);
+            bool got = false;
+            while (q.Take(cmd)) {
+                state = cmd;
+                got = true;
+                received++;
+            }
+            if (finished) break;
+            if (!got) std::this_thread::yield();
+        }
+        ui.join();
+        CHECK_EQ(state, script.back());
+        CHECK(received <= (int)script.size());
+
+        // Quit always arrives, even behind a full ring
+        for (int i = 0; i < 16; i++) q.Post(TEST_CMD_HIDE);
+        q.Post(TEST_CMD_RESTORE);
+        q.Post(TEST_CMD_QUIT);
+        while (q.Take(cmd)) state = cmd;
+        CHECK_EQ(state, TEST_CMD_QUIT);
+    }
+}
+
+int main() {
+    TestCapacity();
+    TestWraparound();
+    TestTwoThreads();
+    TestCoalescingOverflow();
+    TestCoalescingStress();
+    TestCursorCommandStress();
+    return CheckResult("spsc_ring_test");
+}
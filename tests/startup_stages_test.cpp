@@ -0,0 +1,151 @@
+// Tests for core/StartupStages.h: the deferred grid build driven with fake
+// stages (cells, then raster, then the ready notice) in order on the worker,
+// an EnsureGridReady that comes before the build timer, the handoff of the
+// data between the worker and the UI thread, and the startup trace's
+// first-write-wins marks. Configure with -DKJ_SANITIZE_THREAD=ON to run the
+// threaded cases under ThreadSanitizer.
+#include "core/StartupStages.h"
+#include "tests/Check.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+// The app's use of StagedBuild with fake stages: each stage checks it owns
+// the data and appends its name to log, which is the data
+struct FakeGrid {
+    StagedBuild build;
+    std::thread::id uiThread = std::this_thread::get_id();
+    std::vector<std::string> log;
+    std::atomic<bool> started{false}, release{true};
+    std::atomic<int> notices{0};
+    int unowned = 0;  // Stages that ran without owning the data
+
+    bool Owned() const { return build.OwnedByCaller(std::this_thread::get_id() == uiThread); }
+    void Stage(const char* name) {
+        unowned += !Owned();
+        log.push_back(name);
+    }
+    // The worker's side: signals it started, then waits for release
+    void Work(bool cells) {
+        started.store(true);
+        while (!release.load()) std::this_thread::yield();
+        if (cells) Stage("cells");
+        Stage("raster");
+        notices++;
+    }
+    // BeginGridBuild (also what the build timer calls)
+    void Begin() { build.Begin([this] { Work(true); }); }
+    // EnsureGridReady
+    void Ensure() {
+        if (build.State() == STAGE_READY) return;
+        Begin();
+        build.Finish();
+    }
+};
+
+// The timer begins the build, the worker runs cells then raster, and the
+// UI thread waits for it; a second timer does nothing
+static void TestOrdering() {
+    FakeGrid grid;
+    CHECK_EQ(grid.build.State(), STAGE_PENDING);
+    CHECK(grid.Owned());
+    grid.Begin();
+    CHECK_EQ(grid.build.State(), STAGE_RUNNING);
+    grid.Ensure();
+    CHECK_EQ(grid.build.State(), STAGE_READY);
+    CHECK_EQ(grid.log.size(), 2);
+    CHECK(grid.log[0] == "cells");
+    CHECK(grid.log[1] == "raster");
+    CHECK_EQ(grid.notices.load(), 1);
+    CHECK_EQ(grid.unowned, 0);
+
+    grid.Begin();  // A late timer
+    grid.Ensure();
+    CHECK_EQ(grid.log.size(), 2);
+    CHECK_EQ(grid.build.State(), STAGE_READY);
+}
+
+// The grid is needed before the build timer fires: EnsureGridReady builds
+// it and returns with it done, and the timer that fires later does nothing
+static void TestEarlyEnsure() {
+    FakeGrid grid;
+    grid.Ensure();
+    CHECK_EQ(grid.build.State(), STAGE_READY);
+    CHECK_EQ(grid.log.size(), 2);
+    CHECK(grid.Owned());
+    CHECK(!grid.build.Begin([&grid] { grid.Work(true); }));
+    CHECK_EQ(grid.log.size(), 2);
+    CHECK_EQ(grid.notices.load(), 1);
+}
+
+// While the worker runs, it owns the data and the UI thread does not;
+// after Finish it is the other way round. A later relabel hands the data
+// to a worker again.
+static void TestHandoff() {
+    FakeGrid grid;
+    grid.release.store(false);
+    grid.Begin();
+    while (!grid.started.load()) std::this_thread::yield();
+    CHECK(!grid.Owned());  // UI thread, worker holding the data
+    bool ownedOnWorker = false, ownedOnOther = true;
+    grid.release.store(true);
+    grid.build.Finish();
+    CHECK(grid.Owned());
+    CHECK_EQ(grid.unowned, 0);
+
+    // Relabel after READY: the worker owns the data again, then hands it back
+    grid.release.store(false);
+    grid.started.store(false);
+    grid.build.Run([&] {
+        ownedOnWorker = grid.Owned();
+        grid.Work(false);
+    });
+    CHECK_EQ(grid.build.State(), STAGE_RUNNING);
+    while (!grid.started.load()) std::this_thread::yield();
+    CHECK(!grid.Owned());
+    grid.release.store(true);
+    grid.build.Finish();
+    CHECK(ownedOnWorker);
+    CHECK_EQ(grid.build.State(), STAGE_READY);
+    CHECK(grid.Owned());
+    CHECK_EQ(grid.log.size(), 3);
+    CHECK(grid.log[2] == "raster");
+    CHECK_EQ(grid.notices.load(), 2);
+
+    // Other threads never own it
+    std::thread other([&] { ownedOnOther = grid.Owned(); });
+    other.join();
+    CHECK(!ownedOnOther);
+}
+
+// Marks keep their first time, from whichever thread gets there first, and
+// a mark at tick 0 still reads as reached
+static void TestTrace() {
+    static StartupTrace trace;
+    for (int i = 0; i < STARTUP_MARK_COUNT; i++) CHECK_EQ(trace.At((StartupMark)i), 0);
+    trace.Mark(STARTUP_TRAY_ICON, 0);
+    CHECK_EQ(trace.At(STARTUP_TRAY_ICON), 1);
+    trace.Mark(STARTUP_FIRST_PAINT, 500);
+    trace.Mark(STARTUP_FIRST_PAINT, 700);
+    CHECK_EQ(trace.At(STARTUP_FIRST_PAINT), 500);
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t <= 8; t++) {
+        threads.emplace_back([t] {
+            for (int k = 0; k < 1000; k++) trace.Mark(STARTUP_GRID_READY, t * 1000 + k);
+        });
+    }
+    for (std::thread& t : threads) t.join();
+    long long ready = trace.At(STARTUP_GRID_READY);
+    CHECK(ready >= 1000 && ready < 9000);
+    CHECK_EQ(ready % 1000, 0);  // Each thread's first mark, never a later one
+}
+
+int main() {
+    TestOrdering();
+    TestEarlyEnsure();
+    TestHandoff();
+    TestTrace();
+    return CheckResult("startup_stages_test");
+}
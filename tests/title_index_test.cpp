@@ -0,0 +1,128 @@
+// Tests for core/TitleIndex.h: folded packing, and search levels that are
+// reused as the query grows and shrinks yet match a search from scratch
+#include "core/FoldedSearch.h"
+#include "core/TitleIndex.h"
+#include "tests/Check.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+static char16_t FoldAscii(char16_t c) {
+    return (c >= u'A' && c <= u'Z') ? (char16_t)(c - u'A' + u'a') : c;
+}
+
+// Substring matcher that counts its calls
+struct CountingMatch {
+    int* calls;
+    bool operator()(const char16_t* title, int len, const char16_t* query, int n, int* pos, int* score) const {
+        (*calls)++;
+        int at = FindFolded(title, len, query, n);
+        if (at < 0) return false;
+        for (int k = 0; k < n; k++) pos[k] = at + k;
+        *score = -at;
+        return true;
+    }
+};
+
+static FoldedTitleIndex<char16_t> MakeIndex(const std::vector<std::u16string>& titles) {
+    FoldedTitleIndex<char16_t> ix = {};
+    for (const std::u16string& t : titles) AppendFoldedTitle(ix, t.data(), (int)t.size(), FoldAscii);
+    ix.normalCount = (int)titles.size();
+    return ix;
+}
+
+static void TestPacking() {
+    FoldedTitleIndex<char16_t> ix = MakeIndex({ u"Inbox - Outlook", u"", u"README.md" });
+    CHECK_EQ(ix.offset.size(), 3);
+    CHECK_EQ(ix.offset[1], 15);
+    CHECK_EQ(ix.length[1], 0);
+    CHECK_EQ(ix.offset[2], 15);
+    CHECK(std::u16string(ix.folded.begin(), ix.folded.end()) == u"inbox - outlookreadme.md");
+}
+
+// The entries a from-scratch scan finds, with their match starts
+static std::vector<std::pair<int, int>> Scratch(const std::vector<std::u16string>& folded, const std::u16string& q) {
+    std::vector<std::pair<int, int>> found;
+    for (int e = 0; e < (int)folded.size(); e++) {
+        size_t at = folded[e].find(q);
+        if (at != std::u16string::npos) found.push_back({ e, (int)at });
+    }
+    return found;
+}
+
+static void CheckLevels(const std::vector<SearchLevel>& levels, const std::vector<std::u16string>& folded,
+                        const std::u16string& q) {
+    CHECK_EQ(levels.size(), q.size());
+    for (size_t n = 1; n <= q.size(); n++) {
+        std::vector<std::pair<int, int>> expect = Scratch(folded, q.substr(0, n));
+        const SearchLevel& level = levels[n - 1];
+        CHECK_EQ(level.hits.size(), expect.size());
+        if (level.hits.size() != expect.size()) continue;
+        for (size_t i = 0; i < expect.size(); i++) {
+            CHECK_EQ(level.hits[i].entry, expect[i].first);
+            CHECK_EQ(level.positions[level.hits[i].matchAt], expect[i].second);
+        }
+    }
+}
+
+static void TestIncremental() {
+    std::vector<std::u16string> titles = { u"Visual Studio Code", u"Studio One", u"Notepad", u"Code Review",
+                                           u"VS Code - main.cpp", u"Outlook" };
+    std::vector<std::u16string> folded;
+    for (const std::u16string& t : titles) {
+        folded.push_back(t);
+        for (char16_t& c : folded.back()) c = FoldAscii(c);
+    }
+    FoldedTitleIndex<char16_t> ix = MakeIndex(titles);
+    std::vector<SearchLevel> levels;
+    std::u16string levelsQuery;
+    int calls = 0;
+    CountingMatch match = { &calls };
+
+    UpdateSearchLevels(levels, levelsQuery, std::u16string(u"c"), ix, match);
+    CHECK_EQ(calls, 6);  // First level scans every title
+    CheckLevels(levels, folded, u"c");
+    calls = 0;
+    UpdateSearchLevels(levels, levelsQuery, std::u16string(u"co"), ix, match);
+    CHECK_EQ(calls, 3);  // Only the three titles with a 'c'
+    CheckLevels(levels, folded, u"co");
+    calls = 0;
+    UpdateSearchLevels(levels, levelsQuery, std::u16string(u"c"), ix, match);
+    CHECK_EQ(calls, 0);  // Backspace reuses the saved level
+    CheckLevels(levels, folded, u"c");
+    calls = 0;
+    UpdateSearchLevels(levels, levelsQuery, std::u16string(u"st"), ix, match);
+    CHECK_EQ(calls, 6 + 3);  // New first letter: start over
+    CheckLevels(levels, folded, u"st");
+}
+
+// Random edits against random titles: the kept levels must always equal a
+// fresh scan
+static void TestRandomEdits() {
+    std::mt19937 rng(5);
+    const std::u16string alphabet = u"abcde ";
+    std::vector<std::u16string> titles(300);
+    for (std::u16string& t : titles) {
+        int len = (int)(rng() % 30);
+        for (int k = 0; k < len; k++) t += alphabet[rng() % alphabet.size()];
+    }
+    FoldedTitleIndex<char16_t> ix = MakeIndex(titles);
+    std::vector<SearchLevel> levels;
+    std::u16string levelsQuery, query;
+    int calls = 0;
+    CountingMatch match = { &calls };
+    for (int step = 0; step < 500; step++) {
+        if (!query.empty() && rng() % 3 == 0) query.pop_back();
+        else if (query.size() < 6) query += alphabet[rng() % 5];
+        UpdateSearchLevels(levels, levelsQuery, query, ix, match);
+        CheckLevels(levels, titles, query);
+    }
+}
+
+int main() {
+    TestPacking();
+    TestIncremental();
+    TestRandomEdits();
+    return CheckResult("title_index_test");
+}
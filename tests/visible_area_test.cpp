@@ -0,0 +1,80 @@
+// Tests for core/VisibleArea.h: the sweep must agree exactly with region
+// arithmetic on random window stacks
+#include "core/VisibleArea.h"
+#include "tests/Check.h"
+#include "tests/RegionReference.h"
+
+#include <random>
+#include <vector>
+
+static void CheckStack(const std::vector<TestRect>& rects) {
+    int n = (int)rects.size();
+    std::vector<long long> sweep(n), reference(n);
+    ComputeVisibleAreas(rects.data(), n, sweep.data());
+    ReferenceVisibleAreas(rects.data(), n, reference.data());
+    for (int i = 0; i < n; i++) CHECK_EQ(sweep[i], reference[i]);
+}
+
+// n random windows on a grid of step-sized coordinates in [lo, hi): small
+// steps make many windows share edges
+static std::vector<TestRect> RandomStack(std::mt19937& rng, int n, int lo, int hi, int step) {
+    std::uniform_int_distribution<int> coord(lo / step, hi / step);
+    std::vector<TestRect> rects(n);
+    for (TestRect& r : rects) {
+        int x0 = coord(rng) * step, x1 = coord(rng) * step;
+        int y0 = coord(rng) * step, y1 = coord(rng) * step;
+        r = { x0 < x1 ? x0 : x1, y0 < y1 ? y0 : y1, x0 < x1 ? x1 : x0, y0 < y1 ? y1 : y0 };
+    }
+    return rects;
+}
+
+static void TestFixedStacks() {
+    CheckStack({});
+    CheckStack({ { 0, 0, 10, 10 } });
+    CheckStack({ { 0, 0, 10, 10 }, { 0, 0, 10, 10 } });              // Identical: fully hidden
+    CheckStack({ { 0, 0, 5, 5 }, { 0, 0, 10, 10 } });                // Front one inside
+    CheckStack({ { 0, 0, 10, 10 }, { 2, 2, 5, 5 } });                // Back one inside
+    CheckStack({ { 0, 0, 10, 10 }, { 10, 0, 20, 10 }, { 5, 5, 15, 15 } });
+    CheckStack({ { 3, 3, 3, 8 }, { 0, 0, 10, 10 }, { 4, 0, 4, 4 } }); // Empty rects
+    CheckStack({ { -3840, -200, 0, 1960 }, { -100, 0, 200, 300 }, { 0, 0, 3840, 2160 } });
+
+    // Reference results by hand
+    std::vector<TestRect> rects = { { 0, 0, 10, 10 }, { 5, 5, 15, 15 }, { 0, 0, 20, 20 } };
+    long long areas[3];
+    ComputeVisibleAreas(rects.data(), 3, areas);
+    CHECK_EQ(areas[0], 100);
+    CHECK_EQ(areas[1], 75);
+    CHECK_EQ(areas[2], 400 - 175);
+}
+
+static void TestRandomStacks() {
+    std::mt19937 rng(1234);
+    for (int round = 0; round < 2000; round++) {
+        int n = 1 + round % 40;
+        CheckStack(RandomStack(rng, n, -50, 50, 1 + round % 7));
+    }
+    for (int round = 0; round < 20; round++) {
+        CheckStack(RandomStack(rng, 300, -3840, 7680, round % 2 ? 1 : 64));
+    }
+}
+
+// Cascades and tiles, the layouts that made the band sweep quadratic: many
+// windows spanning the same bands
+static void TestCascadeAndTiles() {
+    std::vector<TestRect> rects;
+    for (int i = 0; i < 400; i++) rects.push_back({ i * 8, i * 6, i * 8 + 1600, i * 6 + 1000 });
+    CheckStack(rects);
+    rects.clear();
+    for (int row = 0; row < 20; row++) {
+        for (int col = 0; col < 20; col++) rects.push_back({ col * 190, row * 100, col * 190 + 200, row * 100 + 110 });
+    }
+    rects.push_back({ 0, 0, 4000, 2200 });
+    CheckStack(rects);
+}
+
+int main() {
+    TestFixedStacks();
+    TestRandomStacks();
+    TestCascadeAndTiles();
+    return CheckResult("visible_area_test");
+}
@@ -0,0 +1,173 @@
+// Tests for core/WindowInventory.h: which events are hooked and count, and
+// scripted sessions replayed to check the snapshot is usable when it should
+// be, never shows a moved window, and what each Tab costs until it highlights
+#include "core/WindowInventory.h"
+#include "tests/Check.h"
+#include "tests/InventoryReplay.h"
+
+#include <vector>
+
+static const int DEBOUNCE_MS = 100;  // INVENTORY_DEBOUNCE_MS
+
+static void TestHookedEvents() {
+    const unsigned hooked[] = { INV_SYSTEM_FOREGROUND, INV_SYSTEM_MOVESIZEEND, INV_SYSTEM_MINIMIZESTART,
+                                INV_SYSTEM_MINIMIZEEND, INV_OBJECT_CREATE, INV_OBJECT_DESTROY,
+                                INV_OBJECT_SHOW, INV_OBJECT_HIDE, INV_OBJECT_LOCATIONCHANGE,
+                                INV_OBJECT_NAMECHANGE };
+    for (unsigned e = 0; e < 0x9000; e++) {
+        bool expect = false;
+        for (unsigned h : hooked) expect = expect || e == h;
+        CHECK_EQ(InventoryEventHooked(e), expect);
+    }
+    // Ranges don't overlap, so no event is delivered twice
+    for (int i = 0; i < INVENTORY_EVENT_RANGE_COUNT; i++) {
+        for (int j = i + 1; j < INVENTORY_EVENT_RANGE_COUNT; j++) {
+            CHECK(INVENTORY_EVENT_RANGES[i].last < INVENTORY_EVENT_RANGES[j].first ||
+                  INVENTORY_EVENT_RANGES[j].last < INVENTORY_EVENT_RANGES[i].first);
+        }
+    }
+}
+
+static void TestStaleRules() {
+    CHECK(InventoryEventStales(INV_OBJECT_DESTROY, true, false));
+    CHECK(!InventoryEventStales(INV_OBJECT_DESTROY, false, true));  // Never in the snapshot
+    CHECK(InventoryEventStales(INV_OBJECT_SHOW, false, true));
+    CHECK(!InventoryEventStales(INV_OBJECT_SHOW, false, false));    // Child window
+    CHECK(!InventoryEventStales(INV_OBJECT_NAMECHANGE, true, false));
+    CHECK(InventoryEventStales(INV_SYSTEM_FOREGROUND, false, true));
+    CHECK(InventoryEventStales(INV_OBJECT_LOCATIONCHANGE, true, true));
+    CHECK(!InventoryEventStales(INV_OBJECT_LOCATIONCHANGE, false, true));  // Not in the snapshot
+    CHECK(!InventoryEventStales(INV_OBJECT_LOCATIONCHANGE, true, false));
+    CHECK(!InventoryEventStales(0x8005, true, true));              // EVENT_OBJECT_FOCUS
+}
+
+// Round costs so latencies can be checked exactly: 100 us to highlight from
+// a snapshot, 10 us per window to enumerate, 1 us per window to check a rect
+static TabCosts TestCosts() {
+    TabCosts costs;
+    costs.highlightUs = 100;
+    costs.enumerateUsPerWindow = 10;
+    costs.rectCheckUsPerWindow = 1;
+    return costs;
+}
+
+static ReplayStats Replay(const std::vector<ScriptedEvent>& events, const std::vector<long long>& tabs,
+                          long long endMs, int windows = 8) {
+    InventoryReplay replay(INVENTORY_EVENT_RANGES, INVENTORY_EVENT_RANGE_COUNT, DEBOUNCE_MS, windows,
+                           TestCosts());
+    return replay.Run(events, tabs, endMs);
+}
+
+// A new window appears and sets its title a few times: one rebuild, and
+// Tab uses the snapshot once the debounce has passed
+static void TestAppLaunch() {
+    std::vector<ScriptedEvent> events = {
+        { 1000, INV_OBJECT_CREATE, 7, true }, { 1005, INV_OBJECT_SHOW, 7, true },
+        { 1010, INV_SYSTEM_FOREGROUND, 7, true },
+    };
+    for (int k = 0; k < 5; k++) events.push_back({ 1020 + 10 * k, INV_OBJECT_NAMECHANGE, 7, true });
+    ReplayStats s = Replay(events, { 1030, 1060 + DEBOUNCE_MS, 2000 }, 3000);
+    CHECK_EQ(s.delivered, 8);
+    CHECK_EQ(s.relevant, 8);
+    CHECK_EQ(s.rebuilds, 1);
+    CHECK_EQ(s.tabsFresh, 2);
+    CHECK_EQ(s.staleMs, 1060 + DEBOUNCE_MS - 1000);
+}
+
+// A drag keeps the snapshot stale on the inventory thread until it has been
+// quiet for the debounce: Tabs during it enumerate inline, the one after
+// is served from the rebuilt snapshot, and none sees the old rect
+static void TestDrag() {
+    std::vector<ScriptedEvent> events = { { 500, 0x000A, 2, true } };  // EVENT_SYSTEM_MOVESIZESTART
+    for (int k = 0; k < 60; k++) events.push_back({ 500 + 16 * k, INV_OBJECT_LOCATIONCHANGE, 2, true });
+    events.push_back({ 1460, INV_SYSTEM_MOVESIZEEND, 2, true });
+    ReplayStats s = Replay(events, { 400, 800, 802, 810, 1600 }, 2000);
+    CHECK_EQ(s.delivered, 61);
+    CHECK_EQ(s.relevant, 61);
+    CHECK_EQ(s.tabs, 5);
+    CHECK_EQ(s.tabsFresh, 2);
+    CHECK_EQ(s.tabsMoved, 0);
+    CHECK_EQ(s.rebuilds, 1);
+    CHECK_EQ(s.staleMs, 1460 + DEBOUNCE_MS - 500);
+    const double expect[] = { 100, 180, 180, 180, 100 };
+    CHECK_EQ((int)s.tabLatencyUs.size(), 5);
+    for (int k = 0; k < 5; k++) CHECK_EQ(s.tabLatencyUs[k], expect[k]);
+}
+
+// A window snapped by the keyboard moves with only a location change: the
+// inventory thread rebuilds after the debounce, and Tab never queries a rect
+static void TestSilentMove() {
+    ReplayStats s = Replay({ { 100, INV_OBJECT_LOCATIONCHANGE, 3, true } }, { 150, 200, 300 }, 400);
+    CHECK_EQ(s.delivered, 1);
+    CHECK_EQ(s.rebuilds, 1);
+    CHECK_EQ(s.tabsFresh, 2);
+    CHECK_EQ(s.tabsMoved, 0);
+    CHECK_EQ(s.staleMs, DEBOUNCE_MS);
+    CHECK_EQ(s.tabLatencyUs[0], 180.0);
+    CHECK_EQ(s.tabLatencyUs[1], 100.0);
+}
+
+// The same move under the earlier design, where location changes were not
+// hooked and Tab checked every snapshot window's rect itself: each Tab pays
+// for the check, and the one that finds the move enumerates as well
+static void TestTabRectCheck() {
+    static const InventoryEventRange unmoved[] = {
+        { INV_OBJECT_CREATE, INV_OBJECT_HIDE }, { INV_OBJECT_NAMECHANGE, INV_OBJECT_NAMECHANGE },
+        { INV_SYSTEM_FOREGROUND, INV_SYSTEM_FOREGROUND }, { INV_SYSTEM_MOVESIZEEND, INV_SYSTEM_MOVESIZEEND },
+        { INV_SYSTEM_MINIMIZESTART, INV_SYSTEM_MINIMIZEEND },
+    };
+    std::vector<ScriptedEvent> events = { { 100, INV_OBJECT_LOCATIONCHANGE, 3, true } };
+    InventoryReplay checked(unmoved, 5, DEBOUNCE_MS, 8, TestCosts(), true);
+    ReplayStats s = checked.Run(events, { 150, 300 }, 400);
+    CHECK_EQ(s.delivered, 0);
+    CHECK_EQ(s.tabsFresh, 1);
+    CHECK_EQ(s.tabsMoved, 0);
+    CHECK_EQ(s.tabLatencyUs[0], 100.0 + 8 + 80);
+    CHECK_EQ(s.tabLatencyUs[1], 100.0 + 8);
+
+    // Without the check or the hook, Tab would highlight the old rect
+    InventoryReplay unchecked(unmoved, 5, DEBOUNCE_MS, 8, TestCosts());
+    s = unchecked.Run(events, { 150, 300 }, 400);
+    CHECK_EQ(s.tabsFresh, 2);
+    CHECK_EQ(s.tabsMoved, 2);
+}
+
+// Child controls renaming and moving themselves, and focus and value churn,
+// never stale the snapshot
+static void TestChildChurn() {
+    std::vector<ScriptedEvent> events;
+    for (int k = 0; k < 200; k++) {
+        events.push_back({ 10 * k, INV_OBJECT_NAMECHANGE, k % 8, false });
+        events.push_back({ 10 * k + 1, 0x8005, k % 8, true });  // EVENT_OBJECT_FOCUS
+        events.push_back({ 10 * k + 2, 0x800E, k % 8, true });  // EVENT_OBJECT_VALUECHANGE
+        events.push_back({ 10 * k + 3, INV_OBJECT_LOCATIONCHANGE, k % 8, false });  // Child relayout
+    }
+    ReplayStats s = Replay(events, { 500, 1000, 1999 }, 2000);
+    CHECK_EQ(s.delivered, 400);
+    CHECK_EQ(s.relevant, 0);
+    CHECK_EQ(s.rebuilds, 0);
+    CHECK_EQ(s.tabsFresh, 3);
+    CHECK_EQ(s.staleMs, 0);
+}
+
+// Closing a window in the snapshot stales it; the snapshot never shows a
+// dead window to Tab
+static void TestClose() {
+    ReplayStats s = Replay({ { 100, INV_OBJECT_HIDE, 4, true }, { 101, INV_OBJECT_DESTROY, 4, false } },
+                           { 150, 300 }, 400);
+    CHECK_EQ(s.relevant, 2);
+    CHECK_EQ(s.rebuilds, 1);
+    CHECK_EQ(s.tabsFresh, 1);
+}
+
+int main() {
+    TestHookedEvents();
+    TestStaleRules();
+    TestAppLaunch();
+    TestDrag();
+    TestSilentMove();
+    TestTabRectCheck();
+    TestChildChurn();
+    TestClose();
+    return CheckResult("window_inventory_test");
+}
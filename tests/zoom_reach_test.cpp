@@ -0,0 +1,86 @@
+// Tests for core/ZoomMath.h: on every tested monitor, the cells, their
+// sub-cells and the zoom levels below them can put the mouse on every pixel
+#include "core/ZoomMath.h"
+#include "tests/Check.h"
+#include "tests/TestGrid.h"
+
+#include <vector>
+
+// Visit every region reachable by typing below each sub-cell of mon and
+// mark the pixel each one moves the mouse to. Returns the most letters typed
+// below a sub-cell to reach a single pixel.
+static int MarkReachable(const TestMonitor& mon, const TestCells& cells, std::vector<bool>& reached) {
+    int width = mon.rc.right - mon.rc.left;
+    auto mark = [&](TestPoint pt) {
+        CHECK(pt.x >= mon.rc.left && pt.x < mon.rc.right && pt.y >= mon.rc.top && pt.y < mon.rc.bottom);
+        reached[(size_t)(pt.y - mon.rc.top) * width + (pt.x - mon.rc.left)] = true;
+    };
+    struct Level { TestRect region; int depth; };
+    std::vector<Level> stack;
+    int deepest = 0;
+    for (int i = mon.firstCell; i < mon.firstCell + mon.cellCount; i++) {
+        const TestRect& cell = cells.rect[i];
+        CHECK(ZoomPartsTile(cell, 3, 3));
+        for (int sub = 0; sub < 9; sub++) {
+            TestRect rc = SubCellRect(cell, sub);
+            // Drawn sub-grid lines are the sub-cell edges
+            CHECK_EQ(rc.left, PartEdge(cell.left, cell.right, 3, sub % 3));
+            CHECK_EQ(rc.bottom, PartEdge(cell.top, cell.bottom, 3, sub / 3 + 1));
+            stack.push_back({ rc, 0 });
+        }
+        while (!stack.empty()) {
+            Level level = stack.back();
+            stack.pop_back();
+            mark(ZoomTarget<TestPoint>(level.region));
+            int cols, rows;
+            ZoomGridSize(level.region, &cols, &rows);
+            if (cols * rows <= 1) {
+                if (level.depth > deepest) deepest = level.depth;
+                continue;
+            }
+            CHECK(cols * rows <= 26);
+            CHECK(ZoomPartsTile(level.region, cols, rows));
+            for (int k = 0; k < cols * rows; k++) {
+                stack.push_back({ ZoomSubRegion(level.region, cols, rows, k), level.depth + 1 });
+            }
+        }
+    }
+    return deepest;
+}
+
+static void CheckMonitor(int width, int height, int dpi) {
+    std::vector<TestMonitor> monitors = { { { -width, 100, 0, 100 + height }, dpi } };
+    TestCells cells = {};
+    BuildTestGrid(monitors, cells);
+    const TestMonitor& mon = monitors[0];
+
+    // Cells tile the monitor
+    long long area = 0;
+    for (int i = 0; i < cells.count; i++) {
+        const TestRect& c = cells.rect[i];
+        CHECK(c.left < c.right && c.top < c.bottom);
+        area += (long long)(c.right - c.left) * (c.bottom - c.top);
+    }
+    CHECK_EQ(area, (long long)width * height);
+
+    std::vector<bool> reached((size_t)width * height);
+    int deepest = MarkReachable(mon, cells, reached);
+    long long missed = 0;
+    for (bool r : reached) missed += !r;
+    std::printf("%5dx%-5d @%3d dpi: %5d cells, up to %d zoom letters, %lld pixels unreachable\n",
+                width, height, dpi, cells.count, deepest, missed);
+    CHECK_EQ(missed, 0);
+}
+
+int main() {
+    CheckMonitor(1366, 768, 96);
+    CheckMonitor(1920, 1080, 96);
+    CheckMonitor(1080, 1920, 96);
+    CheckMonitor(2560, 1440, 120);
+    CheckMonitor(3440, 1440, 96);
+    CheckMonitor(3840, 2160, 144);
+    CheckMonitor(5120, 2880, 192);
+    CheckMonitor(7680, 4320, 96);
+    CheckMonitor(7680, 4320, 192);
+    return CheckResult("zoom_reach_test");
+}